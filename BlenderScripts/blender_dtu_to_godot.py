@@ -43,11 +43,259 @@ except:
     sys.path.append(script_dir)
     import blender_tools
 
+import gltf_tools
+gltf_tools.logFilename = logFilename
+
 def _add_to_log(sMessage):
     print(str(sMessage))
     with open(logFilename, "a") as file:
         file.write(sMessage + "\n")
 
+def _post_process_gltf(gltfFilePath, optimize_options, report_path):
+    if (not os.path.exists(gltfFilePath)):
+        return
+    bLimitSkinning = optimize_options.get("max_bone_influences", 0) > 0 or optimize_options.get("skin_weight_threshold", 0.0) > 0.0
+    if True not in optimize_options.values() and not bLimitSkinning:
+        return
+    try:
+        gltf_tools.optimize_gltf(gltfFilePath, optimize_options, report_path)
+    except Exception as e:
+        _add_to_log("ERROR: unable to optimize gltf file: " + gltfFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+
+def _transcode_textures(gltfFilePath, toktx_path, report_path):
+    if (not os.path.exists(gltfFilePath)):
+        return
+    try:
+        gltf_tools.transcode_textures_ktx2(gltfFilePath, toktx_path, report_path)
+    except Exception as e:
+        _add_to_log("ERROR: unable to transcode textures for gltf file: " + gltfFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+
+def _compress_glb(gltfFilePath, report_path):
+    if (not os.path.exists(gltfFilePath)):
+        return
+    try:
+        gltf_tools.compress_meshopt(gltfFilePath, None, report_path)
+    except Exception as e:
+        _add_to_log("ERROR: unable to compress glb file: " + gltfFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+
+def _publish_texture_variants(texture_folder, destinationPath):
+    # copies the 2k/ and 1k/ textures generated by the Daz plugin next to the asset, the .gdignore
+    # file keeps godot from importing them until a platform build switches to them
+    if not os.path.exists(texture_folder):
+        return
+    variants_folder = os.path.join(destinationPath, "TextureVariants").replace("\\","/")
+    if not os.path.exists(variants_folder):
+        os.makedirs(variants_folder)
+    open(os.path.join(variants_folder, ".gdignore"), "w").close()
+    num_variants = 0
+    for resolution in ["2k", "1k"]:
+        resolution_folder = os.path.join(texture_folder, resolution)
+        if not os.path.isdir(resolution_folder):
+            continue
+        if not os.path.exists(os.path.join(variants_folder, resolution)):
+            os.makedirs(os.path.join(variants_folder, resolution))
+        for filename in os.listdir(resolution_folder):
+            try:
+                shutil.copy(os.path.join(resolution_folder, filename), os.path.join(variants_folder, resolution, filename))
+                num_variants += 1
+            except Exception as e:
+                _add_to_log("ERROR: unable to copy texture variant: " + resolution + "/" + filename)
+                _add_to_log("EXCEPTION: " + str(e))
+    _add_to_log("DEBUG: published " + str(num_variants) + " texture variants to: " + variants_folder)
+
+SKELETON_REGISTRY_FILENAME = ".daz_skeleton.json"
+
+def _write_skeleton_registry(destinationPath, dtu_dict, scene_filename):
+    # records the skeleton of a published character so animation-only exports can find it,
+    # the leading dot hides the file from the Godot FileSystem dock
+    if dtu_dict.get("Skeleton Hash", "") == "":
+        return
+    registry = {"Skeleton Hash": dtu_dict["Skeleton Hash"], "Asset Name": dtu_dict["Asset Name"],
+                "Asset Id": dtu_dict.get("Asset Id", ""), "Scene": scene_filename}
+    try:
+        with open(os.path.join(destinationPath, SKELETON_REGISTRY_FILENAME), "w") as file:
+            json.dump(registry, file, indent=4)
+    except Exception as e:
+        _add_to_log("ERROR: unable to write skeleton registry: " + destinationPath)
+        _add_to_log("EXCEPTION: " + str(e))
+
+def _find_published_character(godot_project_path, skeleton_hash):
+    # returns the folder of the most recently published character with a matching skeleton, or None
+    matches = []
+    if skeleton_hash == "" or not os.path.exists(godot_project_path):
+        return None
+    for folder in os.listdir(godot_project_path):
+        registry_path = os.path.join(godot_project_path, folder, SKELETON_REGISTRY_FILENAME)
+        if not os.path.exists(registry_path):
+            continue
+        try:
+            with open(registry_path, "r") as file:
+                registry = json.load(file)
+        except Exception:
+            continue
+        if registry.get("Skeleton Hash") == skeleton_hash:
+            matches.append((os.path.getmtime(registry_path), os.path.join(godot_project_path, folder).replace("\\","/")))
+    if len(matches) == 0:
+        return None
+    return max(matches)[1]
+
+def _write_animation_library_import(gltfFilePath):
+    # imports the file as an AnimationLibrary instead of a scene, godot fills in the remaining settings
+    import_path = gltfFilePath + ".import"
+    if os.path.exists(import_path):
+        return
+    with open(import_path, "w") as file:
+        file.write('[remap]\n\nimporter="animation_library"\nimporter_version=1\ntype="AnimationLibrary"\n')
+
+def _write_scene_import_params(scene_path, params):
+    # sets [params] entries of the godot .import file, creating a minimal one which godot completes on import
+    import_path = scene_path + ".import"
+    if os.path.exists(import_path):
+        with open(import_path, "r") as file:
+            lines = file.read().splitlines()
+    else:
+        lines = ['[remap]', '', 'importer="scene"', 'importer_version=1', 'type="PackedScene"', '']
+    if "[params]" not in lines:
+        lines += ["[params]", ""]
+    params_start = lines.index("[params]") + 1
+    params_end = params_start
+    while params_end < len(lines) and not lines[params_end].startswith("["):
+        params_end += 1
+    for key, value in params.items():
+        entry = key + "=" + value
+        matches = [i for i in range(params_start, params_end) if lines[i].startswith(key + "=")]
+        if len(matches) > 0:
+            lines[matches[0]] = entry
+        else:
+            lines.insert(params_start, entry)
+            params_end += 1
+    with open(import_path, "w") as file:
+        file.write("\n".join(lines) + "\n")
+
+def _split_scene(gltfFilePath, godot_project_path, dtu_dict, report_path):
+    # returns the object files which godot imports, or the combined file if splitting failed
+    cell_size = dtu_dict.get("Scene Cell Size", gltf_tools.SCENE_CELL_SIZE)
+    try:
+        report = gltf_tools.split_scene(gltfFilePath, godot_project_path, cell_size, report_path)
+        _add_to_log("DEBUG: _split_scene(): saved scene: " + report["scene"])
+        return report["object_files"]
+    except Exception as e:
+        _add_to_log("ERROR: _split_scene(): unable to split scene: " + gltfFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+    return [gltfFilePath]
+
+PUBLISHED_DTU_FILENAME = ".daz_materials.dtu"
+
+def _publish_materials(jsonPath, destinationPath):
+    # keeps a copy of the exported DTU next to the asset, material updates are compared against it
+    try:
+        shutil.copy(jsonPath, os.path.join(destinationPath, PUBLISHED_DTU_FILENAME))
+    except Exception as e:
+        _add_to_log("ERROR: unable to publish DTU materials: " + destinationPath)
+        _add_to_log("EXCEPTION: " + str(e))
+
+def _changed_materials(published_materials, current_materials, published_time):
+    # names of the materials whose DTU entries differ from the published ones, or whose
+    # texture files were modified after the asset was published
+    published = {}
+    for mat in published_materials:
+        published.setdefault(mat["Material Name"], []).append(mat)
+    current = {}
+    for mat in current_materials:
+        current.setdefault(mat["Material Name"], []).append(mat)
+    changed = []
+    for name, entries in current.items():
+        if name not in published or json.dumps(entries, sort_keys=True) != json.dumps(published[name], sort_keys=True):
+            changed.append(name)
+            continue
+        for mat in entries:
+            textures = [property.get("Texture", "") for property in mat["Properties"]]
+            if any(texture != "" and os.path.exists(texture) and os.path.getmtime(texture) > published_time for texture in textures):
+                changed.append(name)
+                break
+    return changed
+
+def _update_materials(fbxPath, jsonPath, dtu_dict):
+    # re-exports only the changed materials of a published GLB/GLTF asset and patches them
+    # into the published file, its meshes, skin and animations are left untouched
+    godot_project_path = dtu_dict["Godot Project Folder"]
+    if (godot_project_path == ""):
+        godot_project_path = os.path.join(os.path.dirname(fbxPath), "godot_project").replace("\\","/")
+    destinationPath = os.path.join(godot_project_path, dtu_dict["Asset Name"]).replace("\\","/")
+    base_name = os.path.splitext(os.path.basename(fbxPath))[0]
+    published_files = [os.path.join(destinationPath, base_name + extension).replace("\\","/") for extension in [".glb", ".gltf"]]
+    published_files = [path for path in published_files if os.path.exists(path)]
+    published_dtu_path = os.path.join(destinationPath, PUBLISHED_DTU_FILENAME)
+    if len(published_files) == 0 or not os.path.exists(published_dtu_path):
+        _add_to_log("ERROR: _update_materials(): no published GLB or GLTF asset found in: " + destinationPath
+                    + ", export the asset first.  Material updates do not support the .blend formats.")
+        return
+    publishedFilePath = max(published_files, key=os.path.getmtime)
+    with open(published_dtu_path, "r") as file:
+        published_dict = json.load(file)
+    changed_names = _changed_materials(published_dict.get("Materials", []), dtu_dict.get("Materials", []),
+                                       os.path.getmtime(published_dtu_path))
+    _add_to_log("DEBUG: _update_materials(): " + str(len(changed_names)) + " changed materials: " + str(changed_names))
+    if len(changed_names) == 0:
+        _add_to_log("DEBUG: _update_materials(): materials are up to date: " + publishedFilePath)
+        return
+
+    # only the changed materials go through process_dtu
+    update_dict = dict(dtu_dict)
+    update_dict["Materials"] = [mat for mat in dtu_dict["Materials"] if mat["Material Name"] in changed_names]
+    update_json_path = jsonPath.replace(".dtu", "_material_update.dtu")
+    with open(update_json_path, "w") as file:
+        json.dump(update_dict, file, indent=4)
+    blender_tools.create_material_carriers(changed_names)
+    lowres_mode = None
+    if "Texture Resolution" in dtu_dict and dtu_dict["Texture Resolution"].lower() != "full":
+        lowres_mode = dtu_dict["Texture Resolution"]
+    blender_tools.process_dtu(update_json_path, lowres_mode)
+
+    update_folder = os.path.join(os.path.dirname(fbxPath), "MaterialUpdate").replace("\\","/")
+    if os.path.exists(update_folder):
+        shutil.rmtree(update_folder)
+    os.makedirs(update_folder)
+    updateFilePath = os.path.join(update_folder, os.path.basename(publishedFilePath)).replace("\\","/")
+    bGlb = publishedFilePath.endswith(".glb")
+    _add_to_log("DEBUG: _update_materials(): exporting changed materials to: " + updateFilePath)
+    try:
+        if bGlb:
+            bpy.ops.export_scene.gltf(filepath=updateFilePath, export_format="GLB", use_visible=True,
+                                      export_animations=False, export_morph=False, export_skins=False)
+        else:
+            bpy.ops.export_scene.gltf(filepath=updateFilePath, export_format="GLTF_SEPARATE", export_texture_dir="Textures",
+                                      use_visible=True, export_animations=False, export_morph=False, export_skins=False)
+        gltf_tools.patch_materials(publishedFilePath, updateFilePath, changed_names)
+    except Exception as e:
+        _add_to_log("ERROR: _update_materials(): unable to update materials of: " + publishedFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+        return
+    if dtu_dict.get("KTX2 Textures", False):
+        _transcode_textures(publishedFilePath, dtu_dict.get("Toktx Executable Path", ""), fbxPath.replace(".fbx", "_ktx2_report.json"))
+    if bGlb and dtu_dict.get("Meshopt Compression", False):
+        _compress_glb(publishedFilePath, fbxPath.replace(".fbx", "_meshopt_report.json"))
+    # the next update is compared against these materials
+    shutil.copy(jsonPath, published_dtu_path)
+    _add_to_log("DEBUG: _update_materials(): completed material update for: " + publishedFilePath)
+
+def _check_budgets(gltfFilePath, dtu_dict, report_path):
+    # compares the exported file against the budgets of the export profile, see gltf_tools.EXPORT_BUDGETS
+    if (not os.path.exists(gltfFilePath)):
+        return
+    budgets = {}
+    for dtu_key, description in gltf_tools.EXPORT_BUDGETS.values():
+        if dtu_key in dtu_dict:
+            budgets[dtu_key] = dtu_dict[dtu_key]
+    try:
+        gltf_tools.check_budgets(gltfFilePath, budgets, dtu_dict.get("Export Profile", ""), report_path)
+    except Exception as e:
+        _add_to_log("ERROR: unable to check budgets for gltf file: " + gltfFilePath)
+        _add_to_log("EXCEPTION: " + str(e))
+
 def _main(argv):
     try:
         line = str(argv[-1])
@@ -67,6 +315,15 @@ def _main(argv):
     blender_tools.switch_to_layout_mode()
 
     fbxPath = line.replace("\\","/").strip()
+    # a material update comes with a DTU only
+    jsonPath = fbxPath.replace(".fbx", ".dtu")
+    if os.path.exists(jsonPath):
+        with open(jsonPath, "r") as file:
+            dtu_dict = json.load(file)
+        if dtu_dict.get("Asset Type", "").lower() == "godot_material_update":
+            _update_materials(fbxPath, jsonPath, dtu_dict)
+            return
+
     if (not os.path.exists(fbxPath)):
         _add_to_log("ERROR: main(): fbx file not found: " + str(fbxPath))
         exit(1)
@@ -75,21 +332,119 @@ def _main(argv):
     # load FBX
     _add_to_log("DEBUG: main(): loading fbx file: " + str(fbxPath))
     blender_tools.import_fbx(fbxPath)
-    blender_tools.fix_eyes()
-    blender_tools.fix_scalp()
-
-    blender_tools.center_all_viewports()
     jsonPath = fbxPath.replace(".fbx", ".dtu")
     _add_to_log("DEBUG: main(): loading json file: " + str(jsonPath))
-    dtu_dict = blender_tools.process_dtu(jsonPath)
+    with open(jsonPath, "r") as file:
+        dtu_dict = json.load(file)
+    bAnimationOnly = (dtu_dict["Asset Type"].lower() == "godot_animation")
+    if bAnimationOnly:
+        # meshes and materials are reused from the published character
+        blender_tools.strip_to_armatures(dtu_dict["Asset Name"])
+        blender_tools.center_all_viewports()
+    else:
+        blender_tools.fix_eyes()
+        blender_tools.fix_scalp()
+        blender_tools.center_all_viewports()
+        # use the 2k/1k texture variants generated by the Daz plugin for the selected platform
+        lowres_mode = None
+        if "Texture Resolution" in dtu_dict and dtu_dict["Texture Resolution"].lower() != "full":
+            lowres_mode = dtu_dict["Texture Resolution"]
+        dtu_dict = blender_tools.process_dtu(jsonPath, lowres_mode)
 
+    # split the exported timeline into named clips, exported as separate animations in ACTIONS mode
+    if "Animation Clips" in dtu_dict and len(dtu_dict["Animation Clips"]) > 0:
+        blender_tools.split_animation_clips(dtu_dict["Animation Clips"])
     if "Has Animation" in dtu_dict:
         bHasAnimation = dtu_dict["Has Animation"]
     else:
         bHasAnimation = False
 
+    # morph encoding options
+    bSparseMorphs = True
+    if "Sparse Morph Encoding" in dtu_dict:
+        bSparseMorphs = dtu_dict["Sparse Morph Encoding"]
+    bQuantizeMorphs = False
+    if "Quantize Morph Deltas" in dtu_dict:
+        bQuantizeMorphs = dtu_dict["Quantize Morph Deltas"]
+    morph_prune_threshold = 0.0
+    if "Morph Prune Threshold" in dtu_dict:
+        morph_prune_threshold = dtu_dict["Morph Prune Threshold"]
+    blender_tools.prune_shape_keys(morph_prune_threshold)
+    bQuantizeVertices = False
+    if "Quantize Vertex Attributes" in dtu_dict:
+        bQuantizeVertices = dtu_dict["Quantize Vertex Attributes"]
+    # animation curve reduction options, tolerances in degrees, meters and scale ratio
+    bReduceAnimations = False
+    if "Reduce Animation Keys" in dtu_dict:
+        bReduceAnimations = dtu_dict["Reduce Animation Keys"]
+    bQuantizeAnimations = False
+    if "Quantize Animation Rotations" in dtu_dict:
+        bQuantizeAnimations = dtu_dict["Quantize Animation Rotations"]
+    animation_tolerances = {}
+    if "Animation Rotation Tolerance" in dtu_dict:
+        animation_tolerances["rotation"] = dtu_dict["Animation Rotation Tolerance"]
+    if "Animation Translation Tolerance" in dtu_dict:
+        animation_tolerances["translation"] = dtu_dict["Animation Translation Tolerance"]
+    if "Animation Scale Tolerance" in dtu_dict:
+        animation_tolerances["scale"] = dtu_dict["Animation Scale Tolerance"]
+    # skinning options, 0 = keep all influences
+    max_bone_influences = 0
+    if "Max Bone Influences" in dtu_dict:
+        max_bone_influences = dtu_dict["Max Bone Influences"]
+    skin_weight_threshold = 0.0
+    if "Skin Weight Threshold" in dtu_dict:
+        skin_weight_threshold = dtu_dict["Skin Weight Threshold"]
+    bRemoveUnusedBones = False
+    if "Remove Unused Bones" in dtu_dict:
+        bRemoveUnusedBones = dtu_dict["Remove Unused Bones"]
+    bPruneSurfaces = False
+    if "Prune Mesh Surfaces" in dtu_dict:
+        bPruneSurfaces = dtu_dict["Prune Mesh Surfaces"]
+    bDeduplicateMeshes = False
+    if "Deduplicate Meshes" in dtu_dict:
+        bDeduplicateMeshes = dtu_dict["Deduplicate Meshes"]
+    optimize_options = {
+        "prune_surfaces": bPruneSurfaces,
+        "deduplicate_meshes": bDeduplicateMeshes,
+        "max_bone_influences": max_bone_influences,
+        "skin_weight_threshold": skin_weight_threshold,
+        "remove_unused_bones": bRemoveUnusedBones,
+        "sparse_morphs": bSparseMorphs,
+        "quantize_morphs": bQuantizeMorphs,
+        "quantize_vertices": bQuantizeVertices,
+        "reduce_animations": bReduceAnimations,
+        "quantize_animations": bQuantizeAnimations,
+        "animation_tolerances": animation_tolerances,
+    }
+    bMeshoptCompression = False
+    if "Meshopt Compression" in dtu_dict:
+        bMeshoptCompression = dtu_dict["Meshopt Compression"]
+    bKtx2Textures = False
+    if "KTX2 Textures" in dtu_dict:
+        bKtx2Textures = dtu_dict["KTX2 Textures"]
+    toktx_path = ""
+    if "Toktx Executable Path" in dtu_dict:
+        toktx_path = dtu_dict["Toktx Executable Path"]
+
+    # texture atlas options
+    bAtlasTextures = False
+    if "Atlas Textures" in dtu_dict:
+        bAtlasTextures = dtu_dict["Atlas Textures"]
+    atlas_size = 4096
+    if "Atlas Size" in dtu_dict:
+        atlas_size = dtu_dict["Atlas Size"]
+    atlas_padding = 8
+    if "Atlas Padding" in dtu_dict:
+        atlas_padding = dtu_dict["Atlas Padding"]
+    if bAtlasTextures:
+        atlas_folder = os.path.join(os.path.dirname(jsonPath), "AtlasTextures").replace("\\","/")
+        try:
+            blender_tools.atlas_materials(dtu_dict["Materials"], atlas_folder, atlas_size, atlas_padding)
+        except Exception as e:
+            _add_to_log("ERROR: main(): texture atlasing failed: " + str(e))
+
     daz_generation = dtu_dict["Asset Id"]
-    if (bHasAnimation == False):
+    if (bHasAnimation == False and not bAnimationOnly):
         if ("Genesis8" in daz_generation):
             blender_tools.apply_tpose_for_g8_g9()
         elif ("Genesis9" in daz_generation):
@@ -131,10 +486,21 @@ def _main(argv):
 
     gltf_filename = os.path.basename(fbxPath).replace(".fbx", ".glb")
     destinationPath = os.path.join(godot_project_path, godot_asset_name).replace("\\","/")
+    if bAnimationOnly:
+        # animation libraries are saved next to the character they were exported from
+        skeleton_hash = dtu_dict.get("Skeleton Hash", "")
+        character_path = _find_published_character(godot_project_path, skeleton_hash)
+        if character_path is not None:
+            destinationPath = os.path.join(character_path, "Animations").replace("\\","/")
+            _add_to_log("DEBUG: main(): found published character for skeleton " + skeleton_hash + ": " + character_path)
+        else:
+            _add_to_log("ERROR: main(): no published character found for skeleton hash '" + skeleton_hash
+                        + "', export the character first.  Saving animation library to: " + destinationPath)
     if (not os.path.exists(destinationPath)):
         _add_to_log("DEBUG: creating destination folder: " + destinationPath)
         os.makedirs(destinationPath)
     gltfFilePath = os.path.join(destinationPath, gltf_filename).replace("\\","/")
+    optimize_report_path = fbxPath.replace(".fbx", "_optimize_report.json")
 
     image_cache_list = []
     # Copy files to godot project folder:    
@@ -181,6 +547,22 @@ def _main(argv):
         except Exception as e:
             _add_to_log("ERROR: unable to save blend file: " + blend_destination_path)
             _add_to_log("EXCEPTION: " + str(e))
+    elif godot_asset_type.lower() == "godot_animation":
+        _add_to_log("DEBUG: saving animation library to destination: " + gltfFilePath)
+        try:
+            bpy.ops.export_scene.gltf(filepath=gltfFilePath, export_format="GLB", use_visible=True, use_selection=True,
+                                      export_materials="NONE", export_morph=False,
+                                      export_animation_mode="ACTIONS", export_bake_animation=True,
+                                      export_anim_single_armature=True, export_reset_pose_bones=True,
+                                      export_optimize_animation_keep_anim_armature=True)
+            _add_to_log("DEBUG: save completed.")
+        except Exception as e:
+            _add_to_log("ERROR: unable to save animation library: " + gltfFilePath)
+            _add_to_log("EXCEPTION: " + str(e))
+        if os.path.exists(gltfFilePath):
+            gltf_tools.add_animation_skins(gltfFilePath)
+            _write_animation_library_import(gltfFilePath)
+        _post_process_gltf(gltfFilePath, optimize_options, optimize_report_path)
     elif godot_asset_type.lower() == "godot_glb":
         # save GLB file to godot project folder
         gltfFilePath = gltfFilePath.replace(".gltf", ".glb")
@@ -189,30 +571,64 @@ def _main(argv):
             bpy.ops.export_scene.gltf(filepath=gltfFilePath, export_format="GLB", use_visible=True, use_selection=True, 
                                       export_animation_mode="ACTIONS", export_bake_animation=True, 
                                       export_anim_single_armature=True, export_reset_pose_bones=True, 
-                                      export_optimize_animation_keep_anim_armature=True)
+                                      export_optimize_animation_keep_anim_armature=True,
+                                      export_try_sparse_sk=bSparseMorphs, export_tangents=True)
             _add_to_log("DEBUG: save completed.")
         except Exception as e:
             _add_to_log("ERROR: unable to save GLB file: " + gltfFilePath)
             _add_to_log("EXCEPTION: " + str(e))
+        _post_process_gltf(gltfFilePath, optimize_options, optimize_report_path)
+        if bKtx2Textures:
+            _transcode_textures(gltfFilePath, toktx_path, fbxPath.replace(".fbx", "_ktx2_report.json"))
+        if bMeshoptCompression:
+            _compress_glb(gltfFilePath, fbxPath.replace(".fbx", "_meshopt_report.json"))
     elif ( godot_asset_type.lower() == "godot_gltf" or
-          godot_asset_type.lower() == "godot_gltf_blend" ):
+          godot_asset_type.lower() == "godot_gltf_blend" or
+          godot_asset_type.lower() == "godot_scene" ):
         # create textures folder
         destination_texture_folder = os.path.join(destinationPath, "Textures").replace("\\","/")
         if (not os.path.exists(destination_texture_folder)):
             os.makedirs(destination_texture_folder)        
         # save GLTF file to godot project folder, specify textures folder
         gltfFilePath = gltfFilePath.replace(".glb", ".gltf")
+        # a scene export takes every visible object, the objects are split into separate files below
+        bUseSelection = godot_asset_type.lower() != "godot_scene"
         _add_to_log("DEBUG: saving GLTF file to destination: " + gltfFilePath)
         try:
-            bpy.ops.export_scene.gltf(filepath=gltfFilePath, export_format="GLTF_SEPARATE", export_texture_dir="Textures", use_visible=True, use_selection=True, 
+            bpy.ops.export_scene.gltf(filepath=gltfFilePath, export_format="GLTF_SEPARATE", export_texture_dir="Textures", use_visible=True, use_selection=bUseSelection, 
                                       export_animation_mode="ACTIONS", export_bake_animation=True,
                                       export_anim_single_armature=True, export_reset_pose_bones=True, 
-                                      export_optimize_animation_keep_anim_armature=True)
+                                      export_optimize_animation_keep_anim_armature=True,
+                                      export_try_sparse_sk=bSparseMorphs, export_tangents=True)
             _add_to_log("DEBUG: save completed.")
         except Exception as e:
             _add_to_log("ERROR: unable to save GLTF file: " + gltfFilePath)
             _add_to_log("EXCEPTION: " + str(e))
-        
+        _post_process_gltf(gltfFilePath, optimize_options, optimize_report_path)
+        # blender can not import KTX2 textures, so the .blend conversion keeps PNG/JPG
+        if bKtx2Textures and godot_asset_type.lower() in ["godot_gltf", "godot_scene"]:
+            _transcode_textures(gltfFilePath, toktx_path, fbxPath.replace(".fbx", "_ktx2_report.json"))
+
+    if not bAnimationOnly:
+        # the .blend formats are checked through the intermediate gltf, the BLEND format has none
+        if godot_asset_type.lower() != "godot_blend":
+            _check_budgets(gltfFilePath, dtu_dict, fbxPath.replace(".fbx", "_budget_report.ini"))
+        scene_paths = [gltfFilePath]
+        if godot_asset_type.lower() in ["godot_blend", "godot_gltf_blend"]:
+            scene_paths = [os.path.splitext(gltfFilePath)[0] + ".blend"]
+        elif godot_asset_type.lower() == "godot_scene":
+            scene_paths = _split_scene(gltfFilePath, godot_project_path, dtu_dict, fbxPath.replace(".fbx", "_scene_report.json"))
+        # godot generates the LODs on import and picks their number itself, 1 enables and 0 disables
+        # the generation, -1 keeps the import settings
+        generate_lods = dtu_dict.get("Generate LODs", -1)
+        if generate_lods >= 0:
+            for scene_path in scene_paths:
+                _write_scene_import_params(scene_path, {"meshes/generate_lods": "true" if generate_lods > 0 else "false"})
+        _write_skeleton_registry(destinationPath, dtu_dict, os.path.basename(gltfFilePath))
+        if godot_asset_type.lower() in ["godot_glb", "godot_gltf"]:
+            _publish_materials(jsonPath, destinationPath)
+        if dtu_dict.get("Publish Texture Variants", False):
+            _publish_texture_variants(os.path.join(intermediate_folder_path, "Textures"), destinationPath)
     _add_to_log("DEBUG: main(): completed conversion for: " + str(fbxPath))
 
 
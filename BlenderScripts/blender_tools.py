@@ -16,9 +16,10 @@ script_dir = str(Path( __file__ ).parent.absolute())
 logFilename = "blender_tools.log"
 
 ## Do not modify below
-import sys, json, os
+import sys, json, os, hashlib
 try:
     import bpy
+    import numpy as np
     import NodeArrange
 except:
     print("DEBUG: blender python libraries not detected, continuing for pydoc mode.")
@@ -63,6 +64,118 @@ def load_cached_image_to_material(matName, input_key, output_key, texture_map, t
     return link
 
 
+global_packed_image_cache = {}
+
+def pack_image_channels(name_suffix, channel_sources, output_folder, color_space="Non-Color"):
+    """Builds and saves a PNG whose R, G, B, A channels are copied from other
+    image files. channel_sources holds 4 entries, each None (filled with 1.0)
+    or a (filepath, channel index) pair. Channel index 3 falls back to the red
+    channel for files without alpha, ex: grayscale cutout maps. Sources are
+    scaled to the largest source size. Results are cached per combination so
+    materials sharing maps also share the packed image.
+    """
+    global global_packed_image_cache
+    cache_key = (tuple(channel_sources), color_space)
+    if cache_key in global_packed_image_cache:
+        _add_to_log("DEBUG: pack_image_channels(): using cached image: " + global_packed_image_cache[cache_key].name)
+        return global_packed_image_cache[cache_key]
+
+    source_paths = []
+    for source in channel_sources:
+        if source is not None and source[0] not in source_paths:
+            source_paths.append(source[0])
+    # only the output and one source are held in memory at a time: the sizes are read first and
+    # the pixel buffers freed, then each source is decoded again, copied into its channels and removed
+    source_images = {}
+    source_sizes = []
+    try:
+        for source_path in source_paths:
+            image = bpy.data.images.load(source_path, check_existing=False)
+            image.colorspace_settings.name = "Non-Color"
+            source_images[source_path] = image
+            source_sizes.append(tuple(image.size))
+            image.buffers_free()
+        width = max(size[0] for size in source_sizes)
+        height = max(size[1] for size in source_sizes)
+        if width == 0 or height == 0:
+            _add_to_log("ERROR: pack_image_channels(): unable to read images: " + str(source_paths))
+            return None
+
+        packed = np.ones((width * height, 4), dtype=np.float32)
+        pixels = np.empty(width * height * 4, dtype=np.float32)
+        for source_path in source_paths:
+            image = source_images[source_path]
+            if image.size[0] != width or image.size[1] != height:
+                _add_to_log("DEBUG: pack_image_channels(): scaling " + source_path + " to " + str(width) + "x" + str(height))
+                image.scale(width, height)
+            image.pixels.foreach_get(pixels)
+            bpy.data.images.remove(image)
+            del source_images[source_path]
+            source_pixels = pixels.reshape(-1, 4)
+            for dst_channel, source in enumerate(channel_sources):
+                if source is None or source[0] != source_path:
+                    continue
+                src_channel = source[1]
+                if src_channel == 3 and source_pixels[:, 3].min() >= 1.0:
+                    src_channel = 0
+                packed[:, dst_channel] = source_pixels[:, src_channel]
+        del source_pixels, pixels
+    finally:
+        for image in source_images.values():
+            bpy.data.images.remove(image)
+
+    first_source = os.path.splitext(os.path.basename(source_paths[0]))[0]
+    key_hash = hashlib.md5(str(cache_key).encode("utf-8")).hexdigest()[:8]
+    image_name = first_source + "_" + name_suffix + "_" + key_hash
+    packed_image = save_generated_image(image_name, packed, width, height, channel_sources[3] is not None, color_space, output_folder)
+    global_packed_image_cache[cache_key] = packed_image
+    return packed_image
+
+def save_generated_image(image_name, pixels, width, height, use_alpha, color_space, output_folder):
+    # creates an image datablock from a float RGBA pixel array (bottom row first) and saves it as PNG
+    if not os.path.exists(output_folder):
+        os.makedirs(output_folder)
+    output_path = os.path.join(output_folder, image_name + ".png").replace("\\", "/")
+    image = bpy.data.images.new(image_name, width, height, alpha=use_alpha)
+    image.colorspace_settings.name = color_space
+    image.pixels.foreach_set(np.ascontiguousarray(pixels, dtype=np.float32).ravel())
+    image.filepath_raw = output_path
+    image.file_format = "PNG"
+    image.save()
+    _add_to_log("DEBUG: save_generated_image(): saved image: " + output_path)
+    return image
+
+def get_gltf_material_output_group():
+    # node group recognized by the Blender glTF exporter for the occlusion texture
+    group = bpy.data.node_groups.get("glTF Material Output")
+    if group is None:
+        group = bpy.data.node_groups.new("glTF Material Output", "ShaderNodeTree")
+        if hasattr(group, "interface"):
+            group.interface.new_socket("Occlusion", in_out="INPUT", socket_type="NodeSocketFloat")
+        else:
+            group.inputs.new("NodeSocketFloat", "Occlusion")
+    return group
+
+def link_orm_image_to_material(matName, orm_image, use_occlusion, use_roughness, use_metallic):
+    data = bpy.data.materials[matName]
+    nodes = data.node_tree.nodes
+    links = data.node_tree.links
+    bsdf_inputs = nodes["Principled BSDF"].inputs
+    node_tex = nodes.new("ShaderNodeTexImage")
+    node_tex.image = orm_image
+    # glTF channel layout: R = occlusion, G = roughness, B = metallic
+    node_separate = nodes.new("ShaderNodeSeparateColor")
+    links.new(node_tex.outputs["Color"], node_separate.inputs["Color"])
+    if use_roughness:
+        links.new(node_separate.outputs["Green"], bsdf_inputs["Roughness"])
+    if use_metallic:
+        links.new(node_separate.outputs["Blue"], bsdf_inputs["Metallic"])
+    if use_occlusion:
+        node_output = nodes.new("ShaderNodeGroup")
+        node_output.node_tree = get_gltf_material_output_group()
+        links.new(node_separate.outputs["Red"], node_output.inputs["Occlusion"])
+
+
 def srgb_to_linear_rgb(srgb):
     if srgb < 0:
         return 0
@@ -112,6 +225,16 @@ def fix_scalp():
             mat.show_transparent_back = False
 
 def swap_lowres_filename(filename, lowres_mode="2k"):
+    # variants of the Daz texture stage are in 2k/ and 1k/ subfolders with the same filename,
+    # in those folders a "_2k" file is a source texture of its own and never a variant
+    texture_folder, texture_name = os.path.split(filename)
+    variant_folders = [os.path.join(texture_folder, "2k"), os.path.join(texture_folder, "1k")]
+    if any(os.path.isdir(folder) for folder in variant_folders):
+        if lowres_mode.lower() == "1k" and os.path.exists(os.path.join(variant_folders[1], texture_name)):
+            return os.path.join(variant_folders[1], texture_name)
+        if os.path.exists(os.path.join(variant_folders[0], texture_name)):
+            return os.path.join(variant_folders[0], texture_name)
+        return filename
     filename_base, ext = os.path.splitext(filename)
     filename_2k = filename_base + "_2k"
     filename_1k = filename_base + "_1k"
@@ -168,6 +291,37 @@ def clean_fcurves(obj, threshold=0.00001):
                     keyframe_points.remove(keyframe_points[i])
                 i -= 1
 
+def prune_shape_keys(prune_threshold=0.0, zero_threshold=0.000001):
+    # snap near-zero deltas to the basis so they can be dropped by sparse accessors,
+    # then remove shape keys whose largest remaining delta is below prune_threshold
+    # (thresholds are in world units, meters)
+    for obj in bpy.data.objects:
+        if obj.type != "MESH" or obj.data.shape_keys is None:
+            continue
+        key_blocks = obj.data.shape_keys.key_blocks
+        basis = obj.data.shape_keys.reference_key
+        num_verts = len(obj.data.vertices)
+        basis_co = np.empty(num_verts * 3, dtype=np.float32)
+        basis.data.foreach_get("co", basis_co)
+        basis_co = basis_co.reshape(num_verts, 3)
+        world_scale = max(obj.matrix_world.to_scale())
+        shape_co = np.empty(num_verts * 3, dtype=np.float32)
+        for key_block in list(key_blocks):
+            if key_block == basis:
+                continue
+            key_block.data.foreach_get("co", shape_co)
+            deltas = shape_co.reshape(num_verts, 3) - basis_co
+            magnitudes = np.linalg.norm(deltas, axis=1) * world_scale
+            max_delta = magnitudes.max() if num_verts > 0 else 0.0
+            if prune_threshold > 0.0 and max_delta < prune_threshold:
+                _add_to_log("DEBUG: prune_shape_keys(): removing shape key: " + obj.name + "." + key_block.name + ", max delta=" + str(max_delta))
+                obj.shape_key_remove(key_block)
+                continue
+            snap = magnitudes < zero_threshold
+            if snap.any():
+                cleaned = np.where(snap[:, None], basis_co, shape_co.reshape(num_verts, 3))
+                key_block.data.foreach_set("co", cleaned.ravel())
+
 def apply_tpose_for_g8_g9():
     _add_to_log("DEBUG: applying t-pose for G8/G9...")
 
@@ -286,7 +440,9 @@ def apply_tpose_for_g8_g9():
 
 
 
-def process_material(mat, lowres_mode=None):
+def process_material(mat, lowres_mode=None, packed_texture_folder=None):
+    # packed_texture_folder: if set, occlusion/roughness/metallic maps are packed into
+    # one ORM texture and cutout maps into the base color alpha, saved to this folder
     matName = ""
     colorMap = ""
     color_value = None
@@ -294,6 +450,7 @@ def process_material(mat, lowres_mode=None):
     metallic_weight = 0.0
     roughnessMap = ""
     roughness_value = 0.0
+    occlusionMap = ""
     reflectivity_value = 0.0
     emissionMap = ""
     emission_property = None
@@ -393,6 +550,10 @@ def process_material(mat, lowres_mode=None):
                 opacity_strength = property["Value"]
                 if lowres_mode is not None:
                     cutoutMap = swap_lowres_filename(cutoutMap, lowres_mode)
+            elif property["Name"] == "Ambient Occlusion":
+                occlusionMap = property["Texture"]
+                if lowres_mode is not None:
+                    occlusionMap = swap_lowres_filename(occlusionMap, lowres_mode)
             elif property["Name"] == "Horizontal Tiles":
                 horizontal_tiles = property["Value"]
             elif property["Name"] == "Vertical Tiles":
@@ -432,7 +593,34 @@ def process_material(mat, lowres_mode=None):
 
     bsdf_inputs = nodes["Principled BSDF"].inputs
 
-    if (colorMap != ""):
+    packed_color_image = None
+    if packed_texture_folder is not None:
+        orm_maps = [texture_map if (texture_map != "" and os.path.exists(texture_map)) else None
+                    for texture_map in [occlusionMap, roughnessMap, metallicMap]]
+        # only pack when it saves a texture
+        if len([texture_map for texture_map in orm_maps if texture_map is not None]) >= 2:
+            channel_sources = [(texture_map, 0) if texture_map is not None else None for texture_map in orm_maps] + [None]
+            orm_image = pack_image_channels("orm", channel_sources, packed_texture_folder)
+            if orm_image is not None:
+                link_orm_image_to_material(matName, orm_image, orm_maps[0] is not None, orm_maps[1] is not None, orm_maps[2] is not None)
+                # packed maps are already linked, only their default values are set below
+                roughnessMap = ""
+                metallicMap = ""
+        if (colorMap != "" and cutoutMap != "" and colorMap != cutoutMap
+                and os.path.exists(colorMap) and os.path.exists(cutoutMap)):
+            channel_sources = [(colorMap, 0), (colorMap, 1), (colorMap, 2), (cutoutMap, 3)]
+            packed_color_image = pack_image_channels("rgba", channel_sources, packed_texture_folder, "sRGB")
+    elif occlusionMap != "":
+        _add_to_log("DEBUG: process_dtu(): occlusion map is only exported when texture packing is enabled, skipping...")
+
+    if (packed_color_image is not None):
+        node_tex = nodes.new("ShaderNodeTexImage")
+        node_tex.image = packed_color_image
+        links = data.node_tree.links
+        links.new(node_tex.outputs["Color"], bsdf_inputs["Base Color"])
+        links.new(node_tex.outputs["Alpha"], bsdf_inputs["Alpha"])
+        bsdf_inputs["Base Color"].default_value = color_value
+    elif (colorMap != ""):
         if (not os.path.exists(colorMap)):
             _add_to_log("ERROR: process_dtu(): color map file does not exist, skipping...")
         else:
@@ -572,7 +760,8 @@ def process_material(mat, lowres_mode=None):
     if (cutoutMap != ""):
         if data.blend_method == "OPAQUE" or data.blend_method == "BLEND":
             data.blend_method = "HASHED"
-        load_cached_image_to_material(matName, "Alpha", "Alpha", cutoutMap, opacity_strength, "Non-Color")
+        if (packed_color_image is None):
+            load_cached_image_to_material(matName, "Alpha", "Alpha", cutoutMap, opacity_strength, "Non-Color")
     else:
         bsdf_inputs["Alpha"].default_value = opacity_strength
 
@@ -599,8 +788,11 @@ def process_material(mat, lowres_mode=None):
             else:
                 # create image texture node
                 node_tex = nodes.new("ShaderNodeTexImage")
-                node_tex.image = bpy.data.images.load(cutoutMap)
-                node_tex.image.colorspace_settings.name = "Non-Color"
+                if (packed_color_image is not None):
+                    node_tex.image = packed_color_image
+                else:
+                    node_tex.image = bpy.data.images.load(cutoutMap)
+                    node_tex.image.colorspace_settings.name = "Non-Color"
                 node_math = nodes.new("ShaderNodeMath")
                 node_math.operation = "MULTIPLY"
                 node_math.inputs[1].default_value = 0.5
@@ -612,7 +804,335 @@ def process_material(mat, lowres_mode=None):
     NodeArrange.toNodeArrange(data.node_tree.nodes)
     _add_to_log("DEBUG: process_dtu(): done processing material: " + matName)
 
-def process_dtu(jsonPath, lowres_mode=None):
+# Principled BSDF inputs which are baked into atlas textures, all other inputs must match to merge materials
+ATLAS_INPUTS = ["Base Color", "Alpha", "Roughness", "Metallic", "Normal", "Emission"]
+
+def linear_to_srgb(value):
+    if value <= 0.0031308:
+        return max(value, 0.0) * 12.92
+    return 1.055 * (value ** (1.0 / 2.4)) - 0.055
+
+def _get_linked_image_source(socket):
+    """Returns (image, channel) feeding a shader socket, where channel is
+    "rgb", "alpha" or a channel index when read through a Separate Color
+    node. Returns None if unlinked and False for other node setups.
+    """
+    if not socket.is_linked:
+        return None
+    link = socket.links[0]
+    node = link.from_node
+    if node.bl_idname == "ShaderNodeTexImage" and node.image is not None:
+        # repeating (tiled) textures can not be atlased
+        if node.inputs["Vector"].is_linked:
+            return False
+        return (node.image, "alpha" if link.from_socket.name == "Alpha" else "rgb")
+    if node.bl_idname in ["ShaderNodeSeparateColor", "ShaderNodeSeparateRGB"]:
+        channels = {"Red": 0, "Green": 1, "Blue": 2, "R": 0, "G": 1, "B": 2}
+        source = _get_linked_image_source(node.inputs[0])
+        if source and source[1] == "rgb" and link.from_socket.name in channels:
+            return (source[0], channels[link.from_socket.name])
+        return False
+    if node.bl_idname == "ShaderNodeNormalMap":
+        return _get_linked_image_source(node.inputs["Color"])
+    return False
+
+def _get_atlas_material_info(mat, dtu_material):
+    """Collects the texture sources and constant values of a material for
+    atlasing, plus a key which must be equal for materials to be merged.
+    Returns None if the material can not be atlased.
+    """
+    if mat is None or not mat.use_nodes:
+        return None
+    nodes = mat.node_tree.nodes
+    bsdf = nodes.get("Principled BSDF")
+    if bsdf is None:
+        return None
+    for property in dtu_material.get("Properties", []):
+        if property["Name"] == "Refraction Weight" and property["Value"] != 0.0:
+            return None
+        if property["Name"] in ["Horizontal Tiles", "Vertical Tiles"] and property["Value"] != 1.0:
+            return None
+
+    info = {"material": mat, "sources": {}, "values": {}, "normal_strength": None}
+    key = [dtu_material.get("Material Type", ""), mat.blend_method, mat.use_backface_culling]
+    for socket in bsdf.inputs:
+        if socket.name in ATLAS_INPUTS:
+            source = _get_linked_image_source(socket)
+            if source is False:
+                return None
+            if source is not None:
+                info["sources"][socket.name] = source
+            if hasattr(socket, "default_value"):
+                info["values"][socket.name] = socket.default_value[:] if hasattr(socket.default_value, "__len__") else socket.default_value
+            if socket.name == "Normal" and socket.is_linked and socket.links[0].from_node.bl_idname == "ShaderNodeNormalMap":
+                info["normal_strength"] = socket.links[0].from_node.inputs["Strength"].default_value
+        elif socket.is_linked:
+            return None
+        elif hasattr(socket, "default_value"):
+            value = socket.default_value
+            key.append(tuple(round(v, 4) for v in value) if hasattr(value, "__len__") else round(value, 4))
+    for node in nodes:
+        if node.bl_idname == "ShaderNodeGroup" and node.node_tree is not None and node.node_tree.name == "glTF Material Output":
+            if "Occlusion" in node.inputs:
+                source = _get_linked_image_source(node.inputs["Occlusion"])
+                if source is False:
+                    return None
+                if source is not None:
+                    info["sources"]["Occlusion"] = source
+    key.append(None if info["normal_strength"] is None else round(info["normal_strength"], 4))
+    info["key"] = tuple(key)
+    return info
+
+def _read_image_cell(image, width, height, pixel_cache):
+    # returns the image scaled to width x height as a (height, width, 4) float array
+    cache_key = (image.name, width, height)
+    if cache_key not in pixel_cache:
+        scaled = image.copy()
+        try:
+            scaled.colorspace_settings.name = "Non-Color"
+            scaled.scale(width, height)
+            pixels = np.empty(width * height * 4, dtype=np.float32)
+            scaled.pixels.foreach_get(pixels)
+        finally:
+            bpy.data.images.remove(scaled)
+        pixel_cache[cache_key] = pixels.reshape(height, width, 4)
+    return pixel_cache[cache_key]
+
+def _atlas_channel(info, source_name, inner_size, pixel_cache):
+    # returns (cell pixels, channel) for an atlas source or None
+    source = info["sources"].get(source_name)
+    if source is None:
+        return None
+    pixels = _read_image_cell(source[0], inner_size, inner_size, pixel_cache)
+    if source[1] == "alpha":
+        # grayscale cutout maps without alpha store opacity in the color channels
+        return pixels, (3 if pixels[:, :, 3].min() < 1.0 else 0)
+    if source[1] == "rgb":
+        return pixels, 0
+    return pixels, source[1]
+
+def _build_atlas_image(name, group, layout, layers, color_space, use_alpha, output_folder):
+    """layers: 4 entries (R, G, B, A), each a function(info, inner_size) which
+    returns a (inner_size, inner_size) array or a constant float.
+    """
+    atlas_width, atlas_height, cell_size, padding, columns = layout
+    inner_size = cell_size - 2 * padding
+    atlas = np.zeros((atlas_height, atlas_width, 4), dtype=np.float32)
+    for cell_index, info in enumerate(group):
+        cell = np.empty((inner_size, inner_size, 4), dtype=np.float32)
+        for channel, layer in enumerate(layers):
+            cell[:, :, channel] = layer(info, inner_size)
+        # replicate the border pixels into the padding to avoid mipmap bleeding between cells
+        if padding > 0:
+            cell = np.pad(cell, ((padding, padding), (padding, padding), (0, 0)), mode="edge")
+        x = (cell_index % columns) * cell_size
+        y = (cell_index // columns) * cell_size
+        atlas[y:y+cell_size, x:x+cell_size] = cell
+    return save_generated_image(name, atlas, atlas_width, atlas_height, use_alpha, color_space, output_folder)
+
+def _needs_atlas(group, source_names, value_name=None):
+    if any(source_name in info["sources"] for info in group for source_name in source_names):
+        return True
+    if value_name is not None:
+        values = set(str(info["values"].get(value_name)) for info in group)
+        return len(values) > 1
+    return False
+
+def _create_atlas_material(name, group, layout, output_folder):
+    atlas_width, atlas_height, cell_size, padding, columns = layout
+    first_mat = group[0]["material"]
+    new_mat = first_mat.copy()
+    new_mat.name = name
+    nodes = new_mat.node_tree.nodes
+    links = new_mat.node_tree.links
+    for node in list(nodes):
+        if node.bl_idname not in ["ShaderNodeBsdfPrincipled", "ShaderNodeOutputMaterial"]:
+            nodes.remove(node)
+    bsdf_inputs = nodes["Principled BSDF"].inputs
+    for socket_name in ATLAS_INPUTS:
+        for link in list(bsdf_inputs[socket_name].links):
+            links.remove(link)
+    pixel_cache = {}
+
+    def channel_layer(source_name, channel_index, fallback):
+        def layer(info, inner_size):
+            result = _atlas_channel(info, source_name, inner_size, pixel_cache)
+            if result is None:
+                return fallback(info)
+            pixels, channel = result
+            return pixels[:, :, channel if channel_index is None else channel_index]
+        return layer
+    def value_of(socket_name, index=None, srgb=False):
+        def fallback(info):
+            value = info["values"].get(socket_name, 1.0)
+            if index is not None:
+                value = value[index]
+            return linear_to_srgb(value) if srgb else value
+        return fallback
+
+    # base color and alpha
+    if _needs_atlas(group, ["Base Color", "Alpha"], "Base Color") or _needs_atlas(group, ["Alpha"], "Alpha"):
+        use_alpha = _needs_atlas(group, ["Alpha"], "Alpha") or any(info["values"].get("Alpha", 1.0) < 1.0 for info in group)
+        layers = [channel_layer("Base Color", i, value_of("Base Color", i, True)) for i in range(3)]
+        layers.append(channel_layer("Alpha", None, value_of("Alpha")))
+        image = _build_atlas_image(name + "_color", group, layout, layers, "sRGB", use_alpha, output_folder)
+        node_tex = nodes.new("ShaderNodeTexImage")
+        node_tex.image = image
+        links.new(node_tex.outputs["Color"], bsdf_inputs["Base Color"])
+        if use_alpha:
+            links.new(node_tex.outputs["Alpha"], bsdf_inputs["Alpha"])
+            bsdf_inputs["Alpha"].default_value = 1.0
+
+    # occlusion, roughness, metallic
+    use_occlusion = _needs_atlas(group, ["Occlusion"])
+    use_roughness = _needs_atlas(group, ["Roughness"], "Roughness")
+    use_metallic = _needs_atlas(group, ["Metallic"], "Metallic")
+    if use_occlusion or use_roughness or use_metallic:
+        layers = [channel_layer("Occlusion", None, lambda info: 1.0),
+                  channel_layer("Roughness", None, value_of("Roughness")),
+                  channel_layer("Metallic", None, value_of("Metallic")),
+                  lambda info, inner_size: 1.0]
+        image = _build_atlas_image(name + "_orm", group, layout, layers, "Non-Color", False, output_folder)
+        link_orm_image_to_material(new_mat.name, image, use_occlusion, use_roughness, use_metallic)
+
+    # normal
+    if _needs_atlas(group, ["Normal"]):
+        flat_normal = [0.5, 0.5, 1.0, 1.0]
+        layers = [channel_layer("Normal", i, lambda info, i=i: flat_normal[i]) for i in range(3)] + [lambda info, inner_size: 1.0]
+        image = _build_atlas_image(name + "_normal", group, layout, layers, "Non-Color", False, output_folder)
+        node_tex = nodes.new("ShaderNodeTexImage")
+        node_tex.image = image
+        node_normalmap = nodes.new("ShaderNodeNormalMap")
+        node_normalmap.space = "TANGENT"
+        node_normalmap.inputs["Strength"].default_value = group[0]["normal_strength"] if group[0]["normal_strength"] is not None else 1.0
+        links.new(node_tex.outputs["Color"], node_normalmap.inputs["Color"])
+        links.new(node_normalmap.outputs["Normal"], bsdf_inputs["Normal"])
+
+    # emission
+    if _needs_atlas(group, ["Emission"], "Emission"):
+        layers = [channel_layer("Emission", i, value_of("Emission", i, True)) for i in range(3)] + [lambda info, inner_size: 1.0]
+        image = _build_atlas_image(name + "_emission", group, layout, layers, "sRGB", False, output_folder)
+        node_tex = nodes.new("ShaderNodeTexImage")
+        node_tex.image = image
+        links.new(node_tex.outputs["Color"], bsdf_inputs["Emission"])
+
+    NodeArrange.toNodeArrange(nodes)
+    return new_mat
+
+def atlas_materials(dtu_materials, output_folder, atlas_size=4096, padding=8, max_cells=16):
+    """Merges compatible materials of each mesh into atlased materials.
+    Materials are compatible when their DTU material type, blend settings and
+    all shader inputs which are not baked into the atlas are equal. Each
+    material's textures are scaled into one cell of a square grid with
+    padding pixels of border replication, and the UVs of its faces are
+    remapped into that cell. Materials with tiled or out of range UVs are
+    left unchanged.
+    """
+    dtu_lookup = {}
+    for dtu_material in dtu_materials:
+        dtu_lookup[dtu_material["Material Name"]] = dtu_material
+    atlas_count = 0
+    for obj in bpy.data.objects:
+        if obj.type != "MESH" or obj.data.users > 1 or len(obj.data.materials) < 2 or obj.data.uv_layers.active is None:
+            continue
+        mesh = obj.data
+        uv_layer = mesh.uv_layers.active
+        uvs = np.empty(len(mesh.loops) * 2, dtype=np.float32)
+        uv_layer.data.foreach_get("uv", uvs)
+        uvs = uvs.reshape(-1, 2)
+        polygon_materials = np.empty(len(mesh.polygons), dtype=np.int32)
+        mesh.polygons.foreach_get("material_index", polygon_materials)
+        loop_totals = np.empty(len(mesh.polygons), dtype=np.int32)
+        mesh.polygons.foreach_get("loop_total", loop_totals)
+        loop_starts = np.empty(len(mesh.polygons), dtype=np.int32)
+        mesh.polygons.foreach_get("loop_start", loop_starts)
+        loop_materials = np.empty(len(mesh.loops), dtype=np.int32)
+        for start, total, material_index in zip(loop_starts, loop_totals, polygon_materials):
+            loop_materials[start:start+total] = material_index
+
+        # group compatible materials, keeping the UV tile of each material
+        groups = {}
+        for slot_index, mat in enumerate(mesh.materials):
+            if mat is None or mat.name not in dtu_lookup:
+                continue
+            loop_mask = loop_materials == slot_index
+            if not loop_mask.any():
+                continue
+            info = _get_atlas_material_info(mat, dtu_lookup[mat.name])
+            if info is None:
+                continue
+            slot_uvs = uvs[loop_mask]
+            tile = np.floor(slot_uvs.min(axis=0) + 0.0001)
+            if (slot_uvs.max(axis=0) - tile).max() > 1.0001:
+                _add_to_log("DEBUG: atlas_materials(): skipping material with UVs outside of one tile: " + mat.name)
+                continue
+            info["slot"] = slot_index
+            info["tile"] = tile
+            groups.setdefault(info["key"], []).append(info)
+
+        new_slot_materials = {}
+        for key, group in groups.items():
+            for chunk_start in range(0, len(group), max_cells):
+                chunk = group[chunk_start:chunk_start+max_cells]
+                if len(chunk) < 2:
+                    continue
+                columns = int(np.ceil(np.sqrt(len(chunk))))
+                rows = int(np.ceil(len(chunk) / columns))
+                cell_size = atlas_size // columns
+                cell_padding = min(padding, cell_size // 8)
+                layout = (cell_size * columns, cell_size * rows, cell_size, cell_padding, columns)
+                atlas_name = obj.name + "_atlas" + str(atlas_count)
+                atlas_count += 1
+                _add_to_log("DEBUG: atlas_materials(): merging " + str(len(chunk)) + " materials into " + atlas_name + ": "
+                            + str([info["material"].name for info in chunk]))
+                new_mat = _create_atlas_material(atlas_name, chunk, layout, output_folder)
+                atlas_width, atlas_height = layout[0], layout[1]
+                inner_size = cell_size - 2 * cell_padding
+                for cell_index, info in enumerate(chunk):
+                    loop_mask = loop_materials == info["slot"]
+                    x = (cell_index % columns) * cell_size + cell_padding
+                    y = (cell_index // columns) * cell_size + cell_padding
+                    local_uvs = np.clip(uvs[loop_mask] - info["tile"], 0.0, 1.0)
+                    uvs[loop_mask, 0] = (x + local_uvs[:, 0] * inner_size) / atlas_width
+                    uvs[loop_mask, 1] = (y + local_uvs[:, 1] * inner_size) / atlas_height
+                    new_slot_materials[info["slot"]] = new_mat
+
+        if len(new_slot_materials) == 0:
+            continue
+        uv_layer.data.foreach_set("uv", uvs.ravel())
+        # rebuild the material slots, dropping the merged materials
+        old_materials = list(mesh.materials)
+        new_materials = []
+        slot_remap = np.zeros(len(old_materials), dtype=np.int32)
+        for slot_index, mat in enumerate(old_materials):
+            mat = new_slot_materials.get(slot_index, mat)
+            if mat not in new_materials:
+                new_materials.append(mat)
+            slot_remap[slot_index] = new_materials.index(mat)
+        mesh.materials.clear()
+        for mat in new_materials:
+            mesh.materials.append(mat)
+        mesh.polygons.foreach_set("material_index", slot_remap[polygon_materials])
+        mesh.update()
+        _add_to_log("DEBUG: atlas_materials(): " + obj.name + ": " + str(len(old_materials)) + " materials -> " + str(len(new_materials)))
+
+
+def apply_texture_remap(dtu_dict):
+    # textures converted by the Daz plugin's texture stage are listed as source path -> converted path
+    if "Texture Remap" not in dtu_dict or len(dtu_dict["Texture Remap"]) == 0:
+        return
+    texture_remap = dtu_dict["Texture Remap"]
+    num_remapped = 0
+    for mat in dtu_dict["Materials"]:
+        for property in mat["Properties"]:
+            if "Texture" in property and property["Texture"] in texture_remap:
+                property["Texture"] = texture_remap[property["Texture"]]
+                num_remapped += 1
+    _add_to_log("DEBUG: apply_texture_remap(): remapped " + str(num_remapped) + " texture references")
+
+
+def process_dtu(jsonPath, lowres_mode=None, pack_orm=None):
+    # pack_orm: pack scalar maps into ORM/RGBA textures, defaults to the DTU "Pack ORM Textures" setting
     _add_to_log("DEBUG: process_dtu(): json file = " + jsonPath)
     jsonObj = {}
     dtuVersion = -1
@@ -629,6 +1149,16 @@ def process_dtu(jsonPath, lowres_mode=None):
         _add_to_log("ERROR: process_dtu(): unable to parse DTU: " + jsonPath)
         return
 
+    apply_texture_remap(jsonObj)
+
+    if pack_orm is None:
+        pack_orm = False
+        if "Pack ORM Textures" in jsonObj:
+            pack_orm = jsonObj["Pack ORM Textures"]
+    packed_texture_folder = None
+    if pack_orm:
+        packed_texture_folder = os.path.join(os.path.dirname(jsonPath), "PackedTextures").replace("\\", "/")
+
     # delete all nodes from materials so that we can rebuild them
     for mat in materialsList:
         matName = mat["Material Name"]
@@ -643,16 +1173,87 @@ def process_dtu(jsonPath, lowres_mode=None):
     # find and process each DTU material node
     for mat in materialsList:
         try:
-            process_material(mat, lowres_mode)
+            process_material(mat, lowres_mode, packed_texture_folder)
         except Exception as e:
             _add_to_log("ERROR: exception caught while processing material: " + mat["Material Name"] + ", " + str(e))
 
     _add_to_log("DEBUG: process_dtu(): done processing DTU: " + jsonPath)
     return jsonObj
 
+# blender frame of FBX time 0, the default anim_offset of the FBX importer
+FBX_IMPORT_ANIM_OFFSET = 1
+
 def import_fbx(fbxPath):
     _add_to_log("DEBUG: import_fbx(): fbx file = " + fbxPath)
-    bpy.ops.import_scene.fbx(filepath=fbxPath, use_prepost_rot=1)
+    bpy.ops.import_scene.fbx(filepath=fbxPath, use_prepost_rot=1, anim_offset=FBX_IMPORT_ANIM_OFFSET)
+
+def _copy_action_range(action, name, start_frame, end_frame):
+    # copies the keys within [start_frame, end_frame] of an action into a new action starting at frame 0
+    new_action = bpy.data.actions.new(name)
+    for fcurve in action.fcurves:
+        count = len(fcurve.keyframe_points)
+        if count == 0:
+            continue
+        co = np.empty(count * 2, dtype=np.float32)
+        fcurve.keyframe_points.foreach_get("co", co)
+        co = co.reshape(-1, 2)
+        in_range = (co[:, 0] >= start_frame - 0.001) & (co[:, 0] <= end_frame + 0.001)
+        if not in_range.any():
+            # hold the last value before the clip, like the baked timeline does
+            before = np.nonzero(co[:, 0] < start_frame)[0]
+            value = co[before[-1], 1] if len(before) > 0 else co[0, 1]
+            clip_co = np.array([[start_frame, value]], dtype=np.float32)
+        else:
+            clip_co = co[in_range]
+        clip_co[:, 0] -= start_frame
+        new_fcurve = new_action.fcurves.new(fcurve.data_path, index=fcurve.array_index, action_group=fcurve.group.name if fcurve.group else "")
+        new_fcurve.keyframe_points.add(len(clip_co))
+        new_fcurve.keyframe_points.foreach_set("co", clip_co.ravel())
+        new_fcurve.keyframe_points.foreach_set("interpolation", [bpy.types.Keyframe.bl_rna.properties["interpolation"].enum_items["LINEAR"].value] * len(clip_co))
+        new_fcurve.update()
+    new_action.use_fake_user = True
+    return new_action
+
+def split_animation_clips(clips):
+    """Splits the imported timeline action of each armature and shape key
+    block into one action per DTU "Animation Clips" entry, so the glTF
+    exporter writes each clip as a separate animation in ACTIONS mode.
+    Each clip is placed on a muted NLA track named after the clip, which the
+    exporter uses to merge shape key animation with the armature animation.
+    """
+    owners = [obj for obj in bpy.data.objects if obj.animation_data and obj.animation_data.action]
+    owners += [key for key in bpy.data.shape_keys if key.animation_data and key.animation_data.action]
+    for owner in owners:
+        timeline_action = owner.animation_data.action
+        for clip in clips:
+            start_frame = clip["Start Frame"] + FBX_IMPORT_ANIM_OFFSET
+            end_frame = clip["End Frame"] + FBX_IMPORT_ANIM_OFFSET
+            new_action = _copy_action_range(timeline_action, clip["Name"], start_frame, end_frame)
+            track = owner.animation_data.nla_tracks.new()
+            track.name = clip["Name"]
+            track.strips.new(new_action.name, 0, new_action)
+            track.mute = True
+            _add_to_log("DEBUG: split_animation_clips(): " + owner.name + ": " + new_action.name
+                        + " frames " + str(start_frame) + "-" + str(end_frame))
+        owner.animation_data.action = None
+        bpy.data.actions.remove(timeline_action)
+
+def strip_to_armatures(action_name=None):
+    # removes everything except armatures and their animation, for animation-only exports
+    bpy.ops.object.select_all(action="DESELECT")
+    for obj in list(bpy.data.objects):
+        if obj.type != "ARMATURE":
+            bpy.data.objects.remove(obj, do_unlink=True)
+    for obj in bpy.data.objects:
+        obj.select_set(True)
+    for mesh in bpy.data.meshes:
+        bpy.data.meshes.remove(mesh, do_unlink=True)
+    bpy.ops.outliner.orphans_purge(do_local_ids=True, do_linked_ids=True, do_recursive=True)
+    # name the clip after the asset, this becomes the animation name in the Godot AnimationLibrary
+    if action_name is not None and len(bpy.data.actions) == 1:
+        bpy.data.actions[0].name = action_name
+    _add_to_log("DEBUG: strip_to_armatures(): remaining objects: " + str([obj.name for obj in bpy.data.objects])
+                + ", actions: " + str([action.name for action in bpy.data.actions]))
 
 def delete_all_items():
 #    bpy.ops.object.mode_set(mode="OBJECT");
@@ -668,6 +1269,23 @@ def delete_all_items():
     bpy.ops.outliner.orphans_purge(do_local_ids=True, do_linked_ids=True, do_recursive=True)
 
 
+def create_material_carriers(material_names):
+    # one triangle with a UV layer per material, so that the gltf exporter writes materials
+    # which have no mesh in the scene, see blender_dtu_to_godot.py material updates
+    for name in material_names:
+        material = bpy.data.materials.get(name)
+        if material is None:
+            material = bpy.data.materials.new(name)
+        material.use_nodes = True
+        mesh = bpy.data.meshes.new(name)
+        mesh.from_pydata([(0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0)], [], [(0, 1, 2)])
+        mesh.uv_layers.new(name="UVMap")
+        mesh.materials.append(material)
+        obj = bpy.data.objects.new(name, mesh)
+        bpy.context.scene.collection.objects.link(obj)
+    _add_to_log("DEBUG: create_material_carriers(): created " + str(len(material_names)) + " material carriers")
+
+
 def switch_to_layout_mode():
     layout = bpy.data.workspaces.get("Layout")
     if (layout is not None):
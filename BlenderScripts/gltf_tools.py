@@ -0,0 +1,2823 @@
+"""glTF Tools module
+
+Python module containing post-processing tools which operate directly on the
+json and binary buffers of exported .gltf/.glb files. Used for optimizations
+which are not available from the Blender glTF exporter, ex: quantized and
+sparse morph target deltas, KHR_mesh_quantization vertex attributes,
+EXT_meshopt_compression buffer compression and KTX2 (KHR_texture_basisu)
+texture transcoding, and for checking exported files against the
+performance budgets of an export profile.
+
+Requirements:
+    - Python 3+
+    - numpy (bundled with Blender 3.6+)
+    - toktx from KTX-Software 4.x (KTX2 texture transcoding only)
+
+"""
+logFilename = "gltf_tools.log"
+
+## Do not modify below
+import os, sys, json, struct, base64, time, zlib, hashlib, tempfile, shutil, subprocess, configparser
+from urllib.parse import unquote
+from concurrent.futures import ThreadPoolExecutor
+try:
+    import numpy as np
+except:
+    print("DEBUG: numpy not detected, continuing for pydoc mode.")
+
+def _add_to_log(sMessage):
+    print(str(sMessage))
+    with open(logFilename, "a") as file:
+        file.write(sMessage + "\n")
+
+
+GLB_MAGIC = 0x46546C67
+GLB_CHUNK_JSON = 0x4E4F534A
+GLB_CHUNK_BIN = 0x004E4942
+
+BYTE = 5120
+UNSIGNED_BYTE = 5121
+SHORT = 5122
+UNSIGNED_SHORT = 5123
+UNSIGNED_INT = 5125
+FLOAT = 5126
+
+ARRAY_BUFFER = 34962
+ELEMENT_ARRAY_BUFFER = 34963
+
+COMPONENT_DTYPES = {
+    BYTE: "i1",
+    UNSIGNED_BYTE: "u1",
+    SHORT: "<i2",
+    UNSIGNED_SHORT: "<u2",
+    UNSIGNED_INT: "<u4",
+    FLOAT: "<f4",
+}
+
+TYPE_COMPONENTS = {
+    "SCALAR": 1,
+    "VEC2": 2,
+    "VEC3": 3,
+    "VEC4": 4,
+    "MAT2": 4,
+    "MAT3": 9,
+    "MAT4": 16,
+}
+
+
+def dequantize(values, component_type):
+    values = values.astype(np.float32)
+    if component_type == BYTE:
+        return np.maximum(values / 127.0, -1.0)
+    if component_type == UNSIGNED_BYTE:
+        return values / 255.0
+    if component_type == SHORT:
+        return np.maximum(values / 32767.0, -1.0)
+    if component_type == UNSIGNED_SHORT:
+        return values / 65535.0
+    return values
+
+def quantize_snorm(values, component_type):
+    scale = 127.0 if component_type == BYTE else 32767.0
+    quantized = np.round(np.clip(values, -1.0, 1.0) * scale)
+    return quantized.astype(COMPONENT_DTYPES[component_type])
+
+def quantize_unorm(values, component_type):
+    scale = 255.0 if component_type == UNSIGNED_BYTE else 65535.0
+    quantized = np.round(np.clip(values, 0.0, 1.0) * scale)
+    return quantized.astype(COMPONENT_DTYPES[component_type])
+
+
+MESHOPT_EXTENSION = "EXT_meshopt_compression"
+MESHOPT_GLB_SUFFIX = ".glb.meshopt"
+MESHOPT_VERTEX_HEADER = 0xA0
+MESHOPT_INDEX_SEQUENCE_HEADER = 0xD1
+MESHOPT_VERTEX_BLOCK_SIZE_BYTES = 8192
+MESHOPT_VERTEX_BLOCK_MAX_SIZE = 256
+MESHOPT_BYTE_GROUP_SIZE = 16
+MESHOPT_TAIL_MIN_SIZE = 32
+
+# number of escaped (all ones) values in a packed selector byte, indexed by byte value
+_MESHOPT_ESCAPES_2BIT = [sum(1 for shift in (6, 4, 2, 0) if (value >> shift) & 3 == 3) for value in range(256)]
+_MESHOPT_ESCAPES_4BIT = [sum(1 for shift in (4, 0) if (value >> shift) & 15 == 15) for value in range(256)]
+
+
+def _meshopt_vertex_block_size(byte_stride):
+    block_size = (MESHOPT_VERTEX_BLOCK_SIZE_BYTES // byte_stride) & ~(MESHOPT_BYTE_GROUP_SIZE - 1)
+    return min(block_size, MESHOPT_VERTEX_BLOCK_MAX_SIZE)
+
+def _meshopt_encode_byte_streams(values):
+    """Encodes (streams, groups, 16) zigzag deltas, each stream being one
+    byte column of one vertex block, and returns the concatenated streams
+    as a uint8 array. Each group of 16 bytes is stored as zeros, 2-bit or
+    4-bit selectors with escaped bytes, or raw bytes, whichever is smaller.
+    """
+    num_streams, num_groups, _ = values.shape
+    escaped_2bit = values >= 3
+    escaped_4bit = values >= 15
+    cost_2bit = 4 + escaped_2bit.sum(axis=2)
+    cost_4bit = 8 + escaped_4bit.sum(axis=2)
+    modes = np.where(cost_2bit <= cost_4bit, 1, 2)
+    costs = np.minimum(cost_2bit, cost_4bit)
+    modes[costs >= 16] = 3
+    costs = np.minimum(costs, 16)
+    zero_groups = ~values.any(axis=2)
+    modes[zero_groups] = 0
+    costs[zero_groups] = 0
+
+    payload = np.zeros((num_streams, num_groups, 24), dtype=np.uint8)
+    for mode, bits, escaped in [(1, 2, escaped_2bit), (2, 4, escaped_4bit)]:
+        selected = modes == mode
+        if not selected.any():
+            continue
+        group_values = values[selected]
+        group_escaped = escaped[selected]
+        selectors = np.minimum(group_values, (1 << bits) - 1).reshape(len(group_values), -1, 8 // bits)
+        shifts = np.arange(8 - bits, -1, -bits, dtype=np.uint8)
+        packed = np.bitwise_or.reduce(selectors << shifts, axis=2).astype(np.uint8)
+        # escaped bytes follow the selectors, in the order they appear
+        order = np.argsort(~group_escaped, axis=1, kind="stable")
+        extra = np.take_along_axis(group_values, order, axis=1)
+        payload[selected] = np.concatenate([packed, extra, np.zeros((len(group_values), 8 - packed.shape[1]), dtype=np.uint8)], axis=1)
+    raw = modes == 3
+    payload[raw, :16] = values[raw]
+
+    header_size = (num_groups + 3) // 4
+    header_modes = np.zeros((num_streams, header_size * 4), dtype=np.uint8)
+    header_modes[:, :num_groups] = modes
+    header = np.bitwise_or.reduce(header_modes.reshape(num_streams, header_size, 4) << np.array([0, 2, 4, 6], dtype=np.uint8), axis=2).astype(np.uint8)
+
+    rows = np.concatenate([header, payload.reshape(num_streams, -1)], axis=1)
+    mask = np.concatenate([np.ones((num_streams, header_size), dtype=bool),
+                           (np.arange(24) < costs[:, :, None]).reshape(num_streams, -1)], axis=1)
+    return rows[mask]
+
+def meshopt_encode_vertex_buffer(data, count, byte_stride):
+    """Encodes count elements of byte_stride bytes with the meshoptimizer
+    vertex codec (EXT_meshopt_compression mode ATTRIBUTES, version 0).
+    """
+    if byte_stride % 4 != 0 or byte_stride > 256:
+        raise ValueError("meshopt vertex codec requires a byte stride divisible by 4 and at most 256")
+    vertices = np.frombuffer(data, dtype=np.uint8, count=count * byte_stride).reshape(count, byte_stride)
+    previous = np.empty_like(vertices)
+    if count > 0:
+        previous[0] = vertices[0]
+        previous[1:] = vertices[:-1]
+    deltas = vertices - previous
+    zigzag = (deltas << 1) ^ (deltas.view(np.int8) >> 7).view(np.uint8)
+
+    parts = [np.array([MESHOPT_VERTEX_HEADER], dtype=np.uint8)]
+    block_size = _meshopt_vertex_block_size(byte_stride)
+    num_full_blocks = count // block_size
+    if num_full_blocks > 0:
+        blocks = zigzag[:num_full_blocks * block_size].reshape(num_full_blocks, block_size, byte_stride)
+        streams = blocks.transpose(0, 2, 1).reshape(num_full_blocks * byte_stride, -1, MESHOPT_BYTE_GROUP_SIZE)
+        parts.append(_meshopt_encode_byte_streams(streams))
+    remainder = count - num_full_blocks * block_size
+    if remainder > 0:
+        aligned = (remainder + MESHOPT_BYTE_GROUP_SIZE - 1) & ~(MESHOPT_BYTE_GROUP_SIZE - 1)
+        block = np.zeros((aligned, byte_stride), dtype=np.uint8)
+        block[:remainder] = zigzag[num_full_blocks * block_size:]
+        parts.append(_meshopt_encode_byte_streams(block.T.reshape(byte_stride, -1, MESHOPT_BYTE_GROUP_SIZE)))
+
+    # the tail holds the first vertex, which seeds the delta decoding
+    tail = np.zeros(max(byte_stride, MESHOPT_TAIL_MIN_SIZE), dtype=np.uint8)
+    if count > 0:
+        tail[-byte_stride:] = vertices[0]
+    parts.append(tail)
+    return np.concatenate(parts).tobytes()
+
+def meshopt_decode_vertex_buffer(data, count, byte_stride):
+    if byte_stride % 4 != 0 or byte_stride > 256:
+        raise ValueError("meshopt vertex codec requires a byte stride divisible by 4 and at most 256")
+    tail_size = max(byte_stride, MESHOPT_TAIL_MIN_SIZE)
+    if len(data) < 1 + tail_size or (data[0] & 0xF0) != MESHOPT_VERTEX_HEADER or (data[0] & 0x0F) != 0:
+        raise ValueError("unsupported meshopt vertex buffer header")
+
+    # the group sizes depend on their contents, so locate every group first
+    block_size = _meshopt_vertex_block_size(byte_stride)
+    group_modes = []
+    group_offsets = []
+    block_groups = []
+    position = 1
+    for block_start in range(0, count, block_size):
+        num_groups = (min(block_size, count - block_start) + MESHOPT_BYTE_GROUP_SIZE - 1) // MESHOPT_BYTE_GROUP_SIZE
+        block_groups.append(num_groups)
+        header_size = (num_groups + 3) // 4
+        for _ in range(byte_stride):
+            header = data[position:position + header_size]
+            position += header_size
+            for group in range(num_groups):
+                mode = (header[group >> 2] >> ((group & 3) * 2)) & 3
+                group_modes.append(mode)
+                group_offsets.append(position)
+                if mode == 1:
+                    position += 4 + sum(_MESHOPT_ESCAPES_2BIT[value] for value in data[position:position + 4])
+                elif mode == 2:
+                    position += 8 + sum(_MESHOPT_ESCAPES_4BIT[value] for value in data[position:position + 8])
+                elif mode == 3:
+                    position += 16
+        if position + tail_size > len(data):
+            raise ValueError("meshopt vertex buffer is truncated")
+    if position + tail_size != len(data):
+        raise ValueError("meshopt vertex buffer has unexpected trailing data")
+
+    buffer = np.frombuffer(data, dtype=np.uint8)
+    modes = np.array(group_modes, dtype=np.uint8)
+    offsets = np.array(group_offsets, dtype=np.int64)
+    groups = np.zeros((len(modes), MESHOPT_BYTE_GROUP_SIZE), dtype=np.uint8)
+    for mode, bits in [(1, 2), (2, 4)]:
+        selected = modes == mode
+        if not selected.any():
+            continue
+        selector_size = 2 * bits
+        packed = buffer[offsets[selected, None] + np.arange(selector_size)]
+        shifts = np.arange(8 - bits, -1, -bits, dtype=np.uint8)
+        selectors = ((packed[:, :, None] >> shifts) & ((1 << bits) - 1)).reshape(len(packed), MESHOPT_BYTE_GROUP_SIZE)
+        escaped = selectors == (1 << bits) - 1
+        extra_offsets = offsets[selected, None] + selector_size + np.cumsum(escaped, axis=1) - 1
+        groups[selected] = np.where(escaped, buffer[np.minimum(extra_offsets, len(buffer) - 1)], selectors)
+    raw = modes == 3
+    if raw.any():
+        groups[raw] = buffer[offsets[raw, None] + np.arange(MESHOPT_BYTE_GROUP_SIZE)]
+
+    zigzag = np.empty((count, byte_stride), dtype=np.uint8)
+    group_index = 0
+    for block_index, num_groups in enumerate(block_groups):
+        block_start = block_index * block_size
+        block_count = min(block_size, count - block_start)
+        streams = groups[group_index:group_index + byte_stride * num_groups].reshape(byte_stride, -1)
+        zigzag[block_start:block_start + block_count] = streams[:, :block_count].T
+        group_index += byte_stride * num_groups
+    deltas = ((zigzag & 1) * np.uint8(255)) ^ (zigzag >> 1)
+    if count > 0:
+        deltas[0] += buffer[-byte_stride:]
+    return np.cumsum(deltas, axis=0, dtype=np.uint8).tobytes()
+
+def meshopt_encode_index_sequence(indices):
+    """Encodes an index array with the meshoptimizer index sequence codec
+    (EXT_meshopt_compression mode INDICES, version 1).
+    """
+    data = bytearray([MESHOPT_INDEX_SEQUENCE_HEADER])
+    last = [0, 0]
+    current = 0
+    for index in indices.tolist():
+        delta = (index - last[current]) & 0xFFFFFFFF
+        if delta >= 0x80000000:
+            delta = 0x100000000 - delta
+        # switch to the other baseline when the delta no longer fits a single byte
+        if delta >= 30:
+            current ^= 1
+        delta = (index - last[current]) & 0xFFFFFFFF
+        value = ((delta << 1) ^ (0xFFFFFFFF if delta & 0x80000000 else 0)) & 0xFFFFFFFF
+        value = ((value << 1) | current) & 0xFFFFFFFF
+        while value > 127:
+            data.append((value & 127) | 128)
+            value >>= 7
+        data.append(value)
+        last[current] = index
+    data += b"\0" * 4
+    return bytes(data)
+
+def meshopt_decode_index_sequence(data, count, byte_stride):
+    if len(data) < 1 + count + 4 or data[0] != MESHOPT_INDEX_SEQUENCE_HEADER:
+        raise ValueError("unsupported meshopt index sequence header")
+    indices = []
+    last = [0, 0]
+    position = 1
+    end = len(data) - 4
+    for _ in range(count):
+        value = 0
+        shift = 0
+        while True:
+            if position >= end:
+                raise ValueError("meshopt index sequence is truncated")
+            byte = data[position]
+            position += 1
+            value |= (byte & 127) << shift
+            shift += 7
+            if byte < 128:
+                break
+        value &= 0xFFFFFFFF
+        current = value & 1
+        value >>= 1
+        delta = (value >> 1) ^ (0xFFFFFFFF if value & 1 else 0)
+        index = (last[current] + delta) & 0xFFFFFFFF
+        last[current] = index
+        indices.append(index)
+    if position != end:
+        raise ValueError("meshopt index sequence has unexpected trailing data")
+    return np.array(indices, dtype="<u2" if byte_stride == 2 else "<u4").tobytes()
+
+
+def _is_glb_path(path):
+    return path.lower().endswith((".glb", MESHOPT_GLB_SUFFIX))
+
+
+class GltfAsset:
+    """In-memory .gltf/.glb file, with each bufferView held as a separate
+    bytes object so that accessors can be rewritten independently. All
+    bufferViews are repacked into a single buffer on save(). Views stored
+    with EXT_meshopt_compression are decoded on load. With load=False an
+    empty asset is created which is written to path on save().
+    """
+    def __init__(self, path, load=True):
+        self.path = path
+        self.is_glb = _is_glb_path(path)
+        self.json = {}
+        self.view_data = []
+        self._external_buffer_paths = []
+        if load:
+            self._load()
+
+    def _load(self):
+        glb_bin_chunk = None
+        if self.is_glb:
+            with open(self.path, "rb") as file:
+                data = file.read()
+            magic, version, length = struct.unpack_from("<III", data, 0)
+            if magic != GLB_MAGIC:
+                raise ValueError("not a GLB file: " + self.path)
+            offset = 12
+            while offset < length:
+                chunk_length, chunk_type = struct.unpack_from("<II", data, offset)
+                offset += 8
+                if chunk_type == GLB_CHUNK_JSON:
+                    self.json = json.loads(data[offset:offset+chunk_length].decode("utf-8"))
+                elif chunk_type == GLB_CHUNK_BIN and glb_bin_chunk is None:
+                    glb_bin_chunk = data[offset:offset+chunk_length]
+                offset += chunk_length
+        else:
+            with open(self.path, "r", encoding="utf-8") as file:
+                self.json = json.load(file)
+
+        folder = os.path.dirname(self.path)
+        buffers_data = []
+        for buffer_index, buffer in enumerate(self.json.get("buffers", [])):
+            uri = buffer.get("uri")
+            if uri is None:
+                if buffer_index == 0 and glb_bin_chunk is not None:
+                    buffers_data.append(glb_bin_chunk)
+                else:
+                    buffers_data.append(b"")
+            elif uri.startswith("data:"):
+                buffers_data.append(base64.b64decode(uri.split(",", 1)[1]))
+            else:
+                buffer_path = os.path.join(folder, unquote(uri))
+                self._external_buffer_paths.append(buffer_path)
+                with open(buffer_path, "rb") as file:
+                    buffers_data.append(file.read())
+
+        for view in self.json.get("bufferViews", []):
+            compression = view.get("extensions", {}).pop(MESHOPT_EXTENSION, None)
+            if compression is not None:
+                self.view_data.append(self._decode_meshopt_view(view, compression, buffers_data))
+                if len(view["extensions"]) == 0:
+                    view.pop("extensions")
+                continue
+            offset = view.get("byteOffset", 0)
+            self.view_data.append(buffers_data[view["buffer"]][offset:offset+view["byteLength"]])
+        self._remove_extension(MESHOPT_EXTENSION)
+
+    def _decode_meshopt_view(self, view, compression, buffers_data):
+        offset = compression.get("byteOffset", 0)
+        data = buffers_data[compression["buffer"]][offset:offset+compression["byteLength"]]
+        if compression.get("filter", "NONE") != "NONE":
+            raise ValueError("unsupported " + MESHOPT_EXTENSION + " filter: " + compression["filter"])
+        if compression["mode"] == "ATTRIBUTES":
+            decoded = meshopt_decode_vertex_buffer(data, compression["count"], compression["byteStride"])
+        elif compression["mode"] == "INDICES":
+            decoded = meshopt_decode_index_sequence(data, compression["count"], compression["byteStride"])
+        else:
+            raise ValueError("unsupported " + MESHOPT_EXTENSION + " mode: " + compression["mode"])
+        if len(decoded) != view["byteLength"]:
+            raise ValueError(MESHOPT_EXTENSION + " bufferView decoded to " + str(len(decoded))
+                             + " bytes, expected " + str(view["byteLength"]))
+        return decoded
+
+    def _meshopt_view_layouts(self):
+        """Returns {view index: (mode, byte stride)} for each bufferView which
+        can be stored losslessly with the meshopt vertex or index codecs.
+        """
+        accessors = self.json.get("accessors", [])
+        element_sizes = {}
+        index_views = set()
+        def add_element(view_index, component_type, type_name):
+            size = np.dtype(COMPONENT_DTYPES[component_type]).itemsize * TYPE_COMPONENTS[type_name]
+            element_sizes.setdefault(view_index, set()).add(size)
+        for accessor in accessors:
+            if "bufferView" in accessor:
+                add_element(accessor["bufferView"], accessor["componentType"], accessor["type"])
+            sparse = accessor.get("sparse")
+            if sparse:
+                add_element(sparse["indices"]["bufferView"], sparse["indices"]["componentType"], "SCALAR")
+                add_element(sparse["values"]["bufferView"], accessor["componentType"], accessor["type"])
+                index_views.add(sparse["indices"]["bufferView"])
+        # images and primitive extensions (ex: draco) are already compressed
+        excluded = set(image["bufferView"] for image in self.json.get("images", []) if "bufferView" in image)
+        for mesh in self.json.get("meshes", []):
+            for primitive in mesh.get("primitives", []):
+                if "indices" in primitive and "bufferView" in accessors[primitive["indices"]]:
+                    index_views.add(accessors[primitive["indices"]]["bufferView"])
+                for extension in primitive.get("extensions", {}).values():
+                    if isinstance(extension, dict) and "bufferView" in extension:
+                        excluded.add(extension["bufferView"])
+
+        layouts = {}
+        for view_index, view in enumerate(self.json.get("bufferViews", [])):
+            sizes = element_sizes.get(view_index, set())
+            if view_index in excluded or len(sizes) != 1:
+                continue
+            size = sizes.pop()
+            if view_index in index_views or view.get("target") == ELEMENT_ARRAY_BUFFER:
+                if size in (2, 4) and view["byteLength"] % size == 0:
+                    layouts[view_index] = ("INDICES", size)
+                continue
+            stride = view.get("byteStride", size)
+            if stride % 4 == 0 and stride <= 256 and view["byteLength"] % stride == 0:
+                layouts[view_index] = ("ATTRIBUTES", stride)
+        return layouts
+
+    def _remove_extension(self, name):
+        for key in ["extensionsUsed", "extensionsRequired"]:
+            if name in self.json.get(key, []):
+                self.json[key].remove(name)
+                if len(self.json[key]) == 0:
+                    self.json.pop(key)
+
+    def save(self, path=None, meshopt=False):
+        """Writes the asset to path, or back to its own path. With meshopt,
+        every bufferView the codecs support is stored compressed with
+        EXT_meshopt_compression, backed by a fallback buffer without data.
+        """
+        if path is None:
+            path = self.path
+        self.remove_unused_buffer_views()
+        self._remove_extension(MESHOPT_EXTENSION)
+        layouts = self._meshopt_view_layouts() if meshopt else {}
+
+        blob = bytearray()
+        fallback_length = 0
+        for view_index, (view, data) in enumerate(zip(self.json.get("bufferViews", []), self.view_data)):
+            if MESHOPT_EXTENSION in view.get("extensions", {}):
+                view["extensions"].pop(MESHOPT_EXTENSION)
+                if len(view["extensions"]) == 0:
+                    view.pop("extensions")
+            blob += b"\0" * (-len(blob) % 4)
+            encoded = None
+            if view_index in layouts:
+                mode, stride = layouts[view_index]
+                if mode == "ATTRIBUTES":
+                    encoded = meshopt_encode_vertex_buffer(data, len(data) // stride, stride)
+                else:
+                    encoded = meshopt_encode_index_sequence(np.frombuffer(data, dtype="<u2" if stride == 2 else "<u4"))
+                if len(encoded) >= len(data):
+                    encoded = None
+            if encoded is None:
+                view["buffer"] = 0
+                view["byteOffset"] = len(blob)
+                view["byteLength"] = len(data)
+                blob += data
+                continue
+            fallback_length += -fallback_length % 4
+            view["buffer"] = 1
+            view["byteOffset"] = fallback_length
+            view["byteLength"] = len(data)
+            fallback_length += len(data)
+            view.setdefault("extensions", {})[MESHOPT_EXTENSION] = {
+                "buffer": 0, "byteOffset": len(blob), "byteLength": len(encoded),
+                "byteStride": stride, "count": len(data) // stride, "mode": mode}
+            blob += encoded
+        blob += b"\0" * (-len(blob) % 4)
+
+        buffer = {"byteLength": len(blob)}
+        buffers = [buffer]
+        if fallback_length > 0:
+            # the fallback buffer has no uri, so loaders must support the extension
+            self.add_extension(MESHOPT_EXTENSION, required=True)
+            buffers.append({"byteLength": fallback_length, "extensions": {MESHOPT_EXTENSION: {"fallback": True}}})
+        if len(blob) == 0 and fallback_length == 0:
+            self.json.pop("buffers", None)
+        elif _is_glb_path(path):
+            self.json["buffers"] = buffers
+        else:
+            bin_filename = os.path.splitext(os.path.basename(path))[0] + ".bin"
+            buffer["uri"] = bin_filename
+            self.json["buffers"] = buffers
+            bin_path = os.path.join(os.path.dirname(path), bin_filename)
+            for old_path in self._external_buffer_paths:
+                if os.path.exists(old_path) and os.path.normcase(old_path) != os.path.normcase(bin_path):
+                    os.remove(old_path)
+            with open(bin_path, "wb") as file:
+                file.write(blob)
+
+        json_bytes = json.dumps(self.json, separators=(",", ":")).encode("utf-8")
+        if _is_glb_path(path):
+            json_bytes += b" " * (-len(json_bytes) % 4)
+            length = 12 + 8 + len(json_bytes)
+            if len(blob) > 0:
+                length += 8 + len(blob)
+            with open(path, "wb") as file:
+                file.write(struct.pack("<III", GLB_MAGIC, 2, length))
+                file.write(struct.pack("<II", len(json_bytes), GLB_CHUNK_JSON))
+                file.write(json_bytes)
+                if len(blob) > 0:
+                    file.write(struct.pack("<II", len(blob), GLB_CHUNK_BIN))
+                    file.write(blob)
+        else:
+            with open(path, "wb") as file:
+                file.write(json_bytes)
+        self.path = path
+
+    def _buffer_view_references(self):
+        # yields (dict, key) pairs for every property which holds a bufferView index
+        for accessor in self.json.get("accessors", []):
+            if "bufferView" in accessor:
+                yield accessor, "bufferView"
+            sparse = accessor.get("sparse")
+            if sparse:
+                yield sparse["indices"], "bufferView"
+                yield sparse["values"], "bufferView"
+        for image in self.json.get("images", []):
+            if "bufferView" in image:
+                yield image, "bufferView"
+        for mesh in self.json.get("meshes", []):
+            for primitive in mesh.get("primitives", []):
+                for extension in primitive.get("extensions", {}).values():
+                    if isinstance(extension, dict) and "bufferView" in extension:
+                        yield extension, "bufferView"
+
+    def remove_unused_buffer_views(self):
+        views = self.json.get("bufferViews", [])
+        used = sorted(set(owner[key] for owner, key in self._buffer_view_references()))
+        if len(used) == len(views):
+            return
+        remap = {old_index: new_index for new_index, old_index in enumerate(used)}
+        for owner, key in self._buffer_view_references():
+            owner[key] = remap[owner[key]]
+        self.json["bufferViews"] = [views[i] for i in used]
+        self.view_data = [self.view_data[i] for i in used]
+
+    def _accessor_references(self):
+        # yields (dict, key) pairs for every property which holds an accessor index
+        def attribute_references(attributes):
+            for name in attributes:
+                yield attributes, name
+        for mesh in self.json.get("meshes", []):
+            for primitive in mesh.get("primitives", []):
+                yield from attribute_references(primitive.get("attributes", {}))
+                if "indices" in primitive:
+                    yield primitive, "indices"
+                for target in primitive.get("targets", []):
+                    yield from attribute_references(target)
+        for node in self.json.get("nodes", []):
+            for extension in node.get("extensions", {}).values():
+                if isinstance(extension, dict):
+                    yield from attribute_references(extension.get("attributes", {}))
+        for skin in self.json.get("skins", []):
+            if "inverseBindMatrices" in skin:
+                yield skin, "inverseBindMatrices"
+        for animation in self.json.get("animations", []):
+            for sampler in animation.get("samplers", []):
+                yield sampler, "input"
+                yield sampler, "output"
+
+    def remove_unused_accessors(self):
+        accessors = self.json.get("accessors", [])
+        used = sorted(set(owner[key] for owner, key in self._accessor_references()))
+        if len(used) == len(accessors):
+            return
+        remap = {old_index: new_index for new_index, old_index in enumerate(used)}
+        for owner, key in self._accessor_references():
+            owner[key] = remap[owner[key]]
+        self.json["accessors"] = [accessors[i] for i in used]
+
+    def add_accessor(self, values, component_type, type_name, normalized=False, vertex_attribute=False):
+        self.json.setdefault("accessors", []).append({"type": type_name})
+        return self.write_accessor(len(self.json["accessors"]) - 1, values, component_type, normalized, vertex_attribute)
+
+    def add_buffer_view(self, data, target=None, byte_stride=None):
+        view = {"buffer": 0, "byteLength": len(data)}
+        if byte_stride is not None:
+            view["byteStride"] = byte_stride
+        if target is not None:
+            view["target"] = target
+        self.json.setdefault("bufferViews", []).append(view)
+        self.view_data.append(bytes(data))
+        return len(self.json["bufferViews"]) - 1
+
+    def _read_view(self, view_index, byte_offset, count, component_type, num_components):
+        dtype = np.dtype(COMPONENT_DTYPES[component_type])
+        view = self.json["bufferViews"][view_index]
+        stride = view.get("byteStride", dtype.itemsize * num_components)
+        array = np.ndarray((count, num_components), dtype=dtype, buffer=self.view_data[view_index],
+                           offset=byte_offset, strides=(stride, dtype.itemsize))
+        return array.copy()
+
+    def read_accessor(self, accessor_index, raw=False):
+        """Returns accessor data as a (count, components) array with sparse
+        substitution applied. Normalized integer data is converted to float
+        unless raw is True.
+        """
+        accessor = self.json["accessors"][accessor_index]
+        component_type = accessor["componentType"]
+        num_components = TYPE_COMPONENTS[accessor["type"]]
+        count = accessor["count"]
+        if "bufferView" in accessor:
+            values = self._read_view(accessor["bufferView"], accessor.get("byteOffset", 0), count,
+                                     component_type, num_components)
+        else:
+            values = np.zeros((count, num_components), dtype=COMPONENT_DTYPES[component_type])
+        sparse = accessor.get("sparse")
+        if sparse:
+            indices = self._read_view(sparse["indices"]["bufferView"], sparse["indices"].get("byteOffset", 0),
+                                      sparse["count"], sparse["indices"]["componentType"], 1)[:, 0]
+            values[indices] = self._read_view(sparse["values"]["bufferView"], sparse["values"].get("byteOffset", 0),
+                                              sparse["count"], component_type, num_components)
+        if accessor.get("normalized", False) and not raw:
+            return dequantize(values, component_type)
+        return values
+
+    def _pack_elements(self, values, vertex_attribute):
+        # vertex attribute elements must start on 4-byte boundaries, so pad each element
+        count, num_components = values.shape
+        element_size = values.dtype.itemsize * num_components
+        if not vertex_attribute:
+            return values.tobytes(), None
+        stride = (element_size + 3) & ~3
+        if stride == element_size:
+            return values.tobytes(), stride
+        padded = np.zeros((count, stride), dtype=np.uint8)
+        padded[:, :element_size] = values.view(np.uint8).reshape(count, element_size)
+        return padded.tobytes(), stride
+
+    def write_accessor(self, accessor_index, values, component_type, normalized=False,
+                       vertex_attribute=True, allow_sparse=False):
+        """Replaces the data of an existing accessor. values must already be
+        quantized for integer component types. With allow_sparse, elements
+        which are zero are dropped and a sparse accessor is written if that
+        is smaller than the dense form.
+        """
+        accessor = self.json["accessors"][accessor_index]
+        values = np.ascontiguousarray(values, dtype=COMPONENT_DTYPES[component_type])
+        count, num_components = values.shape
+        for key in ["bufferView", "byteOffset", "sparse", "normalized", "min", "max"]:
+            accessor.pop(key, None)
+        accessor["componentType"] = component_type
+        accessor["count"] = count
+        if normalized:
+            accessor["normalized"] = True
+        if count > 0:
+            accessor["min"] = values.min(axis=0).tolist()
+            accessor["max"] = values.max(axis=0).tolist()
+
+        if allow_sparse:
+            nonzero = np.nonzero(np.any(values != 0, axis=1))[0]
+            index_type = UNSIGNED_SHORT if count <= 0xFFFF else UNSIGNED_INT
+            sparse_size = len(nonzero) * (np.dtype(COMPONENT_DTYPES[index_type]).itemsize + values.dtype.itemsize * num_components)
+            dense_size = count * ((values.dtype.itemsize * num_components + 3) & ~3)
+            if len(nonzero) == 0:
+                # accessor without bufferView or sparse is initialized to zeros
+                return accessor_index
+            if sparse_size < dense_size:
+                indices = nonzero.astype(COMPONENT_DTYPES[index_type])
+                accessor["sparse"] = {
+                    "count": len(nonzero),
+                    "indices": {"bufferView": self.add_buffer_view(indices.tobytes()), "componentType": index_type},
+                    "values": {"bufferView": self.add_buffer_view(values[nonzero].tobytes())},
+                }
+                return accessor_index
+
+        data, stride = self._pack_elements(values, vertex_attribute)
+        accessor["bufferView"] = self.add_buffer_view(data, ARRAY_BUFFER if vertex_attribute else None, stride)
+        return accessor_index
+
+    def add_extension(self, name, required=False):
+        used = self.json.setdefault("extensionsUsed", [])
+        if name not in used:
+            used.append(name)
+        if required:
+            required_list = self.json.setdefault("extensionsRequired", [])
+            if name not in required_list:
+                required_list.append(name)
+
+    def file_size(self):
+        return sum(len(data) for data in self.view_data)
+
+
+def encode_morph_targets(asset, quantize=True, mesh_scales=None):
+    """Rewrites morph target deltas with zero deltas dropped into sparse
+    accessors and, if quantize is True, with POSITION/NORMAL/TANGENT deltas
+    stored as 16-bit normalized integers (KHR_mesh_quantization).
+
+    glTF has no per-accessor dequantization scale, so normalized deltas
+    cover [-1, 1] in mesh units (divided by mesh_scales[mesh_index] when
+    positions were quantized with a node scale). Per-target bounds are used
+    to check the range: targets with a delta outside it are kept as float.
+    Returns a list of per-target statistics.
+    """
+    if mesh_scales is None:
+        mesh_scales = {}
+    stats = []
+    processed_accessors = set()
+    for mesh_index, mesh in enumerate(asset.json.get("meshes", [])):
+        scale = mesh_scales.get(mesh_index, 1.0)
+        target_names = mesh.get("extras", {}).get("targetNames", [])
+        for primitive in mesh.get("primitives", []):
+            for target_index, target in enumerate(primitive.get("targets", [])):
+                for attribute, accessor_index in target.items():
+                    if accessor_index in processed_accessors:
+                        continue
+                    processed_accessors.add(accessor_index)
+                    accessor = asset.json["accessors"][accessor_index]
+                    if accessor["componentType"] != FLOAT:
+                        continue
+                    deltas = asset.read_accessor(accessor_index)
+                    if attribute == "POSITION":
+                        deltas = deltas / scale
+                    bound = float(np.abs(deltas).max()) if len(deltas) > 0 else 0.0
+                    target_name = target_names[target_index] if target_index < len(target_names) else str(target_index)
+                    stat = {"mesh": mesh.get("name", str(mesh_index)), "target": target_name,
+                            "attribute": attribute, "bound": bound * (scale if attribute == "POSITION" else 1.0),
+                            "moved": int(np.count_nonzero(np.any(deltas != 0, axis=1))),
+                            "count": len(deltas), "quantized": False, "max_error": 0.0}
+                    if quantize and attribute in ["POSITION", "NORMAL", "TANGENT"] and bound <= 1.0:
+                        quantized = quantize_snorm(deltas, SHORT)
+                        error = np.abs(dequantize(quantized, SHORT) - deltas).max() if len(deltas) > 0 else 0.0
+                        if attribute == "POSITION":
+                            error *= scale
+                        asset.write_accessor(accessor_index, quantized, SHORT, normalized=True, allow_sparse=True)
+                        stat["quantized"] = True
+                        stat["max_error"] = float(error)
+                    else:
+                        asset.write_accessor(accessor_index, deltas, FLOAT, allow_sparse=True)
+                    stats.append(stat)
+    if any(stat["quantized"] for stat in stats):
+        asset.add_extension("KHR_mesh_quantization", required=True)
+    return stats
+
+
+def _matrix_from_trs(node):
+    if "matrix" in node:
+        return np.array(node["matrix"], dtype=np.float64).reshape(4, 4).T
+    x, y, z, w = node.get("rotation", [0.0, 0.0, 0.0, 1.0])
+    rotation = np.array([
+        [1 - 2*(y*y + z*z), 2*(x*y - z*w), 2*(x*z + y*w)],
+        [2*(x*y + z*w), 1 - 2*(x*x + z*z), 2*(y*z - x*w)],
+        [2*(x*z - y*w), 2*(y*z + x*w), 1 - 2*(x*x + y*y)]])
+    matrix = np.identity(4)
+    matrix[:3, :3] = rotation * np.array(node.get("scale", [1.0, 1.0, 1.0]))
+    matrix[:3, 3] = node.get("translation", [0.0, 0.0, 0.0])
+    return matrix
+
+def _dequantization_matrix(center, scale):
+    matrix = np.identity(4) * scale
+    matrix[3, 3] = 1.0
+    matrix[:3, 3] = center
+    return matrix
+
+def _angle_error_degrees(source, quantized):
+    lengths = np.linalg.norm(quantized, axis=1)
+    lengths[lengths == 0] = 1.0
+    dots = np.clip(np.sum(source * (quantized / lengths[:, None]), axis=1), -1.0, 1.0)
+    return np.degrees(np.arccos(dots))
+
+def _quantize_weights(weights):
+    # 8-bit weights which still sum to exactly 255 per vertex
+    totals = weights.sum(axis=1)
+    totals[totals == 0] = 1.0
+    quantized = np.round(weights / totals[:, None] * 255.0).astype(np.int32)
+    largest = np.argmax(quantized, axis=1)
+    rows = np.arange(len(quantized))
+    quantized[rows, largest] += 255 - quantized.sum(axis=1)
+    return np.clip(quantized, 0, 255).astype(np.uint8)
+
+def _apply_dequantization_transform(asset, node_index, transform, skin_cache):
+    """Moves the dequantization transform of a quantized mesh onto the
+    nodes that use it: folded into the inverse bind matrices for skinned
+    meshes, into the node TRS for leaf nodes which are not animated, and
+    otherwise into a new child node which takes over the mesh.
+    """
+    nodes = asset.json["nodes"]
+    node = nodes[node_index]
+    if "skin" in node:
+        cache_key = (node["skin"], node["mesh"])
+        original_key = ("inverseBindMatrices", node["skin"])
+        if cache_key not in skin_cache:
+            skin = asset.json["skins"][node["skin"]]
+            num_joints = len(skin["joints"])
+            if original_key not in skin_cache:
+                skin_cache[original_key] = skin.get("inverseBindMatrices")
+            if skin_cache[original_key] is not None:
+                matrices = asset.read_accessor(skin_cache[original_key]).astype(np.float64)
+            else:
+                matrices = np.tile(np.identity(4).T.reshape(16), (num_joints, 1))
+            folded = np.array([(matrix.reshape(4, 4).T @ transform).T.reshape(16) for matrix in matrices], dtype=np.float32)
+            accessors = asset.json["accessors"]
+            accessors.append({"componentType": FLOAT, "count": num_joints, "type": "MAT4"})
+            asset.write_accessor(len(accessors) - 1, folded, FLOAT, vertex_attribute=False)
+            accessors[-1].pop("min", None)
+            accessors[-1].pop("max", None)
+            # skins shared by several quantized meshes need one copy per mesh
+            if any(key[0] == node["skin"] for key in skin_cache):
+                new_skin = dict(skin)
+                asset.json["skins"].append(new_skin)
+                skin_cache[cache_key] = len(asset.json["skins"]) - 1
+            else:
+                new_skin = skin
+                skin_cache[cache_key] = node["skin"]
+            new_skin["inverseBindMatrices"] = len(accessors) - 1
+        node["skin"] = skin_cache[cache_key]
+        return
+    animated = any(channel["target"].get("node") == node_index and channel["target"]["path"] != "weights"
+                   for animation in asset.json.get("animations", []) for channel in animation["channels"])
+    if not animated and len(node.get("children", [])) == 0:
+        matrix = _matrix_from_trs(node) @ transform
+        if "matrix" in node:
+            node["matrix"] = matrix.T.reshape(16).tolist()
+        else:
+            node["translation"] = matrix[:3, 3].tolist()
+            node["scale"] = (np.array(node.get("scale", [1.0, 1.0, 1.0])) * transform[0, 0]).tolist()
+        return
+    child = {"name": node.get("name", "node") + "_mesh", "mesh": node.pop("mesh"),
+             "translation": transform[:3, 3].tolist(), "scale": [float(transform[0, 0])] * 3}
+    if "weights" in node:
+        child["weights"] = node.pop("weights")
+    nodes.append(child)
+    child_index = len(nodes) - 1
+    node.setdefault("children", []).append(child_index)
+    for animation in asset.json.get("animations", []):
+        for channel in animation["channels"]:
+            if channel["target"].get("node") == node_index and channel["target"]["path"] == "weights":
+                channel["target"]["node"] = child_index
+
+def quantize_vertex_attributes(asset):
+    """Stores vertex attributes as KHR_mesh_quantization integer types:
+    positions as 16-bit normalized with a per-mesh uniform scale and offset
+    moved onto the node, normals and tangents as 8-bit normalized, UVs in
+    [0, 1] as 16-bit normalized, joint weights as 8-bit normalized and
+    joint indices as 8-bit where possible.
+
+    Returns (mesh_scales, report): the position scale of each quantized mesh
+    (needed to encode its morph targets) and the per-mesh error against the
+    float source.
+    """
+    mesh_scales = {}
+    mesh_transforms = {}
+    report = []
+    processed_accessors = set()
+    for mesh_index, mesh in enumerate(asset.json.get("meshes", [])):
+        primitives = mesh.get("primitives", [])
+        position_accessors = [primitive["attributes"]["POSITION"] for primitive in primitives if "POSITION" in primitive["attributes"]]
+        if len(position_accessors) == 0 or any(index in processed_accessors for index in position_accessors):
+            continue
+        positions = [asset.read_accessor(index) for index in position_accessors]
+        lower = np.min([values.min(axis=0) for values in positions if len(values) > 0], axis=0)
+        upper = np.max([values.max(axis=0) for values in positions if len(values) > 0], axis=0)
+        center = (lower + upper) * 0.5
+        scale = float(np.max(upper - lower) * 0.5)
+        if scale == 0.0:
+            scale = 1.0
+        mesh_scales[mesh_index] = scale
+        mesh_transforms[mesh_index] = _dequantization_matrix(center, scale)
+        entry = {"mesh": mesh.get("name", str(mesh_index)), "scale": scale,
+                 "position_max_error": 0.0, "position_mean_error": 0.0,
+                 "normal_max_error_degrees": 0.0, "tangent_max_error_degrees": 0.0,
+                 "texcoord_max_error": 0.0, "weight_max_error": 0.0, "skipped": []}
+        position_errors = []
+        for primitive in primitives:
+            attributes = primitive["attributes"]
+            # weights are quantized together so each vertex still sums to 1
+            weight_keys = sorted(key for key in attributes if key.startswith("WEIGHTS_"))
+            weight_accessors = [attributes[key] for key in weight_keys]
+            quantize_weights = len(weight_accessors) > 0 \
+                and not any(index in processed_accessors for index in weight_accessors) \
+                and all(asset.json["accessors"][index]["componentType"] == FLOAT for index in weight_accessors)
+            for attribute, accessor_index in attributes.items():
+                if accessor_index in processed_accessors or attribute.startswith("WEIGHTS_"):
+                    continue
+                accessor = asset.json["accessors"][accessor_index]
+                if attribute == "POSITION":
+                    values = asset.read_accessor(accessor_index)
+                    quantized = quantize_snorm((values - center) / scale, SHORT)
+                    errors = np.linalg.norm(dequantize(quantized, SHORT) * scale + center - values, axis=1)
+                    position_errors.append(errors)
+                    asset.write_accessor(accessor_index, quantized, SHORT, normalized=True)
+                elif attribute == "NORMAL" and accessor["componentType"] == FLOAT:
+                    values = asset.read_accessor(accessor_index)
+                    quantized = quantize_snorm(values, BYTE)
+                    if len(values) > 0:
+                        entry["normal_max_error_degrees"] = max(entry["normal_max_error_degrees"],
+                            float(_angle_error_degrees(values, dequantize(quantized, BYTE)).max()))
+                    asset.write_accessor(accessor_index, quantized, BYTE, normalized=True)
+                elif attribute == "TANGENT" and accessor["componentType"] == FLOAT:
+                    values = asset.read_accessor(accessor_index)
+                    quantized = quantize_snorm(values, BYTE)
+                    if len(values) > 0:
+                        entry["tangent_max_error_degrees"] = max(entry["tangent_max_error_degrees"],
+                            float(_angle_error_degrees(values[:, :3], dequantize(quantized, BYTE)[:, :3]).max()))
+                    asset.write_accessor(accessor_index, quantized, BYTE, normalized=True)
+                elif attribute.startswith("TEXCOORD_") and accessor["componentType"] == FLOAT:
+                    values = asset.read_accessor(accessor_index)
+                    if len(values) == 0 or values.min() < 0.0 or values.max() > 1.0:
+                        # tiled (UDIM) coordinates do not fit a normalized type
+                        entry["skipped"].append(attribute)
+                        continue
+                    quantized = quantize_unorm(values, UNSIGNED_SHORT)
+                    entry["texcoord_max_error"] = max(entry["texcoord_max_error"],
+                        float(np.abs(dequantize(quantized, UNSIGNED_SHORT) - values).max()))
+                    asset.write_accessor(accessor_index, quantized, UNSIGNED_SHORT, normalized=True)
+                elif attribute.startswith("JOINTS_") and accessor["componentType"] == UNSIGNED_SHORT:
+                    values = asset.read_accessor(accessor_index)
+                    if len(values) > 0 and values.max() < 256:
+                        asset.write_accessor(accessor_index, values, UNSIGNED_BYTE)
+                processed_accessors.add(accessor_index)
+
+            if quantize_weights:
+                weights = np.concatenate([asset.read_accessor(index) for index in weight_accessors], axis=1)
+                quantized = _quantize_weights(weights)
+                if len(weights) > 0:
+                    totals = weights.sum(axis=1)
+                    totals[totals == 0] = 1.0
+                    entry["weight_max_error"] = float(np.abs(quantized / 255.0 - weights / totals[:, None]).max())
+                for set_index, accessor_index in enumerate(weight_accessors):
+                    asset.write_accessor(accessor_index, quantized[:, set_index*4:set_index*4+4], UNSIGNED_BYTE, normalized=True)
+                    processed_accessors.add(accessor_index)
+
+        if len(position_errors) > 0:
+            errors = np.concatenate(position_errors)
+            if len(errors) > 0:
+                entry["position_max_error"] = float(errors.max())
+                entry["position_mean_error"] = float(errors.mean())
+        report.append(entry)
+
+    skin_cache = {}
+    for node_index, node in enumerate(list(asset.json.get("nodes", []))):
+        if "mesh" in node and node["mesh"] in mesh_transforms:
+            _apply_dequantization_transform(asset, node_index, mesh_transforms[node["mesh"]], skin_cache)
+
+    if len(mesh_scales) > 0:
+        asset.add_extension("KHR_mesh_quantization", required=True)
+    return mesh_scales, report
+
+# default curve fitting tolerances: degrees, scene units (meters), scale ratio and morph weight
+ANIMATION_TOLERANCES = {"rotation": 0.05, "translation": 0.0001, "scale": 0.001, "weights": 0.001}
+ANIMATION_REST_VALUES = {"rotation": [0.0, 0.0, 0.0, 1.0], "translation": [0.0, 0.0, 0.0], "scale": [1.0, 1.0, 1.0]}
+
+def _normalize_quaternions(values):
+    lengths = np.linalg.norm(values, axis=1)
+    lengths[lengths == 0.0] = 1.0
+    return values / lengths[:, None]
+
+def _interpolate_keys(path, start, end, t):
+    """Interpolates between keyframe values start and end, each (components,)
+    or (n, components), at the factors t, as glTF LINEAR samplers do:
+    slerp for rotations and lerp for everything else.
+    """
+    t = t[:, None]
+    if path != "rotation":
+        return start + (end - start) * t
+    dot = np.sum(start * end, axis=-1, keepdims=True)
+    end = np.where(dot < 0.0, -end, end)
+    dot = np.clip(np.abs(dot), 0.0, 1.0)
+    theta = np.arccos(dot)
+    sin_theta = np.sin(theta)
+    # fall back to lerp for nearly equal rotations to avoid dividing by zero
+    near = sin_theta < 1e-6
+    sin_theta[near] = 1.0
+    scale_start = np.where(near, 1.0 - t, np.sin((1.0 - t) * theta) / sin_theta)
+    scale_end = np.where(near, t, np.sin(t * theta) / sin_theta)
+    return _normalize_quaternions(scale_start * start + scale_end * end)
+
+def _key_error(path, values, reference):
+    # per-key error in the units of ANIMATION_TOLERANCES
+    if path == "rotation":
+        dot = np.clip(np.abs(np.sum(values * reference, axis=-1)), 0.0, 1.0)
+        return np.degrees(2.0 * np.arccos(dot))
+    if path == "translation":
+        return np.linalg.norm(values - reference, axis=-1)
+    if path == "scale":
+        return np.max(np.abs(values - reference) / np.maximum(np.abs(reference), 1e-6), axis=-1)
+    return np.max(np.abs(values - reference), axis=-1)
+
+def _reduce_linear_keys(path, times, values, tolerance):
+    """Douglas-Peucker curve fitting: returns the indices of the keyframes
+    to keep so that interpolating the kept keys stays within tolerance of
+    every original key.
+    """
+    count = len(times)
+    keep = np.zeros(count, dtype=bool)
+    keep[0] = keep[-1] = True
+    stack = [(0, count - 1)]
+    while stack:
+        first, last = stack.pop()
+        if last - first < 2:
+            continue
+        inner = np.arange(first + 1, last)
+        duration = times[last] - times[first]
+        t = (times[inner] - times[first]) / duration if duration > 0.0 else np.zeros(len(inner))
+        errors = _key_error(path, _interpolate_keys(path, values[first], values[last], t), values[inner])
+        worst = int(np.argmax(errors))
+        if errors[worst] > tolerance:
+            split = int(inner[worst])
+            keep[split] = True
+            stack.append((first, split))
+            stack.append((split, last))
+    return np.nonzero(keep)[0]
+
+def _evaluate_keys(path, times, values, sample_times, interpolation):
+    # evaluates a reduced LINEAR or STEP curve at the original key times
+    upper = np.clip(np.searchsorted(times, sample_times, side="right"), 1, max(len(times) - 1, 1))
+    lower = upper - 1
+    if len(times) == 1:
+        return np.repeat(values[:1], len(sample_times), axis=0)
+    if interpolation == "STEP":
+        return values[np.where(sample_times >= times[upper], upper, lower)]
+    duration = times[upper] - times[lower]
+    duration[duration == 0.0] = 1.0
+    t = np.clip((sample_times - times[lower]) / duration, 0.0, 1.0)
+    return _interpolate_keys(path, values[lower], values[upper], t)
+
+def reduce_animations(asset, tolerances=None, quantize_rotations=False):
+    """Reduces baked animation keyframes in place. LINEAR curves are fitted
+    with per-path tolerances (see ANIMATION_TOLERANCES), redundant STEP keys
+    are dropped, constant tracks are collapsed to a single key and duplicate
+    or untargeted channels are removed. Constant tracks are only removed
+    entirely for non-joint nodes at their rest value, since Godot relies on
+    joint tracks to reset poses between clips. With quantize_rotations,
+    rotation outputs are stored as normalized shorts (core glTF 2.0).
+    Returns a list of per-animation stats.
+    """
+    tolerances = dict(ANIMATION_TOLERANCES, **(tolerances or {}))
+    nodes = asset.json.get("nodes", [])
+    joints = set()
+    for skin in asset.json.get("skins", []):
+        joints.update(skin.get("joints", []))
+    input_accessors = {}
+    report = []
+
+    def accessor_size(accessor_index):
+        accessor = asset.json["accessors"][accessor_index]
+        return accessor["count"] * TYPE_COMPONENTS[accessor["type"]] * np.dtype(COMPONENT_DTYPES[accessor["componentType"]]).itemsize
+
+    def add_input(times):
+        data = times.astype(np.float32)
+        key = data.tobytes()
+        if key not in input_accessors:
+            input_accessors[key] = asset.add_accessor(data[:, None], FLOAT, "SCALAR")
+        return input_accessors[key]
+
+    for animation_index, animation in enumerate(asset.json.get("animations", [])):
+        samplers = animation.get("samplers", [])
+        channels = animation.get("channels", [])
+        entry = {"animation": animation.get("name", str(animation_index)), "channels_before": len(channels),
+                 "keys_before": 0, "keys_after": 0, "constant_tracks": 0, "removed_tracks": 0,
+                 "max_error": {}, "bytes_before": 0, "bytes_after": 0}
+        counted = set()
+        for sampler in samplers:
+            for accessor_index in [sampler["input"], sampler["output"]]:
+                if accessor_index not in counted:
+                    entry["bytes_before"] += accessor_size(accessor_index)
+                    counted.add(accessor_index)
+
+        # drop channels without a target node and all but the last channel per target
+        targets = {}
+        for channel in channels:
+            target = channel.get("target", {})
+            if "node" not in target:
+                continue
+            targets[(target["node"], target["path"])] = channel
+        kept_channels = [channel for channel in channels if channel in targets.values()]
+
+        end_time = 0.0
+        sampler_paths = {}
+        for channel in kept_channels:
+            sampler_paths.setdefault(channel["sampler"], []).append(channel["target"])
+        reduced_samplers = {}
+        constant_samplers = []
+        removed_samplers = []
+        for sampler_index, sampler_targets in sampler_paths.items():
+            sampler = samplers[sampler_index]
+            path = sampler_targets[0]["path"]
+            interpolation = sampler.get("interpolation", "LINEAR")
+            times = asset.read_accessor(sampler["input"])[:, 0].astype(np.float64)
+            output_accessor = asset.json["accessors"][sampler["output"]]
+            values = asset.read_accessor(sampler["output"]).astype(np.float64)
+            if len(times) > 0:
+                end_time = max(end_time, float(times[-1]))
+            if interpolation == "CUBICSPLINE" or len(times) == 0:
+                reduced_samplers[sampler_index] = None
+                continue
+            # morph weights are stored as one scalar per target for each key
+            values = values.reshape(len(times), -1)
+            if path == "rotation":
+                values = _normalize_quaternions(values)
+            tolerance = min(tolerances.get(target["path"], tolerances["weights"]) for target in sampler_targets)
+            entry["keys_before"] += len(times)
+
+            if np.all(_key_error(path, values, values[0]) <= tolerance):
+                entry["constant_tracks"] += 1
+                rest = ANIMATION_REST_VALUES.get(path)
+                if path == "weights":
+                    node = nodes[sampler_targets[0]["node"]]
+                    mesh = asset.json["meshes"][node["mesh"]] if "mesh" in node else {}
+                    rest = node.get("weights", mesh.get("weights", [0.0] * values.shape[1]))
+                removable = all(target["node"] not in joints and "matrix" not in nodes[target["node"]]
+                                for target in sampler_targets)
+                keep = np.array([0])
+                if removable and rest is not None and _key_error(path, values[:1], np.array([rest]))[0] <= tolerance:
+                    removed_samplers.append(sampler_index)
+                else:
+                    constant_samplers.append(sampler_index)
+            elif interpolation == "STEP":
+                changed = _key_error(path, values[1:], values[:-1]) > tolerance
+                keep = np.concatenate([[0], np.nonzero(changed)[0] + 1])
+            else:
+                keep = _reduce_linear_keys(path, times, values, tolerance)
+            reduced_samplers[sampler_index] = (path, interpolation, times, values, keep, output_accessor["componentType"])
+
+        # never leave an animation without channels
+        if len(removed_samplers) == len(reduced_samplers) and len(removed_samplers) > 0:
+            constant_samplers.append(removed_samplers.pop(0))
+
+        # a clip's length is the last key time of any track, so keep it if every track was reduced to one key
+        if end_time > 0.0:
+            covered = any(isinstance(reduced, tuple) and reduced[2][reduced[4][-1]] >= end_time for reduced in reduced_samplers.values())
+            covered = covered or any(reduced is None for reduced in reduced_samplers.values())
+            constant_samplers = [index for index in constant_samplers if index not in removed_samplers]
+            if not covered and len(constant_samplers) > 0:
+                path, interpolation, times, values, keep, component_type = reduced_samplers[constant_samplers[0]]
+                reduced_samplers[constant_samplers[0]] = (path, interpolation, times, values, np.array([0, len(times) - 1]), component_type)
+
+        # write the reduced samplers and drop removed channels
+        new_samplers = []
+        sampler_remap = {}
+        new_channels = []
+        for channel in kept_channels:
+            if channel["sampler"] in removed_samplers:
+                entry["removed_tracks"] += 1
+                continue
+            reduced = reduced_samplers[channel["sampler"]]
+            if channel["sampler"] not in sampler_remap:
+                sampler = samplers[channel["sampler"]]
+                if isinstance(reduced, tuple):
+                    path, interpolation, times, values, keep, component_type = reduced
+                    reduced_times = times[keep]
+                    reduced_values = values[keep]
+                    if path == "rotation" and quantize_rotations:
+                        output_values = quantize_snorm(reduced_values, SHORT)
+                        output_type, normalized = SHORT, True
+                        reduced_values = dequantize(output_values, SHORT)
+                    elif path == "rotation" and component_type != FLOAT:
+                        output_values = quantize_snorm(reduced_values, component_type)
+                        output_type, normalized = component_type, True
+                    else:
+                        output_values, output_type, normalized = reduced_values.astype(np.float32), FLOAT, False
+                    if path == "weights":
+                        output_values = output_values.reshape(-1, 1)
+                    error = _key_error(path, _evaluate_keys(path, reduced_times, _normalize_quaternions(reduced_values) if path == "rotation" else reduced_values,
+                                                            times, interpolation), values)
+                    entry["max_error"][path] = max(entry["max_error"].get(path, 0.0), float(error.max()))
+                    entry["keys_after"] += len(keep)
+                    sampler = dict(sampler)
+                    sampler["input"] = add_input(reduced_times)
+                    sampler["output"] = asset.add_accessor(output_values, output_type, asset.json["accessors"][sampler["output"]]["type"], normalized)
+                sampler_remap[channel["sampler"]] = len(new_samplers)
+                new_samplers.append(sampler)
+            channel["sampler"] = sampler_remap[channel["sampler"]]
+            new_channels.append(channel)
+        animation["samplers"] = new_samplers
+        animation["channels"] = new_channels
+        entry["channels_after"] = len(new_channels)
+        report.append(entry)
+
+    asset.remove_unused_accessors()
+    # sizes after removal so that shared time accessors are counted once per animation
+    for entry, animation in zip(report, asset.json.get("animations", [])):
+        counted = set()
+        for sampler in animation["samplers"]:
+            for accessor_index in [sampler["input"], sampler["output"]]:
+                if accessor_index not in counted:
+                    entry["bytes_after"] += accessor_size(accessor_index)
+                    counted.add(accessor_index)
+    return report
+
+def add_animation_skins(gltf_path):
+    """Adds a skin to each animated node hierarchy of a glTF file which has
+    no skins, ex: animation-only exports without meshes. Godot only creates
+    a Skeleton3D from skins, so without this the animation tracks would
+    target plain nodes instead of the bones of the published character.
+    """
+    asset = GltfAsset(gltf_path)
+    if len(asset.json.get("skins", [])) > 0 or len(asset.json.get("animations", [])) == 0:
+        return 0
+    nodes = asset.json.get("nodes", [])
+    animated = set()
+    for animation in asset.json["animations"]:
+        for channel in animation.get("channels", []):
+            if "node" in channel.get("target", {}):
+                animated.add(channel["target"]["node"])
+
+    def descendants(node_index, parent_matrix):
+        for child in nodes[node_index].get("children", []):
+            world = parent_matrix @ _matrix_from_trs(nodes[child])
+            yield child, world
+            yield from descendants(child, world)
+
+    skins = []
+    for scene in asset.json.get("scenes", []):
+        for root in scene.get("nodes", []):
+            root_matrix = _matrix_from_trs(nodes[root])
+            joints = list(descendants(root, root_matrix))
+            if len(joints) == 0 or not any(joint in animated for joint, world in joints):
+                continue
+            # inverse bind matrices are relative to the skeleton root, like Blender's skinned exports
+            inverse_binds = np.array([np.linalg.inv(np.linalg.inv(root_matrix) @ world).T.ravel() for joint, world in joints])
+            skin = {"name": nodes[root].get("name", "Armature"), "joints": [joint for joint, world in joints], "skeleton": root,
+                    "inverseBindMatrices": asset.add_accessor(inverse_binds, FLOAT, "MAT4")}
+            skins.append(skin)
+    if len(skins) > 0:
+        asset.json["skins"] = skins
+        asset.save()
+    _add_to_log("DEBUG: add_animation_skins(): added " + str(len(skins)) + " skins to " + gltf_path)
+    return len(skins)
+
+def limit_skin_influences(joints, weights, max_influences, weight_threshold=0.0):
+    """Keeps the max_influences largest weights of each vertex (0 = all),
+    drops weights below weight_threshold and renormalizes. The largest
+    weight of a vertex is always kept. Returns the (joints, weights) arrays,
+    sorted by weight and trimmed to the largest remaining influence count,
+    and the weight removed from each vertex before renormalizing.
+    """
+    count = len(weights)
+    totals = weights.sum(axis=1)
+    totals[totals == 0] = 1.0
+    weights = weights / totals[:, None]
+    order = np.argsort(-weights, axis=1, kind="stable")
+    rows = np.arange(count)[:, None]
+    joints = joints[rows, order]
+    weights = weights[rows, order]
+    keep = weights > 0
+    if weight_threshold > 0.0:
+        keep &= weights >= weight_threshold
+    if max_influences > 0:
+        keep[:, max_influences:] = False
+    keep[:, 0] = weights[:, 0] > 0
+    removed = np.where(keep, 0.0, weights).sum(axis=1)
+    weights = np.where(keep, weights, 0.0)
+    joints = np.where(keep, joints, 0)
+    kept_totals = weights.sum(axis=1)
+    kept_totals[kept_totals == 0] = 1.0
+    weights = weights / kept_totals[:, None]
+    num_influences = int(keep.sum(axis=1).max()) if count > 0 else 0
+    num_columns = max(4, (num_influences + 3) // 4 * 4)
+    return joints[:, :num_columns], weights[:, :num_columns], removed
+
+def _remove_nodes(asset, removed_nodes):
+    """Deletes nodes and remaps every node index. Animation channels which
+    target a deleted node are removed together with their samplers.
+    """
+    nodes = asset.json.get("nodes", [])
+    remap = {}
+    for old_index in range(len(nodes)):
+        if old_index not in removed_nodes:
+            remap[old_index] = len(remap)
+    asset.json["nodes"] = [node for index, node in enumerate(nodes) if index not in removed_nodes]
+    for node in asset.json["nodes"]:
+        if "children" in node:
+            node["children"] = [remap[child] for child in node["children"] if child in remap]
+            if len(node["children"]) == 0:
+                node.pop("children")
+    for scene in asset.json.get("scenes", []):
+        scene["nodes"] = [remap[root] for root in scene.get("nodes", []) if root in remap]
+    for skin in asset.json.get("skins", []):
+        skin["joints"] = [remap[joint] for joint in skin["joints"]]
+        if "skeleton" in skin:
+            skin["skeleton"] = remap[skin["skeleton"]]
+    for animation in asset.json.get("animations", []):
+        channels = [channel for channel in animation["channels"]
+                    if channel["target"].get("node") is None or channel["target"]["node"] in remap]
+        used_samplers = sorted(set(channel["sampler"] for channel in channels))
+        sampler_remap = {old_index: new_index for new_index, old_index in enumerate(used_samplers)}
+        for channel in channels:
+            channel["sampler"] = sampler_remap[channel["sampler"]]
+            if "node" in channel["target"]:
+                channel["target"]["node"] = remap[channel["target"]["node"]]
+        animation["channels"] = channels
+        animation["samplers"] = [animation["samplers"][index] for index in used_samplers]
+
+def _unused_skin_joints(asset, skin_index, used_slots, animated_nodes, shared_joints):
+    # joint slots whose whole subtree has no weights, no animation and nothing but other joints
+    nodes = asset.json["nodes"]
+    skin = asset.json["skins"][skin_index]
+    slots = {joint: slot for slot, joint in enumerate(skin["joints"])}
+    removable = {}
+
+    def is_removable(node_index):
+        if node_index in removable:
+            return removable[node_index]
+        node = nodes[node_index]
+        result = node_index in slots and slots[node_index] not in used_slots \
+            and node_index not in animated_nodes and node_index not in shared_joints \
+            and node_index != skin.get("skeleton") \
+            and not any(key in node for key in ["mesh", "camera", "skin", "extensions"])
+        children_removable = [is_removable(child) for child in node.get("children", [])]
+        removable[node_index] = result and all(children_removable)
+        return removable[node_index]
+
+    for joint in skin["joints"]:
+        is_removable(joint)
+    return set(slots[joint] for joint in skin["joints"] if removable[joint])
+
+def optimize_skinning(asset, max_influences=4, weight_threshold=0.0, remove_unused_joints=False):
+    """Limits the joint influences of skinned primitives to max_influences
+    per vertex (0 = unlimited), drops weights below weight_threshold and
+    renormalizes, then rewrites JOINTS_n/WEIGHTS_n with only as many sets
+    as are still needed. With remove_unused_joints, joints which have no
+    weights left, are not animated and only have such joints below them are
+    removed from their skin and from the node hierarchy.
+
+    Returns a per-mesh report of the influence counts and the skinning
+    error, measured as the weight removed from a vertex before
+    renormalizing (0 = unchanged, 1 = all of its weight).
+    """
+    report = []
+    skin_data = {}
+    processed = {}
+    mesh_skins = {}
+    for node in asset.json.get("nodes", []):
+        if "mesh" in node and "skin" in node:
+            mesh_skins.setdefault(node["mesh"], set()).add(node["skin"])
+
+    for mesh_index, mesh in enumerate(asset.json.get("meshes", [])):
+        entry = {"mesh": mesh.get("name", str(mesh_index)), "vertices": 0, "vertices_changed": 0,
+                 "influences_before": 0, "influences_after": 0, "max_error": 0.0, "mean_error": 0.0}
+        errors = []
+        for primitive in mesh.get("primitives", []):
+            attributes = primitive["attributes"]
+            joint_keys = sorted((key for key in attributes if key.startswith("JOINTS_")), key=lambda key: int(key[7:]))
+            weight_keys = ["WEIGHTS_" + key[7:] for key in joint_keys]
+            if len(joint_keys) == 0 or any(key not in attributes for key in weight_keys):
+                continue
+            accessor_key = tuple(attributes[key] for key in joint_keys + weight_keys)
+            if accessor_key not in processed:
+                joints = np.concatenate([asset.read_accessor(attributes[key]).astype(np.int64) for key in joint_keys], axis=1)
+                weights = np.concatenate([asset.read_accessor(attributes[key]).astype(np.float64) for key in weight_keys], axis=1)
+                influences_before = int((weights > 0).sum(axis=1).max()) if len(weights) > 0 else 0
+                new_joints, new_weights, removed = limit_skin_influences(joints, weights, max_influences, weight_threshold)
+                influences_after = int((new_weights > 0).sum(axis=1).max()) if len(weights) > 0 else 0
+                processed[accessor_key] = {"joint_keys": joint_keys, "weight_keys": weight_keys,
+                                           "joints": new_joints, "weights": new_weights, "primitives": [], "meshes": set()}
+                entry["vertices"] += len(weights)
+                entry["vertices_changed"] += int(np.count_nonzero(removed > 0))
+                entry["influences_before"] = max(entry["influences_before"], influences_before)
+                entry["influences_after"] = max(entry["influences_after"], influences_after)
+                errors.append(removed)
+            data = processed[accessor_key]
+            data["primitives"].append(primitive)
+            data["meshes"].add(mesh_index)
+            for skin_index in mesh_skins.get(mesh_index, []):
+                used = skin_data.setdefault(skin_index, set())
+                used.update(np.unique(data["joints"][data["weights"] > 0]).tolist())
+        if len(errors) > 0:
+            errors = np.concatenate(errors)
+            entry["max_error"] = float(errors.max()) if len(errors) > 0 else 0.0
+            entry["mean_error"] = float(errors.mean()) if len(errors) > 0 else 0.0
+            report.append(entry)
+
+    # joint slots of each skin, after removing unused joints
+    slot_remaps = {}
+    removed_nodes = set()
+    if remove_unused_joints:
+        animated_nodes = set(channel["target"]["node"] for animation in asset.json.get("animations", [])
+                             for channel in animation["channels"] if "node" in channel["target"])
+        joint_skins = {}
+        for skin_index, skin in enumerate(asset.json.get("skins", [])):
+            for joint in skin["joints"]:
+                joint_skins.setdefault(joint, set()).add(skin_index)
+        shared_joints = set(joint for joint, skins in joint_skins.items() if len(skins) > 1)
+        # skins of meshes which are bound to more than one skin keep all of their joints,
+        # also when the meshes only share their joint accessors
+        fixed_skins = set()
+        for data in processed.values():
+            skins = set(skin for mesh_index in data["meshes"] for skin in mesh_skins.get(mesh_index, []))
+            if len(skins) > 1:
+                fixed_skins.update(skins)
+        for skin_index, used_slots in skin_data.items():
+            if skin_index in fixed_skins:
+                continue
+            skin = asset.json["skins"][skin_index]
+            unused_slots = _unused_skin_joints(asset, skin_index, used_slots, animated_nodes, shared_joints)
+            if len(unused_slots) == 0:
+                continue
+            kept_slots = [slot for slot in range(len(skin["joints"])) if slot not in unused_slots]
+            slot_remaps[skin_index] = np.zeros(len(skin["joints"]), dtype=np.int64)
+            slot_remaps[skin_index][kept_slots] = np.arange(len(kept_slots))
+            removed_nodes.update(skin["joints"][slot] for slot in unused_slots)
+            if "inverseBindMatrices" in skin:
+                matrices = asset.read_accessor(skin["inverseBindMatrices"])[kept_slots]
+                skin["inverseBindMatrices"] = asset.add_accessor(matrices, FLOAT, "MAT4")
+            skin["joints"] = [skin["joints"][slot] for slot in kept_slots]
+            _add_to_log("DEBUG: optimize_skinning(): removed " + str(len(unused_slots)) + " unused joints from skin "
+                        + skin.get("name", str(skin_index)))
+
+    for data in processed.values():
+        joints = data["joints"]
+        skins = mesh_skins.get(next(iter(data["meshes"])), set())
+        remap = slot_remaps.get(next(iter(skins))) if len(skins) == 1 else None
+        if remap is not None:
+            joints = np.where(data["weights"] > 0, remap[joints], 0)
+        joint_type = UNSIGNED_BYTE if len(joints) == 0 or joints.max() < 256 else UNSIGNED_SHORT
+        accessors = asset.json["accessors"]
+        weight_type = accessors[data["primitives"][0]["attributes"][data["weight_keys"][0]]]["componentType"]
+        if weight_type == FLOAT:
+            weights = data["weights"]
+        else:
+            weights = _quantize_weights(data["weights"])
+            weight_type = UNSIGNED_BYTE
+        num_sets = joints.shape[1] // 4
+        for set_index in range(num_sets):
+            joint_key, weight_key = data["joint_keys"][set_index], data["weight_keys"][set_index]
+            joint_accessor = data["primitives"][0]["attributes"][joint_key]
+            weight_accessor = data["primitives"][0]["attributes"][weight_key]
+            asset.write_accessor(joint_accessor, joints[:, set_index*4:set_index*4+4], joint_type)
+            asset.write_accessor(weight_accessor, weights[:, set_index*4:set_index*4+4], weight_type,
+                                 normalized=(weight_type != FLOAT))
+        for primitive in data["primitives"]:
+            for key in data["joint_keys"][num_sets:] + data["weight_keys"][num_sets:]:
+                primitive["attributes"].pop(key, None)
+
+    if len(removed_nodes) > 0:
+        _remove_nodes(asset, removed_nodes)
+    asset.remove_unused_accessors()
+    return report
+
+def _material_signature(material):
+    # every material property except the name, so identically set up Daz surfaces compare equal
+    return json.dumps({key: value for key, value in material.items() if key != "name"}, sort_keys=True)
+
+def _is_invisible_material(material):
+    alpha = material.get("pbrMetallicRoughness", {}).get("baseColorFactor", [1.0, 1.0, 1.0, 1.0])[3]
+    return material.get("alphaMode", "OPAQUE") != "OPAQUE" and alpha <= 0.0
+
+def _used_texcoord_sets(material):
+    # the first set stays so materials assigned in Godot can still be textured
+    if material is None:
+        return 1
+    return max([texture_info.get("texCoord", 0) + 1 for key, texture_info in _texture_infos(material)], default=1)
+
+def _primitive_layout(asset, primitive):
+    # primitives with the same layout can be concatenated into one vertex buffer
+    accessors = asset.json["accessors"]
+    def attribute_layout(attributes):
+        return tuple(sorted((name, accessors[index]["componentType"], accessors[index].get("normalized", False),
+                             accessors[index]["type"]) for name, index in attributes.items()))
+    return (primitive.get("mode", TRIANGLES), attribute_layout(primitive.get("attributes", {})),
+            tuple(attribute_layout(target) for target in primitive.get("targets", [])))
+
+def _primitive_indices(asset, primitive):
+    if "indices" in primitive:
+        return asset.read_accessor(primitive["indices"], raw=True)[:, 0].astype(np.int64)
+    return np.arange(asset.json["accessors"][primitive["attributes"]["POSITION"]]["count"], dtype=np.int64)
+
+def _write_merged_primitive(asset, primitives, indices_list):
+    """Concatenates the vertex data of primitives with the same layout,
+    drops vertices which no index references and writes new accessors into
+    the first primitive, which is returned.
+    """
+    accessors = asset.json["accessors"]
+    merged = primitives[0]
+    offsets = np.cumsum([0] + [accessors[primitive["attributes"]["POSITION"]]["count"] for primitive in primitives])
+    indices = np.concatenate([indices_list[i] + offsets[i] for i in range(len(primitives))])
+    used, indices = np.unique(indices, return_inverse=True)
+
+    def merge_attributes(attribute_dicts):
+        result = {}
+        for name, index in attribute_dicts[0].items():
+            accessor = accessors[index]
+            values = np.concatenate([asset.read_accessor(attributes[name], raw=True) for attributes in attribute_dicts])[used]
+            result[name] = asset.add_accessor(values, accessor["componentType"], accessor["type"],
+                                              accessor.get("normalized", False), vertex_attribute=True)
+        return result
+
+    merged["attributes"] = merge_attributes([primitive["attributes"] for primitive in primitives])
+    if "targets" in merged:
+        merged["targets"] = [merge_attributes([primitive["targets"][target] for primitive in primitives])
+                             for target in range(len(merged["targets"]))]
+    index_type = UNSIGNED_SHORT if len(used) <= 0xFFFF else UNSIGNED_INT
+    merged["indices"] = asset.add_accessor(indices.reshape(-1, 1), index_type, "SCALAR")
+    asset.json["bufferViews"][accessors[merged["indices"]]["bufferView"]]["target"] = ELEMENT_ARRAY_BUFFER
+    return merged
+
+def _remove_unused_materials(asset):
+    # a materials only export has no meshes and keeps every material
+    materials = asset.json.get("materials", [])
+    if len(asset.json.get("meshes", [])) == 0 or len(materials) == 0:
+        return
+    used_materials = sorted(set(primitive["material"] for mesh in asset.json["meshes"]
+                                for primitive in mesh["primitives"] if "material" in primitive))
+    if len(used_materials) == len(materials):
+        return
+    material_remap = {old_index: new_index for new_index, old_index in enumerate(used_materials)}
+    asset.json["materials"] = [materials[index] for index in used_materials]
+    for mesh in asset.json["meshes"]:
+        for primitive in mesh["primitives"]:
+            if "material" in primitive:
+                primitive["material"] = material_remap[primitive["material"]]
+
+def prune_primitives(asset):
+    """Removes primitives without triangles or with a fully transparent
+    material, merges the primitives of a mesh whose materials differ only
+    by name, and drops unused vertices, UV sets no texture reads, meshes
+    left without primitives and unused materials. Returns a report entry
+    per mesh.
+    """
+    materials = asset.json.get("materials", [])
+    accessors = asset.json.get("accessors", [])
+    meshes = asset.json.get("meshes", [])
+    stats = []
+    removed_meshes = set()
+    for mesh_index, mesh in enumerate(meshes):
+        primitives = mesh.get("primitives", [])
+        entry = {"mesh": mesh.get("name", str(mesh_index)), "primitives_before": len(primitives),
+                 "vertices_before": 0, "removed": [], "merged": [], "texcoords_removed": 0}
+        groups = []
+        for primitive in primitives:
+            material = materials[primitive["material"]] if "material" in primitive else None
+            material_name = material.get("name", str(primitive["material"])) if material is not None else "(none)"
+            vertex_count = accessors[primitive["attributes"]["POSITION"]]["count"] if "POSITION" in primitive.get("attributes", {}) else 0
+            entry["vertices_before"] += vertex_count
+            indices = _primitive_indices(asset, primitive) if vertex_count > 0 else np.zeros(0, dtype=np.int64)
+            if len(indices) == 0 or (primitive.get("mode", TRIANGLES) == TRIANGLES and len(indices) < 3) \
+                    or (material is not None and _is_invisible_material(material)):
+                entry["removed"].append(material_name)
+                continue
+            num_texcoords = _used_texcoord_sets(material)
+            for name in list(primitive["attributes"]):
+                if name.startswith("TEXCOORD_") and int(name[len("TEXCOORD_"):]) >= num_texcoords:
+                    primitive["attributes"].pop(name)
+                    entry["texcoords_removed"] += 1
+            # compressed primitives are kept as they are
+            if "extensions" in primitive:
+                groups.append({"primitives": [primitive], "indices": [indices], "key": None})
+                continue
+            key = (_material_signature(material) if material is not None else None, _primitive_layout(asset, primitive))
+            group = next((group for group in groups if group["key"] == key), None)
+            if group is None:
+                groups.append({"primitives": [primitive], "indices": [indices], "key": key})
+            else:
+                group["primitives"].append(primitive)
+                group["indices"].append(indices)
+                entry["merged"].append(material_name)
+
+        mesh["primitives"] = []
+        for group in groups:
+            primitive = group["primitives"][0]
+            vertex_count = sum([accessors[p["attributes"]["POSITION"]]["count"] for p in group["primitives"]])
+            is_sparse = len(np.unique(np.concatenate(group["indices"]))) < vertex_count
+            if group["key"] is not None and (len(group["primitives"]) > 1 or is_sparse):
+                primitive = _write_merged_primitive(asset, group["primitives"], group["indices"])
+                accessors = asset.json["accessors"]
+            mesh["primitives"].append(primitive)
+        entry["primitives_after"] = len(mesh["primitives"])
+        entry["vertices_after"] = sum([accessors[p["attributes"]["POSITION"]]["count"] for p in mesh["primitives"]
+                                       if "POSITION" in p.get("attributes", {})])
+        if len(mesh["primitives"]) == 0:
+            removed_meshes.add(mesh_index)
+        stats.append(entry)
+
+    if len(removed_meshes) > 0:
+        mesh_remap = {}
+        for old_index in range(len(meshes)):
+            if old_index not in removed_meshes:
+                mesh_remap[old_index] = len(mesh_remap)
+        asset.json["meshes"] = [mesh for index, mesh in enumerate(meshes) if index not in removed_meshes]
+        nodes_without_mesh = set()
+        for node_index, node in enumerate(asset.json.get("nodes", [])):
+            if "mesh" not in node:
+                continue
+            if node["mesh"] in removed_meshes:
+                # a skin without a mesh has nothing to deform
+                node.pop("mesh")
+                node.pop("skin", None)
+                node.pop("weights", None)
+                nodes_without_mesh.add(node_index)
+            else:
+                node["mesh"] = mesh_remap[node["mesh"]]
+        for animation in asset.json.get("animations", []):
+            channels = [channel for channel in animation["channels"]
+                        if not (channel["target"]["path"] == "weights" and channel["target"].get("node") in nodes_without_mesh)]
+            used_samplers = sorted(set(channel["sampler"] for channel in channels))
+            sampler_remap = {old_index: new_index for new_index, old_index in enumerate(used_samplers)}
+            for channel in channels:
+                channel["sampler"] = sampler_remap[channel["sampler"]]
+            animation["channels"] = channels
+            animation["samplers"] = [animation["samplers"][index] for index in used_samplers]
+        asset.json["animations"] = [animation for animation in asset.json.get("animations", []) if len(animation["channels"]) > 0]
+        if len(asset.json["animations"]) == 0:
+            asset.json.pop("animations")
+
+    _remove_unused_materials(asset)
+    asset.remove_unused_accessors()
+    asset.remove_unused_buffer_views()
+    return stats
+
+
+# meshes which only differ by less than this in the positions relative to their bounds are shared
+DEDUP_POSITION_TOLERANCE = 1e-5
+# shared meshes with at least this many static instances are reported as MultiMeshInstance3D candidates
+MULTIMESH_MIN_INSTANCES = 4
+
+def _mesh_geometry_key(asset, mesh):
+    """Returns a hash of everything but the positions of a mesh: the layout,
+    vertex attributes, indices, morph targets and material signatures of
+    its primitives, or None for compressed meshes. Translated copies of a
+    prop differ in their float32 positions by rounding noise which no exact
+    hash absorbs, so the positions of meshes with the same key are compared
+    by _mesh_positions_match().
+    """
+    materials = asset.json.get("materials", [])
+    primitives = mesh.get("primitives", [])
+    if len(primitives) == 0 or any("extensions" in primitive for primitive in primitives):
+        return None
+    digest = hashlib.sha1()
+    digest.update(json.dumps({key: value for key, value in mesh.items() if key not in ("name", "primitives")},
+                             sort_keys=True).encode("utf-8"))
+    for primitive in primitives:
+        material = materials[primitive["material"]] if "material" in primitive else None
+        digest.update(json.dumps([_material_signature(material) if material is not None else "",
+                                  _primitive_layout(asset, primitive)]).encode("utf-8"))
+        for name, accessor_index in sorted(primitive["attributes"].items()):
+            if name != "POSITION":
+                digest.update(np.ascontiguousarray(asset.read_accessor(accessor_index, raw=True)).tobytes())
+        digest.update(_primitive_indices(asset, primitive).tobytes())
+        for target in primitive.get("targets", []):
+            for name, accessor_index in sorted(target.items()):
+                digest.update(np.ascontiguousarray(asset.read_accessor(accessor_index, raw=True)).tobytes())
+    return digest.hexdigest()
+
+def _mesh_positions(asset, mesh):
+    # returns the float64 positions of each primitive and the minimum of their bounds (the origin)
+    positions = [asset.read_accessor(primitive["attributes"]["POSITION"]).astype(np.float64) if "POSITION" in primitive["attributes"]
+                 else np.zeros((0, 3)) for primitive in mesh["primitives"]]
+    non_empty = [values for values in positions if len(values) > 0]
+    origin = np.min([values.min(axis=0) for values in non_empty], axis=0) if len(non_empty) > 0 else np.zeros(3)
+    return positions, origin
+
+def _mesh_positions_match(positions, origin, other_positions, other_origin, relative):
+    """Compares the positions of two meshes with the same _mesh_geometry_key().
+    With relative the positions are compared relative to their origins
+    within DEDUP_POSITION_TOLERANCE, widened to the float32 precision of the
+    coordinates so that copies far from the scene origin still match.
+    Otherwise the positions must be identical.
+    """
+    for values, other_values in zip(positions, other_positions):
+        if values.shape != other_values.shape:
+            return False
+        if not relative:
+            if not np.array_equal(values, other_values):
+                return False
+            continue
+        if len(values) == 0:
+            continue
+        magnitude = max(np.abs(values).max(), np.abs(other_values).max())
+        tolerance = max(DEDUP_POSITION_TOLERANCE, 4.0 * float(np.spacing(np.float32(magnitude))))
+        if not np.allclose(values - origin, other_values - other_origin, rtol=0.0, atol=tolerance):
+            return False
+    return True
+
+def deduplicate_meshes(asset):
+    """Shares meshes with identical geometry and material signatures, such
+    as repeated props of an environment: the nodes of every copy reference
+    the first mesh and the copies are removed. Copies whose transform was
+    baked into the vertices are matched relative to their bounds and the
+    offset is moved onto their nodes. Skinned meshes must match exactly.
+    Returns a report of the shared meshes and MultiMeshInstance3D candidates.
+    """
+    nodes = asset.json.get("nodes", [])
+    meshes = asset.json.get("meshes", [])
+    skinned_meshes = set(node["mesh"] for node in nodes if "mesh" in node and "skin" in node)
+    candidates = {} # (key, skinned) -> [(mesh index, positions)] of the distinct meshes
+    duplicates = {}
+    origins = {}
+    for mesh_index, mesh in enumerate(meshes):
+        key = _mesh_geometry_key(asset, mesh)
+        if key is None:
+            continue
+        relative = mesh_index not in skinned_meshes
+        positions, origin = _mesh_positions(asset, mesh)
+        origins[mesh_index] = origin if relative else None
+        bucket = candidates.setdefault((key, relative), [])
+        for first_index, first_positions in bucket:
+            if _mesh_positions_match(positions, origin, first_positions, origins[first_index] if relative else origin, relative):
+                duplicates[mesh_index] = first_index
+                break
+        else:
+            bucket.append((mesh_index, positions))
+
+    report = {"meshes_before": len(meshes), "meshes_after": len(meshes) - len(duplicates), "shared": []}
+    if len(duplicates) == 0:
+        return report
+    instances = {}
+    for node_index, node in enumerate(list(nodes)):
+        if "mesh" not in node:
+            continue
+        mesh_index = node["mesh"]
+        shared_index = duplicates.get(mesh_index, mesh_index)
+        instances.setdefault(shared_index, []).append(node_index)
+        if shared_index == mesh_index:
+            continue
+        node["mesh"] = shared_index
+        if origins[mesh_index] is not None and origins[shared_index] is not None:
+            offset = origins[mesh_index] - origins[shared_index]
+            if np.max(np.abs(offset)) > DEDUP_POSITION_TOLERANCE:
+                transform = np.identity(4)
+                transform[:3, 3] = offset
+                # the same placement as for a dequantization offset
+                _apply_dequantization_transform(asset, node_index, transform, {})
+
+    for shared_index in sorted(set(duplicates.values())):
+        mesh = meshes[shared_index]
+        node_indices = instances.get(shared_index, [])
+        is_static = shared_index not in skinned_meshes and not any("targets" in primitive for primitive in mesh["primitives"])
+        entry = {"mesh": mesh.get("name", str(shared_index)), "instances": len(node_indices),
+                 "duplicates": [meshes[index].get("name", str(index)) for index, first in duplicates.items() if first == shared_index],
+                 "multimesh_candidate": is_static and len(node_indices) >= MULTIMESH_MIN_INSTANCES}
+        report["shared"].append(entry)
+
+    mesh_remap = {}
+    for old_index in range(len(meshes)):
+        if old_index not in duplicates:
+            mesh_remap[old_index] = len(mesh_remap)
+    asset.json["meshes"] = [mesh for index, mesh in enumerate(meshes) if index not in duplicates]
+    for node in asset.json["nodes"]:
+        if "mesh" in node:
+            node["mesh"] = mesh_remap[node["mesh"]]
+    _remove_unused_materials(asset)
+    asset.remove_unused_accessors()
+    asset.remove_unused_buffer_views()
+    return report
+
+def optimize_gltf(gltf_path, options, report_path=None):
+    """Runs the enabled post-processing stages on an exported .gltf/.glb
+    file and saves it in place. options keys: "prune_surfaces",
+    "deduplicate_meshes", "max_bone_influences",
+    "skin_weight_threshold", "remove_unused_bones", "sparse_morphs",
+    "quantize_morphs", "quantize_vertices", "reduce_animations",
+    "quantize_animations" and "animation_tolerances" (see
+    ANIMATION_TOLERANCES). If report_path is given, a json report with the
+    size reduction and quantization error is written there.
+    """
+    _add_to_log("DEBUG: optimize_gltf(): processing: " + gltf_path + ", options=" + str(options))
+    asset = GltfAsset(gltf_path)
+    size_before = asset.file_size()
+    report = {"file": gltf_path, "options": options}
+
+    # surfaces are pruned first, so the later stages process less data
+    if options.get("prune_surfaces", False):
+        report["surfaces"] = prune_primitives(asset)
+        for entry in report["surfaces"]:
+            _add_to_log("DEBUG: optimize_gltf(): mesh " + entry["mesh"]
+                        + ": primitives " + str(entry["primitives_before"]) + " -> " + str(entry["primitives_after"])
+                        + ", vertices " + str(entry["vertices_before"]) + " -> " + str(entry["vertices_after"])
+                        + ", removed=" + str(entry["removed"]) + ", merged=" + str(entry["merged"])
+                        + ", UV sets removed=" + str(entry["texcoords_removed"]))
+
+    # shared meshes are quantized once, with the offset moved onto each node
+    if options.get("deduplicate_meshes", False):
+        report["deduplication"] = deduplicate_meshes(asset)
+        for entry in report["deduplication"]["shared"]:
+            _add_to_log("DEBUG: optimize_gltf(): mesh " + entry["mesh"] + " shared by " + str(entry["instances"])
+                        + " nodes, removed copies=" + str(entry["duplicates"])
+                        + (", MultiMeshInstance3D candidate" if entry["multimesh_candidate"] else ""))
+
+    # influences are limited before the weights are quantized
+    max_influences = options.get("max_bone_influences", 0)
+    weight_threshold = options.get("skin_weight_threshold", 0.0)
+    remove_unused_joints = options.get("remove_unused_bones", False)
+    if max_influences > 0 or weight_threshold > 0.0 or remove_unused_joints:
+        report["skinning"] = optimize_skinning(asset, max_influences, weight_threshold, remove_unused_joints)
+        for entry in report["skinning"]:
+            _add_to_log("DEBUG: optimize_gltf(): skinned mesh " + entry["mesh"]
+                        + ": influences " + str(entry["influences_before"]) + " -> " + str(entry["influences_after"])
+                        + ", vertices changed=" + str(entry["vertices_changed"]) + "/" + str(entry["vertices"])
+                        + ", weight error max=" + str(entry["max_error"]) + " mean=" + str(entry["mean_error"]))
+
+    mesh_scales = None
+    if options.get("quantize_vertices", False):
+        mesh_scales, report["vertex_quantization"] = quantize_vertex_attributes(asset)
+        for entry in report["vertex_quantization"]:
+            _add_to_log("DEBUG: optimize_gltf(): quantized mesh " + entry["mesh"]
+                        + ": position error max=" + str(entry["position_max_error"])
+                        + " mean=" + str(entry["position_mean_error"])
+                        + ", normal error max=" + str(entry["normal_max_error_degrees"]) + " deg"
+                        + ", skipped=" + str(entry["skipped"]))
+
+    # morph deltas must be rescaled whenever positions were quantized
+    if options.get("sparse_morphs", False) or options.get("quantize_morphs", False) or mesh_scales:
+        stats = encode_morph_targets(asset, options.get("quantize_morphs", False), mesh_scales)
+        num_quantized = len([stat for stat in stats if stat["quantized"]])
+        max_error = max([stat["max_error"] for stat in stats], default=0.0)
+        _add_to_log("DEBUG: optimize_gltf(): " + str(len(stats)) + " morph target accessors, "
+                    + str(num_quantized) + " quantized, max error=" + str(max_error))
+        report["morph_targets"] = stats
+
+    if options.get("reduce_animations", False) or options.get("quantize_animations", False):
+        if options.get("reduce_animations", False):
+            tolerances = options.get("animation_tolerances")
+        else:
+            # quantize only: keep every key that is not exactly redundant
+            tolerances = {path: 0.0 for path in ANIMATION_TOLERANCES}
+        stats = reduce_animations(asset, tolerances, options.get("quantize_animations", False))
+        for entry in stats:
+            _add_to_log("DEBUG: optimize_gltf(): animation " + entry["animation"]
+                        + ": keys " + str(entry["keys_before"]) + " -> " + str(entry["keys_after"])
+                        + ", channels " + str(entry["channels_before"]) + " -> " + str(entry["channels_after"])
+                        + ", bytes " + str(entry["bytes_before"]) + " -> " + str(entry["bytes_after"])
+                        + ", max error=" + str(entry["max_error"]))
+        report["animations"] = stats
+
+    asset.save()
+    size_after = asset.file_size()
+    report["binary_size_before"] = size_before
+    report["binary_size_after"] = size_after
+    _add_to_log("DEBUG: optimize_gltf(): binary size: " + str(size_before) + " -> " + str(size_after) + " bytes")
+    if report_path is not None:
+        with open(report_path, "w") as file:
+            json.dump(report, file, indent=4)
+    return report
+
+
+KTX2_EXTENSION = "KHR_texture_basisu"
+
+# toktx settings per map type: color maps use ETC1S in sRGB, normal and
+# ORM data maps use UASTC in linear space with zstd supercompression
+KTX2_COMMON_ARGS = ["--t2", "--genmipmap", "--threads", "1"]
+KTX2_MAP_TYPE_ARGS = {
+    "color": ["--encode", "etc1s", "--clevel", "2", "--qlevel", "192", "--assign_oetf", "srgb"],
+    "normal": ["--encode", "uastc", "--uastc_quality", "2", "--zcmp", "18", "--assign_oetf", "linear"],
+    "orm": ["--encode", "uastc", "--uastc_quality", "2", "--uastc_rdo_l", "1.0", "--zcmp", "18", "--assign_oetf", "linear"],
+}
+KTX2_COLOR_TEXTURES = ["baseColorTexture", "emissiveTexture", "diffuseTexture", "specularGlossinessTexture",
+                       "sheenColorTexture", "specularColorTexture"]
+KTX2_NORMAL_TEXTURES = ["normalTexture", "clearcoatNormalTexture"]
+
+def _texture_infos(value, key=None):
+    # yields (key, textureInfo) for every texture reference in a material, including extensions
+    if isinstance(value, dict):
+        if key is not None and key.endswith("Texture") and "index" in value:
+            yield key, value
+        for child_key, child in value.items():
+            yield from _texture_infos(child, child_key)
+    elif isinstance(value, list):
+        for child in value:
+            yield from _texture_infos(child, key)
+
+def _image_map_types(asset):
+    """Returns {image index: "color"|"normal"|"orm"} based on how the
+    materials use each image. The first use of an image decides its type.
+    """
+    textures = asset.json.get("textures", [])
+    map_types = {}
+    for material in asset.json.get("materials", []):
+        for key, texture_info in _texture_infos(material):
+            texture = textures[texture_info["index"]]
+            if "source" not in texture:
+                continue
+            if key in KTX2_COLOR_TEXTURES:
+                map_type = "color"
+            elif key in KTX2_NORMAL_TEXTURES:
+                map_type = "normal"
+            else:
+                map_type = "orm"
+            if map_types.setdefault(texture["source"], map_type) != map_type:
+                _add_to_log("WARNING: image " + str(texture["source"]) + " is used as both " + map_types[texture["source"]]
+                            + " and " + map_type + " map, encoding as " + map_types[texture["source"]])
+    return map_types
+
+def _image_dimensions(data):
+    if data[:8] == b"\x89PNG\r\n\x1a\n":
+        return struct.unpack(">II", data[16:24])
+    if data[:2] == b"\xff\xd8":
+        offset = 2
+        while offset + 9 < len(data):
+            marker, length = struct.unpack(">HH", data[offset:offset+4])
+            # SOF0-SOF15 except DHT, JPG and DAC hold the frame size
+            if 0xFFC0 <= marker <= 0xFFCF and marker not in (0xFFC4, 0xFFC8, 0xFFCC):
+                height, width = struct.unpack(">HH", data[offset+5:offset+9])
+                return width, height
+            offset += 2 + length
+    if data[:12] == b"\xabKTX 20\xbb\r\n\x1a\n":
+        return struct.unpack("<II", data[20:28])
+    return None
+
+def _run_toktx(toktx_path, job):
+    with open(job["source_path"], "rb") as file:
+        dimensions = _image_dimensions(file.read(64 * 1024))
+    command = [toktx_path] + KTX2_COMMON_ARGS + KTX2_MAP_TYPE_ARGS[job["map_type"]]
+    if dimensions is not None:
+        job["width"], job["height"] = dimensions
+        # KHR_texture_basisu requires dimensions which are multiples of 4
+        width = (dimensions[0] + 3) & ~3
+        height = (dimensions[1] + 3) & ~3
+        if (width, height) != tuple(dimensions):
+            command += ["--resize", str(width) + "x" + str(height)]
+    command += [job["output_path"], job["source_path"]]
+    start = time.perf_counter()
+    try:
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        if result.returncode != 0 or not os.path.exists(job["output_path"]):
+            job["error"] = result.stdout.decode("utf-8", "replace").strip()
+    except Exception as e:
+        job["error"] = str(e)
+    job["seconds"] = time.perf_counter() - start
+    return job
+
+def transcode_textures_ktx2(gltf_path, toktx_path=None, report_path=None, max_workers=None):
+    """Transcodes every material image of a .gltf/.glb file to KTX2 with
+    mipmaps using toktx, one process per image in parallel, and references
+    them with KHR_texture_basisu. The PNG/JPG images are replaced, so the
+    extension is required. Images which fail to transcode are kept as-is.
+    """
+    if toktx_path is None or toktx_path == "":
+        toktx_path = shutil.which("toktx")
+    if toktx_path is None or not os.path.exists(toktx_path):
+        _add_to_log("ERROR: transcode_textures_ktx2(): toktx executable not found: " + str(toktx_path))
+        return None
+    _add_to_log("DEBUG: transcode_textures_ktx2(): processing: " + gltf_path + ", toktx=" + toktx_path)
+
+    asset = GltfAsset(gltf_path)
+    images = asset.json.get("images", [])
+    folder = os.path.dirname(gltf_path)
+    temp_folder = tempfile.mkdtemp()
+    jobs = []
+    for image_index, map_type in sorted(_image_map_types(asset).items()):
+        image = images[image_index]
+        job = {"image": image_index, "name": image.get("name", image.get("uri", str(image_index))),
+               "map_type": map_type, "width": 0, "height": 0}
+        if image.get("mimeType") == "image/ktx2" or image.get("uri", "").lower().endswith(".ktx2"):
+            continue
+        if "bufferView" in image:
+            extension = ".jpg" if image.get("mimeType") == "image/jpeg" else ".png"
+            job["source_path"] = os.path.join(temp_folder, "image_" + str(image_index) + extension)
+            job["output_path"] = os.path.join(temp_folder, "image_" + str(image_index) + ".ktx2")
+            with open(job["source_path"], "wb") as file:
+                file.write(asset.view_data[image["bufferView"]])
+        elif "uri" in image and not image["uri"].startswith("data:"):
+            job["source_path"] = os.path.join(folder, unquote(image["uri"]))
+            job["output_path"] = os.path.splitext(job["source_path"])[0] + ".ktx2"
+        else:
+            _add_to_log("WARNING: transcode_textures_ktx2(): skipping embedded data uri image: " + job["name"])
+            continue
+        job["source_size"] = os.path.getsize(job["source_path"])
+        jobs.append(job)
+
+    start = time.perf_counter()
+    if max_workers is None:
+        max_workers = os.cpu_count() or 1
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        jobs = list(executor.map(lambda job: _run_toktx(toktx_path, job), jobs))
+    wall_seconds = time.perf_counter() - start
+
+    converted = set()
+    for job in jobs:
+        if "error" in job:
+            _add_to_log("ERROR: transcode_textures_ktx2(): unable to transcode image " + job["name"] + ": " + job["error"])
+            continue
+        image = images[job["image"]]
+        job["ktx2_size"] = os.path.getsize(job["output_path"])
+        if "bufferView" in image:
+            with open(job["output_path"], "rb") as file:
+                asset.view_data[image["bufferView"]] = file.read()
+        else:
+            image["uri"] = os.path.splitext(image["uri"])[0] + ".ktx2"
+            # the source is removed so that Godot does not import it as a separate texture
+            if os.path.exists(job["source_path"]):
+                os.remove(job["source_path"])
+        image["mimeType"] = "image/ktx2"
+        converted.add(job["image"])
+    for texture in asset.json.get("textures", []):
+        if texture.get("source") in converted:
+            texture.setdefault("extensions", {})[KTX2_EXTENSION] = {"source": texture.pop("source")}
+    if len(converted) > 0:
+        asset.add_extension(KTX2_EXTENSION, required=True)
+        asset.save()
+    shutil.rmtree(temp_folder, ignore_errors=True)
+
+    report = {"file": gltf_path, "toktx": toktx_path, "workers": max_workers,
+              "wall_seconds": wall_seconds, "converted": len(converted), "images": jobs}
+    for job in jobs:
+        job.pop("source_path", None)
+        job.pop("output_path", None)
+    _add_to_log("DEBUG: transcode_textures_ktx2(): " + str(len(converted)) + "/" + str(len(jobs))
+                + " images transcoded in " + "%.1f" % wall_seconds + "s with " + str(max_workers) + " workers")
+    if report_path is not None:
+        with open(report_path, "w") as file:
+            json.dump(report, file, indent=4)
+    return report
+
+
+def compress_meshopt(glb_path, output_path=None, report_path=None):
+    """Writes an EXT_meshopt_compression copy of a .glb file, by default
+    next to it as <name>.glb.meshopt, which Godot does not try to import.
+    The copy is decoded again to verify it, and the encode/decode times are
+    reported against reading and writing the uncompressed file.
+    """
+    if output_path is None:
+        output_path = os.path.splitext(glb_path)[0] + MESHOPT_GLB_SUFFIX
+    _add_to_log("DEBUG: compress_meshopt(): compressing: " + glb_path + " -> " + output_path)
+
+    start = time.perf_counter()
+    asset = GltfAsset(glb_path)
+    read_seconds = time.perf_counter() - start
+    asset.remove_unused_buffer_views()
+    source_views = list(asset.view_data)
+    binary_size = asset.file_size()
+
+    # baseline: writing the same data uncompressed
+    temp_handle, temp_path = tempfile.mkstemp(suffix=".glb")
+    os.close(temp_handle)
+    try:
+        start = time.perf_counter()
+        asset.save(temp_path)
+        write_seconds = time.perf_counter() - start
+    finally:
+        os.remove(temp_path)
+
+    start = time.perf_counter()
+    asset.save(output_path, meshopt=True)
+    encode_seconds = time.perf_counter() - start
+    num_views = len(asset.json.get("bufferViews", []))
+    num_compressed = len([view for view in asset.json.get("bufferViews", []) if MESHOPT_EXTENSION in view.get("extensions", {})])
+
+    start = time.perf_counter()
+    decoded = GltfAsset(output_path)
+    decode_seconds = time.perf_counter() - start
+    if decoded.view_data != source_views:
+        os.remove(output_path)
+        raise ValueError("compress_meshopt(): decoded data does not match source: " + glb_path)
+
+    def file_sizes(path):
+        with open(path, "rb") as file:
+            data = file.read()
+        # zlib size approximates what git stores for the file
+        return len(data), len(zlib.compress(data, 6))
+    def megabytes_per_second(seconds):
+        return binary_size / 1000000.0 / seconds if seconds > 0 else 0.0
+
+    size, zlib_size = file_sizes(glb_path)
+    compressed_size, compressed_zlib_size = file_sizes(output_path)
+    report = {
+        "file": glb_path,
+        "output": output_path,
+        "binary_size": binary_size,
+        "compressed_views": num_compressed,
+        "total_views": num_views,
+        "uncompressed": {"size": size, "zlib_size": zlib_size,
+                         "write_seconds": write_seconds, "read_seconds": read_seconds,
+                         "write_mb_per_second": megabytes_per_second(write_seconds),
+                         "read_mb_per_second": megabytes_per_second(read_seconds)},
+        "meshopt": {"size": compressed_size, "zlib_size": compressed_zlib_size,
+                    "encode_seconds": encode_seconds, "decode_seconds": decode_seconds,
+                    "encode_mb_per_second": megabytes_per_second(encode_seconds),
+                    "decode_mb_per_second": megabytes_per_second(decode_seconds)},
+    }
+    _add_to_log("DEBUG: compress_meshopt(): " + str(num_compressed) + "/" + str(num_views) + " bufferViews compressed, size: "
+                + str(size) + " -> " + str(compressed_size) + " bytes (zlib: " + str(zlib_size) + " -> " + str(compressed_zlib_size)
+                + "), encode=" + "%.3f" % encode_seconds + "s, decode=" + "%.3f" % decode_seconds + "s")
+    if report_path is not None:
+        with open(report_path, "w") as file:
+            json.dump(report, file, indent=4)
+    return report
+
+def decompress_meshopt(input_path, output_path=None):
+    """Writes a plain .glb from an EXT_meshopt_compression file, by default
+    next to it with the .meshopt extension removed.
+    """
+    if output_path is None:
+        if input_path.lower().endswith(MESHOPT_GLB_SUFFIX):
+            output_path = input_path[:-len(MESHOPT_GLB_SUFFIX)] + ".glb"
+        else:
+            output_path = os.path.splitext(input_path)[0] + "_decompressed.glb"
+    _add_to_log("DEBUG: decompress_meshopt(): decompressing: " + input_path + " -> " + output_path)
+    GltfAsset(input_path).save(output_path)
+    return output_path
+
+
+# glTF primitive modes which are drawn as triangles
+TRIANGLES = 4
+TRIANGLE_STRIP = 5
+TRIANGLE_FAN = 6
+
+# estimated GPU bytes per pixel: KTX2 is transcoded to a 1 byte/pixel block format (BC7, ASTC 4x4),
+# PNG/JPG are counted as uncompressed RGBA8, both with mipmaps (x 4/3)
+BUDGET_BYTES_PER_PIXEL = {"image/ktx2": 1.0, "default": 4.0}
+
+# budget name -> (DTU key, description), a budget of 0 is not checked
+EXPORT_BUDGETS = {
+    "Triangles": ("Budget Max Triangles", "triangles"),
+    "TextureMemoryMB": ("Budget Max Texture MB", "MB texture memory"),
+    "DrawCalls": ("Budget Max Draw Calls", "draw calls"),
+    "Morphs": ("Morph Budget", "morphs"),
+    "BoneInfluences": ("Max Bone Influences", "bone influences per vertex"),
+}
+
+def _scene_mesh_nodes(asset):
+    # yields the mesh index of every mesh instance in the default scene
+    nodes = asset.json.get("nodes", [])
+    scenes = asset.json.get("scenes", [])
+    if len(scenes) == 0:
+        roots = range(len(nodes))
+    else:
+        roots = scenes[asset.json.get("scene", 0)].get("nodes", [])
+    stack = list(roots)
+    while len(stack) > 0:
+        node = nodes[stack.pop()]
+        if "mesh" in node:
+            yield node["mesh"]
+        stack.extend(node.get("children", []))
+
+def _image_bytes(asset, image):
+    if "bufferView" in image:
+        data = asset.view_data[image["bufferView"]][:64 * 1024]
+    elif "uri" in image and not image["uri"].startswith("data:"):
+        image_path = os.path.join(os.path.dirname(asset.path), unquote(image["uri"]))
+        if not os.path.exists(image_path):
+            return 0
+        with open(image_path, "rb") as file:
+            data = file.read(64 * 1024)
+    else:
+        return 0
+    dimensions = _image_dimensions(data)
+    if dimensions is None:
+        return 0
+    mime_type = image.get("mimeType", "")
+    if mime_type == "" and image.get("uri", "").lower().endswith(".ktx2"):
+        mime_type = "image/ktx2"
+    bytes_per_pixel = BUDGET_BYTES_PER_PIXEL.get(mime_type, BUDGET_BYTES_PER_PIXEL["default"])
+    return dimensions[0] * dimensions[1] * bytes_per_pixel * 4 / 3
+
+def measure_budgets(gltf_path):
+    """Returns the runtime cost of a .gltf/.glb file as counted by
+    EXPORT_BUDGETS: triangles and draw calls (one per primitive) of all
+    mesh instances in the scene, estimated texture memory of all images
+    used by textures, the largest morph target count of a mesh and the
+    largest number of non-zero skin weights of a vertex.
+    """
+    asset = GltfAsset(gltf_path)
+    accessors = asset.json.get("accessors", [])
+    meshes = asset.json.get("meshes", [])
+    values = {"Triangles": 0, "TextureMemoryMB": 0.0, "DrawCalls": 0, "Morphs": 0, "BoneInfluences": 0}
+    for mesh_index in _scene_mesh_nodes(asset):
+        for primitive in meshes[mesh_index].get("primitives", []):
+            mode = primitive.get("mode", TRIANGLES)
+            if mode not in (TRIANGLES, TRIANGLE_STRIP, TRIANGLE_FAN):
+                continue
+            if "indices" in primitive:
+                count = accessors[primitive["indices"]]["count"]
+            else:
+                count = accessors[primitive["attributes"]["POSITION"]]["count"]
+            values["Triangles"] += count // 3 if mode == TRIANGLES else max(count - 2, 0)
+            values["DrawCalls"] += 1
+    for mesh in meshes:
+        for primitive in mesh.get("primitives", []):
+            values["Morphs"] = max(values["Morphs"], len(primitive.get("targets", [])))
+            attributes = primitive.get("attributes", {})
+            # unused slots of the JOINTS_n/WEIGHTS_n sets have zero weight
+            weight_sets = [name for name in attributes if name.startswith("WEIGHTS_")]
+            if len(weight_sets) == 0 or accessors[attributes[weight_sets[0]]]["count"] == 0:
+                continue
+            influences = np.zeros(accessors[attributes[weight_sets[0]]]["count"], dtype=np.int32)
+            for name in weight_sets:
+                influences += np.count_nonzero(asset.read_accessor(attributes[name]) > 0, axis=1).astype(np.int32)
+            values["BoneInfluences"] = max(values["BoneInfluences"], int(influences.max()))
+    images = asset.json.get("images", [])
+    used_images = set()
+    for texture in asset.json.get("textures", []):
+        if "source" in texture:
+            used_images.add(texture["source"])
+        for extension in texture.get("extensions", {}).values():
+            if "source" in extension:
+                used_images.add(extension["source"])
+    texture_bytes = sum([_image_bytes(asset, images[image_index]) for image_index in used_images])
+    values["TextureMemoryMB"] = round(texture_bytes / (1024 * 1024), 1)
+    return values
+
+def check_budgets(gltf_path, budgets, profile_name="", report_path=None):
+    """Compares measure_budgets() against budgets, a dict of DTU keys from
+    EXPORT_BUDGETS to maximum values, and writes an INI report which the
+    Daz plugin reads back with QSettings. Returns the exceeded budget names.
+    """
+    values = measure_budgets(gltf_path)
+    report = configparser.ConfigParser()
+    report.optionxform = str
+    exceeded = []
+    for name, (dtu_key, description) in EXPORT_BUDGETS.items():
+        budget = budgets.get(dtu_key, 0)
+        is_exceeded = budget > 0 and values[name] > budget
+        report[name] = {"Value": str(values[name]), "Budget": str(budget),
+                        "Exceeded": str(is_exceeded).lower(), "Description": description}
+        if is_exceeded:
+            exceeded.append(name)
+            _add_to_log("WARNING: check_budgets(): " + str(values[name]) + " " + description
+                        + " exceeds the budget of " + str(budget) + " for profile '" + profile_name + "'")
+    report["Summary"] = {"File": gltf_path, "Profile": profile_name, "Passed": str(len(exceeded) == 0).lower()}
+    _add_to_log("DEBUG: check_budgets(): " + gltf_path + ": " + str(values) + ", exceeded=" + str(exceeded))
+    if report_path is not None:
+        with open(report_path, "w") as file:
+            report.write(file, space_around_delimiters=False)
+    return exceeded
+
+
+# Godot scene export: the objects of an environment are written as separate
+# files, placed into grid cells which are streamed in around the camera
+SCENE_CELL_SIZE = 32.0
+SCENE_UNLOAD_MARGIN = 1.5
+SCENE_STREAMER_SCRIPT_NAME = "scene_cell_streamer.gd"
+SCENE_STREAMER_SCRIPT = '''extends Node3D
+## Streams the cells of an environment exported from Daz Studio: cells
+## whose bounds come within load_distance of the camera are loaded in the
+## background and instanced, cells beyond unload_distance are freed again.
+
+@export var load_distance := %(load_distance)s
+@export var unload_distance := %(unload_distance)s
+
+var _cells := {}
+var _loading := {}
+
+func _process(_delta: float) -> void:
+	var camera := get_viewport().get_camera_3d()
+	if camera == null:
+		return
+	var origin := global_transform.affine_inverse() * camera.global_position
+	for child in get_children():
+		var placeholder := child as InstancePlaceholder
+		if placeholder == null:
+			continue
+		var cell_name := String(placeholder.name)
+		var bounds: AABB = placeholder.get_meta("aabb", AABB())
+		var distance := origin.distance_to(origin.clamp(bounds.position, bounds.end))
+		if distance <= load_distance and not _cells.has(cell_name):
+			var path := placeholder.get_instance_path()
+			if not _loading.has(cell_name):
+				ResourceLoader.load_threaded_request(path)
+				_loading[cell_name] = path
+				continue
+			var status := ResourceLoader.load_threaded_get_status(path)
+			if status == ResourceLoader.THREAD_LOAD_LOADED:
+				_loading.erase(cell_name)
+				_cells[cell_name] = placeholder.create_instance(false, ResourceLoader.load_threaded_get(path))
+			elif status != ResourceLoader.THREAD_LOAD_IN_PROGRESS:
+				_loading.erase(cell_name)
+		elif distance > unload_distance and _cells.has(cell_name):
+			_cells[cell_name].queue_free()
+			_cells.erase(cell_name)
+'''
+
+def _node_subtree(nodes, roots):
+    # the roots and all their descendants, parents first
+    order = []
+    stack = list(reversed(roots))
+    while len(stack) > 0:
+        node_index = stack.pop()
+        order.append(node_index)
+        stack.extend(reversed(nodes[node_index].get("children", [])))
+    return order
+
+def extract_nodes(asset, roots, path, uri_prefix=""):
+    """Returns a new GltfAsset for path which holds the given root nodes
+    with their descendants and only what they reference: meshes, skins,
+    materials, textures, images, accessors and the animation channels of
+    these nodes. A single root is placed at the origin. uri_prefix is
+    prepended to relative image uris, for files in another folder. Skin
+    joints must be part of the extracted nodes.
+    """
+    source = asset.json
+    result = GltfAsset(path, load=False)
+    target = result.json
+    target["asset"] = dict(source.get("asset", {"version": "2.0"}))
+    for key in ["extensionsUsed", "extensionsRequired"]:
+        if key in source:
+            target[key] = list(source[key])
+    remaps = {}
+
+    def copy_view(view_index):
+        views = remaps.setdefault("bufferViews", {})
+        if view_index not in views:
+            view = {key: value for key, value in source["bufferViews"][view_index].items()
+                    if key not in ["buffer", "byteOffset", "byteLength"]}
+            data = asset.view_data[view_index]
+            view.update({"buffer": 0, "byteLength": len(data)})
+            views[view_index] = len(result.view_data)
+            target.setdefault("bufferViews", []).append(view)
+            result.view_data.append(data)
+        return views[view_index]
+
+    def copy(kind, index, convert):
+        # copies an item once, the slot is reserved first so convert may recurse
+        kind_remap = remaps.setdefault(kind, {})
+        if index not in kind_remap:
+            items = target.setdefault(kind, [])
+            kind_remap[index] = len(items)
+            items.append(None)
+            items[kind_remap[index]] = convert(json.loads(json.dumps(source[kind][index])))
+        return kind_remap[index]
+
+    def convert_accessor(accessor):
+        if "bufferView" in accessor:
+            accessor["bufferView"] = copy_view(accessor["bufferView"])
+        if "sparse" in accessor:
+            for part in ["indices", "values"]:
+                accessor["sparse"][part]["bufferView"] = copy_view(accessor["sparse"][part]["bufferView"])
+        return accessor
+
+    def copy_accessor(accessor_index):
+        return copy("accessors", accessor_index, convert_accessor)
+
+    def convert_image(image):
+        if "bufferView" in image:
+            image["bufferView"] = copy_view(image["bufferView"])
+        elif "uri" in image and not image["uri"].startswith("data:") and "://" not in image["uri"]:
+            image["uri"] = uri_prefix + image["uri"]
+        return image
+
+    def convert_texture(texture):
+        if "source" in texture:
+            texture["source"] = copy("images", texture["source"], convert_image)
+        if "sampler" in texture:
+            texture["sampler"] = copy("samplers", texture["sampler"], lambda sampler: sampler)
+        for extension in texture.get("extensions", {}).values():
+            if isinstance(extension, dict) and "source" in extension:
+                extension["source"] = copy("images", extension["source"], convert_image)
+        return texture
+
+    def convert_material(material):
+        for key, info in _texture_infos(material):
+            info["index"] = copy("textures", info["index"], convert_texture)
+        return material
+
+    def convert_mesh(mesh):
+        for primitive in mesh["primitives"]:
+            attributes = primitive["attributes"]
+            for name in attributes:
+                attributes[name] = copy_accessor(attributes[name])
+            if "indices" in primitive:
+                primitive["indices"] = copy_accessor(primitive["indices"])
+            for morph_target in primitive.get("targets", []):
+                for name in morph_target:
+                    morph_target[name] = copy_accessor(morph_target[name])
+            if "material" in primitive:
+                primitive["material"] = copy("materials", primitive["material"], convert_material)
+            for extension in primitive.get("extensions", {}).values():
+                if isinstance(extension, dict) and "bufferView" in extension:
+                    extension["bufferView"] = copy_view(extension["bufferView"])
+        return mesh
+
+    nodes = source.get("nodes", [])
+    node_order = _node_subtree(nodes, roots)
+    node_remap = {node_index: new_index for new_index, node_index in enumerate(node_order)}
+
+    def convert_skin(skin):
+        for joint in skin["joints"]:
+            if joint not in node_remap:
+                raise ValueError("skin " + skin.get("name", "") + " has joints outside of the extracted nodes")
+        skin["joints"] = [node_remap[joint] for joint in skin["joints"]]
+        if "skeleton" in skin:
+            skin["skeleton"] = node_remap.get(skin["skeleton"], skin["joints"][0])
+        if "inverseBindMatrices" in skin:
+            skin["inverseBindMatrices"] = copy_accessor(skin["inverseBindMatrices"])
+        return skin
+
+    target["nodes"] = []
+    for node_index in node_order:
+        node = json.loads(json.dumps(nodes[node_index]))
+        if "children" in node:
+            node["children"] = [node_remap[child] for child in node["children"]]
+        if "mesh" in node:
+            node["mesh"] = copy("meshes", node["mesh"], convert_mesh)
+        if "skin" in node:
+            node["skin"] = copy("skins", node["skin"], convert_skin)
+        for extension in node.get("extensions", {}).values():
+            if isinstance(extension, dict):
+                attributes = extension.get("attributes", {})
+                for name in attributes:
+                    attributes[name] = copy_accessor(attributes[name])
+        target["nodes"].append(node)
+    if len(roots) == 1:
+        for key in ["matrix", "translation", "rotation", "scale"]:
+            target["nodes"][0].pop(key, None)
+    target["scenes"] = [{"nodes": [node_remap[root] for root in roots]}]
+    target["scene"] = 0
+
+    for animation in source.get("animations", []):
+        channels = [channel for channel in animation["channels"] if channel["target"].get("node") in node_remap]
+        if len(channels) == 0:
+            continue
+        new_animation = {key: value for key, value in animation.items() if key not in ["channels", "samplers"]}
+        new_animation["channels"] = []
+        new_animation["samplers"] = []
+        sampler_remap = {}
+        for channel in channels:
+            if channel["sampler"] not in sampler_remap:
+                sampler = dict(animation["samplers"][channel["sampler"]])
+                sampler["input"] = copy_accessor(sampler["input"])
+                sampler["output"] = copy_accessor(sampler["output"])
+                sampler_remap[channel["sampler"]] = len(new_animation["samplers"])
+                new_animation["samplers"].append(sampler)
+            new_channel = json.loads(json.dumps(channel))
+            new_channel["sampler"] = sampler_remap[channel["sampler"]]
+            new_channel["target"]["node"] = node_remap[channel["target"]["node"]]
+            new_animation["channels"].append(new_channel)
+        target.setdefault("animations", []).append(new_animation)
+    return result
+
+def _world_matrices(nodes, roots):
+    # {node index: world matrix} for the roots and their descendants
+    matrices = {}
+    stack = [(root, np.identity(4)) for root in roots]
+    while len(stack) > 0:
+        node_index, parent_matrix = stack.pop()
+        matrices[node_index] = parent_matrix @ _matrix_from_trs(nodes[node_index])
+        stack.extend((child, matrices[node_index]) for child in nodes[node_index].get("children", []))
+    return matrices
+
+def _mesh_bounds(asset, mesh):
+    # (min, max) of the POSITION accessors, or None
+    accessors = asset.json.get("accessors", [])
+    minimum = np.full(3, np.inf)
+    maximum = np.full(3, -np.inf)
+    for primitive in mesh["primitives"]:
+        accessor = accessors[primitive["attributes"]["POSITION"]] if "POSITION" in primitive["attributes"] else None
+        if accessor is None:
+            continue
+        if "min" in accessor and "max" in accessor:
+            low = np.array(accessor["min"], dtype=np.float64)
+            high = np.array(accessor["max"], dtype=np.float64)
+            if accessor.get("normalized", False):
+                low = dequantize(low, accessor["componentType"])
+                high = dequantize(high, accessor["componentType"])
+        else:
+            positions = asset.read_accessor(primitive["attributes"]["POSITION"]).astype(np.float64)
+            if len(positions) == 0:
+                continue
+            low, high = positions.min(axis=0), positions.max(axis=0)
+        minimum = np.minimum(minimum, low)
+        maximum = np.maximum(maximum, high)
+    if not np.all(np.isfinite(minimum)):
+        return None
+    return minimum, maximum
+
+def _world_bounds(asset, roots):
+    """Returns the world space (min, max) of the meshes below roots; for
+    objects without meshes the bounds of their root positions.
+    """
+    nodes = asset.json.get("nodes", [])
+    meshes = asset.json.get("meshes", [])
+    matrices = _world_matrices(nodes, roots)
+    points = []
+    for node_index, matrix in matrices.items():
+        if "mesh" not in nodes[node_index]:
+            continue
+        bounds = _mesh_bounds(asset, meshes[nodes[node_index]["mesh"]])
+        if bounds is None:
+            continue
+        # skinned meshes are posed by their joints, the bind pose bounds are close enough for placement
+        if "skin" in nodes[node_index]:
+            matrix = np.identity(4)
+        low, high = bounds
+        corners = np.array([[x, y, z, 1.0] for x in (low[0], high[0]) for y in (low[1], high[1]) for z in (low[2], high[2])])
+        points.extend((corners @ matrix.T)[:, :3])
+    if len(points) == 0:
+        points = [matrices[root][:3, 3] for root in roots]
+    points = np.array(points)
+    return points.min(axis=0), points.max(axis=0)
+
+def _scene_objects(asset):
+    """Groups the roots of the default scene into objects: roots are kept
+    together when a skin of one uses joints of another, as for a figure
+    whose clothing was exported as separate roots.
+    """
+    nodes = asset.json.get("nodes", [])
+    scenes = asset.json.get("scenes", [])
+    if len(scenes) == 0:
+        children = set(child for node in nodes for child in node.get("children", []))
+        roots = [index for index in range(len(nodes)) if index not in children]
+    else:
+        roots = list(scenes[asset.json.get("scene", 0)].get("nodes", []))
+    root_of = {}
+    for root in roots:
+        for node_index in _node_subtree(nodes, [root]):
+            root_of[node_index] = root
+    group = {root: root for root in roots}
+    def find(root):
+        while group[root] != root:
+            group[root] = group[group[root]]
+            root = group[root]
+        return root
+    for node_index, root in root_of.items():
+        if "skin" not in nodes[node_index]:
+            continue
+        for joint in asset.json["skins"][nodes[node_index]["skin"]]["joints"]:
+            if joint in root_of:
+                group[find(root_of[joint])] = find(root)
+    objects = {}
+    for root in roots:
+        objects.setdefault(find(root), []).append(root)
+    return list(objects.values())
+
+def _object_key(asset, roots):
+    """Returns a key which is equal for objects that can share one file:
+    the same node hierarchy, meshes and skins apart from names and the
+    placement of the root. Animated or multi-root objects are unique.
+    """
+    if len(roots) != 1:
+        return None
+    nodes = asset.json.get("nodes", [])
+    order = _node_subtree(nodes, roots)
+    subtree = set(order)
+    for animation in asset.json.get("animations", []):
+        if any(channel["target"].get("node") in subtree for channel in animation["channels"]):
+            return None
+    local_index = {node_index: position for position, node_index in enumerate(order)}
+    structure = []
+    for position, node_index in enumerate(order):
+        node = {key: value for key, value in nodes[node_index].items() if key != "name"}
+        if position == 0:
+            for key in ["matrix", "translation", "rotation", "scale"]:
+                node.pop(key, None)
+        if "children" in node:
+            node["children"] = [local_index[child] for child in node["children"]]
+        structure.append(node)
+    return hashlib.sha1(json.dumps(structure, sort_keys=True).encode("utf-8")).hexdigest()
+
+def _godot_node_name(name, used_names):
+    # Godot node names may not contain . : @ / " % and must be unique among siblings
+    for character in '.:@/"%':
+        name = name.replace(character, "_")
+    name = name.strip() or "Node"
+    unique_name = name
+    suffix = 2
+    while unique_name in used_names:
+        unique_name = name + "_" + str(suffix)
+        suffix += 1
+    used_names.add(unique_name)
+    return unique_name
+
+def _godot_real(value):
+    return format(float(value), ".7g")
+
+def _godot_transform(matrix):
+    # Transform3D(basis x axis, y axis, z axis, origin): the columns of the glTF matrix
+    values = [matrix[row, column] for column in range(4) for row in range(3)]
+    return "Transform3D(" + ", ".join(_godot_real(value) for value in values) + ")"
+
+def _godot_aabb(minimum, maximum):
+    values = list(minimum) + list(np.asarray(maximum) - np.asarray(minimum))
+    return "AABB(" + ", ".join(_godot_real(value) for value in values) + ")"
+
+def _res_path(path, project_folder):
+    return "res://" + os.path.relpath(path, project_folder).replace(os.sep, "/")
+
+def _write_tscn(path, root_name, resources, nodes_text, root_properties=""):
+    """Writes a text scene with a Node3D root. resources is a list of
+    (type, res path) which nodes_text refers to as ExtResource("<n>"),
+    counting from 1.
+    """
+    lines = ["[gd_scene load_steps=" + str(len(resources) + 1) + " format=3]", ""]
+    for resource_id, (resource_type, res_path) in enumerate(resources, 1):
+        lines.append('[ext_resource type="' + resource_type + '" path="' + res_path + '" id="' + str(resource_id) + '"]')
+    if len(resources) > 0:
+        lines.append("")
+    lines.append('[node name="' + root_name + '" type="Node3D"]')
+    if root_properties:
+        lines.append(root_properties)
+    lines += ["", ""]
+    with open(path, "w", encoding="utf-8", newline="\n") as file:
+        file.write("\n".join(lines) + nodes_text)
+
+def _instance_nodes_text(instances, resource_ids, used_names):
+    # instances: (object index, name, world matrix), placed below the scene root
+    text = ""
+    for object_index, name, matrix in instances:
+        text += '[node name="' + _godot_node_name(name, used_names) + '" parent="." instance=ExtResource("' + str(resource_ids[object_index]) + '")]\n'
+        text += "transform = " + _godot_transform(matrix) + "\n\n"
+    return text
+
+def split_scene(gltf_path, project_folder, cell_size=SCENE_CELL_SIZE, report_path=None):
+    """Splits an exported environment into a Godot scene: each root of the
+    .gltf/.glb file becomes an object file in Objects/, shared by all roots
+    with the same nodes and meshes, and the objects are instanced into
+    grid cells of cell_size meters in Cells/. The main <name>.tscn holds
+    one InstancePlaceholder per cell with its bounds and a streaming script
+    which loads the cells around the camera. With cell_size <= 0 the
+    objects are instanced directly into the main scene. The combined file
+    is removed. project_folder is the Godot project root for res:// paths.
+    Returns a report with the main scene, object files and cells.
+    """
+    _add_to_log("DEBUG: split_scene(): processing: " + gltf_path + ", cell_size=" + str(cell_size))
+    asset = GltfAsset(gltf_path)
+    folder = os.path.dirname(os.path.abspath(gltf_path))
+    asset_name, extension = os.path.splitext(os.path.basename(gltf_path))
+    objects_folder = os.path.join(folder, "Objects")
+    cells_folder = os.path.join(folder, "Cells")
+    os.makedirs(objects_folder, exist_ok=True)
+    nodes = asset.json.get("nodes", [])
+
+    object_paths = []
+    object_file_by_key = {}
+    used_filenames = set()
+    instances = []
+    for roots in _scene_objects(asset):
+        name = nodes[roots[0]].get("name", "Object")
+        key = _object_key(asset, roots)
+        if key is not None and key in object_file_by_key:
+            object_index = object_file_by_key[key]
+        else:
+            filename = _godot_node_name(name, used_filenames).replace(" ", "_")
+            object_path = os.path.join(objects_folder, filename + extension)
+            extract_nodes(asset, roots, object_path, "../").save()
+            object_index = len(object_paths)
+            object_paths.append(object_path)
+            if key is not None:
+                object_file_by_key[key] = object_index
+        # a single root is stored at the origin and placed by its instance
+        matrix = _matrix_from_trs(nodes[roots[0]]) if len(roots) == 1 else np.identity(4)
+        minimum, maximum = _world_bounds(asset, roots)
+        instances.append({"object": object_index, "name": name, "matrix": matrix, "min": minimum, "max": maximum})
+
+    main_path = os.path.join(folder, asset_name + ".tscn")
+    report = {"file": gltf_path, "scene": main_path, "cell_size": cell_size, "objects": len(instances),
+              "object_files": object_paths, "cells": []}
+    root_name = _godot_node_name(asset_name, set())
+    if cell_size <= 0:
+        resources = [("PackedScene", _res_path(path, project_folder)) for path in object_paths]
+        resource_ids = {object_index: object_index + 1 for object_index in range(len(object_paths))}
+        text = _instance_nodes_text([(entry["object"], entry["name"], entry["matrix"]) for entry in instances], resource_ids, set())
+        _write_tscn(main_path, root_name, resources, text)
+    else:
+        os.makedirs(cells_folder, exist_ok=True)
+        # cells of a previous export may no longer exist
+        for filename in os.listdir(cells_folder):
+            if filename.endswith(".tscn"):
+                os.remove(os.path.join(cells_folder, filename))
+        cells = {}
+        for entry in instances:
+            center = (entry["min"] + entry["max"]) * 0.5
+            cells.setdefault((int(np.floor(center[0] / cell_size)), int(np.floor(center[2] / cell_size))), []).append(entry)
+        script_path = os.path.join(folder, SCENE_STREAMER_SCRIPT_NAME)
+        with open(script_path, "w", encoding="utf-8", newline="\n") as file:
+            file.write(SCENE_STREAMER_SCRIPT % {"load_distance": _godot_real(cell_size * 2.0),
+                                                "unload_distance": _godot_real(cell_size * 2.0 * SCENE_UNLOAD_MARGIN)})
+        main_text = ""
+        used_cell_names = set()
+        for (cell_x, cell_z), entries in sorted(cells.items()):
+            cell_name = "Cell_" + str(cell_x) + "_" + str(cell_z)
+            cell_path = os.path.join(cells_folder, cell_name.lower() + ".tscn")
+            object_indices = sorted(set(entry["object"] for entry in entries))
+            resources = [("PackedScene", _res_path(object_paths[object_index], project_folder)) for object_index in object_indices]
+            resource_ids = {object_index: position + 1 for position, object_index in enumerate(object_indices)}
+            text = _instance_nodes_text([(entry["object"], entry["name"], entry["matrix"]) for entry in entries], resource_ids, set())
+            _write_tscn(cell_path, cell_name, resources, text)
+            minimum = np.min([entry["min"] for entry in entries], axis=0)
+            maximum = np.max([entry["max"] for entry in entries], axis=0)
+            main_text += '[node name="' + _godot_node_name(cell_name, used_cell_names) + '" parent="." instance_placeholder="' + _res_path(cell_path, project_folder) + '"]\n'
+            main_text += "metadata/aabb = " + _godot_aabb(minimum, maximum) + "\n\n"
+            report["cells"].append({"cell": cell_name, "objects": len(entries), "min": minimum.tolist(), "max": maximum.tolist()})
+        _write_tscn(main_path, root_name, [("Script", _res_path(script_path, project_folder))], main_text, 'script = ExtResource("1")')
+
+    # the objects replace the combined file
+    for path in [gltf_path] + asset._external_buffer_paths:
+        if os.path.exists(path):
+            os.remove(path)
+    _add_to_log("DEBUG: split_scene(): " + str(len(instances)) + " objects in " + str(len(object_paths))
+                + " files, " + str(len(report["cells"])) + " cells: " + main_path)
+    if report_path is not None:
+        with open(report_path, "w") as file:
+            json.dump(report, file, indent=4)
+    return report
+
+
+# Material update: the materials which changed in Daz Studio are exported on
+# their own and patched into the published file, which keeps its meshes,
+# skin and animations.
+def _remove_unused_textures(asset):
+    # removes textures, images and samplers which no material references
+    materials = asset.json.get("materials", [])
+    textures = asset.json.get("textures", [])
+    used_textures = sorted(set(info["index"] for material in materials for key, info in _texture_infos(material)))
+    texture_remap = {old_index: new_index for new_index, old_index in enumerate(used_textures)}
+    for material in materials:
+        for key, info in _texture_infos(material):
+            info["index"] = texture_remap[info["index"]]
+    textures = [textures[index] for index in used_textures]
+
+    def image_references():
+        for texture in textures:
+            if "source" in texture:
+                yield texture
+            for extension in texture.get("extensions", {}).values():
+                if isinstance(extension, dict) and "source" in extension:
+                    yield extension
+    images = asset.json.get("images", [])
+    used_images = sorted(set(owner["source"] for owner in image_references()))
+    image_remap = {old_index: new_index for new_index, old_index in enumerate(used_images)}
+    for owner in image_references():
+        owner["source"] = image_remap[owner["source"]]
+    samplers = asset.json.get("samplers", [])
+    used_samplers = sorted(set(texture["sampler"] for texture in textures if "sampler" in texture))
+    sampler_remap = {old_index: new_index for new_index, old_index in enumerate(used_samplers)}
+    for texture in textures:
+        if "sampler" in texture:
+            texture["sampler"] = sampler_remap[texture["sampler"]]
+    for key, items in [("textures", textures), ("images", [images[index] for index in used_images]),
+                       ("samplers", [samplers[index] for index in used_samplers])]:
+        if len(items) > 0:
+            asset.json[key] = items
+        else:
+            asset.json.pop(key, None)
+    asset.remove_unused_buffer_views()
+
+def patch_materials(target_path, source_path, material_names):
+    """Replaces the materials named in material_names in the published
+    .gltf/.glb file at target_path with the materials of the same name in
+    source_path, an export of only the changed materials. Their textures
+    come along: image files of a .gltf are copied next to the target with
+    the same relative uri, embedded images are embedded into the target.
+    Images no material uses any more are removed. Meshes, animations and
+    everything else of the target are kept as they are. Returns a report
+    with the patched and missing material names.
+    """
+    _add_to_log("DEBUG: patch_materials(): patching " + target_path + " from " + source_path + ", materials=" + str(material_names))
+    target = GltfAsset(target_path)
+    source = GltfAsset(source_path)
+    source_folder = os.path.dirname(source_path)
+    target_folder = os.path.dirname(target_path)
+    remaps = {}
+
+    def copy_item(kind, index, convert):
+        # copies a source item into the target, reusing an identical target item
+        kind_remap = remaps.setdefault(kind, {})
+        if index not in kind_remap:
+            item = convert(json.loads(json.dumps(source.json[kind][index])))
+            items = target.json.setdefault(kind, [])
+            if item in items:
+                kind_remap[index] = items.index(item)
+            else:
+                items.append(item)
+                kind_remap[index] = len(items) - 1
+        return kind_remap[index]
+
+    def convert_image(image):
+        if "bufferView" in image:
+            image["bufferView"] = target.add_buffer_view(source.view_data[image["bufferView"]])
+        elif "uri" in image and not image["uri"].startswith("data:") and "://" not in image["uri"]:
+            target_file = os.path.join(target_folder, unquote(image["uri"]))
+            os.makedirs(os.path.dirname(target_file), exist_ok=True)
+            shutil.copyfile(os.path.join(source_folder, unquote(image["uri"])), target_file)
+        return image
+
+    def convert_texture(texture):
+        if "source" in texture:
+            texture["source"] = copy_item("images", texture["source"], convert_image)
+        if "sampler" in texture:
+            texture["sampler"] = copy_item("samplers", texture["sampler"], lambda sampler: sampler)
+        for extension in texture.get("extensions", {}).values():
+            if isinstance(extension, dict) and "source" in extension:
+                extension["source"] = copy_item("images", extension["source"], convert_image)
+        return texture
+
+    source_materials = {}
+    for material in source.json.get("materials", []):
+        source_materials.setdefault(material.get("name", ""), material)
+    target_materials = target.json.get("materials", [])
+    report = {"file": target_path, "patched": [], "missing": []}
+    for name in material_names:
+        target_indices = [index for index, material in enumerate(target_materials) if material.get("name", "") == name]
+        if name not in source_materials or len(target_indices) == 0:
+            report["missing"].append(name)
+            continue
+        material = json.loads(json.dumps(source_materials[name]))
+        for key, info in _texture_infos(material):
+            info["index"] = copy_item("textures", info["index"], convert_texture)
+        for index in target_indices:
+            target_materials[index] = json.loads(json.dumps(material))
+        report["patched"].append(name)
+    for name in source.json.get("extensionsUsed", []):
+        target.add_extension(name, required=name in source.json.get("extensionsRequired", []))
+    _remove_unused_textures(target)
+    target.save()
+    _add_to_log("DEBUG: patch_materials(): patched=" + str(report["patched"]) + ", missing=" + str(report["missing"]))
+    return report
+
+# Command line usage, with any python 3 that has numpy:
+#   python gltf_tools.py compress <file.glb> [<output.glb.meshopt>]
+#   python gltf_tools.py decompress <file.glb.meshopt> [<output.glb>]
+if __name__ == "__main__":
+    if len(sys.argv) < 3 or sys.argv[1] not in ["compress", "decompress"]:
+        print("usage: gltf_tools.py compress|decompress <input> [<output>]")
+        sys.exit(1)
+    output_arg = sys.argv[3] if len(sys.argv) > 3 else None
+    if sys.argv[1] == "compress":
+        compress_meshopt(sys.argv[2], output_arg)
+    else:
+        decompress_meshopt(sys.argv[2], output_arg)
@@ -3,7 +3,9 @@
 #include <QtNetwork/qudpsocket.h>
 #include <QtNetwork/qabstractsocket.h>
 #include <QCryptographicHash>
+#include <QtCore/qbuffer.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qsettings.h>
 
 #include <dzapp.h>
 #include <dzscene.h>
@@ -16,6 +18,11 @@
 #include <dzimageproperty.h>
 #include <dzcolorproperty.h>
 #include <dpcimages.h>
+#include <dzskeleton.h>
+#include <dzbone.h>
+#include <dzfloatproperty.h>
+#include <dzcontentmgr.h>
+#include <dzundostack.h>
 
 #include "QtCore/qmetaobject.h"
 #include "dzmodifier.h"
@@ -28,6 +35,8 @@
 
 #include "DzGodotAction.h"
 #include "DzGodotDialog.h"
+#include "DzGodotTextureStage.h"
+#include "DzGodotLiveLink.h"
 #include "DzBridgeMorphSelectionDialog.h"
 #include "DzBridgeSubdivisionDialog.h"
 
@@ -146,7 +155,7 @@ void DzGodotAction::executeAction()
 			if (m_nNonInteractiveMode == 0)
 			{
 				QMessageBox::warning(0, tr("Error"),
-					tr("Please select one Character or Prop to send."), QMessageBox::Ok);
+					tr("Please select one Character or Prop to send, or use the Godot Scene asset type to send the whole scene."), QMessageBox::Ok);
 			}
 		}
 	}
@@ -282,7 +291,34 @@ void DzGodotAction::executeAction()
 		dir.mkpath(m_sRootFolder);
 		exportProgress->step();
 
-		bool bExportResult = exportHD(exportProgress);
+		bool bExportResult = false;
+		if (m_sAssetType == "Godot_Material_Update")
+		{
+			bExportResult = exportMaterialUpdate();
+		}
+		else
+		{
+			if (buildAnimationClipTimeline() == false)
+			{
+				exportProgress->finish();
+				if (m_nNonInteractiveMode == 0) QMessageBox::warning(0, "Daz To Godot Bridge",
+					tr("Unable to build the animation clips, nothing was exported:\n\n") + m_sAnimationClipError, QMessageBox::Ok);
+				return;
+			}
+
+			if (convertTextures() == false)
+			{
+				restoreAnimationClipTimeline();
+				exportProgress->finish();
+				if (m_nNonInteractiveMode == 0) QMessageBox::warning(0, "Daz To Godot Bridge",
+					tr("Unable to convert the textures, nothing was exported.  Please check the log file for details, or disable Texture Conversion to export the source textures."), QMessageBox::Ok);
+				return;
+			}
+			suspendBridgeTextureConversion();
+			bExportResult = exportHD(exportProgress);
+			restoreBridgeTextureConversion();
+			restoreAnimationClipTimeline();
+		}
 
 		if (!bExportResult)
 		{
@@ -327,7 +363,7 @@ void DzGodotAction::executeAction()
 
 		// 2. attempt copy to plugindata folder, if already exist, use as override
         // search for override files in folder with DLL and copy over extracted files
-		QStringList aOverrideFilenameList = (QStringList() << "blender_dtu_to_godot.py" << "blender_tools.py" << "NodeArrange.py" << "blender_gltf_to_blend.py");
+		QStringList aOverrideFilenameList = (QStringList() << "blender_dtu_to_godot.py" << "blender_tools.py" << "NodeArrange.py" << "blender_gltf_to_blend.py" << "gltf_tools.py");
 		if (sPluginFolder.isEmpty() == false)
 		{
 			foreach(QString filename, aOverrideFilenameList)
@@ -400,6 +436,9 @@ void DzGodotAction::executeAction()
 
 		}
 
+		// the blender scripts only write a new budget report for the formats they can measure
+		QFile::remove(m_sDestinationPath + m_sExportFilename + "_budget_report.ini");
+
 //		QString sScriptPath = dzApp->getTempPath() + "/blender_dtu_to_godot.py";
 		QString sScriptPath = sScriptFolderPath + "/blender_dtu_to_godot.py";
 		QString sCommandArgs = QString("--background;--log-file;%1;--python-exit-code;%2;--python;%3;%4").arg(sBlenderLogPath).arg(m_nPythonExceptionExitCode).arg(sScriptPath).arg(m_sDestinationFBX);
@@ -460,10 +499,27 @@ void DzGodotAction::executeAction()
 
 		}
 
+		// keep the published asset in the Godot editor in sync with later changes
+		if (retCode && m_bLiveLink && m_sAssetType != "Godot_Animation" && m_sAssetType != "Godot_Scene")
+		{
+			startLiveLink(m_pSelectedNode);
+		}
+		else
+		{
+			stopLiveLink();
+		}
+
         exportProgress->setInfo("Daz To Godot: Export Phase Completed.");
 		// DB 2021-10-11: Progress Bar
 		exportProgress->finish();
 
+		QStringList aBudgetWarnings = checkExportBudgets();
+		if (m_nNonInteractiveMode == 0 && retCode && aBudgetWarnings.isEmpty() == false)
+		{
+			QMessageBox::warning(0, "Daz To Godot Bridge",
+				tr("The exported asset exceeds the budgets of the %1 export profile:\n\n").arg(m_sExportProfile) + aBudgetWarnings.join("\n"), QMessageBox::Ok);
+		}
+
 		// DB 2021-09-02: messagebox "Export Complete"
 		if (m_nNonInteractiveMode == 0)
 		{
@@ -517,6 +573,56 @@ void DzGodotAction::writeConfiguration()
 
 	// Godot-specific items
 	writer.addMember("Godot Project Folder", m_sGodotProjectFolderPath);
+	writer.addMember("Sparse Morph Encoding", m_bSparseMorphEncoding);
+	writer.addMember("Quantize Morph Deltas", m_bQuantizeMorphDeltas);
+	writer.addMember("Morph Prune Threshold", m_fMorphPruneThreshold);
+	writer.addMember("Quantize Vertex Attributes", m_bQuantizeVertexAttributes);
+	writer.addMember("Prune Mesh Surfaces", m_bPruneMeshSurfaces);
+	writer.addMember("Deduplicate Meshes", m_bDeduplicateMeshes);
+	writer.addMember("Meshopt Compression", m_bMeshoptCompression);
+	writer.addMember("KTX2 Textures", m_bKtx2Textures);
+	writer.addMember("Toktx Executable Path", m_sToktxExecutablePath);
+	writer.addMember("Pack ORM Textures", m_bPackOrmTextures);
+	writer.addMember("Atlas Textures", m_bAtlasTextures);
+	writer.addMember("Atlas Size", m_nAtlasSize);
+	writer.addMember("Atlas Padding", m_nAtlasPadding);
+	writer.addMember("Reduce Animation Keys", m_bReduceAnimationKeys);
+	writer.addMember("Quantize Animation Rotations", m_bQuantizeAnimationRotations);
+	writer.addMember("Animation Rotation Tolerance", m_fAnimationRotationTolerance);
+	writer.addMember("Animation Translation Tolerance", m_fAnimationTranslationTolerance);
+	writer.addMember("Animation Scale Tolerance", m_fAnimationScaleTolerance);
+	writer.addMember("Skeleton Hash", calculateSkeletonHash(m_pSelectedNode));
+	writer.startMemberArray("Animation Clips", true);
+	foreach(DzGodotAnimationClip clip, m_aResolvedAnimationClips)
+	{
+		writer.startObject(true);
+		writer.addMember("Name", clip.sName);
+		writer.addMember("Source", clip.sSource);
+		writer.addMember("Start Frame", clip.nStartFrame);
+		writer.addMember("End Frame", clip.nEndFrame);
+		writer.finishObject();
+	}
+	writer.finishArray();
+	writer.addMember("Texture Resolution", m_sTextureResolution);
+	writer.addMember("Publish Texture Variants", m_bPublishTextureVariants);
+	writer.addMember("Export Profile", m_sExportProfile);
+	writer.addMember("Generate LODs", m_nGenerateLods);
+	writer.addMember("Morph Budget", m_nMorphBudget);
+	writer.addMember("Max Bone Influences", m_nMaxBoneInfluences);
+	writer.addMember("Skin Weight Threshold", m_fSkinWeightThreshold);
+	writer.addMember("Remove Unused Bones", m_bRemoveUnusedBones);
+	writer.addMember("Budget Max Triangles", m_nBudgetMaxTriangles);
+	writer.addMember("Budget Max Texture MB", m_nBudgetMaxTextureMemory);
+	writer.addMember("Budget Max Draw Calls", m_nBudgetMaxDrawCalls);
+	writer.addMember("Scene Cell Size", m_nSceneCellSize);
+
+	// textures converted by convertTextures(), Blender swaps the source paths for the converted files
+	writer.startMemberObject("Texture Remap", true);
+	foreach(QString sSourcePath, m_aTextureRemap.keys())
+	{
+		writer.addMember(sSourcePath, m_aTextureRemap[sSourcePath]);
+	}
+	writer.finishObject();
 
 	if (m_sAssetType.toLower().contains("mesh") || m_sAssetType == "Animation" ||
 		m_sAssetType.contains("godot", Qt::CaseInsensitive) )
@@ -530,26 +636,43 @@ void DzGodotAction::writeConfiguration()
 			pCVSStream = new QTextStream(&file);
 			*pCVSStream << "Version, Object, Material, Type, Color, Opacity, File" << endl;
 		}
-		writeAllMaterials(m_pSelectedNode, writer, pCVSStream);
-		writeAllMorphs(writer);
+		// animation-only exports reuse the materials and morphs of the published character
+		if (m_sAssetType == "Godot_Scene")
+		{
+			writer.startMemberArray("Materials", true);
+			foreach(DzNode* pNode, buildRootNodeList())
+			{
+				writeAllMaterials(pNode, writer, pCVSStream, true);
+			}
+			writer.finishArray();
+		}
+		else if (m_sAssetType != "Godot_Animation")
+		{
+			writeAllMaterials(m_pSelectedNode, writer, pCVSStream);
+		}
+		// a material update keeps the meshes, morphs and skeleton of the published asset
+		if (m_sAssetType != "Godot_Material_Update")
+		{
+			writeAllMorphs(writer);
 
-		writeMorphLinks(writer);
-		//writer.startMemberObject("MorphLinks");
-		//writer.finishObject();
-		writeMorphNames(writer);
-		//writer.startMemberArray("MorphNames");
-		//writer.finishArray();
+			writeMorphLinks(writer);
+			//writer.startMemberObject("MorphLinks");
+			//writer.finishObject();
+			writeMorphNames(writer);
+			//writer.startMemberArray("MorphNames");
+			//writer.finishArray();
 
-		DzBoneList aBoneList = getAllBones(m_pSelectedNode);
+			DzBoneList aBoneList = getAllBones(m_pSelectedNode);
 
-		writeSkeletonData(m_pSelectedNode, writer);
-		writeHeadTailData(m_pSelectedNode, writer);
+			writeSkeletonData(m_pSelectedNode, writer);
+			writeHeadTailData(m_pSelectedNode, writer);
 
-		writeJointOrientation(aBoneList, writer);
-		writeLimitData(aBoneList, writer);
-		writePoseData(m_pSelectedNode, writer, true);
-		writeAllSubdivisions(writer);
-		writeAllDforceInfo(m_pSelectedNode, writer);
+			writeJointOrientation(aBoneList, writer);
+			writeLimitData(aBoneList, writer);
+			writePoseData(m_pSelectedNode, writer, true);
+			writeAllSubdivisions(writer);
+			writeAllDforceInfo(m_pSelectedNode, writer);
+		}
 	}
 
 	if (m_sAssetType == "Pose")
@@ -557,7 +680,7 @@ void DzGodotAction::writeConfiguration()
 	   writeAllPoses(writer);
 	}
 
-	if (m_sAssetType == "Environment")
+	if (m_sAssetType == "Environment" || m_sAssetType == "Godot_Scene")
 	{
 		writeEnvironment(writer);
 	}
@@ -579,6 +702,98 @@ void DzGodotAction::setExportOptions(DzFileIOSettings& ExportOptions)
 	ExportOptions.setBoolValue("doBaseFigurePoseOnly", false);
 	ExportOptions.setBoolValue("doHelperScriptScripts", false);
 	ExportOptions.setBoolValue("doMentalRayMaterials", false);
+	if (m_aResolvedAnimationClips.isEmpty() == false)
+	{
+		ExportOptions.setBoolValue("doAnimation", true);
+	}
+	if (m_sAssetType == "Godot_Animation")
+	{
+		ExportOptions.setBoolValue("doCopyTextures", false);
+		ExportOptions.setBoolValue("doEmbed", false);
+	}
+	// the whole visible scene, Godot brings its own lights and cameras
+	if (m_sAssetType == "Godot_Scene")
+	{
+		ExportOptions.setBoolValue("doSelected", false);
+		ExportOptions.setBoolValue("doVisible", true);
+		ExportOptions.setBoolValue("doLights", false);
+		ExportOptions.setBoolValue("doCameras", false);
+	}
+}
+
+// Material updates skip the FBX export: only the DTU of the selected node is written, and the
+// blender scripts patch the changed materials into the asset published by an earlier export
+bool DzGodotAction::exportMaterialUpdate()
+{
+	DzNode* pNode = dzScene->getPrimarySelection();
+	if (pNode == nullptr)
+	{
+		dzApp->log("ERROR: DzGodotAction: exportMaterialUpdate(): nothing selected");
+		return false;
+	}
+	DzBone* pBone = qobject_cast<DzBone*>(pNode);
+	if (pBone)
+	{
+		pNode = pBone->getSkeleton();
+	}
+	m_pSelectedNode = pNode;
+
+	QDir dir;
+	dir.mkpath(m_sDestinationPath);
+	if (convertTextures() == false)
+	{
+		return false;
+	}
+	suspendBridgeTextureConversion();
+	writeConfiguration();
+	restoreBridgeTextureConversion();
+	return true;
+}
+
+bool DzGodotAction::startLiveLink(DzNode* pNode)
+{
+	if (m_pLiveLink == nullptr)
+	{
+		m_pLiveLink = new DzGodotLiveLink(this);
+	}
+	m_pLiveLink->setPort(m_nLiveLinkPort);
+	m_pLiveLink->setMaxFrameRate(m_nLiveLinkMaxFrameRate);
+	QStringList aMorphNames;
+	if (m_bEnableMorphs)
+	{
+		aMorphNames = m_MorphNamesToExport;
+	}
+	return m_pLiveLink->start(pNode, m_sAssetName, aMorphNames);
+}
+
+void DzGodotAction::stopLiveLink()
+{
+	if (m_pLiveLink)
+	{
+		m_pLiveLink->stop();
+	}
+}
+
+// Identifies a skeleton by hashing its DTU skeleton and joint orientation data, so that
+// animation-only exports can be matched to a previously published character
+QString DzGodotAction::calculateSkeletonHash(DzNode* pNode)
+{
+	DzSkeleton* pSkeleton = qobject_cast<DzSkeleton*>(pNode);
+	if (pSkeleton == nullptr)
+	{
+		return "";
+	}
+
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	DzJsonWriter writer(&buffer);
+	writer.startObject(true);
+	writeSkeletonData(pNode, writer);
+	writeJointOrientation(getAllBones(pNode), writer);
+	writer.finishObject();
+	buffer.close();
+
+	return QString(QCryptographicHash::hash(buffer.data(), QCryptographicHash::Sha1).toHex());
 }
 
 QString DzGodotAction::readGuiRootFolder()
@@ -618,6 +833,34 @@ bool DzGodotAction::readGui(DZ_BRIDGE_NAMESPACE::DzBridgeDialog* BridgeDialog)
 		// Collect the values from the dialog fields
 		if (m_sGodotProjectFolderPath == "" || m_nNonInteractiveMode == 0) m_sGodotProjectFolderPath = pGodotDialog->m_wGodotProjectFolderEdit->text().replace("\\", "/");
 		if (m_sBlenderExecutablePath == "" || m_nNonInteractiveMode == 0) m_sBlenderExecutablePath = pGodotDialog->m_wBlenderExecutablePathEdit->text().replace("\\", "/");
+		if (m_nNonInteractiveMode == 0) m_bQuantizeMorphDeltas = pGodotDialog->m_wQuantizeMorphsCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bQuantizeVertexAttributes = pGodotDialog->m_wQuantizeVerticesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bPruneMeshSurfaces = pGodotDialog->m_wPruneMeshSurfacesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bDeduplicateMeshes = pGodotDialog->m_wDeduplicateMeshesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bMeshoptCompression = pGodotDialog->m_wMeshoptCompressionCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bKtx2Textures = pGodotDialog->m_wKtx2TexturesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bPackOrmTextures = pGodotDialog->m_wPackOrmTexturesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bAtlasTextures = pGodotDialog->m_wAtlasTexturesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_nAtlasSize = pGodotDialog->m_wAtlasSizeCombo->itemData(pGodotDialog->m_wAtlasSizeCombo->currentIndex()).toInt();
+		if (m_nNonInteractiveMode == 0) m_nAtlasPadding = pGodotDialog->m_wAtlasPaddingSpinBox->value();
+		if (m_nNonInteractiveMode == 0) m_bReduceAnimationKeys = pGodotDialog->m_wReduceAnimationsCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bQuantizeAnimationRotations = pGodotDialog->m_wQuantizeAnimationsCheckBox->isChecked();
+		if (m_sToktxExecutablePath == "" || m_nNonInteractiveMode == 0) m_sToktxExecutablePath = pGodotDialog->m_wToktxExecutablePathEdit->text().replace("\\", "/");
+		if (m_aAnimationClips.isEmpty() || m_nNonInteractiveMode == 0) m_aAnimationClips = pGodotDialog->m_wAnimationClipsEdit->text().replace("\\", "/").split(";", QString::SkipEmptyParts);
+		if (m_nNonInteractiveMode == 0) m_bTextureStage = pGodotDialog->m_wTextureStageCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_bTextureCache = pGodotDialog->m_wTextureCacheCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_nTextureCacheSize = pGodotDialog->m_wTextureCacheSizeSpinBox->value();
+		if (m_nNonInteractiveMode == 0) m_nTextureMemoryBudget = pGodotDialog->m_wTextureMemoryBudgetSpinBox->value();
+		if (m_nNonInteractiveMode == 0) m_sTextureResolution = pGodotDialog->m_wTextureResolutionCombo->itemData(pGodotDialog->m_wTextureResolutionCombo->currentIndex()).toString();
+		if (m_nNonInteractiveMode == 0) m_bPublishTextureVariants = pGodotDialog->m_wPublishTextureVariantsCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_nMaxBoneInfluences = pGodotDialog->m_wMaxBoneInfluencesCombo->itemData(pGodotDialog->m_wMaxBoneInfluencesCombo->currentIndex()).toInt();
+		if (m_nNonInteractiveMode == 0) m_fSkinWeightThreshold = pGodotDialog->m_wSkinWeightThresholdCombo->itemData(pGodotDialog->m_wSkinWeightThresholdCombo->currentIndex()).toDouble();
+		if (m_nNonInteractiveMode == 0) m_bRemoveUnusedBones = pGodotDialog->m_wRemoveUnusedBonesCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_nSceneCellSize = pGodotDialog->m_wSceneCellSizeSpinBox->value();
+		if (m_nNonInteractiveMode == 0) m_bLiveLink = pGodotDialog->m_wLiveLinkCheckBox->isChecked();
+		if (m_nNonInteractiveMode == 0) m_nLiveLinkPort = pGodotDialog->m_wLiveLinkPortSpinBox->value();
+		if (m_sExportProfile == "" || m_nNonInteractiveMode == 0) m_sExportProfile = pGodotDialog->m_wExportProfileCombo->itemData(pGodotDialog->m_wExportProfileCombo->currentIndex()).toString();
+		if (m_sExportProfile != "") applyExportProfile(pGodotDialog->getExportProfile(m_sExportProfile));
 
 	}
 	else
@@ -631,6 +874,50 @@ bool DzGodotAction::readGui(DZ_BRIDGE_NAMESPACE::DzBridgeDialog* BridgeDialog)
 	return true;
 }
 
+// Overrides the export options with the values of an export profile, keys which are missing
+// from the profile keep their current value
+void DzGodotAction::applyExportProfile(QVariantMap aProfile)
+{
+	if (aProfile.contains("TextureResolution")) m_sTextureResolution = aProfile["TextureResolution"].toString();
+	if (aProfile.contains("Ktx2Textures")) m_bKtx2Textures = aProfile["Ktx2Textures"].toBool();
+	if (aProfile.contains("GenerateLods")) m_nGenerateLods = aProfile["GenerateLods"].toBool() ? 1 : 0;
+	// profiles written by earlier versions, Godot picks the number of LODs itself
+	else if (aProfile.contains("LodCount")) m_nGenerateLods = aProfile["LodCount"].toInt() > 0 ? 1 : 0;
+	if (aProfile.contains("MorphBudget")) m_nMorphBudget = aProfile["MorphBudget"].toInt();
+	if (aProfile.contains("MaxBoneInfluences")) m_nMaxBoneInfluences = aProfile["MaxBoneInfluences"].toInt();
+	if (aProfile.contains("AnimationRotationTolerance")) m_fAnimationRotationTolerance = aProfile["AnimationRotationTolerance"].toDouble();
+	if (aProfile.contains("MaxTriangles")) m_nBudgetMaxTriangles = aProfile["MaxTriangles"].toInt();
+	if (aProfile.contains("MaxTextureMemory")) m_nBudgetMaxTextureMemory = aProfile["MaxTextureMemory"].toInt();
+	if (aProfile.contains("MaxDrawCalls")) m_nBudgetMaxDrawCalls = aProfile["MaxDrawCalls"].toInt();
+}
+
+// Reads the budget report written by the blender scripts, returns one line per exceeded budget
+QStringList DzGodotAction::checkExportBudgets()
+{
+	QStringList aWarnings;
+	QString sReportPath = m_sDestinationPath + m_sExportFilename + "_budget_report.ini";
+	if (QFileInfo(sReportPath).exists() == false)
+	{
+		return aWarnings;
+	}
+
+	QSettings report(sReportPath, QSettings::IniFormat);
+	foreach(QString sBudget, report.childGroups())
+	{
+		if (sBudget == "Summary") continue;
+		report.beginGroup(sBudget);
+		if (report.value("Exceeded").toString() == "true")
+		{
+			QString sWarning = QString("%1 %2 (budget %3)").arg(report.value("Value").toString()).arg(report.value("Description").toString()).arg(report.value("Budget").toString());
+			dzApp->log("WARNING: DazToGodot: Export budget exceeded: " + sWarning);
+			aWarnings.append(sWarning);
+		}
+		report.endGroup();
+	}
+
+	return aWarnings;
+}
+
 bool DzGodotAction::executeBlenderScripts(QString sFilePath, QString sCommandlineArguments)
 {
 	// fork or spawn child process
@@ -679,13 +966,246 @@ bool DzGodotAction::executeBlenderScripts(QString sFilePath, QString sCommandlin
 	return true;
 }
 
+// Resolves m_aAnimationClips into frame ranges. Timeline ranges are used as-is, aniBlock and
+// pose preset files are loaded one after another behind the existing animation, each starting
+// from the default pose. All changes are held on the undo stack and reverted after the export.
+// On failure the reason is in m_sAnimationClipError.
+bool DzGodotAction::buildAnimationClipTimeline()
+{
+	m_aResolvedAnimationClips.clear();
+	m_bAnimationClipTimelineBuilt = false;
+	m_sAnimationClipError = "";
+	if (m_aAnimationClips.isEmpty() || m_pSelectedNode == nullptr)
+	{
+		return true;
+	}
+
+	DzTime nTimeStep = dzScene->getTimeStep();
+	m_oSavedAnimRange = dzScene->getAnimRange();
+	m_oSavedPlayRange = dzScene->getPlayRange();
+	m_nSavedTime = dzScene->getTime();
+
+	// collect the animatable properties of the figure
+	QList<DzFloatProperty*> aProperties;
+	QList<DzNode*> aNodes;
+	aNodes.append(m_pSelectedNode);
+	foreach(DzBone* pBone, getAllBones(m_pSelectedNode))
+	{
+		aNodes.append(pBone);
+	}
+	foreach(DzNode* pNode, aNodes)
+	{
+		for (int i = 0; i < pNode->getNumProperties(); i++)
+		{
+			DzFloatProperty* pProperty = qobject_cast<DzFloatProperty*>(pNode->getProperty(i));
+			if (pProperty && pProperty->isAnimatable())
+			{
+				aProperties.append(pProperty);
+			}
+		}
+	}
+
+	int nNextFrame = m_oSavedAnimRange.getEnd() / nTimeStep + 1;
+	int nLastFrame = m_oSavedAnimRange.getEnd() / nTimeStep;
+	QRegExp rangePattern("^\\s*(\\d+)\\s*-\\s*(\\d+)\\s*$");
+	dzUndoStack->beginHold();
+	m_bAnimationClipTimelineBuilt = true;
+	foreach(QString sClip, m_aAnimationClips)
+	{
+		sClip = sClip.trimmed();
+		if (sClip.isEmpty())
+		{
+			continue;
+		}
+		DzGodotAnimationClip clip;
+		clip.sSource = sClip.section("=", 1).trimmed();
+		clip.sName = sClip.section("=", 0, 0).trimmed();
+		if (clip.sSource.isEmpty())
+		{
+			clip.sSource = clip.sName;
+			clip.sName = QFileInfo(clip.sSource).baseName();
+		}
+		if (rangePattern.indexIn(clip.sSource) != -1)
+		{
+			clip.nStartFrame = rangePattern.cap(1).toInt();
+			clip.nEndFrame = rangePattern.cap(2).toInt();
+		}
+		else if (QFileInfo(clip.sSource).exists())
+		{
+			DzTime nStartTime = nNextFrame * nTimeStep;
+			// start from the default pose so that clips do not inherit each other's last pose
+			foreach(DzFloatProperty* pProperty, aProperties)
+			{
+				pProperty->setValue(nStartTime, pProperty->getDefaultValue());
+			}
+			dzScene->setAnimRange(DzTimeRange(0, nStartTime));
+			dzScene->setPlayRange(DzTimeRange(0, nStartTime));
+			dzScene->setTime(nStartTime);
+			if (dzApp->getContentMgr()->openFile(clip.sSource, true) == false)
+			{
+				m_sAnimationClipError = tr("Unable to load animation clip: %1").arg(clip.sSource);
+				dzApp->log("ERROR: DazToGodot: unable to load animation clip: " + clip.sSource);
+				restoreAnimationClipTimeline();
+				return false;
+			}
+			// pose presets add keys to the properties, aniBlocks are placed on the aniMate
+			// lane without keys, and aniMate extends the scene ranges to the end of the block
+			DzTime nEndTime = qMax(dzScene->getAnimRange().getEnd(), dzScene->getPlayRange().getEnd());
+			foreach(DzFloatProperty* pProperty, aProperties)
+			{
+				for (int i = 0; i < pProperty->getNumKeys(); i++)
+				{
+					nEndTime = qMax(nEndTime, pProperty->getKeyTime(i));
+				}
+			}
+			if (nEndTime <= nStartTime)
+			{
+				m_sAnimationClipError = tr("Animation clip has no frames: %1").arg(clip.sSource);
+				dzApp->log("ERROR: DazToGodot: animation clip has no frames: " + clip.sSource);
+				restoreAnimationClipTimeline();
+				return false;
+			}
+			clip.nStartFrame = nNextFrame;
+			clip.nEndFrame = nEndTime / nTimeStep;
+			nNextFrame = clip.nEndFrame + 1;
+		}
+		else
+		{
+			m_sAnimationClipError = tr("Invalid animation clip, expected a frame range or file: %1").arg(sClip);
+			dzApp->log("ERROR: DazToGodot: invalid animation clip, expected a frame range or file: " + sClip);
+			restoreAnimationClipTimeline();
+			return false;
+		}
+		nLastFrame = qMax(nLastFrame, clip.nEndFrame);
+		m_aResolvedAnimationClips.append(clip);
+		dzApp->log(QString("DazToGodot: animation clip %1: frames %2-%3").arg(clip.sName).arg(clip.nStartFrame).arg(clip.nEndFrame));
+	}
+	dzScene->setAnimRange(DzTimeRange(0, nLastFrame * nTimeStep));
+	dzScene->setPlayRange(DzTimeRange(0, nLastFrame * nTimeStep));
+	dzScene->setTime(0);
+
+	return true;
+}
+
+void DzGodotAction::restoreAnimationClipTimeline()
+{
+	if (m_bAnimationClipTimelineBuilt == false)
+	{
+		return;
+	}
+	// undo the loaded clips and default pose keys
+	dzUndoStack->cancelHold();
+	dzScene->setAnimRange(m_oSavedAnimRange);
+	dzScene->setPlayRange(m_oSavedPlayRange);
+	dzScene->setTime(m_nSavedTime);
+	m_bAnimationClipTimelineBuilt = false;
+}
+
+// Converts the textures of the exported node, or of every root node for a scene export, into the
+// Textures subfolder before the export.  The session cache only skips work which was done
+// by an earlier export, the conversion itself does not depend on it.
+bool DzGodotAction::convertTextures()
+{
+	m_aTextureRemap.clear();
+	if (m_bTextureStage == false || m_sAssetType == "Godot_Animation")
+	{
+		return true;
+	}
+	QList<DzNode*> aNodes;
+	if (m_sAssetType == "Godot_Scene")
+	{
+		foreach(DzNode* pNode, buildRootNodeList()) aNodes.append(pNode);
+	}
+	else
+	{
+		DzNode* pNode = dzScene->getPrimarySelection();
+		DzBone* pBone = qobject_cast<DzBone*>(pNode);
+		if (pBone)
+		{
+			pNode = pBone->getSkeleton();
+		}
+		if (pNode == nullptr)
+		{
+			return false;
+		}
+		aNodes.append(pNode);
+	}
+
+	if (m_bTextureCache)
+	{
+		DzGodotTextureStage::setCacheSize(m_nTextureCacheSize);
+	}
+	else
+	{
+		DzGodotTextureStage::setCacheSize(0);
+		DzGodotTextureStage::clearCache();
+	}
+	DzGodotTextureStage textureStage;
+	textureStage.setOutputFolder(m_sDestinationPath + "Textures");
+	textureStage.setTargetTextureSize(m_bResizeTextures ? m_qTargetTextureSize : QSize(65536, 65536));
+	textureStage.setMemoryBudget(m_nTextureMemoryBudget);
+	textureStage.setRecompressLargeFiles(m_bRecompressIfFileSizeTooBig);
+	textureStage.setRecompressThreshold(m_nFileSizeThresholdToInitiateRecompression);
+	QList<int> aVariantSizes;
+	if (m_sTextureResolution == "2k" || m_bPublishTextureVariants) aVariantSizes.append(2048);
+	if (m_sTextureResolution == "1k" || m_bPublishTextureVariants) aVariantSizes.append(1024);
+	textureStage.setVariantSizes(aVariantSizes);
+	m_aTextureRemap = textureStage.processNodes(aNodes);
+	if (textureStage.getNumFailed() > 0)
+	{
+		dzApp->log(QString("ERROR: DazToGodot: %1 textures could not be converted").arg(textureStage.getNumFailed()));
+		return false;
+	}
+
+	return true;
+}
+
+// The bridge library would convert the textures a second time and write the converted paths
+// into the DTU, where Blender could no longer find the source paths of the texture remap
+void DzGodotAction::suspendBridgeTextureConversion()
+{
+	if (m_bTextureStage == false || m_aSuspendedTextureFlags.isEmpty() == false)
+	{
+		return;
+	}
+	// combining diffuse and cutout maps is left to the bridge library, the stage does not do it
+	m_aSuspendedTextureFlags << m_bConvertToPng << m_bConvertToJpg << m_bExportAllTextures << m_bResizeTextures << m_bRecompressIfFileSizeTooBig;
+	m_bConvertToPng = false;
+	m_bConvertToJpg = false;
+	m_bExportAllTextures = false;
+	m_bResizeTextures = false;
+	m_bRecompressIfFileSizeTooBig = false;
+}
+
+void DzGodotAction::restoreBridgeTextureConversion()
+{
+	if (m_aSuspendedTextureFlags.isEmpty())
+	{
+		return;
+	}
+	m_bConvertToPng = m_aSuspendedTextureFlags[0];
+	m_bConvertToJpg = m_aSuspendedTextureFlags[1];
+	m_bExportAllTextures = m_aSuspendedTextureFlags[2];
+	m_bResizeTextures = m_aSuspendedTextureFlags[3];
+	m_bRecompressIfFileSizeTooBig = m_aSuspendedTextureFlags[4];
+	m_aSuspendedTextureFlags.clear();
+}
+
 bool DzGodotAction::isAssetMorphCompatible(QString sAssetType)
 {
+	if (sAssetType == "Godot_Animation" || sAssetType == "Godot_Material_Update")
+	{
+		return false;
+	}
 	return true;
 }
 
 bool DzGodotAction::isAssetMeshCompatible(QString sAssetType)
 {
+	if (sAssetType == "Godot_Animation" || sAssetType == "Godot_Material_Update")
+	{
+		return false;
+	}
 	return true;
 }
 
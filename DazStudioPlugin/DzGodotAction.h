@@ -8,6 +8,16 @@
 #include "DzGodotDialog.h"
 
 class UnitTest_DzGodotAction;
+class DzGodotLiveLink;
+
+// One named clip of a multi-clip animation export, as frames of the Daz timeline
+struct DzGodotAnimationClip
+{
+	QString sName;
+	QString sSource;
+	int nStartFrame;
+	int nEndFrame;
+};
 
 #include "dzbridge.h"
 
@@ -20,6 +30,44 @@ class DzGodotAction : public DZ_BRIDGE_NAMESPACE::DzBridgeAction {
 	Q_OBJECT
 	Q_PROPERTY(QString sGodotProjectFolderPath READ getGodotProjectFolderPath WRITE setGodotProjectFolderPath)
 	Q_PROPERTY(QString sBlenderExecutablePath READ getBlenderExecutablePath WRITE setBlenderExecutablePath)
+	Q_PROPERTY(bool bSparseMorphEncoding READ getSparseMorphEncoding WRITE setSparseMorphEncoding)
+	Q_PROPERTY(bool bQuantizeMorphDeltas READ getQuantizeMorphDeltas WRITE setQuantizeMorphDeltas)
+	Q_PROPERTY(double fMorphPruneThreshold READ getMorphPruneThreshold WRITE setMorphPruneThreshold)
+	Q_PROPERTY(bool bQuantizeVertexAttributes READ getQuantizeVertexAttributes WRITE setQuantizeVertexAttributes)
+	Q_PROPERTY(bool bPruneMeshSurfaces READ getPruneMeshSurfaces WRITE setPruneMeshSurfaces)
+	Q_PROPERTY(bool bDeduplicateMeshes READ getDeduplicateMeshes WRITE setDeduplicateMeshes)
+	Q_PROPERTY(bool bMeshoptCompression READ getMeshoptCompression WRITE setMeshoptCompression)
+	Q_PROPERTY(bool bKtx2Textures READ getKtx2Textures WRITE setKtx2Textures)
+	Q_PROPERTY(bool bPackOrmTextures READ getPackOrmTextures WRITE setPackOrmTextures)
+	Q_PROPERTY(QString sToktxExecutablePath READ getToktxExecutablePath WRITE setToktxExecutablePath)
+	Q_PROPERTY(bool bAtlasTextures READ getAtlasTextures WRITE setAtlasTextures)
+	Q_PROPERTY(int nAtlasSize READ getAtlasSize WRITE setAtlasSize)
+	Q_PROPERTY(int nAtlasPadding READ getAtlasPadding WRITE setAtlasPadding)
+	Q_PROPERTY(bool bReduceAnimationKeys READ getReduceAnimationKeys WRITE setReduceAnimationKeys)
+	Q_PROPERTY(bool bQuantizeAnimationRotations READ getQuantizeAnimationRotations WRITE setQuantizeAnimationRotations)
+	Q_PROPERTY(double fAnimationRotationTolerance READ getAnimationRotationTolerance WRITE setAnimationRotationTolerance)
+	Q_PROPERTY(double fAnimationTranslationTolerance READ getAnimationTranslationTolerance WRITE setAnimationTranslationTolerance)
+	Q_PROPERTY(double fAnimationScaleTolerance READ getAnimationScaleTolerance WRITE setAnimationScaleTolerance)
+	Q_PROPERTY(QStringList aAnimationClips READ getAnimationClips WRITE setAnimationClips)
+	Q_PROPERTY(bool bTextureStage READ getTextureStage WRITE setTextureStage)
+	Q_PROPERTY(bool bTextureCache READ getTextureCache WRITE setTextureCache)
+	Q_PROPERTY(int nTextureCacheSize READ getTextureCacheSize WRITE setTextureCacheSize)
+	Q_PROPERTY(int nTextureMemoryBudget READ getTextureMemoryBudget WRITE setTextureMemoryBudget)
+	Q_PROPERTY(QString sTextureResolution READ getTextureResolution WRITE setTextureResolution)
+	Q_PROPERTY(bool bPublishTextureVariants READ getPublishTextureVariants WRITE setPublishTextureVariants)
+	Q_PROPERTY(QString sExportProfile READ getExportProfile WRITE setExportProfile)
+	Q_PROPERTY(int nGenerateLods READ getGenerateLods WRITE setGenerateLods)
+	Q_PROPERTY(int nMorphBudget READ getMorphBudget WRITE setMorphBudget)
+	Q_PROPERTY(int nMaxBoneInfluences READ getMaxBoneInfluences WRITE setMaxBoneInfluences)
+	Q_PROPERTY(double fSkinWeightThreshold READ getSkinWeightThreshold WRITE setSkinWeightThreshold)
+	Q_PROPERTY(bool bRemoveUnusedBones READ getRemoveUnusedBones WRITE setRemoveUnusedBones)
+	Q_PROPERTY(int nSceneCellSize READ getSceneCellSize WRITE setSceneCellSize)
+	Q_PROPERTY(bool bLiveLink READ getLiveLink WRITE setLiveLink)
+	Q_PROPERTY(int nLiveLinkPort READ getLiveLinkPort WRITE setLiveLinkPort)
+	Q_PROPERTY(int nLiveLinkMaxFrameRate READ getLiveLinkMaxFrameRate WRITE setLiveLinkMaxFrameRate)
+	Q_PROPERTY(int nBudgetMaxTriangles READ getBudgetMaxTriangles WRITE setBudgetMaxTriangles)
+	Q_PROPERTY(int nBudgetMaxTextureMemory READ getBudgetMaxTextureMemory WRITE setBudgetMaxTextureMemory)
+	Q_PROPERTY(int nBudgetMaxDrawCalls READ getBudgetMaxDrawCalls WRITE setBudgetMaxDrawCalls)
 public:
 	DzGodotAction();
 
@@ -30,6 +78,85 @@ public:
 	Q_INVOKABLE QString getBlenderExecutablePath() { return this->m_sBlenderExecutablePath; };
 	Q_INVOKABLE void setBlenderExecutablePath(QString arg_Filename) { this->m_sBlenderExecutablePath = arg_Filename; };
 
+	Q_INVOKABLE bool getSparseMorphEncoding() { return this->m_bSparseMorphEncoding; };
+	Q_INVOKABLE void setSparseMorphEncoding(bool arg_bEnable) { this->m_bSparseMorphEncoding = arg_bEnable; };
+	Q_INVOKABLE bool getQuantizeMorphDeltas() { return this->m_bQuantizeMorphDeltas; };
+	Q_INVOKABLE void setQuantizeMorphDeltas(bool arg_bEnable) { this->m_bQuantizeMorphDeltas = arg_bEnable; };
+	Q_INVOKABLE double getMorphPruneThreshold() { return this->m_fMorphPruneThreshold; };
+	Q_INVOKABLE void setMorphPruneThreshold(double arg_fThreshold) { this->m_fMorphPruneThreshold = arg_fThreshold; };
+	Q_INVOKABLE bool getQuantizeVertexAttributes() { return this->m_bQuantizeVertexAttributes; };
+	Q_INVOKABLE void setQuantizeVertexAttributes(bool arg_bEnable) { this->m_bQuantizeVertexAttributes = arg_bEnable; };
+	Q_INVOKABLE bool getPruneMeshSurfaces() { return this->m_bPruneMeshSurfaces; };
+	Q_INVOKABLE void setPruneMeshSurfaces(bool arg_bEnable) { this->m_bPruneMeshSurfaces = arg_bEnable; };
+	Q_INVOKABLE bool getDeduplicateMeshes() { return this->m_bDeduplicateMeshes; };
+	Q_INVOKABLE void setDeduplicateMeshes(bool arg_bEnable) { this->m_bDeduplicateMeshes = arg_bEnable; };
+	Q_INVOKABLE bool getMeshoptCompression() { return this->m_bMeshoptCompression; };
+	Q_INVOKABLE void setMeshoptCompression(bool arg_bEnable) { this->m_bMeshoptCompression = arg_bEnable; };
+	Q_INVOKABLE bool getKtx2Textures() { return this->m_bKtx2Textures; };
+	Q_INVOKABLE void setKtx2Textures(bool arg_bEnable) { this->m_bKtx2Textures = arg_bEnable; };
+	Q_INVOKABLE bool getPackOrmTextures() { return this->m_bPackOrmTextures; };
+	Q_INVOKABLE void setPackOrmTextures(bool arg_bEnable) { this->m_bPackOrmTextures = arg_bEnable; };
+	Q_INVOKABLE QString getToktxExecutablePath() { return this->m_sToktxExecutablePath; };
+	Q_INVOKABLE void setToktxExecutablePath(QString arg_Filename) { this->m_sToktxExecutablePath = arg_Filename; };
+	Q_INVOKABLE bool getAtlasTextures() { return this->m_bAtlasTextures; };
+	Q_INVOKABLE void setAtlasTextures(bool arg_bEnable) { this->m_bAtlasTextures = arg_bEnable; };
+	Q_INVOKABLE int getAtlasSize() { return this->m_nAtlasSize; };
+	Q_INVOKABLE void setAtlasSize(int arg_nSize) { this->m_nAtlasSize = arg_nSize; };
+	Q_INVOKABLE int getAtlasPadding() { return this->m_nAtlasPadding; };
+	Q_INVOKABLE void setAtlasPadding(int arg_nPadding) { this->m_nAtlasPadding = arg_nPadding; };
+	Q_INVOKABLE bool getReduceAnimationKeys() { return this->m_bReduceAnimationKeys; };
+	Q_INVOKABLE void setReduceAnimationKeys(bool arg_bEnable) { this->m_bReduceAnimationKeys = arg_bEnable; };
+	Q_INVOKABLE bool getQuantizeAnimationRotations() { return this->m_bQuantizeAnimationRotations; };
+	Q_INVOKABLE void setQuantizeAnimationRotations(bool arg_bEnable) { this->m_bQuantizeAnimationRotations = arg_bEnable; };
+	Q_INVOKABLE double getAnimationRotationTolerance() { return this->m_fAnimationRotationTolerance; };
+	Q_INVOKABLE void setAnimationRotationTolerance(double arg_fDegrees) { this->m_fAnimationRotationTolerance = arg_fDegrees; };
+	Q_INVOKABLE double getAnimationTranslationTolerance() { return this->m_fAnimationTranslationTolerance; };
+	Q_INVOKABLE void setAnimationTranslationTolerance(double arg_fMeters) { this->m_fAnimationTranslationTolerance = arg_fMeters; };
+	Q_INVOKABLE double getAnimationScaleTolerance() { return this->m_fAnimationScaleTolerance; };
+	Q_INVOKABLE void setAnimationScaleTolerance(double arg_fRatio) { this->m_fAnimationScaleTolerance = arg_fRatio; };
+	Q_INVOKABLE QStringList getAnimationClips() { return this->m_aAnimationClips; };
+	Q_INVOKABLE void setAnimationClips(QStringList arg_aClips) { this->m_aAnimationClips = arg_aClips; };
+	Q_INVOKABLE bool getTextureStage() { return this->m_bTextureStage; };
+	Q_INVOKABLE void setTextureStage(bool arg_bEnable) { this->m_bTextureStage = arg_bEnable; };
+	Q_INVOKABLE bool getTextureCache() { return this->m_bTextureCache; };
+	Q_INVOKABLE void setTextureCache(bool arg_bEnable) { this->m_bTextureCache = arg_bEnable; };
+	Q_INVOKABLE int getTextureCacheSize() { return this->m_nTextureCacheSize; };
+	Q_INVOKABLE void setTextureCacheSize(int arg_nMegabytes) { this->m_nTextureCacheSize = arg_nMegabytes; };
+	Q_INVOKABLE int getTextureMemoryBudget() { return this->m_nTextureMemoryBudget; };
+	Q_INVOKABLE void setTextureMemoryBudget(int arg_nMegabytes) { this->m_nTextureMemoryBudget = arg_nMegabytes; };
+	Q_INVOKABLE QString getTextureResolution() { return this->m_sTextureResolution; };
+	Q_INVOKABLE void setTextureResolution(QString arg_sResolution) { this->m_sTextureResolution = arg_sResolution; };
+	Q_INVOKABLE bool getPublishTextureVariants() { return this->m_bPublishTextureVariants; };
+	Q_INVOKABLE void setPublishTextureVariants(bool arg_bEnable) { this->m_bPublishTextureVariants = arg_bEnable; };
+	Q_INVOKABLE QString getExportProfile() { return this->m_sExportProfile; };
+	Q_INVOKABLE void setExportProfile(QString arg_sProfileName) { this->m_sExportProfile = arg_sProfileName; };
+	Q_INVOKABLE int getGenerateLods() { return this->m_nGenerateLods; };
+	Q_INVOKABLE void setGenerateLods(int arg_nGenerateLods) { this->m_nGenerateLods = arg_nGenerateLods; };
+	Q_INVOKABLE int getMorphBudget() { return this->m_nMorphBudget; };
+	Q_INVOKABLE void setMorphBudget(int arg_nCount) { this->m_nMorphBudget = arg_nCount; };
+	Q_INVOKABLE int getMaxBoneInfluences() { return this->m_nMaxBoneInfluences; };
+	Q_INVOKABLE void setMaxBoneInfluences(int arg_nCount) { this->m_nMaxBoneInfluences = arg_nCount; };
+	Q_INVOKABLE double getSkinWeightThreshold() { return this->m_fSkinWeightThreshold; };
+	Q_INVOKABLE void setSkinWeightThreshold(double arg_fThreshold) { this->m_fSkinWeightThreshold = arg_fThreshold; };
+	Q_INVOKABLE bool getRemoveUnusedBones() { return this->m_bRemoveUnusedBones; };
+	Q_INVOKABLE void setRemoveUnusedBones(bool arg_bEnable) { this->m_bRemoveUnusedBones = arg_bEnable; };
+	Q_INVOKABLE int getSceneCellSize() { return this->m_nSceneCellSize; };
+	Q_INVOKABLE void setSceneCellSize(int arg_nMeters) { this->m_nSceneCellSize = arg_nMeters; };
+	Q_INVOKABLE bool getLiveLink() { return this->m_bLiveLink; };
+	Q_INVOKABLE void setLiveLink(bool arg_bEnable) { this->m_bLiveLink = arg_bEnable; };
+	Q_INVOKABLE int getLiveLinkPort() { return this->m_nLiveLinkPort; };
+	Q_INVOKABLE void setLiveLinkPort(int arg_nPort) { this->m_nLiveLinkPort = arg_nPort; };
+	Q_INVOKABLE int getLiveLinkMaxFrameRate() { return this->m_nLiveLinkMaxFrameRate; };
+	Q_INVOKABLE void setLiveLinkMaxFrameRate(int arg_nFramesPerSecond) { this->m_nLiveLinkMaxFrameRate = arg_nFramesPerSecond; };
+	Q_INVOKABLE bool startLiveLink(DzNode* pNode);
+	Q_INVOKABLE void stopLiveLink();
+	Q_INVOKABLE int getBudgetMaxTriangles() { return this->m_nBudgetMaxTriangles; };
+	Q_INVOKABLE void setBudgetMaxTriangles(int arg_nCount) { this->m_nBudgetMaxTriangles = arg_nCount; };
+	Q_INVOKABLE int getBudgetMaxTextureMemory() { return this->m_nBudgetMaxTextureMemory; };
+	Q_INVOKABLE void setBudgetMaxTextureMemory(int arg_nMegabytes) { this->m_nBudgetMaxTextureMemory = arg_nMegabytes; };
+	Q_INVOKABLE int getBudgetMaxDrawCalls() { return this->m_nBudgetMaxDrawCalls; };
+	Q_INVOKABLE void setBudgetMaxDrawCalls(int arg_nCount) { this->m_nBudgetMaxDrawCalls = arg_nCount; };
+
 	Q_INVOKABLE bool executeBlenderScripts(QString sFilePath, QString sCommandlineArguments);
 
 protected:
@@ -41,11 +168,86 @@ protected:
 	Q_INVOKABLE void setExportOptions(DzFileIOSettings& ExportOptions);
 	virtual QString readGuiRootFolder() override;
 	Q_INVOKABLE virtual bool readGui(DZ_BRIDGE_NAMESPACE::DzBridgeDialog*) override;
+	Q_INVOKABLE QString calculateSkeletonHash(DzNode* pNode);
+	Q_INVOKABLE bool buildAnimationClipTimeline();
+	Q_INVOKABLE void restoreAnimationClipTimeline();
+	Q_INVOKABLE bool convertTextures();
+	Q_INVOKABLE void suspendBridgeTextureConversion();
+	Q_INVOKABLE void restoreBridgeTextureConversion();
+	Q_INVOKABLE void applyExportProfile(QVariantMap aProfile);
+	Q_INVOKABLE QStringList checkExportBudgets();
+	Q_INVOKABLE bool exportMaterialUpdate();
 
 	QString m_sGodotProjectFolderPath = "";
 	QString m_sBlenderExecutablePath = "";
 	int m_nBlenderExitCode = 0;
 
+	// Morph encoding options, passed to blender scripts via DTU
+	bool m_bSparseMorphEncoding = true; // drop zero deltas and write morph targets as glTF sparse accessors
+	bool m_bQuantizeMorphDeltas = false; // quantize morph deltas to 16-bit normalized integers
+	double m_fMorphPruneThreshold = 0.0; // remove morphs whose largest delta is below this (meters), 0 = disabled
+	bool m_bQuantizeVertexAttributes = false; // KHR_mesh_quantization for positions, normals, tangents, UVs and weights
+	bool m_bPruneMeshSurfaces = true; // remove invisible surfaces, merge identical ones and drop unused vertices and UV sets
+	bool m_bDeduplicateMeshes = true; // share one mesh between copies of the same prop
+	bool m_bMeshoptCompression = false; // also write an EXT_meshopt_compression copy of GLB files (.glb.meshopt)
+	bool m_bKtx2Textures = false; // transcode GLB/GLTF textures to KTX2 (KHR_texture_basisu), requires Godot 4.3+
+	QString m_sToktxExecutablePath = ""; // KTX-Software toktx, searched in PATH if empty
+	bool m_bPackOrmTextures = true; // pack occlusion/roughness/metallic into ORM and cutout into base color alpha
+	bool m_bAtlasTextures = false; // merge compatible materials per mesh into texture atlases
+	int m_nAtlasSize = 4096; // maximum atlas width/height in pixels
+	int m_nAtlasPadding = 8; // edge-replicated border around each atlas cell in pixels
+	bool m_bReduceAnimationKeys = true; // fit baked animation curves and collapse constant tracks
+	bool m_bQuantizeAnimationRotations = false; // store animation rotations as 16-bit normalized integers
+	double m_fAnimationRotationTolerance = 0.05; // maximum curve fitting error (degrees)
+	double m_fAnimationTranslationTolerance = 0.0001; // maximum curve fitting error (meters)
+	double m_fAnimationScaleTolerance = 0.001; // maximum curve fitting error (scale ratio)
+
+	// Multi-clip animation export: "Name=start-end" timeline frame ranges or "Name=<file>.duf"
+	// aniBlocks and pose presets, which are appended to the timeline for the duration of the export
+	QStringList m_aAnimationClips;
+	QList<DzGodotAnimationClip> m_aResolvedAnimationClips;
+	DzTimeRange m_oSavedAnimRange;
+	DzTimeRange m_oSavedPlayRange;
+	DzTime m_nSavedTime = 0;
+	bool m_bAnimationClipTimelineBuilt = false;
+	QString m_sAnimationClipError = ""; // reason buildAnimationClipTimeline() failed
+
+	// Texture conversion by DzGodotTextureStage instead of the bridge library.  The conversion
+	// flags of the bridge library keep their values and configure the stage, they are only
+	// suspended while the stage's results are exported.
+	bool m_bTextureStage = true;
+	QMap<QString, QString> m_aTextureRemap; // source path -> converted path, written to the DTU
+	QList<bool> m_aSuspendedTextureFlags;
+	// decoded and converted textures are kept for later exports in the same Daz Studio session
+	bool m_bTextureCache = true;
+	int m_nTextureCacheSize = 1024; // megabytes
+	int m_nTextureMemoryBudget = 1024; // megabytes of decoded images in flight while converting
+	QString m_sTextureResolution = "full"; // "full", "2k" or "1k" textures used by the exported asset
+	bool m_bPublishTextureVariants = false; // also copy all 2k/1k variants to the Godot project
+
+	// Export profile for the target platform, see DzGodotDialog::writeDefaultExportProfiles().
+	// Budgets are checked by the blender scripts, 0 = no budget
+	QString m_sExportProfile = ""; // empty = custom settings from the dialog
+	int m_nGenerateLods = -1; // 1 enables Godot's LOD generation on import, 0 disables it, -1 = unchanged
+	int m_nMorphBudget = 0; // maximum number of morph targets
+	int m_nBudgetMaxTriangles = 0;
+	int m_nBudgetMaxTextureMemory = 0; // megabytes, estimated from the image dimensions
+	int m_nBudgetMaxDrawCalls = 0; // one per mesh primitive
+
+	// Skinning optimization of GLB/GLTF files, also set by the export profile
+	int m_nMaxBoneInfluences = 0; // maximum skin weights per vertex, 0 = unlimited
+	double m_fSkinWeightThreshold = 0.0; // skin weights below this fraction of the vertex total are removed
+	bool m_bRemoveUnusedBones = false; // remove bones without weights or animation from the skin
+
+	// Godot_Scene exports the whole scene as a .tscn of per-object GLTF files in streamable grid cells
+	int m_nSceneCellSize = 32; // meters, 0 = all objects in the main scene
+
+	// Live link to the Godot editor add-on, started after a successful export, see DzGodotLiveLink
+	bool m_bLiveLink = false;
+	int m_nLiveLinkPort = 9007;
+	int m_nLiveLinkMaxFrameRate = 30; // frames per second, changes in between are coalesced
+	DzGodotLiveLink* m_pLiveLink = nullptr;
+
 	Q_INVOKABLE virtual bool isAssetMorphCompatible(QString sAssetType) override;
 	Q_INVOKABLE virtual bool isAssetMeshCompatible(QString sAsseType) override;
 	Q_INVOKABLE virtual bool isAssetAnimationCompatible(QString sAssetType) override;
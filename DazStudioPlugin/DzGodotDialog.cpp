@@ -15,6 +15,7 @@
 #include <QtGui/qcheckbox.h>
 #include <QtGui/qlistwidget.h>
 #include <QtGui/qgroupbox.h>
+#include <QtGui/qspinbox.h>
 
 #include "dzapp.h"
 #include "dzscene.h"
@@ -87,6 +88,9 @@ DzGodotDialog::DzGodotDialog(QWidget* parent) :
 	 assetTypeCombo->addItem("Godot .GLTF + extracted textures", "Godot_Gltf");
 	 assetTypeCombo->addItem("Godot .GLB (embedded textures)", "Godot_Glb");
 	 assetTypeCombo->addItem("Godot .BLEND (Godot 4.x) *Work-In-Progress*", "Godot_Blend");
+	 assetTypeCombo->addItem("Godot Animation Library (animation only)", "Godot_Animation");
+	 assetTypeCombo->addItem("Godot Scene (.tscn, whole scene in streamable cells)", "Godot_Scene");
+	 assetTypeCombo->addItem("Godot Material Update (materials of the published asset only)", "Godot_Material_Update");
 	 // Add Project Folder
 	 QHBoxLayout* godotProjectFolderLayout = new QHBoxLayout();
 	 m_wGodotProjectFolderEdit = new QLineEdit(this);
@@ -117,11 +121,199 @@ DzGodotDialog::DzGodotDialog(QWidget* parent) :
 	 intermediateFolderLayout->addWidget(intermediateFolderButton);
 	 connect(intermediateFolderButton, SIGNAL(released()), this, SLOT(HandleSelectIntermediateFolderButton()));
 
+	 // Morph Compression
+	 m_wQuantizeMorphsCheckBox = new QCheckBox("", this);
+	 m_wQuantizeMorphsCheckBox->setToolTip(tr("Quantize morph deltas to 16-bit integers to reduce file size."));
+
+	 // Vertex Quantization
+	 m_wQuantizeVerticesCheckBox = new QCheckBox("", this);
+	 m_wQuantizeVerticesCheckBox->setToolTip(tr("Store vertex data as 8/16-bit integers (KHR_mesh_quantization) for GLB and GLTF files."));
+
+	 // Surface Pruning
+	 m_wPruneMeshSurfacesCheckBox = new QCheckBox("", this);
+	 m_wPruneMeshSurfacesCheckBox->setToolTip(tr("Remove invisible surfaces and merge surfaces with identical materials in GLB and GLTF files."));
+
+	 // Mesh Deduplication
+	 m_wDeduplicateMeshesCheckBox = new QCheckBox("", this);
+	 m_wDeduplicateMeshesCheckBox->setToolTip(tr("Store repeated props with identical geometry once and reference them from each instance."));
+
+	 // Meshopt Compression
+	 m_wMeshoptCompressionCheckBox = new QCheckBox("", this);
+	 m_wMeshoptCompressionCheckBox->setToolTip(tr("Also save a meshopt compressed copy (.glb.meshopt) of GLB files for version control."));
+
+	 // Texture Packing
+	 m_wPackOrmTexturesCheckBox = new QCheckBox("", this);
+	 m_wPackOrmTexturesCheckBox->setChecked(true);
+	 m_wPackOrmTexturesCheckBox->setToolTip(tr("Pack occlusion, roughness and metallic maps into one ORM texture per material."));
+
+	 // KTX2 Textures
+	 QHBoxLayout* ktx2TexturesLayout = new QHBoxLayout();
+	 m_wKtx2TexturesCheckBox = new QCheckBox("", this);
+	 m_wKtx2TexturesCheckBox->setToolTip(tr("Transcode GLB and GLTF textures to KTX2 with mipmaps so Godot does not need to VRAM compress them on import.  Requires Godot 4.3+."));
+	 m_wToktxExecutablePathEdit = new QLineEdit(this);
+	 m_wToktxExecutablePathEdit->setPlaceholderText(tr("toktx (KTX-Software) from PATH"));
+	 m_wToktxExecutablePathButton = new QPushButton("...", this);
+	 ktx2TexturesLayout->addWidget(m_wKtx2TexturesCheckBox);
+	 ktx2TexturesLayout->addWidget(m_wToktxExecutablePathEdit);
+	 ktx2TexturesLayout->addWidget(m_wToktxExecutablePathButton);
+	 connect(m_wToktxExecutablePathButton, SIGNAL(released()), this, SLOT(HandleSelectToktxExecutablePathButton()));
+
+	 // Texture Atlas
+	 QHBoxLayout* atlasTexturesLayout = new QHBoxLayout();
+	 m_wAtlasTexturesCheckBox = new QCheckBox("", this);
+	 m_wAtlasTexturesCheckBox->setToolTip(tr("Merge compatible materials of each mesh into texture atlases to reduce draw calls."));
+	 m_wAtlasSizeCombo = new QComboBox(this);
+	 m_wAtlasSizeCombo->addItem("1024 x 1024", 1024);
+	 m_wAtlasSizeCombo->addItem("2048 x 2048", 2048);
+	 m_wAtlasSizeCombo->addItem("4096 x 4096", 4096);
+	 m_wAtlasSizeCombo->addItem("8192 x 8192", 8192);
+	 m_wAtlasSizeCombo->setToolTip(tr("Maximum atlas texture size."));
+	 m_wAtlasPaddingSpinBox = new QSpinBox(this);
+	 m_wAtlasPaddingSpinBox->setRange(0, 64);
+	 m_wAtlasPaddingSpinBox->setSuffix(" px");
+	 m_wAtlasPaddingSpinBox->setToolTip(tr("Padding around each atlas cell to prevent texture bleeding between materials."));
+	 atlasTexturesLayout->addWidget(m_wAtlasTexturesCheckBox);
+	 atlasTexturesLayout->addWidget(m_wAtlasSizeCombo);
+	 atlasTexturesLayout->addWidget(m_wAtlasPaddingSpinBox);
+
+	 // Animation Compression
+	 QHBoxLayout* reduceAnimationsLayout = new QHBoxLayout();
+	 m_wReduceAnimationsCheckBox = new QCheckBox("", this);
+	 m_wReduceAnimationsCheckBox->setChecked(true);
+	 m_wReduceAnimationsCheckBox->setToolTip(tr("Remove baked animation keys which can be interpolated within a small error, and collapse constant tracks."));
+	 m_wQuantizeAnimationsCheckBox = new QCheckBox(tr("Quantize Rotations"), this);
+	 m_wQuantizeAnimationsCheckBox->setToolTip(tr("Store animation rotations as 16-bit integers."));
+	 reduceAnimationsLayout->addWidget(m_wReduceAnimationsCheckBox);
+	 reduceAnimationsLayout->addWidget(m_wQuantizeAnimationsCheckBox);
+	 reduceAnimationsLayout->addStretch();
+
+	 // Animation Clips
+	 QHBoxLayout* animationClipsLayout = new QHBoxLayout();
+	 m_wAnimationClipsEdit = new QLineEdit(this);
+	 m_wAnimationClipsEdit->setPlaceholderText(tr("Walk=0-30; Run=C:/aniBlocks/Run.duf"));
+	 m_wAnimationClipsEdit->setToolTip(tr("Export several named animation clips in one pass, separated by semicolons."));
+	 m_wAnimationClipsButton = new QPushButton("...", this);
+	 m_wAnimationClipsButton->setToolTip(tr("Add aniBlock or pose preset files as clips."));
+	 animationClipsLayout->addWidget(m_wAnimationClipsEdit);
+	 animationClipsLayout->addWidget(m_wAnimationClipsButton);
+	 connect(m_wAnimationClipsButton, SIGNAL(released()), this, SLOT(HandleAddAnimationClipsButton()));
+
+	 // Texture Conversion
+	 m_wTextureStageCheckBox = new QCheckBox("", this);
+	 m_wTextureStageCheckBox->setChecked(true);
+	 m_wTextureStageCheckBox->setToolTip(tr("Convert, resize and copy textures in parallel with a bounded memory budget."));
+
+	 // Texture Cache
+	 QHBoxLayout* textureCacheLayout = new QHBoxLayout();
+	 m_wTextureCacheCheckBox = new QCheckBox("", this);
+	 m_wTextureCacheCheckBox->setChecked(true);
+	 m_wTextureCacheCheckBox->setToolTip(tr("Keep converted textures in memory so later exports in this session can reuse them."));
+	 m_wTextureCacheSizeSpinBox = new QSpinBox(this);
+	 m_wTextureCacheSizeSpinBox->setRange(0, 16384);
+	 m_wTextureCacheSizeSpinBox->setSingleStep(256);
+	 m_wTextureCacheSizeSpinBox->setSuffix(" MB");
+	 m_wTextureCacheSizeSpinBox->setToolTip(tr("Memory used by the texture cache."));
+	 textureCacheLayout->addWidget(m_wTextureCacheCheckBox);
+	 textureCacheLayout->addWidget(m_wTextureCacheSizeSpinBox);
+	 textureCacheLayout->addStretch();
+
+	 // Texture Memory Budget
+	 m_wTextureMemoryBudgetSpinBox = new QSpinBox(this);
+	 m_wTextureMemoryBudgetSpinBox->setRange(256, 16384);
+	 m_wTextureMemoryBudgetSpinBox->setSingleStep(256);
+	 m_wTextureMemoryBudgetSpinBox->setSuffix(" MB");
+	 m_wTextureMemoryBudgetSpinBox->setToolTip(tr("Maximum memory for textures being converted at the same time."));
+
+	 // Scene Cell Size
+	 m_wSceneCellSizeSpinBox = new QSpinBox(this);
+	 m_wSceneCellSizeSpinBox->setRange(0, 1024);
+	 m_wSceneCellSizeSpinBox->setSingleStep(8);
+	 m_wSceneCellSizeSpinBox->setSuffix(" m");
+	 m_wSceneCellSizeSpinBox->setSpecialValueText(tr("No Cells"));
+	 m_wSceneCellSizeSpinBox->setToolTip(tr("Size of the grid cells which Godot streams in around the camera for Godot Scene exports."));
+
+	 // Live Link
+	 QHBoxLayout* liveLinkLayout = new QHBoxLayout();
+	 m_wLiveLinkCheckBox = new QCheckBox("", this);
+	 m_wLiveLinkCheckBox->setToolTip(tr("After the export, keep sending pose, morph and material changes to the Daz Live Link add-on in the Godot editor."));
+	 m_wLiveLinkPortSpinBox = new QSpinBox(this);
+	 m_wLiveLinkPortSpinBox->setRange(1024, 65535);
+	 m_wLiveLinkPortSpinBox->setPrefix(tr("Port "));
+	 m_wLiveLinkPortSpinBox->setToolTip(tr("Port of the Daz Live Link add-on, set in the Godot project settings."));
+	 liveLinkLayout->addWidget(m_wLiveLinkCheckBox);
+	 liveLinkLayout->addWidget(m_wLiveLinkPortSpinBox);
+	 liveLinkLayout->addStretch();
+
+	 // Texture Resolution
+	 QHBoxLayout* textureResolutionLayout = new QHBoxLayout();
+	 m_wTextureResolutionCombo = new QComboBox(this);
+	 m_wTextureResolutionCombo->addItem("Full (Desktop)", "full");
+	 m_wTextureResolutionCombo->addItem("2K", "2k");
+	 m_wTextureResolutionCombo->addItem("1K (Mobile)", "1k");
+	 m_wTextureResolutionCombo->setToolTip(tr("Texture resolution of the exported asset for the target platform."));
+	 m_wPublishTextureVariantsCheckBox = new QCheckBox(tr("Publish Variants"), this);
+	 m_wPublishTextureVariantsCheckBox->setToolTip(tr("Also copy 2K and 1K versions of all textures to the Godot project."));
+	 textureResolutionLayout->addWidget(m_wTextureResolutionCombo);
+	 textureResolutionLayout->addWidget(m_wPublishTextureVariantsCheckBox);
+	 textureResolutionLayout->addStretch();
+
+	 // Skinning
+	 QHBoxLayout* skinningLayout = new QHBoxLayout();
+	 m_wMaxBoneInfluencesCombo = new QComboBox(this);
+	 m_wMaxBoneInfluencesCombo->addItem(tr("All Influences"), 0);
+	 m_wMaxBoneInfluencesCombo->addItem(tr("8 Influences"), 8);
+	 m_wMaxBoneInfluencesCombo->addItem(tr("4 Influences"), 4);
+	 m_wMaxBoneInfluencesCombo->addItem(tr("2 Influences"), 2);
+	 m_wMaxBoneInfluencesCombo->addItem(tr("1 Influence"), 1);
+	 m_wMaxBoneInfluencesCombo->setToolTip(tr("Maximum number of bones which deform each vertex."));
+	 m_wSkinWeightThresholdCombo = new QComboBox(this);
+	 m_wSkinWeightThresholdCombo->addItem(tr("Keep Small Weights"), 0.0);
+	 m_wSkinWeightThresholdCombo->addItem(tr("Drop < 0.1%"), 0.001);
+	 m_wSkinWeightThresholdCombo->addItem(tr("Drop < 0.5%"), 0.005);
+	 m_wSkinWeightThresholdCombo->addItem(tr("Drop < 1%"), 0.01);
+	 m_wSkinWeightThresholdCombo->addItem(tr("Drop < 2%"), 0.02);
+	 m_wSkinWeightThresholdCombo->setToolTip(tr("Remove skin weights below this fraction of a vertex's total weight."));
+	 m_wRemoveUnusedBonesCheckBox = new QCheckBox(tr("Remove Unused Bones"), this);
+	 m_wRemoveUnusedBonesCheckBox->setToolTip(tr("Remove bones without weights or animation from the exported skeleton."));
+	 skinningLayout->addWidget(m_wMaxBoneInfluencesCombo);
+	 skinningLayout->addWidget(m_wSkinWeightThresholdCombo);
+	 skinningLayout->addWidget(m_wRemoveUnusedBonesCheckBox);
+	 skinningLayout->addStretch();
+
+	 // Export Profile
+	 m_wExportProfileCombo = new QComboBox(this);
+	 m_wExportProfileCombo->addItem(tr("Custom"), "");
+	 writeDefaultExportProfiles();
+	 foreach(QString sProfileName, getExportProfileNames())
+	 {
+		 m_wExportProfileCombo->addItem(sProfileName, sProfileName);
+	 }
+	 m_wExportProfileCombo->setToolTip(tr("Texture, mesh and animation settings and performance budgets for the target platform."));
+	 connect(m_wExportProfileCombo, SIGNAL(activated(int)), this, SLOT(HandleExportProfileComboChange(int)));
+	 mainLayout->addRow("Export Profile", m_wExportProfileCombo);
+
 	 //  Add Intermediate Folder to Advanced Settings container as a new row with specific headers
 	 QFormLayout* advancedLayout = qobject_cast<QFormLayout*>(advancedWidget->layout());
 	 if (advancedLayout)
 	 {
 		 advancedLayout->insertRow(1, "Blender Executable", blenderExecutablePathLayout);
+		 advancedLayout->addRow("Quantize Morphs", m_wQuantizeMorphsCheckBox);
+		 advancedLayout->addRow("Quantize Vertex Data", m_wQuantizeVerticesCheckBox);
+		 advancedLayout->addRow("Prune Mesh Surfaces", m_wPruneMeshSurfacesCheckBox);
+		 advancedLayout->addRow("Deduplicate Meshes", m_wDeduplicateMeshesCheckBox);
+		 advancedLayout->addRow("Meshopt Compression", m_wMeshoptCompressionCheckBox);
+		 advancedLayout->addRow("Pack ORM Textures", m_wPackOrmTexturesCheckBox);
+		 advancedLayout->addRow("KTX2 Textures", ktx2TexturesLayout);
+		 advancedLayout->addRow("Texture Atlas", atlasTexturesLayout);
+		 advancedLayout->addRow("Reduce Animations", reduceAnimationsLayout);
+		 advancedLayout->addRow("Animation Clips", animationClipsLayout);
+		 advancedLayout->addRow("Texture Conversion", m_wTextureStageCheckBox);
+		 advancedLayout->addRow("Texture Cache", textureCacheLayout);
+		 advancedLayout->addRow("Texture Memory", m_wTextureMemoryBudgetSpinBox);
+		 advancedLayout->addRow("Texture Resolution", textureResolutionLayout);
+		 advancedLayout->addRow("Skinning", skinningLayout);
+		 advancedLayout->addRow("Scene Cell Size", m_wSceneCellSizeSpinBox);
+		 advancedLayout->addRow("Live Link", liveLinkLayout);
 
 		 advancedLayout->addRow("Intermediate Folder", intermediateFolderLayout);
 		 // reposition the Open Intermediate Folder button so it aligns with the center section
@@ -151,9 +343,31 @@ DzGodotDialog::DzGodotDialog(QWidget* parent) :
 
 	 // Help
 	 assetNameEdit->setWhatsThis("This is the name the asset will use in Godot.");
-	 assetTypeCombo->setWhatsThis("Skeletal Mesh for something with moving parts, like a character\nStatic Mesh for things like props\nAnimation for a character animation.");
+	 assetTypeCombo->setWhatsThis("Skeletal Mesh for something with moving parts, like a character\nStatic Mesh for things like props\nAnimation for a character animation.\nGodot Scene for a whole environment: every visible root object becomes its own GLTF file, placed by a .tscn scene.\nGodot Material Update to send only the changed materials of a character or prop already sent as .GLB or .GLTF.");
 	 intermediateFolderEdit->setWhatsThis("DazToGodot will collect the assets in a subfolder under this folder.  Godot will import them from here.");
 	 intermediateFolderButton->setWhatsThis("DazToGodot will collect the assets in a subfolder under this folder.  Godot will import them from here.");
+	 m_wQuantizeMorphsCheckBox->setWhatsThis("Morph deltas are always written as sparse accessors containing only the moved vertices.  Enable this to also store the deltas as 16-bit integers, which roughly halves morph data again with sub-millimeter error.");
+	 m_wQuantizeVerticesCheckBox->setWhatsThis("Store positions as 16-bit, normals, tangents and skin weights as 8-bit and UVs as 16-bit integers, roughly halving vertex memory.  The error against the original float data is written to the optimize report in the intermediate folder.");
+	 m_wPruneMeshSurfacesCheckBox->setWhatsThis("Each Daz surface is exported as a separate material slot of its mesh.  Enable this to remove surfaces without triangles or with a fully transparent material, and to merge surfaces whose materials only differ by name into one, which saves a draw call each.  Vertices no triangle uses and UV sets no texture reads are dropped as well.  The removed and merged surfaces are written to the optimize report in the intermediate folder.");
+	 m_wDeduplicateMeshesCheckBox->setWhatsThis("When several copies of a prop such as chairs or trees are exported together, each copy is a separate mesh.  Enable this to store meshes with the same geometry and materials once and let every copy's node reference it, which Godot imports as one shared mesh resource.  Copies are recognized even if their placement was baked into the vertices.  Meshes shared by several static nodes are listed in the optimize report in the intermediate folder as MultiMeshInstance3D candidates.  Only for GLB and GLTF files.");
+	 m_wPackOrmTexturesCheckBox->setWhatsThis("Combine the occlusion, roughness and metallic maps of each material into a single glTF ORM texture (red = occlusion, green = roughness, blue = metallic), and cutout opacity maps into the alpha channel of the base color texture.  This reduces the texture count and samplers per material.  Packed textures are saved to the PackedTextures subfolder of the intermediate folder.");
+	 m_wKtx2TexturesCheckBox->setWhatsThis("Transcode textures to KTX2 (KHR_texture_basisu) with mipmaps using the toktx tool from KTX-Software, one image per CPU core in parallel.  Color maps are encoded as ETC1S (sRGB), normal and ORM maps as UASTC (linear).  The PNG/JPG textures are replaced, so the files require Godot 4.3 or newer.  Not available for the BLEND format.  Timings are written to the KTX2 report in the intermediate folder.");
+	 m_wAtlasTexturesCheckBox->setWhatsThis("Merge materials of the same mesh which only differ in their textures into one material per atlas, remapping the UVs of the merged faces.  Materials with tiled textures, UVs outside of a single tile, refraction or differing shader settings are left unchanged.  Each atlas holds up to 16 materials in a grid that fits the selected size, with the selected padding of repeated edge pixels around each cell.  Atlas textures are saved to the AtlasTextures subfolder of the intermediate folder.");
+	 m_wReduceAnimationsCheckBox->setWhatsThis("Animations are exported with a key on every frame for every bone.  Enable this to remove keys which can be interpolated from their neighbors within 0.05 degrees, 0.1 mm or 0.1% scale, and to reduce constant tracks to a single key.  The tolerances can be changed by script.  Key counts, sizes and the resulting error are written to the optimize report in the intermediate folder.");
+	 m_wQuantizeAnimationsCheckBox->setWhatsThis("Store the remaining animation rotation keys as 16-bit normalized integers instead of floats, halving their size with an error of about 0.003 degrees.");
+	 m_wAnimationClipsEdit->setWhatsThis("Export a library of animation clips for the figure in a single pass, separated by semicolons.  Each clip is either a frame range of the current timeline (\"Walk=0-30\") or an aniBlock or pose preset file (\"Run=C:/aniBlocks/Run.duf\", the name defaults to the file name).  Files are loaded one after another behind the current animation and removed again after the export.  Each clip becomes a separate animation in Godot.  Leave empty to export the timeline as a single animation.");
+	 m_wTextureStageCheckBox->setWhatsThis("Convert, resize and copy the textures of the exported materials before the export, in parallel.  Converted textures are saved to the Textures subfolder of the intermediate folder.  Disable to use the texture conversion of the previous versions.");
+	 m_wTextureCacheCheckBox->setWhatsThis("Keep decoded and converted textures in memory until Daz Studio is closed.  Textures are identified by file path, modification date and conversion settings, so exporting several figures that share skin or eye textures decodes each texture only once.  Least recently used textures are dropped when the cache exceeds the selected size.  Disabling the cache only repeats the work, the converted textures are the same.  Requires Texture Conversion.");
+	 m_wTextureMemoryBudgetSpinBox->setWhatsThis("Textures are converted in parallel, as many at a time as fit into this amount of memory.  JPEG, BMP, TGA and TIFF sources larger than the texture size are downsampled while they are decoded, so 8K and 16K maps in these formats do not need to be held in memory at full resolution.  PNG sources are decoded at full resolution, one at a time if they do not fit.  Lower this value if Daz Studio runs out of memory during export.  Requires Texture Conversion.");
+	 m_wSceneCellSizeSpinBox->setWhatsThis("Godot Scene exports split the scene into square cells of this size on the ground plane.  Each object is saved once as a GLTF file in the Objects subfolder, shared by all of its copies, and each cell is a .tscn file in the Cells subfolder which places the objects of the cell.  The main scene holds one placeholder per cell with the cell's bounds, and its script loads the cells within two cell sizes of the camera in the background and frees them again when the camera moves away, so large environments do not have to be loaded at once.  Select No Cells to place all objects directly in the main scene.");
+	 m_wLiveLinkCheckBox->setWhatsThis("Stream changes of the exported figure or prop to a running Godot editor, for previewing poses, expressions and material colors without exporting again.  Enable the Daz Live Link add-on in the Godot project and open a scene which contains the published asset.  After the export, the bone rotations, morph weights and the color, opacity, metallic, roughness and emission values of the materials are sent to the add-on whenever they change, including during playback, at up to 30 updates per second.  Only the values which changed are sent, and changes made faster than the update rate are combined.  Textures and geometry are not streamed, use Godot Material Update or a full export for them.  The link stays active until the next export without Live Link.");
+	 m_wTextureResolutionCombo->setWhatsThis("Select the texture resolution for the target platform, for example 1K for mobile builds.  2K and 1K versions of the textures are generated in parallel during export (saved with the same names in the 2k and 1k subfolders of the converted textures) and used in place of the full resolution textures.  Textures which are already smaller are used as they are.  Requires Texture Conversion.");
+	 m_wPublishTextureVariantsCheckBox->setWhatsThis("Generate both 2K and 1K versions of all textures and copy them to the TextureVariants subfolder of the asset in the Godot project, so other platform builds can switch to them.  The folder contains a .gdignore file so Godot does not import the variants.");
+	 m_wMaxBoneInfluencesCombo->setWhatsThis("Limit the number of bones which deform each vertex of GLB and GLTF files.  The largest weights are kept and renormalized.  Godot skins up to 4 influences per vertex with one set of weights and needs a second set for up to 8, so 4 influences reduce the vertex data and the cost of GPU skinning, which matters most for crowds of characters.  The weight removed from each vertex is written to the optimization report in the intermediate folder as the skinning error.");
+	 m_wSkinWeightThresholdCombo->setWhatsThis("Remove skin weights below this fraction of the vertex's total weight before limiting the influences.  Daz figures contain many tiny weights which barely move the vertex but still cost a bone influence.");
+	 m_wRemoveUnusedBonesCheckBox->setWhatsThis("Remove bones which have no skin weights left, are not animated and only have such bones below them, ex: face or finger bones of low detail characters.  Bones of other skins and bones with attached props are kept.  Only for GLB and GLTF files.");
+	 m_wExportProfileCombo->setWhatsThis("Select a target platform profile.  Each profile sets the texture resolution, texture compression, LOD generation, morph budget, bone influence limit and animation tolerance, and the exported asset is checked against the profile's triangle, texture memory and draw call budgets.  Exceeded budgets are reported after the export and written to the budget report in the intermediate folder.  Profiles are stored with the plugin settings and can be edited or added there.  Custom uses the settings of this dialog without budgets.");
+	 m_wMeshoptCompressionCheckBox->setWhatsThis("GLB only: save an EXT_meshopt_compression copy next to the .glb file, named .glb.meshopt so that Godot does not import it.  Commit the compressed copy instead of the .glb and restore the .glb with \"python gltf_tools.py decompress <file>.glb.meshopt\".  Works best together with Quantize Vertex Data.  Sizes and timings are written to the meshopt report in the intermediate folder.");
 	 //m_wTargetPluginInstaller->setWhatsThis("You can install the Godot Plugin by selecting the desired Godot version and then clicking Install.");
 
 	 // Set Defaults
@@ -186,6 +400,119 @@ bool DzGodotDialog::loadSavedSettings()
 	{
 		m_wBlenderExecutablePathEdit->setText(settings->value("BlenderExecutablePath").toString());
 	}
+	if (!settings->value("QuantizeMorphs").isNull())
+	{
+		m_wQuantizeMorphsCheckBox->setChecked(settings->value("QuantizeMorphs").toBool());
+	}
+	if (!settings->value("QuantizeVertices").isNull())
+	{
+		m_wQuantizeVerticesCheckBox->setChecked(settings->value("QuantizeVertices").toBool());
+	}
+	if (!settings->value("PruneMeshSurfaces").isNull())
+	{
+		m_wPruneMeshSurfacesCheckBox->setChecked(settings->value("PruneMeshSurfaces").toBool());
+	}
+	if (!settings->value("DeduplicateMeshes").isNull())
+	{
+		m_wDeduplicateMeshesCheckBox->setChecked(settings->value("DeduplicateMeshes").toBool());
+	}
+	if (!settings->value("MeshoptCompression").isNull())
+	{
+		m_wMeshoptCompressionCheckBox->setChecked(settings->value("MeshoptCompression").toBool());
+	}
+	if (!settings->value("PackOrmTextures").isNull())
+	{
+		m_wPackOrmTexturesCheckBox->setChecked(settings->value("PackOrmTextures").toBool());
+	}
+	if (!settings->value("Ktx2Textures").isNull())
+	{
+		m_wKtx2TexturesCheckBox->setChecked(settings->value("Ktx2Textures").toBool());
+	}
+	if (!settings->value("ToktxExecutablePath").isNull())
+	{
+		m_wToktxExecutablePathEdit->setText(settings->value("ToktxExecutablePath").toString());
+	}
+	if (!settings->value("AtlasTextures").isNull())
+	{
+		m_wAtlasTexturesCheckBox->setChecked(settings->value("AtlasTextures").toBool());
+	}
+	if (!settings->value("AtlasSize").isNull())
+	{
+		int nAtlasSizeIndex = m_wAtlasSizeCombo->findData(settings->value("AtlasSize").toInt());
+		if (nAtlasSizeIndex != -1) m_wAtlasSizeCombo->setCurrentIndex(nAtlasSizeIndex);
+	}
+	if (!settings->value("AtlasPadding").isNull())
+	{
+		m_wAtlasPaddingSpinBox->setValue(settings->value("AtlasPadding").toInt());
+	}
+	if (!settings->value("ReduceAnimations").isNull())
+	{
+		m_wReduceAnimationsCheckBox->setChecked(settings->value("ReduceAnimations").toBool());
+	}
+	if (!settings->value("QuantizeAnimations").isNull())
+	{
+		m_wQuantizeAnimationsCheckBox->setChecked(settings->value("QuantizeAnimations").toBool());
+	}
+	if (!settings->value("AnimationClips").isNull())
+	{
+		m_wAnimationClipsEdit->setText(settings->value("AnimationClips").toString());
+	}
+	if (!settings->value("TextureStage").isNull())
+	{
+		m_wTextureStageCheckBox->setChecked(settings->value("TextureStage").toBool());
+	}
+	if (!settings->value("TextureCache").isNull())
+	{
+		m_wTextureCacheCheckBox->setChecked(settings->value("TextureCache").toBool());
+	}
+	if (!settings->value("TextureCacheSize").isNull())
+	{
+		m_wTextureCacheSizeSpinBox->setValue(settings->value("TextureCacheSize").toInt());
+	}
+	if (!settings->value("TextureMemoryBudget").isNull())
+	{
+		m_wTextureMemoryBudgetSpinBox->setValue(settings->value("TextureMemoryBudget").toInt());
+	}
+	if (!settings->value("SceneCellSize").isNull())
+	{
+		m_wSceneCellSizeSpinBox->setValue(settings->value("SceneCellSize").toInt());
+	}
+	if (!settings->value("LiveLink").isNull())
+	{
+		m_wLiveLinkCheckBox->setChecked(settings->value("LiveLink").toBool());
+	}
+	if (!settings->value("LiveLinkPort").isNull())
+	{
+		m_wLiveLinkPortSpinBox->setValue(settings->value("LiveLinkPort").toInt());
+	}
+	if (!settings->value("MaxBoneInfluences").isNull())
+	{
+		int nMaxBoneInfluencesIndex = m_wMaxBoneInfluencesCombo->findData(settings->value("MaxBoneInfluences").toInt());
+		if (nMaxBoneInfluencesIndex != -1) m_wMaxBoneInfluencesCombo->setCurrentIndex(nMaxBoneInfluencesIndex);
+	}
+	if (!settings->value("SkinWeightThreshold").isNull())
+	{
+		int nSkinWeightThresholdIndex = m_wSkinWeightThresholdCombo->findData(settings->value("SkinWeightThreshold").toDouble());
+		if (nSkinWeightThresholdIndex != -1) m_wSkinWeightThresholdCombo->setCurrentIndex(nSkinWeightThresholdIndex);
+	}
+	if (!settings->value("RemoveUnusedBones").isNull())
+	{
+		m_wRemoveUnusedBonesCheckBox->setChecked(settings->value("RemoveUnusedBones").toBool());
+	}
+	if (!settings->value("ExportProfile").isNull())
+	{
+		int nExportProfileIndex = m_wExportProfileCombo->findData(settings->value("ExportProfile").toString());
+		if (nExportProfileIndex != -1) m_wExportProfileCombo->setCurrentIndex(nExportProfileIndex);
+	}
+	if (!settings->value("TextureResolution").isNull())
+	{
+		int nTextureResolutionIndex = m_wTextureResolutionCombo->findData(settings->value("TextureResolution").toString());
+		if (nTextureResolutionIndex != -1) m_wTextureResolutionCombo->setCurrentIndex(nTextureResolutionIndex);
+	}
+	if (!settings->value("PublishTextureVariants").isNull())
+	{
+		m_wPublishTextureVariantsCheckBox->setChecked(settings->value("PublishTextureVariants").toBool());
+	}
 	if (!settings->value("GodotAssetType").isNull())
 	{
 		QString sGodotAssetTypeData = settings->value("GodotAssetType").toString();
@@ -220,6 +547,35 @@ void DzGodotDialog::saveSettings()
 	// Godot Project Path
 	settings->setValue("GodotProjectPath", m_wGodotProjectFolderEdit->text());
 
+	// Optimization Options
+	settings->setValue("QuantizeMorphs", m_wQuantizeMorphsCheckBox->isChecked());
+	settings->setValue("QuantizeVertices", m_wQuantizeVerticesCheckBox->isChecked());
+	settings->setValue("PruneMeshSurfaces", m_wPruneMeshSurfacesCheckBox->isChecked());
+	settings->setValue("DeduplicateMeshes", m_wDeduplicateMeshesCheckBox->isChecked());
+	settings->setValue("MeshoptCompression", m_wMeshoptCompressionCheckBox->isChecked());
+	settings->setValue("PackOrmTextures", m_wPackOrmTexturesCheckBox->isChecked());
+	settings->setValue("Ktx2Textures", m_wKtx2TexturesCheckBox->isChecked());
+	settings->setValue("ToktxExecutablePath", m_wToktxExecutablePathEdit->text());
+	settings->setValue("AtlasTextures", m_wAtlasTexturesCheckBox->isChecked());
+	settings->setValue("AtlasSize", m_wAtlasSizeCombo->itemData(m_wAtlasSizeCombo->currentIndex()).toInt());
+	settings->setValue("AtlasPadding", m_wAtlasPaddingSpinBox->value());
+	settings->setValue("ReduceAnimations", m_wReduceAnimationsCheckBox->isChecked());
+	settings->setValue("QuantizeAnimations", m_wQuantizeAnimationsCheckBox->isChecked());
+	settings->setValue("AnimationClips", m_wAnimationClipsEdit->text());
+	settings->setValue("TextureStage", m_wTextureStageCheckBox->isChecked());
+	settings->setValue("TextureCache", m_wTextureCacheCheckBox->isChecked());
+	settings->setValue("TextureCacheSize", m_wTextureCacheSizeSpinBox->value());
+	settings->setValue("TextureMemoryBudget", m_wTextureMemoryBudgetSpinBox->value());
+	settings->setValue("SceneCellSize", m_wSceneCellSizeSpinBox->value());
+	settings->setValue("LiveLink", m_wLiveLinkCheckBox->isChecked());
+	settings->setValue("LiveLinkPort", m_wLiveLinkPortSpinBox->value());
+	settings->setValue("TextureResolution", m_wTextureResolutionCombo->itemData(m_wTextureResolutionCombo->currentIndex()).toString());
+	settings->setValue("PublishTextureVariants", m_wPublishTextureVariantsCheckBox->isChecked());
+	settings->setValue("MaxBoneInfluences", m_wMaxBoneInfluencesCombo->itemData(m_wMaxBoneInfluencesCombo->currentIndex()).toInt());
+	settings->setValue("SkinWeightThreshold", m_wSkinWeightThresholdCombo->itemData(m_wSkinWeightThresholdCombo->currentIndex()).toDouble());
+	settings->setValue("RemoveUnusedBones", m_wRemoveUnusedBonesCheckBox->isChecked());
+	settings->setValue("ExportProfile", m_wExportProfileCombo->itemData(m_wExportProfileCombo->currentIndex()).toString());
+
 }
 
 void DzGodotDialog::resetToDefaults()
@@ -229,6 +585,32 @@ void DzGodotDialog::resetToDefaults()
 
 	QString DefaultPath = QDesktopServices::storageLocation(QDesktopServices::DocumentsLocation) + QDir::separator() + "DazToGodot";
 	intermediateFolderEdit->setText(DefaultPath);
+	m_wQuantizeMorphsCheckBox->setChecked(false);
+	m_wQuantizeVerticesCheckBox->setChecked(false);
+	m_wPruneMeshSurfacesCheckBox->setChecked(true);
+	m_wDeduplicateMeshesCheckBox->setChecked(true);
+	m_wMeshoptCompressionCheckBox->setChecked(false);
+	m_wPackOrmTexturesCheckBox->setChecked(true);
+	m_wKtx2TexturesCheckBox->setChecked(false);
+	m_wAtlasTexturesCheckBox->setChecked(false);
+	m_wAtlasSizeCombo->setCurrentIndex(m_wAtlasSizeCombo->findData(4096));
+	m_wAtlasPaddingSpinBox->setValue(8);
+	m_wReduceAnimationsCheckBox->setChecked(true);
+	m_wQuantizeAnimationsCheckBox->setChecked(false);
+	m_wAnimationClipsEdit->setText("");
+	m_wTextureStageCheckBox->setChecked(true);
+	m_wTextureCacheCheckBox->setChecked(true);
+	m_wTextureCacheSizeSpinBox->setValue(1024);
+	m_wTextureMemoryBudgetSpinBox->setValue(1024);
+	m_wSceneCellSizeSpinBox->setValue(32);
+	m_wLiveLinkCheckBox->setChecked(false);
+	m_wLiveLinkPortSpinBox->setValue(9007);
+	m_wTextureResolutionCombo->setCurrentIndex(m_wTextureResolutionCombo->findData("full"));
+	m_wPublishTextureVariantsCheckBox->setChecked(false);
+	m_wMaxBoneInfluencesCombo->setCurrentIndex(0);
+	m_wSkinWeightThresholdCombo->setCurrentIndex(0);
+	m_wRemoveUnusedBonesCheckBox->setChecked(false);
+	m_wExportProfileCombo->setCurrentIndex(0);
 
 	DzNode* Selection = dzScene->getPrimarySelection();
 	if (dzScene->getFilename().length() > 0)
@@ -299,6 +681,91 @@ void DzGodotDialog::HandleAssetTypeComboChange(int state)
 
 }
 
+// Writes the built-in profiles which are missing from the settings, existing profiles are kept
+// so that edited budgets survive plugin updates
+void DzGodotDialog::writeDefaultExportProfiles()
+{
+	if (settings == nullptr) return;
+
+	QStringList aProfileNames = (QStringList() << "Desktop" << "Mobile" << "VR");
+	QStringList aTextureResolutions = (QStringList() << "full" << "1k" << "2k");
+	QList<bool> aKtx2Textures = (QList<bool>() << false << true << true);
+	QList<bool> aGenerateLods = (QList<bool>() << true << true << true);
+	QList<int> aMorphBudgets = (QList<int>() << 0 << 50 << 100);
+	QList<int> aMaxBoneInfluences = (QList<int>() << 8 << 4 << 4);
+	QList<double> aAnimationRotationTolerances = (QList<double>() << 0.05 << 0.1 << 0.05);
+	QList<int> aMaxTriangles = (QList<int>() << 200000 << 30000 << 70000);
+	QList<int> aMaxTextureMemory = (QList<int>() << 512 << 64 << 192);
+	QList<int> aMaxDrawCalls = (QList<int>() << 40 << 10 << 20);
+
+	for (int i = 0; i < aProfileNames.count(); i++)
+	{
+		QString sGroup = "Profiles/" + aProfileNames[i];
+		if (settings->value(sGroup + "/TextureResolution").isNull() == false)
+		{
+			continue;
+		}
+		settings->setValue(sGroup + "/TextureResolution", aTextureResolutions[i]);
+		settings->setValue(sGroup + "/Ktx2Textures", aKtx2Textures[i]);
+		settings->setValue(sGroup + "/GenerateLods", aGenerateLods[i]);
+		settings->setValue(sGroup + "/MorphBudget", aMorphBudgets[i]);
+		settings->setValue(sGroup + "/MaxBoneInfluences", aMaxBoneInfluences[i]);
+		settings->setValue(sGroup + "/AnimationRotationTolerance", aAnimationRotationTolerances[i]);
+		settings->setValue(sGroup + "/MaxTriangles", aMaxTriangles[i]);
+		settings->setValue(sGroup + "/MaxTextureMemory", aMaxTextureMemory[i]);
+		settings->setValue(sGroup + "/MaxDrawCalls", aMaxDrawCalls[i]);
+	}
+}
+
+QStringList DzGodotDialog::getExportProfileNames()
+{
+	QStringList aProfileNames;
+	if (settings == nullptr) return aProfileNames;
+
+	settings->beginGroup("Profiles");
+	aProfileNames = settings->childGroups();
+	settings->endGroup();
+
+	return aProfileNames;
+}
+
+QVariantMap DzGodotDialog::getExportProfile(QString sProfileName)
+{
+	QVariantMap aProfile;
+	if (settings == nullptr || sProfileName.isEmpty()) return aProfile;
+
+	settings->beginGroup("Profiles/" + sProfileName);
+	foreach(QString sKey, settings->childKeys())
+	{
+		aProfile[sKey] = settings->value(sKey);
+	}
+	settings->endGroup();
+
+	return aProfile;
+}
+
+void DzGodotDialog::HandleExportProfileComboChange(int state)
+{
+	QVariantMap aProfile = getExportProfile(m_wExportProfileCombo->itemData(state).toString());
+	if (aProfile.isEmpty()) return;
+
+	// show the profile's settings which also have a widget, the rest is applied on export
+	if (aProfile.contains("TextureResolution"))
+	{
+		int nTextureResolutionIndex = m_wTextureResolutionCombo->findData(aProfile["TextureResolution"].toString());
+		if (nTextureResolutionIndex != -1) m_wTextureResolutionCombo->setCurrentIndex(nTextureResolutionIndex);
+	}
+	if (aProfile.contains("Ktx2Textures"))
+	{
+		m_wKtx2TexturesCheckBox->setChecked(aProfile["Ktx2Textures"].toBool());
+	}
+	if (aProfile.contains("MaxBoneInfluences"))
+	{
+		int nMaxBoneInfluencesIndex = m_wMaxBoneInfluencesCombo->findData(aProfile["MaxBoneInfluences"].toInt());
+		if (nMaxBoneInfluencesIndex != -1) m_wMaxBoneInfluencesCombo->setCurrentIndex(nMaxBoneInfluencesIndex);
+	}
+}
+
 #include <QProcessEnvironment>
 
 void DzGodotDialog::HandleTargetPluginInstallerButton()
@@ -491,4 +958,62 @@ void DzGodotDialog::HandleSelectBlenderExecutablePathButton()
 	}
 }
 
+void DzGodotDialog::HandleAddAnimationClipsButton()
+{
+	QString directoryName = "";
+	if (settings != nullptr && settings->value("AnimationClipsFolder").isNull() != true)
+	{
+		directoryName = settings->value("AnimationClipsFolder").toString();
+	}
+	QStringList aFileNames = QFileDialog::getOpenFileNames(this,
+		tr("Select aniBlocks or Pose Presets"),
+		directoryName,
+		tr("Daz Studio Files (*.duf *.dsf *.dsa)"));
+
+	if (aFileNames.isEmpty())
+	{
+		return;
+	}
+	QStringList aClips = m_wAnimationClipsEdit->text().split(";", QString::SkipEmptyParts);
+	foreach(QString fileName, aFileNames)
+	{
+		aClips.append(QString("%1=%2").arg(QFileInfo(fileName).baseName()).arg(fileName));
+	}
+	m_wAnimationClipsEdit->setText(aClips.join("; "));
+	if (settings != nullptr)
+	{
+		settings->setValue("AnimationClipsFolder", QFileInfo(aFileNames.first()).path());
+	}
+}
+
+void DzGodotDialog::HandleSelectToktxExecutablePathButton()
+{
+	QString directoryName = "";
+	if (settings != nullptr && settings->value("ToktxExecutablePath").isNull() != true)
+	{
+		directoryName = QFileInfo(settings->value("ToktxExecutablePath").toString()).dir().path();
+	}
+#ifdef WIN32
+	QString sExeFilter = tr("Executable Files (*.exe)");
+#else
+	QString sExeFilter = tr("All Files (*)");
+#endif
+	QString fileName = QFileDialog::getOpenFileName(this,
+		tr("Select toktx Executable"),
+		directoryName,
+		sExeFilter,
+		&sExeFilter,
+		QFileDialog::ReadOnly |
+		QFileDialog::DontResolveSymlinks);
+
+	if (fileName != "")
+	{
+		m_wToktxExecutablePathEdit->setText(fileName);
+		if (settings != nullptr)
+		{
+			settings->setValue("ToktxExecutablePath", fileName);
+		}
+	}
+}
+
 #include "moc_DzGodotDialog.cpp"
@@ -2,12 +2,14 @@
 #include "dzbasicdialog.h"
 #include <QtGui/qcombobox.h>
 #include <QtCore/qsettings.h>
+#include <QtCore/qvariant.h>
 #include <DzBridgeDialog.h>
 
 class QPushButton;
 class QLineEdit;
 class QCheckBox;
 class QComboBox;
+class QSpinBox;
 class QGroupBox;
 class QLabel;
 class QWidget;
@@ -34,6 +36,10 @@ public:
 	Q_INVOKABLE bool loadSavedSettings() override;
 	Q_INVOKABLE void saveSettings() override;
 
+	// Export profiles are stored as "Profiles/<name>/<key>" in the dialog settings
+	Q_INVOKABLE QStringList getExportProfileNames();
+	Q_INVOKABLE QVariantMap getExportProfile(QString sProfileName);
+
 protected slots:
 	void HandleSelectIntermediateFolderButton();
 	void HandleAssetTypeComboChange(int state);
@@ -45,6 +51,9 @@ protected slots:
 	void showGodotOptions(bool bVisible);
 
 	void HandleSelectBlenderExecutablePathButton();
+	void HandleSelectToktxExecutablePathButton();
+	void HandleAddAnimationClipsButton();
+	void HandleExportProfileComboChange(int state);
 
 protected:
 	QLineEdit* intermediateFolderEdit;
@@ -58,6 +67,38 @@ protected:
 	QPushButton* m_wBlenderExecutablePathButton;
 	QWidget* m_wBlenderExecutablePathRowLabelWdiget;
 
+	QCheckBox* m_wQuantizeMorphsCheckBox;
+	QCheckBox* m_wQuantizeVerticesCheckBox;
+	QCheckBox* m_wPruneMeshSurfacesCheckBox;
+	QCheckBox* m_wDeduplicateMeshesCheckBox;
+	QCheckBox* m_wMeshoptCompressionCheckBox;
+	QCheckBox* m_wKtx2TexturesCheckBox;
+	QCheckBox* m_wPackOrmTexturesCheckBox;
+	QLineEdit* m_wToktxExecutablePathEdit;
+	QPushButton* m_wToktxExecutablePathButton;
+	QCheckBox* m_wAtlasTexturesCheckBox;
+	QComboBox* m_wAtlasSizeCombo;
+	QSpinBox* m_wAtlasPaddingSpinBox;
+	QCheckBox* m_wReduceAnimationsCheckBox;
+	QCheckBox* m_wQuantizeAnimationsCheckBox;
+	QLineEdit* m_wAnimationClipsEdit;
+	QPushButton* m_wAnimationClipsButton;
+	QCheckBox* m_wTextureStageCheckBox;
+	QCheckBox* m_wTextureCacheCheckBox;
+	QSpinBox* m_wTextureCacheSizeSpinBox;
+	QSpinBox* m_wTextureMemoryBudgetSpinBox;
+	QSpinBox* m_wSceneCellSizeSpinBox;
+	QCheckBox* m_wLiveLinkCheckBox;
+	QSpinBox* m_wLiveLinkPortSpinBox;
+	QComboBox* m_wTextureResolutionCombo;
+	QCheckBox* m_wPublishTextureVariantsCheckBox;
+	QComboBox* m_wMaxBoneInfluencesCombo;
+	QComboBox* m_wSkinWeightThresholdCombo;
+	QCheckBox* m_wRemoveUnusedBonesCheckBox;
+	QComboBox* m_wExportProfileCombo;
+
+	void writeDefaultExportProfiles();
+
 	virtual void refreshAsset() override;
 
 #ifdef UNITTEST_DZBRIDGE
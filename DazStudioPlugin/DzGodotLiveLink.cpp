@@ -0,0 +1,317 @@
+#include <QtCore/qtimer.h>
+#include <QtGui/qcolor.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include <dzapp.h>
+#include <dzscene.h>
+#include <dznode.h>
+#include <dzskeleton.h>
+#include <dzbone.h>
+#include <dzobject.h>
+#include <dzshape.h>
+#include <dzmaterial.h>
+#include <dzmodifier.h>
+#include <dzmorph.h>
+#include <dzproperty.h>
+#include <dznumericproperty.h>
+#include <dzfloatproperty.h>
+#include <dzcolorproperty.h>
+
+#include "DzGodotLiveLink.h"
+
+// Daz material properties which the add-on maps to StandardMaterial3D parameters, see
+// daz_live_link.gd.  Textures are not streamed, they need a material update export.
+static const char* s_aMaterialProperties[] = { "Diffuse Color", "Cutout Opacity", "Metallic Weight", "Glossy Roughness", "Emission Color" };
+
+static const int RECONNECT_INTERVAL = 2000; // milliseconds between connection attempts
+static const qint64 MAX_UNSENT_BYTES = 256 * 1024; // frames are held back while more is waiting in the socket
+
+DzGodotLiveLink::DzGodotLiveLink(QObject* parent) :
+	QObject(parent)
+{
+	m_pSocket = new QTcpSocket(this);
+	m_pSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+	connect(m_pSocket, SIGNAL(connected()), this, SLOT(HandleConnected()));
+	connect(m_pSocket, SIGNAL(disconnected()), this, SLOT(HandleDisconnected()));
+	m_pTimer = new QTimer(this);
+	connect(m_pTimer, SIGNAL(timeout()), this, SLOT(HandleTimer()));
+}
+
+DzGodotLiveLink::~DzGodotLiveLink()
+{
+	stop();
+}
+
+bool DzGodotLiveLink::start(DzNode* pNode, QString sAssetName, QStringList aMorphNames)
+{
+	stop();
+	if (pNode == nullptr)
+	{
+		return false;
+	}
+	m_pNode = pNode;
+	m_aMorphNames = aMorphNames;
+	m_bSourcesChanged = false;
+	collectSources(pNode, aMorphNames);
+	dzApp->log(QString("DEBUG: DzGodotLiveLink: linking %1 (%2 bones, %3 morphs, %4 material parameters) to %5:%6")
+		.arg(sAssetName).arg(m_aBones.count()).arg(m_aMorphs.count()).arg(m_aMaterialParameters.count()).arg(m_sHost).arg(m_nPort));
+
+	m_oEncoder = Dtu2Godot::LiveLinkEncoder();
+	m_oEncoder.setMaxFrameRate(m_nMaxFrameRate);
+	m_oEncoder.setAssetName(sAssetName.toUtf8().constData());
+	m_bDirty = true;
+	m_nFramesSent = 0;
+	m_nBytesSent = 0;
+	m_oClock.start();
+	connectToAddOn();
+	m_pTimer->start(1000 / qMax(1, m_nMaxFrameRate));
+	return true;
+}
+
+void DzGodotLiveLink::stop()
+{
+	m_pTimer->stop();
+	releaseSources();
+	if (m_pNode.isNull() == false)
+	{
+		dzApp->log(QString("DEBUG: DzGodotLiveLink: stopped after %1 frames, %2 bytes").arg(m_nFramesSent).arg(m_nBytesSent));
+	}
+	m_pNode = nullptr;
+	m_aMorphNames.clear();
+	m_pSocket->abort();
+}
+
+// Disconnects from the sources which still exist, deleted ones are already disconnected
+void DzGodotLiveLink::releaseSources()
+{
+	foreach(QPointer<QObject> pObject, m_aWatchedObjects)
+	{
+		if (pObject.isNull() == false)
+		{
+			disconnect(pObject, 0, this, 0);
+		}
+	}
+	m_aWatchedObjects.clear();
+	if (dzScene)
+	{
+		disconnect(dzScene, 0, this, 0);
+	}
+	m_aBones.clear();
+	m_aMorphs.clear();
+	m_aMaterialParameters.clear();
+}
+
+bool DzGodotLiveLink::isConnected()
+{
+	return m_pSocket->state() == QAbstractSocket::ConnectedState;
+}
+
+void DzGodotLiveLink::watch(QObject* pObject, const char* sSignal, const char* sSlot)
+{
+	connect(pObject, sSignal, this, sSlot);
+	connect(pObject, SIGNAL(destroyed()), this, SLOT(HandleSourcesChanged()), Qt::UniqueConnection);
+	m_aWatchedObjects.append(pObject);
+}
+
+// Finds the bones, morph controls and material properties of the node and its children
+void DzGodotLiveLink::collectSources(DzNode* pNode, QStringList aMorphNames)
+{
+	DzSkeleton* pSkeleton = qobject_cast<DzSkeleton*>(pNode);
+	if (pSkeleton)
+	{
+		// the bones of conformed items are children too, but belong to their own skeletons
+		foreach(DzNode* pChild, pSkeleton->getNodeChildren(true))
+		{
+			DzBone* pBone = qobject_cast<DzBone*>(pChild);
+			if (pBone == nullptr || pBone->getSkeleton() != pSkeleton) continue;
+			m_aBones.append(pBone);
+			watch(pBone, SIGNAL(transformChanged()));
+		}
+		watch(pSkeleton, SIGNAL(transformChanged()));
+	}
+
+	DzObject* pObject = pNode->getObject();
+	if (pObject && aMorphNames.isEmpty() == false)
+	{
+		for (int i = 0; i < pObject->getNumModifiers(); i++)
+		{
+			DzMorph* pMorph = qobject_cast<DzMorph*>(pObject->getModifier(i));
+			if (pMorph == nullptr || pMorph->getValueControl() == nullptr) continue;
+			if (aMorphNames.contains(pMorph->getName()) == false) continue;
+			m_aMorphs.append(qMakePair(pMorph->getName(), QPointer<DzNumericProperty>(pMorph->getValueControl())));
+			watch(pMorph->getValueControl(), SIGNAL(currentValueChanged()));
+		}
+	}
+
+	QList<DzNode*> aNodes;
+	aNodes.append(pNode);
+	aNodes.append(pNode->getNodeChildren(true));
+	foreach(DzNode* pChild, aNodes)
+	{
+		// fitted or removed items, switched shapes and replaced materials
+		watch(pChild, SIGNAL(childAdded(DzNode*)), SLOT(HandleSourcesChanged()));
+		watch(pChild, SIGNAL(childRemoved(DzNode*)), SLOT(HandleSourcesChanged()));
+		DzObject* pChildObject = pChild->getObject();
+		if (pChildObject)
+		{
+			watch(pChildObject, SIGNAL(currentShapeSwitched()), SLOT(HandleSourcesChanged()));
+		}
+		DzShape* pShape = pChildObject ? pChildObject->getCurrentShape() : nullptr;
+		if (pShape == nullptr)
+		{
+			continue;
+		}
+		watch(pShape, SIGNAL(materialListChanged()), SLOT(HandleSourcesChanged()));
+		for (int i = 0; i < pShape->getNumMaterials(); i++)
+		{
+			DzMaterial* pMaterial = pShape->getMaterial(i);
+			if (pMaterial == nullptr)
+			{
+				continue;
+			}
+			for (size_t j = 0; j < sizeof(s_aMaterialProperties) / sizeof(s_aMaterialProperties[0]); j++)
+			{
+				DzProperty* pProperty = pMaterial->findProperty(s_aMaterialProperties[j]);
+				if (pProperty == nullptr) continue;
+				MaterialParameter parameter;
+				parameter.sName = pMaterial->getName() + "/" + s_aMaterialProperties[j];
+				parameter.pProperty = pProperty;
+				m_aMaterialParameters.append(parameter);
+				watch(pProperty, SIGNAL(currentValueChanged()));
+			}
+		}
+	}
+
+	// playback and timeline scrubbing
+	connect(dzScene, SIGNAL(timeChanged(DzTime)), this, SLOT(HandleChanged()));
+}
+
+// Passes the current values to the encoder, which keeps those that changed
+void DzGodotLiveLink::sample()
+{
+	using namespace Dtu2Godot;
+
+	// bone rotations relative to the rest pose and positions in meters, both in figure space
+	DzQuat inverseRootRotation = m_pNode->getWSRot().inverse();
+	DzVec3 rootPosition = m_pNode->getWSPos();
+	foreach(QPointer<DzBone> pBone, m_aBones)
+	{
+		if (pBone.isNull()) continue;
+		DzQuat rotation = inverseRootRotation * pBone->getWSRot();
+		DzVec3 position = inverseRootRotation.multVec(pBone->getWSPos() - rootPosition) * 0.01;
+		float aValues[7] = { (float)rotation.m_x, (float)rotation.m_y, (float)rotation.m_z, (float)rotation.m_w,
+			(float)position.m_x, (float)position.m_y, (float)position.m_z };
+		m_oEncoder.setValue(LiveLink::Pose, pBone->getName().toUtf8().constData(), aValues, 7);
+	}
+
+	for (int i = 0; i < m_aMorphs.count(); i++)
+	{
+		if (m_aMorphs[i].second.isNull()) continue;
+		float fWeight = (float)m_aMorphs[i].second->getDoubleValue();
+		m_oEncoder.setValue(LiveLink::Morph, m_aMorphs[i].first.toUtf8().constData(), &fWeight, 1);
+	}
+
+	foreach(const MaterialParameter& parameter, m_aMaterialParameters)
+	{
+		if (parameter.pProperty.isNull()) continue;
+		std::string sName = parameter.sName.toUtf8().constData();
+		DzColorProperty* pColorProperty = qobject_cast<DzColorProperty*>(parameter.pProperty);
+		DzNumericProperty* pNumericProperty = qobject_cast<DzNumericProperty*>(parameter.pProperty);
+		if (pColorProperty)
+		{
+			QColor color = pColorProperty->getColorValue();
+			float aValues[3] = { (float)color.redF(), (float)color.greenF(), (float)color.blueF() };
+			m_oEncoder.setValue(LiveLink::Material, sName, aValues, 3);
+		}
+		else if (pNumericProperty)
+		{
+			float fValue = (float)pNumericProperty->getDoubleValue();
+			m_oEncoder.setValue(LiveLink::Material, sName, &fValue, 1);
+		}
+	}
+}
+
+void DzGodotLiveLink::connectToAddOn()
+{
+	m_oReconnectClock.start();
+	m_pSocket->connectToHost(m_sHost, (quint16)m_nPort);
+}
+
+void DzGodotLiveLink::HandleTimer()
+{
+	if (m_pNode.isNull())
+	{
+		dzApp->log("WARNING: DzGodotLiveLink: the linked node was deleted, stopping live link");
+		stop();
+		return;
+	}
+	if (m_bSourcesChanged)
+	{
+		releaseSources();
+		collectSources(m_pNode, m_aMorphNames);
+		m_bSourcesChanged = false;
+		m_bDirty = true;
+	}
+	if (m_pSocket->state() == QAbstractSocket::UnconnectedState)
+	{
+		if (m_oReconnectClock.elapsed() >= RECONNECT_INTERVAL)
+		{
+			connectToAddOn();
+		}
+		return;
+	}
+	if (m_pSocket->state() != QAbstractSocket::ConnectedState)
+	{
+		return;
+	}
+
+	if (m_bDirty)
+	{
+		sample();
+		m_bDirty = false;
+	}
+	// the add-on is behind: hold the frame back, later changes coalesce with it
+	if (m_pSocket->bytesToWrite() > MAX_UNSENT_BYTES)
+	{
+		return;
+	}
+	std::vector<uint8_t> aFrame = m_oEncoder.takeFrame(m_oClock.elapsed() / 1000.0);
+	if (aFrame.empty())
+	{
+		return;
+	}
+	m_pSocket->write((const char*)aFrame.data(), (qint64)aFrame.size());
+	m_nFramesSent++;
+	m_nBytesSent += (qint64)aFrame.size();
+}
+
+void DzGodotLiveLink::HandleConnected()
+{
+	dzApp->log(QString("DEBUG: DzGodotLiveLink: connected to %1:%2").arg(m_sHost).arg(m_nPort));
+	// the add-on starts without channel definitions
+	m_oEncoder.reset();
+	m_bDirty = true;
+}
+
+void DzGodotLiveLink::HandleDisconnected()
+{
+	if (m_pNode.isNull())
+	{
+		return;
+	}
+	dzApp->log(QString("DEBUG: DzGodotLiveLink: disconnected from %1:%2, reconnecting").arg(m_sHost).arg(m_nPort));
+	m_oReconnectClock.start();
+}
+
+void DzGodotLiveLink::HandleChanged()
+{
+	m_bDirty = true;
+}
+
+// Called while the sources are being deleted, they are collected again by the next HandleTimer()
+void DzGodotLiveLink::HandleSourcesChanged()
+{
+	m_bSourcesChanged = true;
+}
+
+#include "moc_DzGodotLiveLink.cpp"
@@ -0,0 +1,99 @@
+#pragma once
+#include <QtCore/qobject.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qdatetime.h>
+
+#include "LiveLink.h"
+
+class QTcpSocket;
+class QTimer;
+class DzNode;
+class DzBone;
+class DzProperty;
+class DzNumericProperty;
+class DzColorProperty;
+
+/*
+ * Streams the pose, morph weights and material parameters of an exported node to the
+ * Daz Live Link add-on in the Godot editor, which applies them to the published asset,
+ * so that changes can be previewed in Godot without exporting again.
+ *
+ * Changes only mark the link dirty.  A timer at the maximum frame rate samples the
+ * node and sends one frame with the values which changed since the previous frame
+ * (see Dtu2Godot::LiveLinkEncoder), so rapid changes such as scrubbing the timeline
+ * are coalesced.  While the add-on falls behind, frames are held back and the changes
+ * keep coalescing.  The link reconnects when the add-on is restarted.
+ *
+ * Bones, morphs and material properties are held by guarded pointers.  When one of them is
+ * deleted, or children or materials are added, removed or replaced, the sources are
+ * collected again before the next frame.
+ */
+class DzGodotLiveLink : public QObject {
+	Q_OBJECT
+	Q_PROPERTY(QString sHost READ getHost WRITE setHost)
+	Q_PROPERTY(int nPort READ getPort WRITE setPort)
+	Q_PROPERTY(int nMaxFrameRate READ getMaxFrameRate WRITE setMaxFrameRate)
+public:
+	DzGodotLiveLink(QObject* parent = nullptr);
+	virtual ~DzGodotLiveLink();
+
+	Q_INVOKABLE QString getHost() { return this->m_sHost; };
+	Q_INVOKABLE void setHost(QString arg_sHost) { this->m_sHost = arg_sHost; };
+	Q_INVOKABLE int getPort() { return this->m_nPort; };
+	Q_INVOKABLE void setPort(int arg_nPort) { this->m_nPort = arg_nPort; };
+	Q_INVOKABLE int getMaxFrameRate() { return this->m_nMaxFrameRate; };
+	Q_INVOKABLE void setMaxFrameRate(int arg_nFramesPerSecond) { this->m_nMaxFrameRate = arg_nFramesPerSecond; };
+
+	// aMorphNames are the morphs exported with the asset, the others have no blend shape in Godot
+	Q_INVOKABLE bool start(DzNode* pNode, QString sAssetName, QStringList aMorphNames = QStringList());
+	Q_INVOKABLE void stop();
+	Q_INVOKABLE bool isActive() { return this->m_pNode.isNull() == false; };
+	Q_INVOKABLE bool isConnected();
+
+	Q_INVOKABLE int getNumFramesSent() { return this->m_nFramesSent; };
+	Q_INVOKABLE int getNumBytesSent() { return (int)this->m_nBytesSent; };
+
+protected slots:
+	void HandleTimer();
+	void HandleConnected();
+	void HandleDisconnected();
+	void HandleChanged();
+	void HandleSourcesChanged();
+
+protected:
+	struct MaterialParameter
+	{
+		QString sName; // "<material>/<property>"
+		QPointer<DzProperty> pProperty;
+	};
+
+	QString m_sHost = "127.0.0.1";
+	int m_nPort = Dtu2Godot::LiveLink::DEFAULT_PORT;
+	int m_nMaxFrameRate = 30;
+
+	QTcpSocket* m_pSocket = nullptr;
+	QTimer* m_pTimer = nullptr;
+	QTime m_oClock; // frame times for the encoder
+	QTime m_oReconnectClock;
+	Dtu2Godot::LiveLinkEncoder m_oEncoder;
+	bool m_bDirty = false;
+	int m_nFramesSent = 0;
+	qint64 m_nBytesSent = 0;
+
+	QPointer<DzNode> m_pNode;
+	QStringList m_aMorphNames;
+	bool m_bSourcesChanged = false;
+	QList<QPointer<DzBone> > m_aBones;
+	QList<QPair<QString, QPointer<DzNumericProperty> > > m_aMorphs;
+	QList<MaterialParameter> m_aMaterialParameters;
+	QList<QPointer<QObject> > m_aWatchedObjects; // sources of change signals
+
+	void collectSources(DzNode* pNode, QStringList aMorphNames);
+	void releaseSources();
+	void watch(QObject* pObject, const char* sSignal, const char* sSlot = SLOT(HandleChanged()));
+	void sample();
+	void connectToAddOn();
+};
@@ -0,0 +1,1378 @@
+#include <QtCore/qbuffer.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtGui/qimagereader.h>
+#include <QtGui/qimagewriter.h>
+#include <QCryptographicHash>
+#include <climits>
+#include <cstring>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <dzapp.h>
+#include <dznode.h>
+#include <dzobject.h>
+#include <dzshape.h>
+#include <dzmaterial.h>
+#include <dzproperty.h>
+#include <dzimageproperty.h>
+#include <dznumericproperty.h>
+#include <dztexture.h>
+
+#include "DzGodotTextureStage.h"
+
+// cache costs are in kilobytes, 3/4 of the cache size goes to decoded images, which
+// also count against the memory budget of the stage that decodes them
+QMutex DzGodotTextureStage::s_cacheMutex;
+QCache<QString, QImage> DzGodotTextureStage::s_decodedCache(768 * 1024);
+QCache<QString, QByteArray> DzGodotTextureStage::s_encodedCache(256 * 1024);
+
+// Converts one texture on a worker thread of processNode()
+class DzGodotTextureJob : public QRunnable
+{
+public:
+	DzGodotTextureJob(DzGodotTextureStage* pStage, QString sSourcePath, QString sOutputPath) :
+		m_pStage(pStage), m_sSourcePath(sSourcePath), m_sOutputPath(sOutputPath)
+	{
+		setAutoDelete(false);
+	}
+	void run() { m_bResult = m_pStage->convertTexture(m_sSourcePath, m_sOutputPath); }
+
+	DzGodotTextureStage* m_pStage;
+	QString m_sSourcePath;
+	QString m_sOutputPath;
+	bool m_bResult = false;
+};
+
+// Reads BMP, TGA and baseline TIFF files one row at a time.  The image plugins of Qt can
+// only decode these formats at full resolution, rows read here are downsampled as they
+// arrive.  Variants which are not supported (palettes, tiles, JPEG compressed TIFF, ...)
+// fail in open() and are decoded by the image plugins.
+class DzGodotScanlineReader
+{
+public:
+	bool open(QString sPath);
+	QSize getSize() const { return m_qSize; }
+	bool hasAlpha() const { return m_bHasAlpha; }
+	// rows are stored bottom to top (BMP, TGA)
+	bool isBottomUp() const { return m_bBottomUp; }
+	// memory held by the reader, besides the row buffers of the caller
+	qint64 getScratchBytes() const { return m_nScratchBytes; }
+	// next row in file order
+	bool readRow(QRgb* pRow);
+	QString getError() const { return m_sError; }
+
+protected:
+	enum Format { Bmp, Tga, Tiff };
+	enum Compression { None = 1, Lzw = 5, Deflate = 8, AdobeDeflate = 32946, PackBits = 32773 };
+
+	QFile m_file;
+	Format m_eFormat = Bmp;
+	QSize m_qSize;
+	bool m_bHasAlpha = false;
+	bool m_bBottomUp = false;
+	qint64 m_nScratchBytes = 0;
+	QString m_sError = "";
+	int m_nRow = 0;
+	QByteArray m_aRow; // raw bytes of one row
+
+	// buffered input, limited to the current strip for compressed data
+	QByteArray m_aInput;
+	int m_nInputPos = 0;
+	qint64 m_nInputLeft = 0;
+
+	// BMP and TGA
+	int m_nBytesPerPixel = 0;
+	bool m_bTgaRle = false;
+	int m_nRunLeft = 0;
+	bool m_bRunRepeat = false;
+	uchar m_aRunPixel[4];
+
+	// TIFF
+	bool m_bBigEndian = false;
+	int m_nSamples = 0;
+	int m_nBitsPerSample = 8;
+	int m_nPhotometric = 1;
+	int m_nCompression = None;
+	int m_nPredictor = 1;
+	bool m_bPremultiplied = false;
+	int m_nRowsPerStrip = 0;
+	QVector<quint32> m_aStripOffsets;
+	QVector<quint32> m_aStripByteCounts;
+	QByteArray m_aStrip; // decompressed deflate strip
+	int m_nStripPos = 0;
+	// LZW state, codes are MSB first with the early change of TIFF
+	QVector<quint16> m_aLzwPrefix;
+	QVector<uchar> m_aLzwSuffix;
+	QVector<uchar> m_aLzwFirst;
+	QVector<quint16> m_aLzwLength;
+	QByteArray m_aLzwString;
+	int m_nLzwStringPos = 0;
+	int m_nLzwNextCode = 258;
+	int m_nLzwWidth = 9;
+	int m_nLzwPrevCode = -1;
+	quint32 m_nBitBuffer = 0;
+	int m_nBitCount = 0;
+
+	bool fail(QString sMessage) { m_sError = sMessage; return false; }
+	int nextByte();
+	bool readBytes(uchar* pData, int nBytes);
+	quint16 tiff16(const uchar* pData) const;
+	quint32 tiff32(const uchar* pData) const;
+	QVector<quint32> readTiffValues(const uchar* pEntry);
+	bool openBmp();
+	bool openTga();
+	bool openTiff();
+	bool startStrip(int nStrip);
+	bool readTgaRow();
+	bool readTiffRow();
+	bool unpackBits(uchar* pData, int nBytes);
+	bool decodeLzw(uchar* pData, int nBytes);
+	void resetLzw();
+};
+
+static inline quint16 readLittleEndian16(const uchar* pData) { return (quint16)(pData[0] | (pData[1] << 8)); }
+static inline quint32 readLittleEndian32(const uchar* pData) { return (quint32)pData[0] | ((quint32)pData[1] << 8) | ((quint32)pData[2] << 16) | ((quint32)pData[3] << 24); }
+
+bool DzGodotScanlineReader::open(QString sPath)
+{
+	m_file.setFileName(sPath);
+	if (m_file.open(QIODevice::ReadOnly) == false)
+	{
+		return fail(m_file.errorString());
+	}
+	QByteArray aMagic = m_file.peek(4);
+	bool bResult = false;
+	if (aMagic.startsWith("BM"))
+	{
+		bResult = openBmp();
+	}
+	else if (aMagic == QByteArray("II*\0", 4) || aMagic == QByteArray("MM\0*", 4))
+	{
+		bResult = openTiff();
+	}
+	else if (QFileInfo(sPath).suffix().toLower() == "tga")
+	{
+		// TGA has no signature
+		bResult = openTga();
+	}
+	else
+	{
+		return fail("unsupported format");
+	}
+	if (bResult)
+	{
+		m_nScratchBytes += m_aRow.size() + 65536;
+	}
+
+	return bResult;
+}
+
+int DzGodotScanlineReader::nextByte()
+{
+	if (m_nInputPos >= m_aInput.size())
+	{
+		if (m_nInputLeft <= 0)
+		{
+			return -1;
+		}
+		m_aInput.resize((int)qMin(m_nInputLeft, (qint64)65536));
+		if (m_file.read(m_aInput.data(), m_aInput.size()) != m_aInput.size())
+		{
+			m_nInputLeft = 0;
+			return -1;
+		}
+		m_nInputLeft -= m_aInput.size();
+		m_nInputPos = 0;
+	}
+
+	return (uchar)m_aInput[m_nInputPos++];
+}
+
+bool DzGodotScanlineReader::readBytes(uchar* pData, int nBytes)
+{
+	for (int i = 0; i < nBytes; i++)
+	{
+		int nByte = nextByte();
+		if (nByte < 0)
+		{
+			return fail("unexpected end of file");
+		}
+		pData[i] = (uchar)nByte;
+	}
+
+	return true;
+}
+
+// uncompressed 24 and 32 bit BMP
+bool DzGodotScanlineReader::openBmp()
+{
+	m_eFormat = Bmp;
+	QByteArray aHeader = m_file.read(70);
+	if (aHeader.size() < 54)
+	{
+		return fail("truncated BMP header");
+	}
+	const uchar* pHeader = (const uchar*)aHeader.constData();
+	quint32 nDataOffset = readLittleEndian32(pHeader + 10);
+	quint32 nHeaderSize = readLittleEndian32(pHeader + 14);
+	qint32 nWidth = (qint32)readLittleEndian32(pHeader + 18);
+	qint32 nHeight = (qint32)readLittleEndian32(pHeader + 22);
+	int nBitsPerPixel = readLittleEndian16(pHeader + 28);
+	quint32 nCompression = readLittleEndian32(pHeader + 30);
+	if (nHeaderSize < 40 || nWidth <= 0 || nHeight == 0 || (nBitsPerPixel != 24 && nBitsPerPixel != 32))
+	{
+		return fail("unsupported BMP variant");
+	}
+	if (nCompression == 3 && nBitsPerPixel == 32 && aHeader.size() >= 70)
+	{
+		// only the BGRA layout of the bit fields
+		if (readLittleEndian32(pHeader + 54) != 0x00FF0000 || readLittleEndian32(pHeader + 58) != 0x0000FF00 || readLittleEndian32(pHeader + 62) != 0x000000FF)
+		{
+			return fail("unsupported BMP bit fields");
+		}
+		m_bHasAlpha = nHeaderSize >= 56 && readLittleEndian32(pHeader + 66) == 0xFF000000;
+	}
+	else if (nCompression != 0)
+	{
+		return fail("unsupported BMP compression");
+	}
+	m_qSize = QSize(nWidth, qAbs(nHeight));
+	m_bBottomUp = nHeight > 0;
+	m_nBytesPerPixel = nBitsPerPixel / 8;
+	m_aRow.resize((nWidth * nBitsPerPixel + 31) / 32 * 4);
+	if (m_file.seek(nDataOffset) == false)
+	{
+		return fail("truncated BMP file");
+	}
+	m_nInputLeft = m_file.size() - nDataOffset;
+
+	return true;
+}
+
+// uncompressed and run length encoded true color and gray TGA
+bool DzGodotScanlineReader::openTga()
+{
+	m_eFormat = Tga;
+	QByteArray aHeader = m_file.read(18);
+	if (aHeader.size() < 18)
+	{
+		return fail("truncated TGA header");
+	}
+	const uchar* pHeader = (const uchar*)aHeader.constData();
+	int nImageType = pHeader[2];
+	int nColorMapBytes = pHeader[1] ? readLittleEndian16(pHeader + 5) * ((pHeader[7] + 7) / 8) : 0;
+	int nWidth = readLittleEndian16(pHeader + 12);
+	int nHeight = readLittleEndian16(pHeader + 14);
+	int nBitsPerPixel = pHeader[16];
+	int nDescriptor = pHeader[17];
+	bool bTrueColor = (nImageType == 2 || nImageType == 10) && (nBitsPerPixel == 24 || nBitsPerPixel == 32);
+	bool bGray = (nImageType == 3 || nImageType == 11) && nBitsPerPixel == 8;
+	// right to left rows are not supported
+	if ((bTrueColor || bGray) == false || nWidth == 0 || nHeight == 0 || (nDescriptor & 0x10))
+	{
+		return fail("unsupported TGA variant");
+	}
+	m_qSize = QSize(nWidth, nHeight);
+	m_bBottomUp = (nDescriptor & 0x20) == 0;
+	m_bHasAlpha = nBitsPerPixel == 32 && (nDescriptor & 0x0F) != 0;
+	m_bTgaRle = nImageType >= 9;
+	m_nBytesPerPixel = nBitsPerPixel / 8;
+	m_aRow.resize(nWidth * m_nBytesPerPixel);
+	qint64 nDataOffset = 18 + pHeader[0] + nColorMapBytes;
+	if (m_file.seek(nDataOffset) == false)
+	{
+		return fail("truncated TGA file");
+	}
+	m_nInputLeft = m_file.size() - nDataOffset;
+
+	return true;
+}
+
+bool DzGodotScanlineReader::readTgaRow()
+{
+	uchar* pRow = (uchar*)m_aRow.data();
+	if (m_bTgaRle == false)
+	{
+		return readBytes(pRow, m_aRow.size());
+	}
+	// packets may run across rows
+	for (int x = 0; x < m_qSize.width(); x++)
+	{
+		if (m_nRunLeft == 0)
+		{
+			int nHeader = nextByte();
+			if (nHeader < 0)
+			{
+				return fail("unexpected end of file");
+			}
+			m_nRunLeft = (nHeader & 0x7F) + 1;
+			m_bRunRepeat = (nHeader & 0x80) != 0;
+			if (m_bRunRepeat && readBytes(m_aRunPixel, m_nBytesPerPixel) == false)
+			{
+				return false;
+			}
+		}
+		uchar* pPixel = pRow + x * m_nBytesPerPixel;
+		if (m_bRunRepeat)
+		{
+			memcpy(pPixel, m_aRunPixel, m_nBytesPerPixel);
+		}
+		else if (readBytes(pPixel, m_nBytesPerPixel) == false)
+		{
+			return false;
+		}
+		m_nRunLeft--;
+	}
+
+	return true;
+}
+
+quint16 DzGodotScanlineReader::tiff16(const uchar* pData) const
+{
+	return m_bBigEndian ? (quint16)((pData[0] << 8) | pData[1]) : readLittleEndian16(pData);
+}
+
+quint32 DzGodotScanlineReader::tiff32(const uchar* pData) const
+{
+	return m_bBigEndian ? ((quint32)pData[0] << 24) | ((quint32)pData[1] << 16) | ((quint32)pData[2] << 8) | pData[3] : readLittleEndian32(pData);
+}
+
+// SHORT or LONG values of an IFD entry, stored in the entry when they fit into 4 bytes
+QVector<quint32> DzGodotScanlineReader::readTiffValues(const uchar* pEntry)
+{
+	QVector<quint32> aValues;
+	int nType = tiff16(pEntry + 2);
+	quint32 nCount = tiff32(pEntry + 4);
+	int nSize = (nType == 3) ? 2 : (nType == 4) ? 4 : 0;
+	if (nSize == 0 || nCount == 0 || nCount > (1 << 24))
+	{
+		return aValues;
+	}
+	QByteArray aData;
+	if (nCount * nSize <= 4)
+	{
+		aData = QByteArray((const char*)pEntry + 8, 4);
+	}
+	else
+	{
+		qint64 nPosition = m_file.pos();
+		if (m_file.seek(tiff32(pEntry + 8)) == false)
+		{
+			return aValues;
+		}
+		aData = m_file.read(nCount * nSize);
+		m_file.seek(nPosition);
+		if (aData.size() < (int)(nCount * nSize))
+		{
+			return aValues;
+		}
+	}
+	const uchar* pData = (const uchar*)aData.constData();
+	for (quint32 i = 0; i < nCount; i++)
+	{
+		aValues.append(nSize == 2 ? tiff16(pData + i * 2) : tiff32(pData + i * 4));
+	}
+
+	return aValues;
+}
+
+// first image of a baseline TIFF: 8 or 16 bits per sample, gray or RGB with an optional
+// alpha, in strips which are uncompressed, LZW, Deflate or PackBits compressed
+bool DzGodotScanlineReader::openTiff()
+{
+	m_eFormat = Tiff;
+	QByteArray aHeader = m_file.read(8);
+	if (aHeader.size() < 8)
+	{
+		return fail("truncated TIFF header");
+	}
+	m_bBigEndian = aHeader[0] == 'M';
+	if (m_file.seek(tiff32((const uchar*)aHeader.constData() + 4)) == false)
+	{
+		return fail("truncated TIFF file");
+	}
+	QByteArray aCount = m_file.read(2);
+	if (aCount.size() < 2)
+	{
+		return fail("truncated TIFF file");
+	}
+	int nEntries = tiff16((const uchar*)aCount.constData());
+	QByteArray aEntries = m_file.read(nEntries * 12);
+	if (aEntries.size() < nEntries * 12)
+	{
+		return fail("truncated TIFF file");
+	}
+	int nWidth = 0, nHeight = 0, nPlanarConfig = 1, nSampleFormat = 1;
+	QVector<quint32> aBitsPerSample, aExtraSamples;
+	m_nSamples = 1;
+	m_nRowsPerStrip = 0;
+	for (int i = 0; i < nEntries; i++)
+	{
+		const uchar* pEntry = (const uchar*)aEntries.constData() + i * 12;
+		int nTag = tiff16(pEntry);
+		QVector<quint32> aValues = readTiffValues(pEntry);
+		quint32 nValue = aValues.isEmpty() ? 0 : aValues[0];
+		switch (nTag)
+		{
+		case 256: nWidth = (int)nValue; break;
+		case 257: nHeight = (int)nValue; break;
+		case 258: aBitsPerSample = aValues; break;
+		case 259: m_nCompression = (int)nValue; break;
+		case 262: m_nPhotometric = (int)nValue; break;
+		case 273: m_aStripOffsets = aValues; break;
+		case 277: m_nSamples = (int)nValue; break;
+		case 278: m_nRowsPerStrip = (int)qMin(nValue, (quint32)INT_MAX); break;
+		case 279: m_aStripByteCounts = aValues; break;
+		case 284: nPlanarConfig = (int)nValue; break;
+		case 317: m_nPredictor = (int)nValue; break;
+		case 322: return fail("tiled TIFF files are not supported");
+		case 338: aExtraSamples = aValues; break;
+		case 339: nSampleFormat = (int)nValue; break;
+		}
+	}
+	m_nBitsPerSample = aBitsPerSample.isEmpty() ? 1 : (int)aBitsPerSample[0];
+	foreach(quint32 nBits, aBitsPerSample)
+	{
+		if ((int)nBits != m_nBitsPerSample) return fail("unsupported TIFF bit depth");
+	}
+	bool bGray = (m_nPhotometric == 0 || m_nPhotometric == 1) && (m_nSamples == 1 || m_nSamples == 2);
+	bool bRgb = m_nPhotometric == 2 && (m_nSamples == 3 || m_nSamples == 4);
+	bool bCompression = m_nCompression == None || m_nCompression == Lzw || m_nCompression == Deflate || m_nCompression == AdobeDeflate || m_nCompression == PackBits;
+	if (nWidth <= 0 || nHeight <= 0 || (bGray || bRgb) == false || (m_nBitsPerSample != 8 && m_nBitsPerSample != 16) ||
+		nPlanarConfig != 1 || nSampleFormat != 1 || bCompression == false || (m_nPredictor != 1 && m_nPredictor != 2))
+	{
+		return fail("unsupported TIFF variant");
+	}
+	if (m_nRowsPerStrip <= 0 || m_nRowsPerStrip > nHeight)
+	{
+		m_nRowsPerStrip = nHeight;
+	}
+	int nStrips = (nHeight + m_nRowsPerStrip - 1) / m_nRowsPerStrip;
+	if (m_aStripOffsets.size() < nStrips || m_aStripByteCounts.size() < nStrips)
+	{
+		return fail("missing TIFF strips");
+	}
+	m_qSize = QSize(nWidth, nHeight);
+	m_bHasAlpha = (m_nSamples == 2 || m_nSamples == 4);
+	m_bPremultiplied = m_bHasAlpha && aExtraSamples.isEmpty() == false && aExtraSamples[0] == 1;
+	m_aRow.resize(nWidth * m_nSamples * m_nBitsPerSample / 8);
+	if (m_nCompression == Deflate || m_nCompression == AdobeDeflate)
+	{
+		// zlib streams are inflated one strip at a time
+		m_nScratchBytes = (qint64)m_nRowsPerStrip * m_aRow.size() + m_aStripByteCounts[0];
+	}
+	else if (m_nCompression == Lzw)
+	{
+		m_aLzwPrefix.resize(4096);
+		m_aLzwSuffix.resize(4096);
+		m_aLzwFirst.resize(4096);
+		m_aLzwLength.resize(4096);
+		m_aLzwString.resize(4096);
+		m_nScratchBytes = 4096 * 6;
+	}
+
+	return startStrip(0);
+}
+
+bool DzGodotScanlineReader::startStrip(int nStrip)
+{
+	if (m_file.seek(m_aStripOffsets[nStrip]) == false)
+	{
+		return fail("truncated TIFF file");
+	}
+	m_aInput.clear();
+	m_nInputPos = 0;
+	m_nInputLeft = m_aStripByteCounts[nStrip];
+	m_nRunLeft = 0;
+	m_nBitBuffer = 0;
+	m_nBitCount = 0;
+	resetLzw();
+	if (m_nCompression == Deflate || m_nCompression == AdobeDeflate)
+	{
+		int nRows = qMin(m_nRowsPerStrip, m_qSize.height() - nStrip * m_nRowsPerStrip);
+		quint32 nExpected = (quint32)nRows * m_aRow.size();
+		// qUncompress() expects the uncompressed size in front of the zlib stream
+		QByteArray aCompressed(4, 0);
+		aCompressed[0] = (char)(nExpected >> 24);
+		aCompressed[1] = (char)(nExpected >> 16);
+		aCompressed[2] = (char)(nExpected >> 8);
+		aCompressed[3] = (char)nExpected;
+		aCompressed.append(m_file.read(m_aStripByteCounts[nStrip]));
+		m_aStrip = qUncompress(aCompressed);
+		m_nStripPos = 0;
+		m_nInputLeft = 0;
+		if ((quint32)m_aStrip.size() < nExpected)
+		{
+			return fail("corrupt Deflate strip");
+		}
+	}
+
+	return true;
+}
+
+void DzGodotScanlineReader::resetLzw()
+{
+	for (int i = 0; i < 256 && i < m_aLzwPrefix.size(); i++)
+	{
+		m_aLzwSuffix[i] = (uchar)i;
+		m_aLzwFirst[i] = (uchar)i;
+		m_aLzwLength[i] = 1;
+	}
+	m_nLzwNextCode = 258;
+	m_nLzwWidth = 9;
+	m_nLzwPrevCode = -1;
+	m_nLzwStringPos = 0;
+	m_aLzwString.resize(0);
+}
+
+bool DzGodotScanlineReader::decodeLzw(uchar* pData, int nBytes)
+{
+	int n = 0;
+	while (n < nBytes)
+	{
+		// bytes left from the last code
+		if (m_nLzwStringPos < m_aLzwString.size())
+		{
+			int nCopy = qMin(nBytes - n, m_aLzwString.size() - m_nLzwStringPos);
+			memcpy(pData + n, m_aLzwString.constData() + m_nLzwStringPos, nCopy);
+			m_nLzwStringPos += nCopy;
+			n += nCopy;
+			continue;
+		}
+		while (m_nBitCount < m_nLzwWidth)
+		{
+			int nByte = nextByte();
+			if (nByte < 0)
+			{
+				return fail("unexpected end of LZW strip");
+			}
+			m_nBitBuffer = (m_nBitBuffer << 8) | (quint32)nByte;
+			m_nBitCount += 8;
+		}
+		int nCode = (int)((m_nBitBuffer >> (m_nBitCount - m_nLzwWidth)) & ((1u << m_nLzwWidth) - 1));
+		m_nBitCount -= m_nLzwWidth;
+		if (nCode == 256)
+		{
+			resetLzw();
+			continue;
+		}
+		if (nCode == 257 || nCode > m_nLzwNextCode || (m_nLzwPrevCode < 0 && nCode > 255))
+		{
+			return fail("corrupt LZW strip");
+		}
+		if (m_nLzwPrevCode >= 0 && m_nLzwNextCode < 4096)
+		{
+			// the new entry is the previous string followed by the first byte of this one
+			int nFirst = (nCode == m_nLzwNextCode) ? m_aLzwFirst[m_nLzwPrevCode] : m_aLzwFirst[nCode];
+			m_aLzwPrefix[m_nLzwNextCode] = (quint16)m_nLzwPrevCode;
+			m_aLzwSuffix[m_nLzwNextCode] = (uchar)nFirst;
+			m_aLzwFirst[m_nLzwNextCode] = m_aLzwFirst[m_nLzwPrevCode];
+			m_aLzwLength[m_nLzwNextCode] = m_aLzwLength[m_nLzwPrevCode] + 1;
+			m_nLzwNextCode++;
+			if (m_nLzwNextCode >= (1 << m_nLzwWidth) - 1 && m_nLzwWidth < 12)
+			{
+				m_nLzwWidth++;
+			}
+		}
+		int nLength = m_aLzwLength[nCode];
+		m_aLzwString.resize(nLength);
+		for (int i = nLength - 1, nEntry = nCode; i >= 0; i--, nEntry = m_aLzwPrefix[nEntry])
+		{
+			m_aLzwString[i] = (char)m_aLzwSuffix[nEntry];
+		}
+		m_nLzwStringPos = 0;
+		m_nLzwPrevCode = nCode;
+	}
+
+	return true;
+}
+
+bool DzGodotScanlineReader::unpackBits(uchar* pData, int nBytes)
+{
+	// runs may continue into the next row
+	for (int n = 0; n < nBytes; n++)
+	{
+		while (m_nRunLeft == 0)
+		{
+			int nHeader = nextByte();
+			if (nHeader < 0)
+			{
+				return fail("unexpected end of PackBits strip");
+			}
+			if (nHeader == 128)
+			{
+				continue;
+			}
+			m_bRunRepeat = nHeader > 128;
+			m_nRunLeft = m_bRunRepeat ? 257 - nHeader : nHeader + 1;
+			if (m_bRunRepeat && readBytes(m_aRunPixel, 1) == false)
+			{
+				return false;
+			}
+		}
+		if (m_bRunRepeat)
+		{
+			pData[n] = m_aRunPixel[0];
+		}
+		else if (readBytes(pData + n, 1) == false)
+		{
+			return false;
+		}
+		m_nRunLeft--;
+	}
+
+	return true;
+}
+
+bool DzGodotScanlineReader::readTiffRow()
+{
+	if (m_nRow > 0 && m_nRow % m_nRowsPerStrip == 0 && startStrip(m_nRow / m_nRowsPerStrip) == false)
+	{
+		return false;
+	}
+	uchar* pRow = (uchar*)m_aRow.data();
+	int nBytes = m_aRow.size();
+	bool bResult = true;
+	switch (m_nCompression)
+	{
+	case Lzw:
+		bResult = decodeLzw(pRow, nBytes);
+		break;
+	case PackBits:
+		bResult = unpackBits(pRow, nBytes);
+		break;
+	case Deflate:
+	case AdobeDeflate:
+		memcpy(pRow, m_aStrip.constData() + m_nStripPos, nBytes);
+		m_nStripPos += nBytes;
+		break;
+	default:
+		bResult = readBytes(pRow, nBytes);
+	}
+	if (bResult && m_nPredictor == 2)
+	{
+		// horizontal differencing
+		if (m_nBitsPerSample == 8)
+		{
+			for (int i = m_nSamples; i < nBytes; i++) pRow[i] = (uchar)(pRow[i] + pRow[i - m_nSamples]);
+		}
+		else
+		{
+			for (int i = m_nSamples * 2; i < nBytes; i += 2)
+			{
+				quint16 nValue = (quint16)(tiff16(pRow + i) + tiff16(pRow + i - m_nSamples * 2));
+				pRow[i] = (uchar)(m_bBigEndian ? nValue >> 8 : nValue);
+				pRow[i + 1] = (uchar)(m_bBigEndian ? nValue : nValue >> 8);
+			}
+		}
+	}
+
+	return bResult;
+}
+
+bool DzGodotScanlineReader::readRow(QRgb* pRow)
+{
+	if (m_nRow >= m_qSize.height())
+	{
+		return fail("read past the last row");
+	}
+	bool bResult = (m_eFormat == Tiff) ? readTiffRow() : (m_eFormat == Tga) ? readTgaRow() : readBytes((uchar*)m_aRow.data(), m_aRow.size());
+	if (bResult == false)
+	{
+		return false;
+	}
+	m_nRow++;
+
+	const uchar* pData = (const uchar*)m_aRow.constData();
+	int nWidth = m_qSize.width();
+	if (m_eFormat != Tiff)
+	{
+		// BGR(A) or gray
+		for (int x = 0; x < nWidth; x++, pData += m_nBytesPerPixel)
+		{
+			if (m_nBytesPerPixel == 1) pRow[x] = qRgb(pData[0], pData[0], pData[0]);
+			else pRow[x] = qRgba(pData[2], pData[1], pData[0], m_bHasAlpha ? pData[3] : 255);
+		}
+		return true;
+	}
+	// 16 bit samples keep their high byte
+	int nSampleBytes = m_nBitsPerSample / 8;
+	int nHighByte = (nSampleBytes == 2 && m_bBigEndian == false) ? 1 : 0;
+	for (int x = 0; x < nWidth; x++, pData += m_nSamples * nSampleBytes)
+	{
+		int aSamples[4];
+		for (int c = 0; c < m_nSamples; c++) aSamples[c] = pData[c * nSampleBytes + nHighByte];
+		int nRed, nGreen, nBlue, nAlpha = 255;
+		if (m_nSamples <= 2)
+		{
+			nRed = nGreen = nBlue = (m_nPhotometric == 0) ? 255 - aSamples[0] : aSamples[0];
+		}
+		else
+		{
+			nRed = aSamples[0];
+			nGreen = aSamples[1];
+			nBlue = aSamples[2];
+		}
+		if (m_bHasAlpha)
+		{
+			nAlpha = aSamples[m_nSamples - 1];
+			if (m_bPremultiplied && nAlpha > 0 && nAlpha < 255)
+			{
+				nRed = qMin(255, nRed * 255 / nAlpha);
+				nGreen = qMin(255, nGreen * 255 / nAlpha);
+				nBlue = qMin(255, nBlue * 255 / nAlpha);
+			}
+		}
+		pRow[x] = qRgba(nRed, nGreen, nBlue, nAlpha);
+	}
+
+	return true;
+}
+
+DzGodotTextureStage::DzGodotTextureStage(QObject* parent) :
+	QObject(parent)
+{
+}
+
+void DzGodotTextureStage::setCacheSize(int nMegabytes)
+{
+	QMutexLocker locker(&s_cacheMutex);
+	int nKilobytes = qMax(nMegabytes, 0) * 1024;
+	s_decodedCache.setMaxCost(nKilobytes - nKilobytes / 4);
+	s_encodedCache.setMaxCost(nKilobytes / 4);
+}
+
+int DzGodotTextureStage::getCacheSize()
+{
+	QMutexLocker locker(&s_cacheMutex);
+	return (s_decodedCache.maxCost() + s_encodedCache.maxCost()) / 1024;
+}
+
+void DzGodotTextureStage::clearCache()
+{
+	QMutexLocker locker(&s_cacheMutex);
+	s_decodedCache.clear();
+	s_encodedCache.clear();
+}
+
+QString DzGodotTextureStage::getSourceKey(const QFileInfo& sourceInfo)
+{
+	return QString("%1|%2|%3").arg(sourceInfo.absoluteFilePath()).arg(sourceInfo.lastModified().toMSecsSinceEpoch()).arg(sourceInfo.size());
+}
+
+QString DzGodotTextureStage::getOptionsKey(QSize qTargetSize)
+{
+	return QString("%1x%2").arg(qTargetSize.width()).arg(qTargetSize.height());
+}
+
+// Keeps the source filename when possible, textures with the same name from different
+// folders get a short path hash appended
+QString DzGodotTextureStage::getOutputFilename(const QFileInfo& sourceInfo)
+{
+	QString sSuffix = sourceInfo.suffix().toLower();
+	if (sSuffix != "png" && sSuffix != "jpg" && sSuffix != "jpeg")
+	{
+		sSuffix = "png";
+	}
+	QString sSourcePath = sourceInfo.absoluteFilePath();
+	QString sFilename = sourceInfo.completeBaseName() + "." + sSuffix;
+	if (m_aClaimedFilenames.contains(sFilename) && m_aClaimedFilenames[sFilename] != sSourcePath)
+	{
+		QString sHash = QCryptographicHash::hash(sSourcePath.toUtf8(), QCryptographicHash::Sha1).toHex().left(8);
+		sFilename = sourceInfo.completeBaseName() + "_" + sHash + "." + sSuffix;
+	}
+	m_aClaimedFilenames[sFilename] = sSourcePath;
+
+	return sFilename;
+}
+
+// "2k/<name>.<ext>" below the folder of the converted texture, as found by
+// blender_tools.swap_lowres_filename().  A subfolder can not collide with a source texture
+// which already ends in "_2k", the output folder only holds files.
+QString DzGodotTextureStage::getVariantFilename(QString sOutputPath, int nVariantSize)
+{
+	QFileInfo outputInfo(sOutputPath);
+	return outputInfo.path() + QString("/%1k/").arg(nVariantSize / 1024) + outputInfo.fileName();
+}
+
+QSize DzGodotTextureStage::getDecodeSize(QSize qSourceSize, QSize qTargetSize)
+{
+	if (qSourceSize.width() <= qTargetSize.width() && qSourceSize.height() <= qTargetSize.height())
+	{
+		return qSourceSize;
+	}
+	return qSourceSize.scaled(qTargetSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+}
+
+DzGodotTextureProbe DzGodotTextureStage::probeTexture(const QFileInfo& sourceInfo)
+{
+	DzGodotTextureProbe probe;
+	QImageReader reader(sourceInfo.absoluteFilePath());
+	probe.qSize = reader.size();
+	probe.sFormat = QString(reader.format()).toLower();
+	probe.bValid = reader.canRead() && probe.qSize.isValid();
+	if (probe.bValid)
+	{
+		probe.nBitDepth = readHeaderBitDepth(sourceInfo.absoluteFilePath(), probe.sFormat);
+	}
+
+	return probe;
+}
+
+// Bits per channel as stored in the file, the image plugins of Qt decode everything to 8 bits.
+// Reads the IHDR chunk of PNG files and walks the markers of JPEG files up to the frame header,
+// returns 0 for other formats or when the header can not be read.
+int DzGodotTextureStage::readHeaderBitDepth(QString sSourcePath, QString sFormat)
+{
+	QFile file(sSourcePath);
+	if (file.open(QIODevice::ReadOnly) == false)
+	{
+		return 0;
+	}
+	if (sFormat == "png")
+	{
+		QByteArray header = file.read(26);
+		return (header.size() == 26 && header.mid(12, 4) == "IHDR") ? (uchar)header[24] : 0;
+	}
+	if (sFormat != "jpeg" || file.read(2) != QByteArray("\xFF\xD8", 2))
+	{
+		return 0;
+	}
+	while (file.atEnd() == false)
+	{
+		QByteArray marker = file.read(4);
+		if (marker.size() < 4 || (uchar)marker[0] != 0xFF)
+		{
+			return 0;
+		}
+		uchar nMarker = (uchar)marker[1];
+		int nLength = ((uchar)marker[2] << 8) | (uchar)marker[3];
+		// SOF0 to SOF15, except DHT, JPG and DAC
+		if (nMarker >= 0xC0 && nMarker <= 0xCF && nMarker != 0xC4 && nMarker != 0xC8 && nMarker != 0xCC)
+		{
+			QByteArray precision = file.read(1);
+			return precision.size() == 1 ? (uchar)precision[0] : 0;
+		}
+		if (nMarker == 0xDA || nLength < 2 || file.seek(file.pos() + nLength - 2) == false)
+		{
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+// 8 bit PNG and JPG files at or below the target size need no work, everything else is decoded.
+// With recompression on, PNG and JPG files larger than the threshold are re-encoded as well.
+// Files whose content does not match their extension are converted to the extension's format.
+DzGodotTextureStage::TextureAction DzGodotTextureStage::classifyTexture(const QFileInfo& sourceInfo, const DzGodotTextureProbe& probe)
+{
+	if (probe.bValid == false)
+	{
+		return Convert;
+	}
+	if (getDecodeSize(probe.qSize, m_qTargetTextureSize) != probe.qSize)
+	{
+		return Resize;
+	}
+	// 12 bit JPEG and 16 bit PNG channels are reduced to 8 bits
+	if (probe.nBitDepth > 8)
+	{
+		return Convert;
+	}
+	if (m_bRecompressLargeFiles && sourceInfo.size() > (qint64)m_nRecompressThreshold)
+	{
+		return Convert;
+	}
+	QString sSuffix = sourceInfo.suffix().toLower();
+	if (probe.sFormat == "png" && sSuffix == "png")
+	{
+		return PassThrough;
+	}
+	if (probe.sFormat == "jpeg" && (sSuffix == "jpg" || sSuffix == "jpeg"))
+	{
+		return PassThrough;
+	}
+
+	return Convert;
+}
+
+// Hard links the source into the output folder, falls back to a copy across volumes
+bool DzGodotTextureStage::linkTexture(QString sSourcePath, QString sOutputPath)
+{
+#ifdef WIN32
+	bool bResult = CreateHardLinkW((LPCWSTR)QDir::toNativeSeparators(sOutputPath).utf16(), (LPCWSTR)QDir::toNativeSeparators(sSourcePath).utf16(), NULL) != 0;
+#else
+	bool bResult = ::link(QFile::encodeName(sSourcePath).constData(), QFile::encodeName(sOutputPath).constData()) == 0;
+#endif
+	if (bResult == false)
+	{
+		bResult = QFile::copy(sSourcePath, sOutputPath);
+	}
+
+	return bResult;
+}
+
+// Blocks until the bytes fit into the memory budget, requests larger than the whole budget
+// are clamped so that they run alone.  Decoded images in the cache count against the same
+// budget and are dropped, least recently used first, to make room.
+// Returns the reserved amount for releaseMemory().
+qint64 DzGodotTextureStage::acquireMemory(qint64 nBytes)
+{
+	qint64 nBudget = (qint64)qMax(m_nMemoryBudget, 1) * 1024 * 1024;
+	nBytes = qMin(nBytes, nBudget);
+	QMutexLocker locker(&m_oMutex);
+	while (m_nBytesInFlight > 0 && m_nBytesInFlight + nBytes > nBudget)
+	{
+		m_oMemoryAvailable.wait(&m_oMutex);
+	}
+	m_nBytesInFlight += nBytes;
+	m_nPeakBytesInFlight = qMax(m_nPeakBytesInFlight, m_nBytesInFlight);
+	QMutexLocker cacheLocker(&s_cacheMutex);
+	trimDecodedCache(nBudget - m_nBytesInFlight);
+
+	return nBytes;
+}
+
+// Drops decoded images until the cache holds at most nBytes, called with s_cacheMutex locked
+void DzGodotTextureStage::trimDecodedCache(qint64 nBytes)
+{
+	int nMaxCost = s_decodedCache.maxCost();
+	s_decodedCache.setMaxCost((int)qBound((qint64)0, nBytes / 1024, (qint64)nMaxCost));
+	s_decodedCache.setMaxCost(nMaxCost);
+}
+
+void DzGodotTextureStage::releaseMemory(qint64 nBytes)
+{
+	QMutexLocker locker(&m_oMutex);
+	m_nBytesInFlight -= nBytes;
+	m_oMemoryAvailable.wakeAll();
+}
+
+void DzGodotTextureStage::addError(QString sMessage)
+{
+	QMutexLocker locker(&m_oMutex);
+	m_aErrors.append(sMessage);
+}
+
+void DzGodotTextureStage::logErrors()
+{
+	QMutexLocker locker(&m_oMutex);
+	foreach(QString sMessage, m_aErrors)
+	{
+		dzApp->log(sMessage);
+	}
+	m_aErrors.clear();
+}
+
+// Downsamples the rows of the reader into an image of the decode size, with a box filter.
+// Only the output image, one source row and the sums of one output row are in memory.
+bool DzGodotTextureStage::decodeScanlines(DzGodotScanlineReader& reader, QImage& image, QSize qDecodeSize)
+{
+	QSize qSourceSize = reader.getSize();
+	int nWidth = qDecodeSize.width();
+	QImage result(qDecodeSize, reader.hasAlpha() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+	QVector<QRgb> aRow(qSourceSize.width());
+	QVector<int> aColumns(qSourceSize.width()); // source column -> output column
+	QVector<int> aColumnCounts(nWidth, 0);
+	for (int x = 0; x < qSourceSize.width(); x++)
+	{
+		aColumns[x] = (int)((qint64)x * nWidth / qSourceSize.width());
+		aColumnCounts[aColumns[x]]++;
+	}
+	QVector<quint64> aSums(nWidth * 4, 0);
+	int nOutputRow = -1;
+	int nRows = 0;
+	for (int i = 0; i <= qSourceSize.height(); i++)
+	{
+		// bottom up files fill the output from the last row
+		int y = reader.isBottomUp() ? qSourceSize.height() - 1 - i : i;
+		int nRow = (i < qSourceSize.height()) ? (int)((qint64)y * qDecodeSize.height() / qSourceSize.height()) : -1;
+		if (nRow != nOutputRow && nRows > 0)
+		{
+			QRgb* pOutput = (QRgb*)result.scanLine(nOutputRow);
+			for (int x = 0; x < nWidth; x++)
+			{
+				quint64 nCount = (quint64)aColumnCounts[x] * nRows;
+				const quint64* pSums = &aSums[x * 4];
+				pOutput[x] = qRgba((int)((pSums[0] + nCount / 2) / nCount), (int)((pSums[1] + nCount / 2) / nCount), (int)((pSums[2] + nCount / 2) / nCount), (int)((pSums[3] + nCount / 2) / nCount));
+			}
+			aSums.fill(0);
+			nRows = 0;
+		}
+		if (nRow < 0)
+		{
+			break;
+		}
+		nOutputRow = nRow;
+		if (reader.readRow(aRow.data()) == false)
+		{
+			return false;
+		}
+		for (int x = 0; x < qSourceSize.width(); x++)
+		{
+			QRgb pixel = aRow[x];
+			quint64* pSums = &aSums[aColumns[x] * 4];
+			pSums[0] += qRed(pixel);
+			pSums[1] += qGreen(pixel);
+			pSums[2] += qBlue(pixel);
+			pSums[3] += qAlpha(pixel);
+		}
+		nRows++;
+	}
+	image = result;
+
+	return true;
+}
+
+// Decodes the source at the target size.  JPEG is scaled by the image plugin while decoding,
+// BMP, TGA and TIFF are read one row at a time and downsampled as the rows arrive, so the
+// full resolution image is never held for them.  Other formats (PNG) and unsupported variants
+// are decoded at full resolution, alone if they do not fit into the budget.
+// The decoded image stays reserved in the budget until the caller releases pReserved,
+// without pReserved it is released on return.
+bool DzGodotTextureStage::decodeTexture(const QFileInfo& sourceInfo, QImage& image, QSize qTargetSize, qint64* pReserved)
+{
+	if (pReserved)
+	{
+		*pReserved = 0;
+	}
+	QString sSourcePath = sourceInfo.absoluteFilePath();
+	QImageReader reader(sSourcePath);
+	QSize qSourceSize = reader.size(); // header only
+	QSize qDecodeSize = qSourceSize.isValid() ? getDecodeSize(qSourceSize, qTargetSize) : QSize();
+	QString sDecodedKey = QString("%1|%2x%3").arg(getSourceKey(sourceInfo)).arg(qDecodeSize.width()).arg(qDecodeSize.height());
+
+	{
+		QMutexLocker locker(&s_cacheMutex);
+		QImage* pCachedImage = s_decodedCache.object(sDecodedKey);
+		if (pCachedImage)
+		{
+			image = *pCachedImage;
+			return true;
+		}
+	}
+
+	qint64 nBudget = (qint64)qMax(m_nMemoryBudget, 1) * 1024 * 1024;
+	qint64 nSourceBytes = qSourceSize.isValid() ? (qint64)qSourceSize.width() * qSourceSize.height() * 4 : nBudget;
+	qint64 nDecodeBytes = qDecodeSize.isValid() ? (qint64)qDecodeSize.width() * qDecodeSize.height() * 4 : nBudget;
+	bool bScaled = (qDecodeSize != qSourceSize);
+	// only the JPEG plugin decodes at a reduced size, the others report ScaledSize but decode
+	// the full image and scale it afterwards
+	bool bNativeScaling = bScaled && reader.format() == "jpeg" && reader.supportsOption(QImageIOHandler::ScaledSize);
+	DzGodotScanlineReader scanlineReader;
+	bool bScanlines = bScaled && !bNativeScaling && scanlineReader.open(sSourcePath) && scanlineReader.getSize() == qSourceSize;
+
+	qint64 nReserved = 0;
+	bool bResult = false;
+	QString sError = "";
+	if (bScanlines)
+	{
+		// the scratch memory is released with the reader, the decoded image stays reserved
+		qint64 nScratchBytes = scanlineReader.getScratchBytes() + (qint64)qSourceSize.width() * 4 + (qint64)qDecodeSize.width() * 32;
+		nReserved = acquireMemory(nDecodeBytes + nScratchBytes);
+		bResult = decodeScanlines(scanlineReader, image, qDecodeSize);
+		sError = scanlineReader.getError();
+		qint64 nScratchReserved = qMax(nReserved - nDecodeBytes, (qint64)0);
+		releaseMemory(nScratchReserved);
+		nReserved -= nScratchReserved;
+	}
+	else
+	{
+		// native scaling decodes at up to twice the target size before the final scale, the
+		// other plugins hold the full source image and the scaled copy
+		nReserved = acquireMemory(bNativeScaling ? nDecodeBytes * 5 : nSourceBytes + nDecodeBytes);
+		if (bScaled)
+		{
+			reader.setScaledSize(qDecodeSize);
+		}
+		bResult = reader.read(&image);
+		sError = reader.errorString();
+		if (bResult && qDecodeSize.isValid() == false)
+		{
+			// no size in the header, scale after decoding
+			image = image.scaled(getDecodeSize(image.size(), qTargetSize), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		}
+		qint64 nImageBytes = bResult ? qMin((qint64)image.byteCount(), nReserved) : 0;
+		releaseMemory(nReserved - nImageBytes);
+		nReserved = nImageBytes;
+	}
+	if (bResult == false)
+	{
+		releaseMemory(nReserved);
+		addError(QString("ERROR: DazToGodot: unable to read texture: %1 (%2)").arg(sSourcePath).arg(sError));
+		return false;
+	}
+
+	{
+		QMutexLocker locker(&m_oMutex);
+		m_nDecodes++;
+		QMutexLocker cacheLocker(&s_cacheMutex);
+		s_decodedCache.insert(sDecodedKey, new QImage(image), qMax(image.byteCount() / 1024, 1));
+		// the new image is reserved in flight already
+		trimDecodedCache(nBudget - m_nBytesInFlight + nReserved);
+	}
+	if (pReserved)
+	{
+		*pReserved = nReserved;
+	}
+	else
+	{
+		releaseMemory(nReserved);
+	}
+
+	return true;
+}
+
+bool DzGodotTextureStage::encodeTexture(const QFileInfo& sourceInfo, QByteArray& encodedData, QSize qTargetSize)
+{
+	QString sSuffix = sourceInfo.suffix().toLower();
+	QImage image;
+	qint64 nReserved = 0;
+	if (decodeTexture(sourceInfo, image, qTargetSize, &nReserved) == false)
+	{
+		return false;
+	}
+
+	QBuffer buffer(&encodedData);
+	buffer.open(QIODevice::WriteOnly);
+	bool bJpeg = (sSuffix == "jpg" || sSuffix == "jpeg");
+	QImageWriter writer(&buffer, bJpeg ? "jpg" : "png");
+	if (bJpeg)
+	{
+		writer.setQuality(90);
+	}
+	bool bResult = writer.write(image);
+	image = QImage();
+	releaseMemory(nReserved);
+	if (bResult == false)
+	{
+		addError(QString("ERROR: DazToGodot: unable to encode texture: %1 (%2)").arg(sourceInfo.absoluteFilePath()).arg(writer.errorString()));
+		return false;
+	}
+
+	return true;
+}
+
+bool DzGodotTextureStage::convertTexture(QString sSourcePath, QString sOutputPath)
+{
+	QFileInfo sourceInfo(sSourcePath);
+	// the output of a previous export may be a link to the source, never write through it
+	QFile::remove(sOutputPath);
+
+	DzGodotTextureProbe probe = probeTexture(sourceInfo);
+	if (classifyTexture(sourceInfo, probe) == PassThrough && linkTexture(sSourcePath, sOutputPath))
+	{
+		QMutexLocker locker(&m_oMutex);
+		m_nPassThrough++;
+	}
+	else if (writeTexture(sourceInfo, sOutputPath, m_qTargetTextureSize) == false)
+	{
+		return false;
+	}
+
+	// variants are only written when smaller than the converted texture, otherwise
+	// swap_lowres_filename() falls back to the converted texture
+	QSize qOutputSize = probe.bValid ? getDecodeSize(probe.qSize, m_qTargetTextureSize) : m_qTargetTextureSize;
+	foreach(int nVariantSize, m_aVariantSizes)
+	{
+		QString sVariantPath = getVariantFilename(sOutputPath, nVariantSize);
+		QFile::remove(sVariantPath);
+		if (qMax(qOutputSize.width(), qOutputSize.height()) <= nVariantSize)
+		{
+			continue;
+		}
+		writeTexture(sourceInfo, sVariantPath, QSize(nVariantSize, nVariantSize));
+	}
+
+	return true;
+}
+
+bool DzGodotTextureStage::writeTexture(const QFileInfo& sourceInfo, QString sOutputPath, QSize qTargetSize)
+{
+	QString sEncodedKey = getSourceKey(sourceInfo) + "|" + getOptionsKey(qTargetSize);
+	QByteArray encodedData;
+	bool bCached = false;
+	{
+		QMutexLocker locker(&s_cacheMutex);
+		QByteArray* pCachedData = s_encodedCache.object(sEncodedKey);
+		if (pCachedData)
+		{
+			encodedData = *pCachedData;
+			bCached = true;
+		}
+	}
+	if (bCached)
+	{
+		QMutexLocker locker(&m_oMutex);
+		m_nCacheHits++;
+	}
+	else
+	{
+		if (encodeTexture(sourceInfo, encodedData, qTargetSize) == false)
+		{
+			return false;
+		}
+		QMutexLocker locker(&s_cacheMutex);
+		s_encodedCache.insert(sEncodedKey, new QByteArray(encodedData), qMax(encodedData.size() / 1024, 1));
+	}
+
+	QFile outputFile(sOutputPath);
+	if (outputFile.open(QIODevice::WriteOnly) == false)
+	{
+		addError("ERROR: DazToGodot: unable to write texture: " + sOutputPath);
+		return false;
+	}
+	outputFile.write(encodedData);
+	outputFile.close();
+
+	return true;
+}
+
+// Converts one texture into the output folder and returns the converted path,
+// or an empty string if the texture could not be converted
+QString DzGodotTextureStage::processTexture(QString sSourcePath)
+{
+	QFileInfo sourceInfo(sSourcePath);
+	if (sSourcePath.isEmpty() || sourceInfo.exists() == false || m_sOutputFolder.isEmpty())
+	{
+		return "";
+	}
+
+	QString sOutputPath = m_sOutputFolder + "/" + getOutputFilename(sourceInfo);
+	bool bResult = convertTexture(sSourcePath, sOutputPath);
+	logErrors();
+
+	return bResult ? sOutputPath : "";
+}
+
+// Returns the texture files used by the materials of the node and its children
+QStringList DzGodotTextureStage::collectTextures(DzNode* pNode)
+{
+	QStringList aTextures;
+	if (pNode == nullptr)
+	{
+		return aTextures;
+	}
+
+	QList<DzNode*> aNodes;
+	aNodes.append(pNode);
+	aNodes.append(pNode->getNodeChildren(true));
+	foreach(DzNode* pChild, aNodes)
+	{
+		DzObject* pObject = pChild->getObject();
+		DzShape* pShape = pObject ? pObject->getCurrentShape() : nullptr;
+		if (pShape == nullptr)
+		{
+			continue;
+		}
+		for (int i = 0; i < pShape->getNumMaterials(); i++)
+		{
+			DzMaterial* pMaterial = pShape->getMaterial(i);
+			if (pMaterial == nullptr)
+			{
+				continue;
+			}
+			for (int j = 0; j < pMaterial->getNumProperties(); j++)
+			{
+				DzProperty* pProperty = pMaterial->getProperty(j);
+				QString sFilename = "";
+				DzImageProperty* pImageProperty = qobject_cast<DzImageProperty*>(pProperty);
+				DzNumericProperty* pNumericProperty = qobject_cast<DzNumericProperty*>(pProperty);
+				if (pImageProperty && pImageProperty->getValue())
+				{
+					sFilename = pImageProperty->getValue()->getFilename();
+				}
+				else if (pNumericProperty && pNumericProperty->getMapValue())
+				{
+					sFilename = pNumericProperty->getMapValue()->getFilename();
+				}
+				if (sFilename.isEmpty() == false && aTextures.contains(sFilename) == false)
+				{
+					aTextures.append(sFilename);
+				}
+			}
+		}
+	}
+
+	return aTextures;
+}
+
+// Converts all textures of the node in parallel, returns a map of source path -> converted path
+QMap<QString, QString> DzGodotTextureStage::processNode(DzNode* pNode)
+{
+	QList<DzNode*> aNodes;
+	aNodes.append(pNode);
+	return processNodes(aNodes);
+}
+
+// Converts the textures of several nodes in one pass, so textures shared between them are converted once
+QMap<QString, QString> DzGodotTextureStage::processNodes(const QList<DzNode*>& aNodes)
+{
+	QMap<QString, QString> aTextureRemap;
+	QDir().mkpath(m_sOutputFolder);
+	// the variant folders also tell swap_lowres_filename() that "_2k" files are no variants
+	foreach(int nVariantSize, m_aVariantSizes)
+	{
+		QDir().mkpath(QFileInfo(getVariantFilename(m_sOutputFolder + "/", nVariantSize)).path());
+	}
+	m_aClaimedFilenames.clear();
+	m_nCacheHits = 0;
+	m_nDecodes = 0;
+	m_nPassThrough = 0;
+	m_nFailed = 0;
+	m_nPeakBytesInFlight = 0;
+
+	QTime timer;
+	timer.start();
+	QStringList aTextures;
+	foreach(DzNode* pNode, aNodes)
+	{
+		foreach(QString sSourcePath, collectTextures(pNode))
+		{
+			if (aTextures.contains(sSourcePath) == false) aTextures.append(sSourcePath);
+		}
+	}
+	QList<DzGodotTextureJob*> aJobs;
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount(QThread::idealThreadCount());
+	foreach(QString sSourcePath, aTextures)
+	{
+		QFileInfo sourceInfo(sSourcePath);
+		if (sourceInfo.exists() == false)
+		{
+			continue;
+		}
+		DzGodotTextureJob* pJob = new DzGodotTextureJob(this, sSourcePath, m_sOutputFolder + "/" + getOutputFilename(sourceInfo));
+		aJobs.append(pJob);
+		threadPool.start(pJob);
+	}
+	threadPool.waitForDone();
+	foreach(DzGodotTextureJob* pJob, aJobs)
+	{
+		if (pJob->m_bResult)
+		{
+			aTextureRemap[pJob->m_sSourcePath] = pJob->m_sOutputPath;
+		}
+		else
+		{
+			m_nFailed++;
+		}
+		delete pJob;
+	}
+	logErrors();
+	dzApp->log(QString("DazToGodot: texture stage: %1 textures, %2 passed through, %3 from cache, %4 decoded, peak %5 MB, %6 ms").arg(aTextures.count()).arg(m_nPassThrough).arg(m_nCacheHits).arg(m_nDecodes).arg(getPeakMemory()).arg(timer.elapsed()));
+
+	return aTextureRemap;
+}
+
+#include "moc_DzGodotTextureStage.cpp"
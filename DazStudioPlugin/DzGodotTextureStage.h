@@ -0,0 +1,134 @@
+#pragma once
+#include <QtCore/qobject.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qsize.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+#include <QtGui/qimage.h>
+
+class DzNode;
+class DzGodotScanlineReader;
+class UnitTest_DzGodotTextureStage;
+
+// Texture properties read from the file header, without decoding the pixels
+struct DzGodotTextureProbe
+{
+	bool bValid = false;
+	QString sFormat = ""; // detected from the content, e.g. "png", "jpeg", "tiff"
+	QSize qSize;
+	int nBitDepth = 0; // bits per channel in the PNG or JPEG header, 0 for other formats
+};
+
+/*
+ * Converts the source textures of exported materials into the intermediate folder.
+ * Decoded images and converted files are kept in a session-wide LRU cache, keyed by
+ * source path + modification time + conversion options, so consecutive exports of
+ * figures sharing textures skip most of the decode, resize and encode work.
+ *
+ * Textures are converted in parallel.  Each texture reserves its estimated decode memory
+ * from a byte budget before decoding, and large sources are downsampled while decoding
+ * (natively by the image plugin for JPEG, row by row for BMP, TGA and TIFF), so peak
+ * memory for these depends on the budget and the target size instead of the source
+ * resolution.  PNG and the remaining formats are decoded at full resolution and
+ * reserve the full image, a source larger than the budget is decoded alone.
+ * Cached decoded images count against the same budget.
+ *
+ * 8 bit PNG and JPG sources which already fit the target size, and are below the
+ * recompression threshold when recompression is on, are linked into the output folder
+ * instead of being decoded and re-encoded.  Optional low resolution variants are written
+ * to "2k" and "1k" subfolders of the output folder, with the name of the converted texture.
+ */
+class DzGodotTextureStage : public QObject {
+	Q_OBJECT
+	Q_PROPERTY(QString sOutputFolder READ getOutputFolder WRITE setOutputFolder)
+	Q_PROPERTY(QSize qTargetTextureSize READ getTargetTextureSize WRITE setTargetTextureSize)
+	Q_PROPERTY(int nMemoryBudget READ getMemoryBudget WRITE setMemoryBudget)
+	Q_PROPERTY(bool bRecompressLargeFiles READ getRecompressLargeFiles WRITE setRecompressLargeFiles)
+	Q_PROPERTY(int nRecompressThreshold READ getRecompressThreshold WRITE setRecompressThreshold)
+public:
+	enum TextureAction { PassThrough = 0, Resize, Convert };
+
+	DzGodotTextureStage(QObject* parent = nullptr);
+	virtual ~DzGodotTextureStage() {}
+
+	Q_INVOKABLE QString getOutputFolder() { return this->m_sOutputFolder; };
+	Q_INVOKABLE void setOutputFolder(QString arg_sFolder) { this->m_sOutputFolder = arg_sFolder; };
+	Q_INVOKABLE QSize getTargetTextureSize() { return this->m_qTargetTextureSize; };
+	Q_INVOKABLE void setTargetTextureSize(QSize arg_qSize) { this->m_qTargetTextureSize = arg_qSize; };
+	Q_INVOKABLE int getMemoryBudget() { return this->m_nMemoryBudget; };
+	Q_INVOKABLE void setMemoryBudget(int arg_nMegabytes) { this->m_nMemoryBudget = arg_nMegabytes; };
+	Q_INVOKABLE bool getRecompressLargeFiles() { return this->m_bRecompressLargeFiles; };
+	Q_INVOKABLE void setRecompressLargeFiles(bool arg_bRecompress) { this->m_bRecompressLargeFiles = arg_bRecompress; };
+	Q_INVOKABLE int getRecompressThreshold() { return this->m_nRecompressThreshold; };
+	Q_INVOKABLE void setRecompressThreshold(int arg_nBytes) { this->m_nRecompressThreshold = arg_nBytes; };
+	QList<int> getVariantSizes() { return this->m_aVariantSizes; };
+	void setVariantSizes(QList<int> arg_aSizes) { this->m_aVariantSizes = arg_aSizes; };
+
+	Q_INVOKABLE QStringList collectTextures(DzNode* pNode);
+	Q_INVOKABLE QString processTexture(QString sSourcePath);
+	QMap<QString, QString> processNode(DzNode* pNode);
+	QMap<QString, QString> processNodes(const QList<DzNode*>& aNodes);
+
+	// session-wide cache, shared by all texture stages
+	Q_INVOKABLE static void setCacheSize(int nMegabytes);
+	Q_INVOKABLE static int getCacheSize();
+	Q_INVOKABLE static void clearCache();
+
+	Q_INVOKABLE int getNumCacheHits() { return this->m_nCacheHits; };
+	Q_INVOKABLE int getNumDecodes() { return this->m_nDecodes; };
+	Q_INVOKABLE int getNumPassThrough() { return this->m_nPassThrough; };
+	Q_INVOKABLE int getNumFailed() { return this->m_nFailed; };
+	Q_INVOKABLE int getPeakMemory() { return (int)(this->m_nPeakBytesInFlight / (1024 * 1024)); };
+
+	// thread-safe, called by the worker threads of processNode()
+	bool convertTexture(QString sSourcePath, QString sOutputPath);
+
+protected:
+	QString m_sOutputFolder = "";
+	QSize m_qTargetTextureSize = QSize(4096, 4096);
+	int m_nMemoryBudget = 1024; // megabytes of decoded image data in flight
+	bool m_bRecompressLargeFiles = false;
+	int m_nRecompressThreshold = 1024 * 1024; // bytes, larger PNG and JPG files are re-encoded
+	QList<int> m_aVariantSizes; // e.g. 2048, 1024 for the "2k" and "1k" variant subfolders
+	int m_nCacheHits = 0;
+	int m_nDecodes = 0;
+	int m_nPassThrough = 0;
+	int m_nFailed = 0; // textures which could not be converted, they are left out of the remap
+	QMap<QString, QString> m_aClaimedFilenames; // output filename -> source path
+	QStringList m_aErrors; // logged from the calling thread
+
+	QMutex m_oMutex; // guards statistics, errors and the memory budget
+	QWaitCondition m_oMemoryAvailable;
+	qint64 m_nBytesInFlight = 0;
+	qint64 m_nPeakBytesInFlight = 0;
+
+	QString getOptionsKey(QSize qTargetSize);
+	QString getSourceKey(const QFileInfo& sourceInfo);
+	QString getOutputFilename(const QFileInfo& sourceInfo);
+	QString getVariantFilename(QString sOutputPath, int nVariantSize);
+	QSize getDecodeSize(QSize qSourceSize, QSize qTargetSize);
+	DzGodotTextureProbe probeTexture(const QFileInfo& sourceInfo);
+	int readHeaderBitDepth(QString sSourcePath, QString sFormat);
+	TextureAction classifyTexture(const QFileInfo& sourceInfo, const DzGodotTextureProbe& probe);
+	bool linkTexture(QString sSourcePath, QString sOutputPath);
+	bool decodeTexture(const QFileInfo& sourceInfo, QImage& image, QSize qTargetSize, qint64* pReserved = nullptr);
+	bool decodeScanlines(DzGodotScanlineReader& reader, QImage& image, QSize qDecodeSize);
+	bool encodeTexture(const QFileInfo& sourceInfo, QByteArray& encodedData, QSize qTargetSize);
+	bool writeTexture(const QFileInfo& sourceInfo, QString sOutputPath, QSize qTargetSize);
+	qint64 acquireMemory(qint64 nBytes);
+	void releaseMemory(qint64 nBytes);
+	static void trimDecodedCache(qint64 nBytes);
+	void addError(QString sMessage);
+	void logErrors();
+
+	static QMutex s_cacheMutex;
+	static QCache<QString, QImage> s_decodedCache; // source key + decode size -> decoded image
+	static QCache<QString, QByteArray> s_encodedCache; // source key + options -> converted file data
+
+#ifdef UNITTEST_DZBRIDGE
+	friend class UnitTest_DzGodotTextureStage;
+#endif
+};
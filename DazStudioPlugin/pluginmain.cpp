@@ -25,8 +25,10 @@ NEW_PLUGIN_CUSTOM_CLASS_GUID(DzGodotDialog, ab0c9f63-4adc-4a6c-bc55-41bc2a4eccb3
 
 #include "UnitTest_DzGodotAction.h"
 #include "UnitTest_DzGodotDialog.h"
+#include "UnitTest_DzGodotTextureStage.h"
 
 DZ_PLUGIN_CLASS_GUID(UnitTest_DzGodotAction, baac50b7-2e87-402c-b345-57e4a12d51b8);
 DZ_PLUGIN_CLASS_GUID(UnitTest_DzGodotDialog, b99e3988-a2b6-4c1d-a830-2c2732842075);
+DZ_PLUGIN_CLASS_GUID(UnitTest_DzGodotTextureStage, 5d3f8a21-7c64-4e0b-9a1f-2e6b8c47d903);
 
 #endif
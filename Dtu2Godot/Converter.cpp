@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "Converter.h"
+#include "FbxReader.h"
+#include "GltfWriter.h"
+#include "Log.h"
+#include "MaterialMapper.h"
+#include "MeshOptimizer.h"
+#include "TangentGenerator.h"
+#include "TextureProcessor.h"
+
+namespace fs = std::filesystem;
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+std::string toLower(std::string sValue)
+{
+	std::transform(sValue.begin(), sValue.end(), sValue.begin(), ::tolower);
+	return sValue;
+}
+
+class StageTimer
+{
+public:
+	StageTimer(const std::string& sStage) : m_sStage(sStage), m_tStart(std::chrono::steady_clock::now()) {}
+	~StageTimer()
+	{
+		auto nMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_tStart).count();
+		log("DEBUG: Converter: " + m_sStage + " took " + std::to_string(nMilliseconds) + " ms");
+	}
+
+protected:
+	std::string m_sStage;
+	std::chrono::steady_clock::time_point m_tStart;
+};
+}
+
+bool Converter::fail(const std::string& sError)
+{
+	m_sError = sError;
+	log("ERROR: Converter: " + sError);
+	return false;
+}
+
+std::string Converter::findDtuFile(const std::string& sFolder)
+{
+	std::vector<std::string> aDtuFiles;
+	std::error_code error;
+	for (const fs::directory_entry& entry : fs::directory_iterator(sFolder, error))
+	{
+		if (entry.is_regular_file() && toLower(entry.path().extension().string()) == ".dtu")
+		{
+			aDtuFiles.push_back(entry.path().generic_string());
+		}
+	}
+	if (aDtuFiles.empty()) return "";
+	std::sort(aDtuFiles.begin(), aDtuFiles.end());
+	if (aDtuFiles.size() > 1)
+	{
+		log("WARNING: Converter: more than one DTU file in " + sFolder + ", using " + aDtuFiles.front());
+	}
+	return aDtuFiles.front();
+}
+
+std::string Converter::getDestinationFolder() const
+{
+	if (!m_sOutputFolder.empty()) return m_sOutputFolder;
+	// same fallback as blender_dtu_to_godot.py
+	std::string sProjectFolder = m_oDtu.getGodotProjectFolder();
+	if (sProjectFolder.empty())
+	{
+		sProjectFolder = (fs::path(m_oDtu.getFilePath()).parent_path() / "godot_project").generic_string();
+	}
+	return (fs::path(sProjectFolder) / m_oDtu.getAssetName()).generic_string();
+}
+
+bool Converter::convert(const std::string& sInput)
+{
+	StageTimer totalTimer("conversion");
+	m_sError.clear();
+	m_sOutputFilePath.clear();
+	m_oScene = Scene();
+
+	std::string sDtuPath = sInput;
+	if (fs::is_directory(sInput))
+	{
+		sDtuPath = findDtuFile(sInput);
+		if (sDtuPath.empty()) return fail("no DTU file found in: " + sInput);
+	}
+	{
+		StageTimer timer("DTU parse");
+		if (!m_oDtu.load(sDtuPath)) return fail(m_oDtu.getError());
+	}
+	m_oScene.sName = m_oDtu.getAssetName();
+
+	std::string sFormat = toLower(m_sFormat);
+	if (sFormat.empty())
+	{
+		std::string sAssetType = toLower(m_oDtu.getAssetType());
+		sFormat = (sAssetType == "godot_gltf" || sAssetType == "godot_gltf_blend") ? "gltf" : "glb";
+	}
+	if (sFormat != "glb" && sFormat != "gltf") return fail("unknown output format: " + sFormat);
+	if (m_oDtu.isAnimationOnly())
+	{
+		log("WARNING: Converter: animation libraries are written to the asset folder, not next to the published character");
+	}
+
+	std::string sDestinationFolder = getDestinationFolder();
+	std::string sFbxPath = m_oDtu.getFbxFilePath();
+	std::string sBaseName = fs::path(sFbxPath).stem().string();
+	if (sBaseName.empty()) sBaseName = m_oDtu.getAssetName();
+	m_sOutputFilePath = (fs::path(sDestinationFolder) / (sBaseName + "." + sFormat)).generic_string();
+	log("DEBUG: Converter: asset=" + m_oDtu.getAssetName() + ", type=" + m_oDtu.getAssetType() + ", output=" + m_sOutputFilePath);
+
+	if (fs::exists(sFbxPath))
+	{
+		StageTimer timer("FBX import");
+		FbxReader reader;
+		reader.setThreads(m_nThreads);
+		reader.setSkipMeshes(m_oDtu.isAnimationOnly());
+		reader.setMaxInfluences(m_oDtu.getInt("Max Bone Influences", 0));
+		if (m_bBakeSubdivisions) reader.setSubdivisionLevels(m_oDtu.getSubdivisionLevels());
+		if (!reader.read(sFbxPath, m_oScene)) return fail(reader.getError());
+	}
+	else
+	{
+		log("WARNING: Converter: FBX file not found, writing materials only: " + sFbxPath);
+	}
+
+	// textures of a .gltf are referenced from the Textures folder, a .glb embeds them
+	TextureProcessor textures;
+	textures.setMaxTextureSize(m_nMaxTextureSize);
+	textures.setThreads(m_nThreads);
+	if (sFormat == "gltf")
+	{
+		textures.setOutputFolder((fs::path(sDestinationFolder) / "Textures").generic_string());
+	}
+	else
+	{
+		textures.setOutputFolder((fs::path(m_oDtu.getFilePath()).parent_path() / "dtu2godot_textures").generic_string());
+	}
+
+	MaterialMapper materials;
+	materials.setTextureResolution(m_oDtu.getString("Texture Resolution", "full"));
+	materials.setPackOcclusion(m_oDtu.getBool("Pack ORM Textures", false));
+	{
+		StageTimer timer("material mapping");
+		materials.mapMaterials(m_oDtu, m_oScene, textures);
+	}
+	{
+		StageTimer timer("texture processing");
+		if (!textures.process())
+		{
+			log("WARNING: Converter: some textures could not be processed, see the errors above");
+		}
+		materials.resolveImages(m_oScene, textures);
+	}
+
+	bool bPruneSurfaces = m_oDtu.getBool("Prune Mesh Surfaces", false);
+	bool bDeduplicateMeshes = m_oDtu.getBool("Deduplicate Meshes", false);
+	if (bPruneSurfaces || bDeduplicateMeshes)
+	{
+		StageTimer timer("mesh optimization");
+		MeshOptimizer optimizer;
+		if (bPruneSurfaces) optimizer.process(m_oScene);
+		if (bDeduplicateMeshes) optimizer.deduplicateMeshes(m_oScene);
+	}
+
+	{
+		StageTimer timer("tangent generation");
+		TangentGenerator tangents;
+		tangents.setThreads(m_nThreads);
+		tangents.process(m_oScene);
+	}
+
+	{
+		StageTimer timer("glTF assembly");
+		GltfWriter writer;
+		writer.setThreads(m_nThreads);
+		if (!writer.write(m_oScene, m_sOutputFilePath)) return fail(writer.getError());
+	}
+	return true;
+}
+
+}
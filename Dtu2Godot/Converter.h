@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+
+#include "DtuFile.h"
+#include "Scene.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Converts an intermediate folder written by the Daz plugin (DTU, FBX and
+ * textures) into the glTF asset which blender_dtu_to_godot.py exports into
+ * the Godot project: DTU parse, FBX import, material mapping, texture
+ * processing, mesh optimization, tangent generation and glTF assembly.
+ */
+class Converter
+{
+public:
+	// overrides the DTU "Godot Project Folder"/<Asset Name> destination
+	void setOutputFolder(const std::string& sFolder) { m_sOutputFolder = sFolder; }
+	// "glb" or "gltf", empty = from the DTU asset type
+	void setFormat(const std::string& sFormat) { m_sFormat = sFormat; }
+	// 0 = keep the source size
+	void setMaxTextureSize(int nSize) { m_nMaxTextureSize = nSize; }
+	// 0 = one per hardware thread
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+	// bakes the DTU "Subdivisions" levels into the meshes, for FBX files exported at base resolution
+	void setBakeSubdivisions(bool bBake) { m_bBakeSubdivisions = bBake; }
+
+	// sInput is an intermediate folder or a .dtu file
+	bool convert(const std::string& sInput);
+
+	static std::string findDtuFile(const std::string& sFolder);
+
+	const std::string& getError() const { return m_sError; }
+	const std::string& getOutputFilePath() const { return m_sOutputFilePath; }
+	const DtuFile& getDtu() const { return m_oDtu; }
+	const Scene& getScene() const { return m_oScene; }
+
+protected:
+	std::string m_sOutputFolder;
+	std::string m_sFormat;
+	int m_nMaxTextureSize = 0;
+	int m_nThreads = 0;
+	bool m_bBakeSubdivisions = false;
+
+	std::string m_sError;
+	std::string m_sOutputFilePath;
+	DtuFile m_oDtu;
+	Scene m_oScene;
+
+	std::string getDestinationFolder() const;
+	bool fail(const std::string& sError);
+};
+
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+
+#include "DtuFile.h"
+#include "Log.h"
+
+namespace Dtu2Godot
+{
+
+const DtuProperty* DtuMaterial::findProperty(const std::string& sName) const
+{
+	for (const DtuProperty& property : aProperties)
+	{
+		if (property.sName == sName) return &property;
+	}
+	return nullptr;
+}
+
+bool DtuFile::load(const std::string& sFilePath)
+{
+	m_sFilePath = sFilePath;
+	m_aMaterials.clear();
+	m_aTextureRemap.clear();
+	if (!JsonValue::loadFile(sFilePath, m_oRoot, m_sError))
+	{
+		return false;
+	}
+	if (!m_oRoot.isObject() || !m_oRoot.contains("Asset Name"))
+	{
+		m_sError = "not a DTU file: " + sFilePath;
+		return false;
+	}
+
+	for (const auto& remap : m_oRoot["Texture Remap"].members())
+	{
+		m_aTextureRemap[remap.first] = remap.second.toString();
+	}
+	readMaterials();
+
+	log("DEBUG: DtuFile::load(): " + sFilePath + ": asset=" + getAssetName() + ", type=" + getAssetType()
+		+ ", materials=" + std::to_string(m_aMaterials.size()) + ", remapped textures=" + std::to_string(m_aTextureRemap.size()));
+	return true;
+}
+
+void DtuFile::readMaterials()
+{
+	const JsonValue& materials = m_oRoot["Materials"];
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		const JsonValue& material = materials[i];
+		DtuMaterial dtuMaterial;
+		dtuMaterial.sMaterialName = material["Material Name"].toString();
+		dtuMaterial.sMaterialType = material["Material Type"].toString();
+		dtuMaterial.sAssetName = material["Asset Name"].toString();
+		const JsonValue& properties = material["Properties"];
+		for (size_t j = 0; j < properties.size(); j++)
+		{
+			DtuProperty property;
+			property.sName = properties[j]["Name"].toString();
+			property.sDataType = properties[j]["Data Type"].toString();
+			property.value = properties[j]["Value"];
+			property.sTexture = properties[j]["Texture"].toString();
+			auto remap = m_aTextureRemap.find(property.sTexture);
+			if (remap != m_aTextureRemap.end())
+			{
+				property.sTexture = remap->second;
+			}
+			dtuMaterial.aProperties.push_back(property);
+		}
+		m_aMaterials.push_back(dtuMaterial);
+	}
+}
+
+std::map<std::string, int> DtuFile::getSubdivisionLevels() const
+{
+	std::map<std::string, int> aLevels;
+	const JsonValue& subdivisions = m_oRoot["Subdivisions"];
+	for (size_t i = 0; i < subdivisions.size(); i++)
+	{
+		std::string sName = subdivisions[i]["Asset Name"].toString();
+		int nLevel = subdivisions[i]["Value"].toInt(0);
+		if (!sName.empty() && nLevel > 0) aLevels[sName] = nLevel;
+	}
+	return aLevels;
+}
+
+bool DtuFile::isAnimationOnly() const
+{
+	std::string sAssetType = getAssetType();
+	std::transform(sAssetType.begin(), sAssetType.end(), sAssetType.begin(), ::tolower);
+	return sAssetType == "godot_animation";
+}
+
+std::string DtuFile::getFbxFilePath() const
+{
+	std::string sFbxFilePath = m_sFilePath;
+	size_t nExtension = sFbxFilePath.rfind(".dtu");
+	if (nExtension != std::string::npos)
+	{
+		sFbxFilePath.replace(nExtension, 4, ".fbx");
+	}
+	return sFbxFilePath;
+}
+
+}
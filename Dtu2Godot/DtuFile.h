@@ -0,0 +1,76 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+
+namespace Dtu2Godot
+{
+
+// One entry of a DTU material's "Properties" list
+struct DtuProperty
+{
+	std::string sName;
+	std::string sDataType; // "Double", "Color", "Texture", ...
+	JsonValue value; // number, or "#rrggbb" for colors
+	std::string sTexture; // absolute path, empty if not mapped
+};
+
+struct DtuMaterial
+{
+	std::string sMaterialName;
+	std::string sMaterialType;
+	std::string sAssetName;
+	std::vector<DtuProperty> aProperties;
+
+	const DtuProperty* findProperty(const std::string& sName) const;
+};
+
+/*
+ * DTU file written by DzGodotAction::writeConfiguration(), with the settings
+ * the blender scripts read and the materials of the exported asset.  The
+ * texture remap written by the Daz plugin's texture stage is applied on load,
+ * like blender_tools.apply_texture_remap().
+ */
+class DtuFile
+{
+public:
+	bool load(const std::string& sFilePath);
+
+	const std::string& getFilePath() const { return m_sFilePath; }
+	const std::string& getError() const { return m_sError; }
+	const JsonValue& getRoot() const { return m_oRoot; }
+
+	std::string getAssetName() const { return m_oRoot["Asset Name"].toString(); }
+	std::string getAssetType() const { return m_oRoot["Asset Type"].toString(); }
+	std::string getGodotProjectFolder() const { return m_oRoot["Godot Project Folder"].toString(); }
+	int getDtuVersion() const { return m_oRoot["DTU Version"].toInt(-1); }
+	bool isAnimationOnly() const;
+
+	// FBX file exported next to the DTU, "<name>.fbx" for "<name>.dtu"
+	std::string getFbxFilePath() const;
+
+	// "Subdivisions" list: subdivision level per mesh ("<node>.Shape")
+	std::map<std::string, int> getSubdivisionLevels() const;
+
+	const std::vector<DtuMaterial>& getMaterials() const { return m_aMaterials; }
+	const std::map<std::string, std::string>& getTextureRemap() const { return m_aTextureRemap; }
+
+	// settings with the defaults of the blender scripts
+	bool getBool(const std::string& sKey, bool bDefault) const { return m_oRoot[sKey].toBool(bDefault); }
+	int getInt(const std::string& sKey, int nDefault) const { return m_oRoot[sKey].toInt(nDefault); }
+	double getDouble(const std::string& sKey, double fDefault) const { return m_oRoot[sKey].toDouble(fDefault); }
+	std::string getString(const std::string& sKey, const std::string& sDefault) const { return m_oRoot[sKey].toString(sDefault); }
+
+protected:
+	std::string m_sFilePath;
+	std::string m_sError;
+	JsonValue m_oRoot;
+	std::vector<DtuMaterial> m_aMaterials;
+	std::map<std::string, std::string> m_aTextureRemap; // source path -> converted path
+
+	void readMaterials();
+};
+
+}
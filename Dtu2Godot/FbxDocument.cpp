@@ -0,0 +1,334 @@
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include <zlib.h>
+
+#include "FbxDocument.h"
+#include "ThreadPool.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+const char s_fbxMagic[] = "Kaydara FBX Binary  ";
+const size_t FBX_HEADER_SIZE = 27;
+
+template <typename T> T readValue(const uint8_t* pData)
+{
+	T value;
+	memcpy(&value, pData, sizeof(T));
+	return value;
+}
+}
+
+const FbxNode* FbxNode::find(const std::string& sChildName) const
+{
+	for (const FbxNode& child : aChildren)
+	{
+		if (child.sName == sChildName) return &child;
+	}
+	return nullptr;
+}
+
+std::vector<const FbxNode*> FbxNode::findAll(const std::string& sChildName) const
+{
+	std::vector<const FbxNode*> aResult;
+	for (const FbxNode& child : aChildren)
+	{
+		if (child.sName == sChildName) aResult.push_back(&child);
+	}
+	return aResult;
+}
+
+const FbxNode* FbxNode::findProperty70(const std::string& sPropertyName) const
+{
+	const FbxNode* pProperties = find("Properties70");
+	if (pProperties == nullptr) return nullptr;
+	for (const FbxNode& property : pProperties->aChildren)
+	{
+		if (property.sName == "P" && !property.aProperties.empty() && property.aProperties[0].sValue == sPropertyName)
+		{
+			return &property;
+		}
+	}
+	return nullptr;
+}
+
+double FbxNode::getProperty70Double(const std::string& sPropertyName, double fDefault) const
+{
+	const FbxNode* pProperty = findProperty70(sPropertyName);
+	if (pProperty == nullptr || pProperty->aProperties.size() < 5) return fDefault;
+	return pProperty->aProperties[4].toDouble();
+}
+
+int64_t FbxNode::getProperty70Int(const std::string& sPropertyName, int64_t nDefault) const
+{
+	const FbxNode* pProperty = findProperty70(sPropertyName);
+	if (pProperty == nullptr || pProperty->aProperties.size() < 5) return nDefault;
+	return pProperty->aProperties[4].toInt();
+}
+
+bool FbxNode::getProperty70Vector(const std::string& sPropertyName, double aValues[3]) const
+{
+	const FbxNode* pProperty = findProperty70(sPropertyName);
+	if (pProperty == nullptr || pProperty->aProperties.size() < 7) return false;
+	for (int i = 0; i < 3; i++) aValues[i] = pProperty->aProperties[4 + i].toDouble();
+	return true;
+}
+
+std::string FbxNode::getProperty70String(const std::string& sPropertyName, const std::string& sDefault) const
+{
+	const FbxNode* pProperty = findProperty70(sPropertyName);
+	if (pProperty == nullptr || pProperty->aProperties.size() < 5) return sDefault;
+	return pProperty->aProperties[4].toString();
+}
+
+std::string FbxDocument::objectName(const std::string& sName)
+{
+	size_t nSeparator = sName.find(std::string("\x00\x01", 2));
+	std::string sResult = (nSeparator == std::string::npos) ? sName : sName.substr(0, nSeparator);
+	// ASCII style "Class::Name"
+	size_t nColons = sResult.find("::");
+	if (nSeparator == std::string::npos && nColons != std::string::npos) sResult = sResult.substr(nColons + 2);
+	return sResult;
+}
+
+bool FbxDocument::readProperty(const uint8_t* pData, size_t nSize, size_t& nOffset, FbxProperty& property)
+{
+	if (nOffset >= nSize) return false;
+	property.cType = (char)pData[nOffset++];
+	size_t nRemaining = nSize - nOffset;
+	const uint8_t* pValue = pData + nOffset;
+	switch (property.cType)
+	{
+	case 'Y':
+		if (nRemaining < 2) return false;
+		property.nValue = readValue<int16_t>(pValue);
+		nOffset += 2;
+		return true;
+	case 'C':
+		if (nRemaining < 1) return false;
+		property.nValue = pValue[0] != 0;
+		nOffset += 1;
+		return true;
+	case 'I':
+		if (nRemaining < 4) return false;
+		property.nValue = readValue<int32_t>(pValue);
+		nOffset += 4;
+		return true;
+	case 'L':
+		if (nRemaining < 8) return false;
+		property.nValue = readValue<int64_t>(pValue);
+		nOffset += 8;
+		return true;
+	case 'F':
+		if (nRemaining < 4) return false;
+		property.fValue = readValue<float>(pValue);
+		nOffset += 4;
+		return true;
+	case 'D':
+		if (nRemaining < 8) return false;
+		property.fValue = readValue<double>(pValue);
+		nOffset += 8;
+		return true;
+	case 'S':
+	case 'R':
+	{
+		if (nRemaining < 4) return false;
+		uint32_t nLength = readValue<uint32_t>(pValue);
+		if (nRemaining - 4 < nLength) return false;
+		property.sValue.assign((const char*)pValue + 4, nLength);
+		nOffset += 4 + nLength;
+		return true;
+	}
+	case 'b':
+	case 'i':
+	case 'l':
+	case 'f':
+	case 'd':
+	{
+		if (nRemaining < 12) return false;
+		PendingArray pending;
+		pending.pProperty = &property;
+		pending.nCount = readValue<uint32_t>(pValue);
+		pending.nEncoding = readValue<uint32_t>(pValue + 4);
+		pending.nByteLength = readValue<uint32_t>(pValue + 8);
+		pending.pData = pValue + 12;
+		if (nRemaining - 12 < pending.nByteLength) return false;
+		m_aPendingArrays.push_back(pending);
+		nOffset += 12 + pending.nByteLength;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool FbxDocument::readNode(const uint8_t* pData, size_t nSize, size_t& nOffset, FbxNode& node, bool& bIsNull)
+{
+	bool bWide = m_nVersion >= 7500;
+	size_t nHeaderSize = bWide ? 25 : 13;
+	if (nSize - nOffset < nHeaderSize) return false;
+	uint64_t nEndOffset, nNumProperties;
+	if (bWide)
+	{
+		nEndOffset = readValue<uint64_t>(pData + nOffset);
+		nNumProperties = readValue<uint64_t>(pData + nOffset + 8);
+	}
+	else
+	{
+		nEndOffset = readValue<uint32_t>(pData + nOffset);
+		nNumProperties = readValue<uint32_t>(pData + nOffset + 4);
+	}
+	uint8_t nNameLength = pData[nOffset + nHeaderSize - 1];
+	bIsNull = (nEndOffset == 0);
+	if (bIsNull)
+	{
+		nOffset += nHeaderSize;
+		return true;
+	}
+	if (nEndOffset > nSize || nEndOffset <= nOffset || nSize - nOffset - nHeaderSize < nNameLength) return false;
+	nOffset += nHeaderSize;
+	node.sName.assign((const char*)pData + nOffset, nNameLength);
+	nOffset += nNameLength;
+
+	// sized up front, pending arrays keep pointers to the properties
+	if (nNumProperties > (nEndOffset - nOffset)) return false;
+	node.aProperties.resize((size_t)nNumProperties);
+	for (FbxProperty& property : node.aProperties)
+	{
+		if (!readProperty(pData, (size_t)nEndOffset, nOffset, property)) return false;
+	}
+	while (nOffset < nEndOffset)
+	{
+		FbxNode child;
+		bool bChildIsNull = false;
+		if (!readNode(pData, (size_t)nEndOffset, nOffset, child, bChildIsNull)) return false;
+		if (bChildIsNull) break;
+		node.aChildren.push_back(std::move(child));
+	}
+	nOffset = (size_t)nEndOffset;
+	return true;
+}
+
+bool FbxDocument::decodeArray(const PendingArray& pending, std::string& sError)
+{
+	FbxProperty& property = *pending.pProperty;
+	size_t nElementSize = (property.cType == 'b') ? 1 : ((property.cType == 'i' || property.cType == 'f') ? 4 : 8);
+	size_t nBytes = (size_t)pending.nCount * nElementSize;
+	std::vector<uint8_t> aInflated;
+	const uint8_t* pValues = pending.pData;
+	if (pending.nEncoding == 1)
+	{
+		aInflated.resize(nBytes);
+		uLongf nDestLength = (uLongf)nBytes;
+		if (uncompress(aInflated.data(), &nDestLength, pending.pData, pending.nByteLength) != Z_OK || nDestLength != nBytes)
+		{
+			sError = "corrupt compressed array";
+			return false;
+		}
+		pValues = aInflated.data();
+	}
+	else if (pending.nEncoding != 0 || pending.nByteLength < nBytes)
+	{
+		sError = "invalid array encoding";
+		return false;
+	}
+
+	switch (property.cType)
+	{
+	case 'b':
+		property.aIntArray.assign(pValues, pValues + pending.nCount);
+		break;
+	case 'i':
+		property.aIntArray.resize(pending.nCount);
+		for (uint32_t i = 0; i < pending.nCount; i++) property.aIntArray[i] = readValue<int32_t>(pValues + i * 4);
+		break;
+	case 'l':
+		property.aIntArray.resize(pending.nCount);
+		memcpy(property.aIntArray.data(), pValues, nBytes);
+		break;
+	case 'f':
+		property.aDoubleArray.resize(pending.nCount);
+		for (uint32_t i = 0; i < pending.nCount; i++) property.aDoubleArray[i] = readValue<float>(pValues + i * 4);
+		break;
+	case 'd':
+		property.aDoubleArray.resize(pending.nCount);
+		memcpy(property.aDoubleArray.data(), pValues, nBytes);
+		break;
+	}
+	return true;
+}
+
+bool FbxDocument::parse(const std::vector<uint8_t>& aData, int nThreads)
+{
+	m_oRoot = FbxNode();
+	m_aPendingArrays.clear();
+	m_sError.clear();
+	if (aData.size() < FBX_HEADER_SIZE || memcmp(aData.data(), s_fbxMagic, sizeof(s_fbxMagic) - 1) != 0)
+	{
+		m_sError = "not a binary FBX file";
+		return false;
+	}
+	m_nVersion = readValue<uint32_t>(aData.data() + 23);
+	if (m_nVersion < 7000 || m_nVersion >= 8000)
+	{
+		m_sError = "unsupported FBX version: " + std::to_string(m_nVersion);
+		return false;
+	}
+
+	size_t nOffset = FBX_HEADER_SIZE;
+	while (nOffset < aData.size())
+	{
+		FbxNode node;
+		bool bIsNull = false;
+		if (!readNode(aData.data(), aData.size(), nOffset, node, bIsNull))
+		{
+			m_sError = "corrupt FBX record at offset " + std::to_string(nOffset);
+			return false;
+		}
+		if (bIsNull) break;
+		m_oRoot.aChildren.push_back(std::move(node));
+	}
+
+	std::mutex errorMutex;
+	parallelFor(m_aPendingArrays.size(), nThreads, [&](size_t i)
+	{
+		std::string sError;
+		if (!decodeArray(m_aPendingArrays[i], sError))
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			m_sError = sError;
+		}
+	});
+	m_aPendingArrays.clear();
+	return m_sError.empty();
+}
+
+bool FbxDocument::load(const std::string& sFilePath, int nThreads)
+{
+	std::ifstream file(sFilePath, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		m_sError = "unable to open file: " + sFilePath;
+		return false;
+	}
+	std::vector<uint8_t> aData((size_t)file.tellg());
+	file.seekg(0);
+	file.read((char*)aData.data(), aData.size());
+	if (!file)
+	{
+		m_sError = "unable to read file: " + sFilePath;
+		return false;
+	}
+	if (!parse(aData, nThreads))
+	{
+		m_sError += ": " + sFilePath;
+		return false;
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+/*
+ * Property of a binary FBX node record.  Type codes are those of the file
+ * format: 'Y' int16, 'C' bool, 'I' int32, 'L' int64, 'F' float, 'D' double,
+ * 'S' string, 'R' raw bytes, and the arrays 'b', 'i', 'l', 'f', 'd'.
+ */
+struct FbxProperty
+{
+	char cType = 0;
+	int64_t nValue = 0; // Y, C, I, L
+	double fValue = 0.0; // F, D
+	std::string sValue; // S, R
+	std::vector<int64_t> aIntArray; // b, i, l
+	std::vector<double> aDoubleArray; // f, d
+
+	bool isArray() const { return cType == 'b' || cType == 'i' || cType == 'l' || cType == 'f' || cType == 'd'; }
+	int64_t toInt() const { return (cType == 'F' || cType == 'D') ? (int64_t)fValue : nValue; }
+	double toDouble() const { return (cType == 'F' || cType == 'D') ? fValue : (double)nValue; }
+	const std::string& toString() const { return sValue; }
+};
+
+struct FbxNode
+{
+	std::string sName;
+	std::vector<FbxProperty> aProperties;
+	std::vector<FbxNode> aChildren;
+
+	const FbxNode* find(const std::string& sChildName) const;
+	std::vector<const FbxNode*> findAll(const std::string& sChildName) const;
+
+	// "Properties70" P records: name, type, label, flags, values...
+	const FbxNode* findProperty70(const std::string& sPropertyName) const;
+	double getProperty70Double(const std::string& sPropertyName, double fDefault) const;
+	int64_t getProperty70Int(const std::string& sPropertyName, int64_t nDefault) const;
+	bool getProperty70Vector(const std::string& sPropertyName, double aValues[3]) const;
+	std::string getProperty70String(const std::string& sPropertyName, const std::string& sDefault) const;
+};
+
+/*
+ * Binary FBX file (version 7.x, 32 or 64-bit record offsets) parsed into a
+ * node tree.  The records are read in one pass over the file buffer; the
+ * zlib compressed arrays, which make up most of the file, are collected
+ * during that pass and inflated in parallel afterwards.
+ */
+class FbxDocument
+{
+public:
+	bool load(const std::string& sFilePath, int nThreads = 0);
+	bool parse(const std::vector<uint8_t>& aData, int nThreads = 0);
+
+	const FbxNode& getRoot() const { return m_oRoot; }
+	uint32_t getVersion() const { return m_nVersion; }
+	const std::string& getError() const { return m_sError; }
+
+	// object name of an "Objects" record, "Name\x00\x01Class" -> "Name"
+	static std::string objectName(const std::string& sName);
+
+protected:
+	struct PendingArray
+	{
+		FbxProperty* pProperty;
+		const uint8_t* pData;
+		uint32_t nCount;
+		uint32_t nEncoding;
+		uint32_t nByteLength;
+	};
+
+	FbxNode m_oRoot;
+	uint32_t m_nVersion = 0;
+	std::string m_sError;
+	std::vector<PendingArray> m_aPendingArrays;
+
+	bool readNode(const uint8_t* pData, size_t nSize, size_t& nOffset, FbxNode& node, bool& bIsNull);
+	bool readProperty(const uint8_t* pData, size_t nSize, size_t& nOffset, FbxProperty& property);
+	bool decodeArray(const PendingArray& pending, std::string& sError);
+};
+
+}
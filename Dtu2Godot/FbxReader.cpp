@@ -0,0 +1,1054 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include "FbxReader.h"
+#include "Log.h"
+#include "Subdivider.h"
+#include "ThreadPool.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+const std::vector<int64_t> s_emptyIntArray;
+const std::vector<double> s_emptyDoubleArray;
+
+const std::vector<int64_t>& intArray(const FbxNode* pNode, const std::string& sChild)
+{
+	const FbxNode* pChild = pNode ? pNode->find(sChild) : nullptr;
+	if (pChild == nullptr || pChild->aProperties.empty()) return s_emptyIntArray;
+	return pChild->aProperties[0].aIntArray;
+}
+
+const std::vector<double>& doubleArray(const FbxNode* pNode, const std::string& sChild)
+{
+	const FbxNode* pChild = pNode ? pNode->find(sChild) : nullptr;
+	if (pChild == nullptr || pChild->aProperties.empty()) return s_emptyDoubleArray;
+	return pChild->aProperties[0].aDoubleArray;
+}
+
+std::string childString(const FbxNode* pNode, const std::string& sChild)
+{
+	const FbxNode* pChild = pNode ? pNode->find(sChild) : nullptr;
+	if (pChild == nullptr || pChild->aProperties.empty()) return "";
+	return pChild->aProperties[0].sValue;
+}
+
+// Layer element (normals, UVs, materials) with its mapping and reference mode
+struct LayerElement
+{
+	const std::vector<double>* pData = nullptr;
+	const std::vector<int64_t>* pIndices = nullptr;
+	std::string sMapping;
+	bool bIndexed = false;
+	int nComponents = 0;
+
+	bool isValid() const { return pData != nullptr && !pData->empty(); }
+
+	bool read(const FbxNode* pElement, const std::string& sDataName, const std::string& sIndexName, int nElementComponents)
+	{
+		if (pElement == nullptr) return false;
+		pData = &doubleArray(pElement, sDataName);
+		pIndices = &intArray(pElement, sIndexName);
+		sMapping = childString(pElement, "MappingInformationType");
+		std::string sReference = childString(pElement, "ReferenceInformationType");
+		bIndexed = (sReference == "IndexToDirect" || sReference == "Index") && !pIndices->empty();
+		nComponents = nElementComponents;
+		return isValid();
+	}
+
+	// index of the value for polygon vertex nPolygonVertex, -1 if not available
+	int64_t index(int64_t nPolygonVertex, int64_t nControlPoint, int64_t nPolygon) const
+	{
+		int64_t nIndex = nPolygonVertex;
+		if (sMapping == "ByVertice" || sMapping == "ByVertex" || sMapping == "ByControlPoint") nIndex = nControlPoint;
+		else if (sMapping == "ByPolygon") nIndex = nPolygon;
+		else if (sMapping == "AllSame") nIndex = 0;
+		if (bIndexed)
+		{
+			if (nIndex < 0 || nIndex >= (int64_t)pIndices->size()) return -1;
+			nIndex = (*pIndices)[nIndex];
+		}
+		if (nIndex < 0 || (nIndex + 1) * nComponents > (int64_t)pData->size()) return -1;
+		return nIndex;
+	}
+};
+
+// material index layer, stored as integers
+struct MaterialLayer
+{
+	const std::vector<int64_t>* pMaterials = nullptr;
+	std::string sMapping;
+
+	int64_t material(int64_t nPolygon) const
+	{
+		if (pMaterials == nullptr || pMaterials->empty()) return 0;
+		if (sMapping == "AllSame") return (*pMaterials)[0];
+		return nPolygon < (int64_t)pMaterials->size() ? (*pMaterials)[nPolygon] : 0;
+	}
+};
+
+// output vertex identity: control point plus the attribute values, so that
+// corners with equal normals and UVs share one vertex
+struct VertexKey
+{
+	int64_t nControlPoint;
+	float aValues[7];
+
+	bool operator==(const VertexKey& other) const
+	{
+		return nControlPoint == other.nControlPoint && memcmp(aValues, other.aValues, sizeof(aValues)) == 0;
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const
+	{
+		uint64_t nHash = 1469598103934665603ULL ^ (uint64_t)key.nControlPoint;
+		const uint8_t* pBytes = (const uint8_t*)key.aValues;
+		for (size_t i = 0; i < sizeof(key.aValues); i++)
+		{
+			nHash = (nHash ^ pBytes[i]) * 1099511628211ULL;
+		}
+		return (size_t)nHash;
+	}
+};
+
+struct Influence
+{
+	int nJoint;
+	float fWeight;
+};
+
+// linear evaluation of an FBX animation curve
+struct Curve
+{
+	const std::vector<int64_t>* pTimes = nullptr;
+	const std::vector<double>* pValues = nullptr;
+
+	bool isSet() const { return pTimes != nullptr && !pTimes->empty() && pValues->size() >= pTimes->size(); }
+
+	double evaluate(int64_t nTime) const
+	{
+		const std::vector<int64_t>& aTimes = *pTimes;
+		const std::vector<double>& aValues = *pValues;
+		if (nTime <= aTimes.front()) return aValues.front();
+		if (nTime >= aTimes.back()) return aValues[aTimes.size() - 1];
+		size_t nNext = std::upper_bound(aTimes.begin(), aTimes.end(), nTime) - aTimes.begin();
+		int64_t nStart = aTimes[nNext - 1], nEnd = aTimes[nNext];
+		double fT = (double)(nTime - nStart) / (double)(nEnd - nStart);
+		return aValues[nNext - 1] + (aValues[nNext] - aValues[nNext - 1]) * fT;
+	}
+};
+
+Curve readCurve(const FbxNode* pCurve)
+{
+	Curve curve;
+	if (pCurve == nullptr) return curve;
+	curve.pTimes = &intArray(pCurve, "KeyTime");
+	curve.pValues = &doubleArray(pCurve, "KeyValueFloat");
+	if (curve.pValues->empty()) curve.pValues = &doubleArray(pCurve, "KeyValueDouble");
+	return curve;
+}
+
+void appendTimes(const Curve& curve, std::vector<int64_t>& aTimes)
+{
+	if (curve.isSet()) aTimes.insert(aTimes.end(), curve.pTimes->begin(), curve.pTimes->end());
+}
+}
+
+const FbxReader::Object* FbxReader::findObject(int64_t nId) const
+{
+	auto object = m_aObjects.find(nId);
+	return object == m_aObjects.end() ? nullptr : &object->second;
+}
+
+std::vector<const FbxReader::Object*> FbxReader::getSources(int64_t nId, const std::string& sType, const std::string& sProperty) const
+{
+	std::vector<const Object*> aResult;
+	auto sources = m_aSources.find(nId);
+	if (sources == m_aSources.end()) return aResult;
+	for (const Connection& connection : sources->second)
+	{
+		const Object* pObject = findObject(connection.nId);
+		if (pObject && pObject->sType == sType && (sProperty.empty() || connection.sProperty == sProperty)) aResult.push_back(pObject);
+	}
+	return aResult;
+}
+
+std::vector<const FbxReader::Object*> FbxReader::getDestinations(int64_t nId, const std::string& sType) const
+{
+	std::vector<const Object*> aResult;
+	auto destinations = m_aDestinations.find(nId);
+	if (destinations == m_aDestinations.end()) return aResult;
+	for (const Connection& connection : destinations->second)
+	{
+		const Object* pObject = findObject(connection.nId);
+		if (pObject && pObject->sType == sType) aResult.push_back(pObject);
+	}
+	return aResult;
+}
+
+void FbxReader::readGlobalSettings(const FbxNode& root)
+{
+	const FbxNode* pSettings = root.find("GlobalSettings");
+	int nUpAxis = 1, nUpSign = 1, nFrontAxis = 2, nFrontSign = 1, nCoordAxis = 0, nCoordSign = 1;
+	double fUnitScaleFactor = 1.0;
+	if (pSettings)
+	{
+		nUpAxis = (int)pSettings->getProperty70Int("UpAxis", 1);
+		nUpSign = (int)pSettings->getProperty70Int("UpAxisSign", 1);
+		nFrontAxis = (int)pSettings->getProperty70Int("FrontAxis", 2);
+		nFrontSign = (int)pSettings->getProperty70Int("FrontAxisSign", 1);
+		nCoordAxis = (int)pSettings->getProperty70Int("CoordAxis", 0);
+		nCoordSign = (int)pSettings->getProperty70Int("CoordAxisSign", 1);
+		fUnitScaleFactor = pSettings->getProperty70Double("UnitScaleFactor", 1.0);
+	}
+	if (nUpAxis < 0 || nUpAxis > 2 || nFrontAxis < 0 || nFrontAxis > 2 || nCoordAxis < 0 || nCoordAxis > 2
+		|| nUpAxis == nFrontAxis || nUpAxis == nCoordAxis || nFrontAxis == nCoordAxis)
+	{
+		log("WARNING: FbxReader: invalid axis settings, assuming Y up");
+		nUpAxis = 1; nUpSign = 1; nFrontAxis = 2; nFrontSign = 1; nCoordAxis = 0; nCoordSign = 1;
+	}
+	// centimeters (the FBX default unit) to meters, as the blender importer with apply_unit_scale
+	m_fUnitScale = fUnitScaleFactor * 0.01;
+
+	// rows of the glTF axes: X = coord axis, Y = up axis, Z = front axis
+	m_oConversion = Matrix4();
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++) m_oConversion.m[j * 4 + i] = 0.0;
+	}
+	m_oConversion.m[nCoordAxis * 4 + 0] = nCoordSign * m_fUnitScale;
+	m_oConversion.m[nUpAxis * 4 + 1] = nUpSign * m_fUnitScale;
+	m_oConversion.m[nFrontAxis * 4 + 2] = nFrontSign * m_fUnitScale;
+	m_oInverseConversion = m_oConversion.inverse();
+}
+
+void FbxReader::readObjects(const FbxNode& root)
+{
+	m_aObjects.clear();
+	m_aSources.clear();
+	m_aDestinations.clear();
+	const FbxNode* pObjects = root.find("Objects");
+	if (pObjects)
+	{
+		for (const FbxNode& node : pObjects->aChildren)
+		{
+			if (node.aProperties.size() < 3) continue;
+			Object object;
+			object.nId = node.aProperties[0].toInt();
+			object.sType = node.sName;
+			object.sName = FbxDocument::objectName(node.aProperties[1].toString());
+			object.sSubType = node.aProperties[2].toString();
+			object.pNode = &node;
+			m_aObjects[object.nId] = object;
+		}
+	}
+	const FbxNode* pConnections = root.find("Connections");
+	if (pConnections)
+	{
+		for (const FbxNode& node : pConnections->aChildren)
+		{
+			if (node.sName != "C" || node.aProperties.size() < 3) continue;
+			Connection source, destination;
+			source.nId = node.aProperties[1].toInt();
+			destination.nId = node.aProperties[2].toInt();
+			if (node.aProperties.size() > 3)
+			{
+				source.sProperty = node.aProperties[3].toString();
+				destination.sProperty = source.sProperty;
+			}
+			m_aSources[destination.nId].push_back(source);
+			m_aDestinations[source.nId].push_back(destination);
+		}
+	}
+}
+
+void FbxReader::readBindPoses()
+{
+	m_aBindPoses.clear();
+	for (const auto& entry : m_aObjects)
+	{
+		const Object& object = entry.second;
+		if (object.sType != "Pose" || object.sSubType != "BindPose") continue;
+		for (const FbxNode* pPoseNode : object.pNode->findAll("PoseNode"))
+		{
+			const FbxNode* pNode = pPoseNode->find("Node");
+			const std::vector<double>& aMatrix = doubleArray(pPoseNode, "Matrix");
+			if (pNode == nullptr || pNode->aProperties.empty() || aMatrix.size() != 16) continue;
+			m_aBindPoses[pNode->aProperties[0].toInt()] = Matrix4::fromArray(aMatrix.data());
+		}
+	}
+}
+
+Matrix4 FbxReader::localMatrix(const FbxNode& model, const double* pTranslation, const double* pRotation, const double* pScale) const
+{
+	double aTranslation[3] = { 0, 0, 0 }, aRotation[3] = { 0, 0, 0 }, aScale[3] = { 1, 1, 1 };
+	double aPreRotation[3] = { 0, 0, 0 }, aPostRotation[3] = { 0, 0, 0 };
+	double aRotationOffset[3] = { 0, 0, 0 }, aRotationPivot[3] = { 0, 0, 0 };
+	double aScalingOffset[3] = { 0, 0, 0 }, aScalingPivot[3] = { 0, 0, 0 };
+	model.getProperty70Vector("Lcl Translation", aTranslation);
+	model.getProperty70Vector("Lcl Rotation", aRotation);
+	model.getProperty70Vector("Lcl Scaling", aScale);
+	model.getProperty70Vector("PreRotation", aPreRotation);
+	model.getProperty70Vector("PostRotation", aPostRotation);
+	model.getProperty70Vector("RotationOffset", aRotationOffset);
+	model.getProperty70Vector("RotationPivot", aRotationPivot);
+	model.getProperty70Vector("ScalingOffset", aScalingOffset);
+	model.getProperty70Vector("ScalingPivot", aScalingPivot);
+	int nRotationOrder = (int)model.getProperty70Int("RotationOrder", 0);
+	if (pTranslation) memcpy(aTranslation, pTranslation, sizeof(aTranslation));
+	if (pRotation) memcpy(aRotation, pRotation, sizeof(aRotation));
+	if (pScale) memcpy(aScale, pScale, sizeof(aScale));
+
+	// T * Roff * Rp * Rpre * R * Rpost^-1 * Rp^-1 * Soff * Sp * S * Sp^-1
+	double aNegRotationPivot[3] = { -aRotationPivot[0], -aRotationPivot[1], -aRotationPivot[2] };
+	double aNegScalingPivot[3] = { -aScalingPivot[0], -aScalingPivot[1], -aScalingPivot[2] };
+	return Matrix4::translation(aTranslation) * Matrix4::translation(aRotationOffset) * Matrix4::translation(aRotationPivot)
+		* Matrix4::eulerRotation(aPreRotation) * Matrix4::eulerRotation(aRotation, nRotationOrder) * Matrix4::eulerRotation(aPostRotation).inverse()
+		* Matrix4::translation(aNegRotationPivot) * Matrix4::translation(aScalingOffset) * Matrix4::translation(aScalingPivot)
+		* Matrix4::scaling(aScale) * Matrix4::translation(aNegScalingPivot);
+}
+
+Matrix4 FbxReader::geometricMatrix(const FbxNode& model) const
+{
+	double aTranslation[3] = { 0, 0, 0 }, aRotation[3] = { 0, 0, 0 }, aScale[3] = { 1, 1, 1 };
+	model.getProperty70Vector("GeometricTranslation", aTranslation);
+	model.getProperty70Vector("GeometricRotation", aRotation);
+	model.getProperty70Vector("GeometricScaling", aScale);
+	return Matrix4::translation(aTranslation) * Matrix4::eulerRotation(aRotation) * Matrix4::scaling(aScale);
+}
+
+void FbxReader::readModels(Scene& scene)
+{
+	m_aModelNodes.clear();
+	std::vector<const Object*> aModels;
+	for (const auto& entry : m_aObjects)
+	{
+		if (entry.second.sType == "Model") aModels.push_back(&entry.second);
+	}
+	// file order
+	std::sort(aModels.begin(), aModels.end(), [](const Object* a, const Object* b) { return a->pNode < b->pNode; });
+
+	for (const Object* pModel : aModels)
+	{
+		SceneNode node;
+		node.sName = pModel->sName;
+		double aTranslation[3], aRotation[4], aScale[3];
+		convert(localMatrix(*pModel->pNode)).decompose(aTranslation, aRotation, aScale);
+		for (int i = 0; i < 3; i++)
+		{
+			node.aTranslation[i] = (float)aTranslation[i];
+			node.aScale[i] = (float)aScale[i];
+		}
+		for (int i = 0; i < 4; i++) node.aRotation[i] = (float)aRotation[i];
+		m_aModelNodes[pModel->nId] = (int)scene.aNodes.size();
+		scene.aNodes.push_back(node);
+	}
+	for (const Object* pModel : aModels)
+	{
+		int nNode = m_aModelNodes[pModel->nId];
+		std::vector<const Object*> aParents = getDestinations(pModel->nId, "Model");
+		if (aParents.empty())
+		{
+			scene.aRootNodes.push_back(nNode);
+		}
+		else
+		{
+			scene.aNodes[m_aModelNodes[aParents[0]->nId]].aChildren.push_back(nNode);
+		}
+	}
+}
+
+void FbxReader::readMaterials(Scene& scene)
+{
+	std::vector<const Object*> aMaterials;
+	for (const auto& entry : m_aObjects)
+	{
+		if (entry.second.sType == "Material") aMaterials.push_back(&entry.second);
+	}
+	std::sort(aMaterials.begin(), aMaterials.end(), [](const Object* a, const Object* b) { return a->pNode < b->pNode; });
+	for (const Object* pMaterial : aMaterials)
+	{
+		if (scene.findMaterial(pMaterial->sName) >= 0) continue;
+		SceneMaterial material;
+		material.sName = pMaterial->sName;
+		double aColor[3];
+		if (pMaterial->pNode->getProperty70Vector("DiffuseColor", aColor))
+		{
+			for (int i = 0; i < 3; i++) material.aBaseColorFactor[i] = (float)aColor[i];
+		}
+		scene.aMaterials.push_back(material);
+	}
+}
+
+bool FbxReader::readMesh(const MeshJob& job, Scene& scene, std::string& sError) const
+{
+	const Object* pModel = findObject(job.nModelId);
+	const Object* pGeometry = findObject(job.nGeometryId);
+	const FbxNode* pGeometryNode = pGeometry->pNode;
+	const std::vector<double>& aFbxVertices = doubleArray(pGeometryNode, "Vertices");
+	const std::vector<int64_t>& aFbxPolygonVertices = intArray(pGeometryNode, "PolygonVertexIndex");
+	size_t nControlPoints = aFbxVertices.size() / 3;
+	if (nControlPoints == 0 || aFbxPolygonVertices.empty())
+	{
+		sError = "mesh without vertices or polygons: " + pGeometry->sName;
+		return false;
+	}
+
+	LayerElement normals;
+	normals.read(pGeometryNode->find("LayerElementNormal"), "Normals", "NormalsIndex", 3);
+	std::vector<LayerElement> aUvSets;
+	std::vector<const FbxNode*> aUvElements = pGeometryNode->findAll("LayerElementUV");
+	std::sort(aUvElements.begin(), aUvElements.end(), [](const FbxNode* a, const FbxNode* b)
+	{
+		return (a->aProperties.empty() ? 0 : a->aProperties[0].toInt()) < (b->aProperties.empty() ? 0 : b->aProperties[0].toInt());
+	});
+	for (const FbxNode* pUvElement : aUvElements)
+	{
+		LayerElement uvs;
+		if (uvs.read(pUvElement, "UV", "UVIndex", 2) && aUvSets.size() < 2) aUvSets.push_back(uvs);
+	}
+	MaterialLayer materials;
+	const FbxNode* pMaterialElement = pGeometryNode->find("LayerElementMaterial");
+	if (pMaterialElement)
+	{
+		materials.pMaterials = &intArray(pMaterialElement, "Materials");
+		materials.sMapping = childString(pMaterialElement, "MappingInformationType");
+	}
+	std::vector<int> aModelMaterials;
+	for (const Object* pMaterial : getSources(job.nModelId, "Material"))
+	{
+		aModelMaterials.push_back(scene.findMaterial(pMaterial->sName));
+	}
+
+	// FBX geometry space -> glTF node space
+	Matrix4 vertexMatrix = m_oConversion * geometricMatrix(*pModel->pNode);
+	Matrix4 normalMatrix = vertexMatrix.inverse();
+	{
+		// inverse transpose of the linear part
+		Matrix4 transposed;
+		for (int c = 0; c < 3; c++)
+		{
+			for (int r = 0; r < 3; r++) transposed.m[c * 4 + r] = normalMatrix.m[r * 4 + c];
+		}
+		normalMatrix = transposed;
+	}
+
+	// skin influences per control point
+	SceneSkin* pSkin = (job.nSkin >= 0) ? &scene.aSkins[job.nSkin] : nullptr;
+	std::vector<std::vector<Influence>> aInfluences;
+	int nInfluences = 0;
+	if (pSkin)
+	{
+		aInfluences.resize(nControlPoints);
+		const Object* pSkinDeformer = getSources(job.nGeometryId, "Deformer")[0];
+		std::vector<const Object*> aClusters;
+		for (const Object* pCluster : getSources(pSkinDeformer->nId, "Deformer"))
+		{
+			if (pCluster->sSubType == "Cluster") aClusters.push_back(pCluster);
+		}
+		Matrix4 meshBind = m_aBindPoses.count(job.nModelId) ? m_aBindPoses.at(job.nModelId) : Matrix4();
+		for (const Object* pCluster : aClusters)
+		{
+			std::vector<const Object*> aBones = getSources(pCluster->nId, "Model");
+			if (aBones.empty()) continue;
+			int nJoint = (int)pSkin->aJoints.size();
+			pSkin->aJoints.push_back(m_aModelNodes.at(aBones[0]->nId));
+
+			const std::vector<double>& aTransform = doubleArray(pCluster->pNode, "Transform");
+			const std::vector<double>& aTransformLink = doubleArray(pCluster->pNode, "TransformLink");
+			Matrix4 meshMatrix = (aTransform.size() == 16) ? Matrix4::fromArray(aTransform.data()) : meshBind;
+			Matrix4 boneMatrix;
+			if (aTransformLink.size() == 16) boneMatrix = Matrix4::fromArray(aTransformLink.data());
+			else if (m_aBindPoses.count(aBones[0]->nId)) boneMatrix = m_aBindPoses.at(aBones[0]->nId);
+			float aInverseBind[16];
+			convert(boneMatrix.inverse() * meshMatrix).toFloats(aInverseBind);
+			pSkin->aInverseBindMatrices.insert(pSkin->aInverseBindMatrices.end(), aInverseBind, aInverseBind + 16);
+
+			const std::vector<int64_t>& aIndexes = intArray(pCluster->pNode, "Indexes");
+			const std::vector<double>& aWeights = doubleArray(pCluster->pNode, "Weights");
+			for (size_t i = 0; i < aIndexes.size() && i < aWeights.size(); i++)
+			{
+				if (aIndexes[i] < 0 || aIndexes[i] >= (int64_t)nControlPoints || aWeights[i] <= 0.0) continue;
+				aInfluences[aIndexes[i]].push_back({ nJoint, (float)aWeights[i] });
+			}
+		}
+		for (std::vector<Influence>& aVertexInfluences : aInfluences)
+		{
+			std::sort(aVertexInfluences.begin(), aVertexInfluences.end(), [](const Influence& a, const Influence& b)
+			{
+				return a.fWeight > b.fWeight || (a.fWeight == b.fWeight && a.nJoint < b.nJoint);
+			});
+			if (m_nMaxInfluences > 0 && (int)aVertexInfluences.size() > m_nMaxInfluences) aVertexInfluences.resize(m_nMaxInfluences);
+			float fTotal = 0.0f;
+			for (const Influence& influence : aVertexInfluences) fTotal += influence.fWeight;
+			for (Influence& influence : aVertexInfluences) influence.fWeight /= (fTotal > 0.0f ? fTotal : 1.0f);
+			nInfluences = std::max(nInfluences, (int)aVertexInfluences.size());
+		}
+		nInfluences = std::max(4, (nInfluences + 3) / 4 * 4);
+	}
+
+	// blend shape deltas per control point, one target per channel
+	struct MorphChannel
+	{
+		std::string sName;
+		std::vector<float> aDeltas; // xyz per control point
+	};
+	std::vector<MorphChannel> aMorphChannels;
+	SceneMesh& mesh = scene.aMeshes[job.nMesh];
+	for (const Object* pBlendShape : getSources(job.nGeometryId, "Deformer"))
+	{
+		if (pBlendShape->sSubType != "BlendShape") continue;
+		for (const Object* pChannel : getSources(pBlendShape->nId, "Deformer"))
+		{
+			if (pChannel->sSubType != "BlendShapeChannel") continue;
+			std::vector<const Object*> aShapes = getSources(pChannel->nId, "Geometry");
+			if (aShapes.empty()) continue;
+			// in-between shapes are not supported, the full weight shape is the last one
+			const FbxNode* pShape = aShapes.back()->pNode;
+			MorphChannel channel;
+			channel.sName = aShapes.back()->sName.empty() ? pChannel->sName : aShapes.back()->sName;
+			channel.aDeltas.assign(nControlPoints * 3, 0.0f);
+			const std::vector<int64_t>& aIndexes = intArray(pShape, "Indexes");
+			const std::vector<double>& aDeltas = doubleArray(pShape, "Vertices");
+			for (size_t i = 0; i < aIndexes.size() && i * 3 + 2 < aDeltas.size(); i++)
+			{
+				if (aIndexes[i] < 0 || aIndexes[i] >= (int64_t)nControlPoints) continue;
+				double aDelta[3];
+				vertexMatrix.transformVector(&aDeltas[i * 3], aDelta);
+				for (int c = 0; c < 3; c++) channel.aDeltas[aIndexes[i] * 3 + c] = (float)aDelta[c];
+			}
+			aMorphChannels.push_back(std::move(channel));
+			mesh.aMorphWeights.push_back((float)(pChannel->pNode->getProperty70Double("DeformPercent", 0.0) / 100.0));
+		}
+	}
+
+	// baked subdivision levels replace the polygons, control points and their layers read below
+	int nSubdivisionLevel = 0;
+	for (const std::string& sName : { pModel->sName, pGeometry->sName, pGeometry->sName + ".Shape" })
+	{
+		auto subdivisionLevel = m_aSubdivisionLevels.find(sName);
+		if (subdivisionLevel == m_aSubdivisionLevels.end()) continue;
+		nSubdivisionLevel = subdivisionLevel->second;
+		break;
+	}
+	SubdivisionMesh subdivided;
+	std::vector<int64_t> aSubdividedPolygonVertices;
+	std::vector<int64_t> aSubdividedMaterials;
+	std::vector<double> aSubdividedNormals;
+	std::vector<std::vector<int64_t>> aSubdividedUvIndices(aUvSets.size());
+	if (nSubdivisionLevel > 0)
+	{
+		subdivided.aPositions = aFbxVertices;
+		subdivided.aUvSets.resize(aUvSets.size());
+		for (size_t nSet = 0; nSet < aUvSets.size(); nSet++) subdivided.aUvSets[nSet].aValues = *aUvSets[nSet].pData;
+		int64_t nPolygon = 0;
+		uint32_t nFaceSize = 0;
+		for (size_t nCorner = 0; nCorner < aFbxPolygonVertices.size(); nCorner++)
+		{
+			int64_t nControlPoint = aFbxPolygonVertices[nCorner];
+			bool bLast = nControlPoint < 0;
+			if (bLast) nControlPoint = ~nControlPoint;
+			if (nControlPoint >= (int64_t)nControlPoints)
+			{
+				sError = "invalid polygon vertex index in mesh: " + pGeometry->sName;
+				return false;
+			}
+			subdivided.aFaceVertices.push_back((uint32_t)nControlPoint);
+			for (size_t nSet = 0; nSet < aUvSets.size(); nSet++)
+			{
+				int64_t nUv = aUvSets[nSet].index(nCorner, nControlPoint, nPolygon);
+				subdivided.aUvSets[nSet].aIndices.push_back(nUv >= 0 ? (uint32_t)nUv : 0);
+			}
+			nFaceSize++;
+			if (!bLast) continue;
+			subdivided.aFaceSizes.push_back(nFaceSize);
+			subdivided.aFaceMaterials.push_back(materials.material(nPolygon));
+			nFaceSize = 0;
+			nPolygon++;
+		}
+		for (MorphChannel& channel : aMorphChannels) subdivided.aMorphDeltas.push_back(std::move(channel.aDeltas));
+		if (pSkin)
+		{
+			subdivided.nInfluences = nInfluences;
+			subdivided.aJoints.assign(nControlPoints * nInfluences, -1);
+			subdivided.aWeights.assign(nControlPoints * nInfluences, 0.0f);
+			for (size_t v = 0; v < nControlPoints; v++)
+			{
+				for (size_t i = 0; i < aInfluences[v].size() && (int)i < nInfluences; i++)
+				{
+					subdivided.aJoints[v * nInfluences + i] = aInfluences[v][i].nJoint;
+					subdivided.aWeights[v * nInfluences + i] = aInfluences[v][i].fWeight;
+				}
+			}
+		}
+
+		Subdivider subdivider;
+		subdivider.setThreads(m_nThreads);
+		if (!subdivider.subdivide(subdivided, nSubdivisionLevel))
+		{
+			sError = "unable to subdivide mesh " + pGeometry->sName + ": " + subdivider.getError();
+			return false;
+		}
+		nControlPoints = subdivided.getVertexCount();
+		log("DEBUG: FbxReader: " + pGeometry->sName + " subdivided to level " + std::to_string(nSubdivisionLevel)
+			+ ": " + std::to_string(subdivided.getFaceCount()) + " polygons, " + std::to_string(nControlPoints) + " control points");
+
+		size_t nCorner = 0;
+		aSubdividedPolygonVertices.reserve(subdivided.aFaceVertices.size());
+		for (uint32_t nFaceSize : subdivided.aFaceSizes)
+		{
+			for (uint32_t i = 0; i < nFaceSize; i++, nCorner++)
+			{
+				int64_t nControlPoint = subdivided.aFaceVertices[nCorner];
+				aSubdividedPolygonVertices.push_back(i + 1 == nFaceSize ? ~nControlPoint : nControlPoint);
+			}
+		}
+		aSubdividedMaterials = subdivided.aFaceMaterials;
+		materials.pMaterials = &aSubdividedMaterials;
+		materials.sMapping = "ByPolygon";
+		if (normals.isValid())
+		{
+			aSubdividedNormals = subdivider.computeNormals(subdivided);
+			normals.pData = &aSubdividedNormals;
+			normals.pIndices = &s_emptyIntArray;
+			normals.sMapping = "ByControlPoint";
+			normals.bIndexed = false;
+		}
+		for (size_t nSet = 0; nSet < aUvSets.size(); nSet++)
+		{
+			const std::vector<uint32_t>& aIndices = subdivided.aUvSets[nSet].aIndices;
+			aSubdividedUvIndices[nSet].assign(aIndices.begin(), aIndices.end());
+			aUvSets[nSet].pData = &subdivided.aUvSets[nSet].aValues;
+			aUvSets[nSet].pIndices = &aSubdividedUvIndices[nSet];
+			aUvSets[nSet].sMapping = "ByPolygonVertex";
+			aUvSets[nSet].bIndexed = true;
+		}
+		for (size_t nMorph = 0; nMorph < aMorphChannels.size(); nMorph++) aMorphChannels[nMorph].aDeltas = std::move(subdivided.aMorphDeltas[nMorph]);
+		if (pSkin)
+		{
+			aInfluences.assign(nControlPoints, std::vector<Influence>());
+			for (size_t v = 0; v < nControlPoints; v++)
+			{
+				for (int i = 0; i < nInfluences; i++)
+				{
+					if (subdivided.aJoints[v * nInfluences + i] < 0) continue;
+					aInfluences[v].push_back({ subdivided.aJoints[v * nInfluences + i], subdivided.aWeights[v * nInfluences + i] });
+				}
+			}
+		}
+		subdivided.aFaceVertices.clear();
+		subdivided.aFaceVertices.shrink_to_fit();
+	}
+	const std::vector<double>& aVertices = (nSubdivisionLevel > 0) ? subdivided.aPositions : aFbxVertices;
+	const std::vector<int64_t>& aPolygonVertices = (nSubdivisionLevel > 0) ? aSubdividedPolygonVertices : aFbxPolygonVertices;
+
+	// triangulated polygons, split into one primitive per material
+	std::map<int, int> aPrimitiveIndices; // scene material -> primitive
+	std::vector<std::unordered_map<VertexKey, uint32_t, VertexKeyHash>> aVertexMaps;
+	std::vector<std::vector<int64_t>> aPrimitiveControlPoints;
+	std::vector<uint32_t> aPolygon;
+	int64_t nPolygon = 0;
+	size_t nPolygonStart = 0;
+	for (size_t nPolygonVertex = 0; nPolygonVertex < aPolygonVertices.size(); nPolygonVertex++)
+	{
+		if (aPolygonVertices[nPolygonVertex] >= 0) continue;
+		// polygon [nPolygonStart, nPolygonVertex], the last index is stored as ~index
+		int64_t nMaterialSlot = materials.material(nPolygon);
+		int nMaterial = (nMaterialSlot >= 0 && nMaterialSlot < (int64_t)aModelMaterials.size()) ? aModelMaterials[nMaterialSlot] : -1;
+		auto primitiveEntry = aPrimitiveIndices.find(nMaterial);
+		int nPrimitive;
+		if (primitiveEntry == aPrimitiveIndices.end())
+		{
+			nPrimitive = (int)mesh.aPrimitives.size();
+			aPrimitiveIndices[nMaterial] = nPrimitive;
+			mesh.aPrimitives.push_back(ScenePrimitive());
+			mesh.aPrimitives.back().nMaterial = nMaterial;
+			mesh.aPrimitives.back().aTexCoords.resize(aUvSets.size());
+			aVertexMaps.emplace_back();
+			aPrimitiveControlPoints.emplace_back();
+		}
+		else
+		{
+			nPrimitive = primitiveEntry->second;
+		}
+		ScenePrimitive& primitive = mesh.aPrimitives[nPrimitive];
+
+		aPolygon.clear();
+		for (size_t nCorner = nPolygonStart; nCorner <= nPolygonVertex; nCorner++)
+		{
+			int64_t nControlPoint = aPolygonVertices[nCorner];
+			if (nControlPoint < 0) nControlPoint = ~nControlPoint;
+			if (nControlPoint >= (int64_t)nControlPoints)
+			{
+				sError = "invalid polygon vertex index in mesh: " + pGeometry->sName;
+				return false;
+			}
+			VertexKey key;
+			key.nControlPoint = nControlPoint;
+			std::fill(key.aValues, key.aValues + 7, 0.0f);
+			int64_t nNormal = normals.isValid() ? normals.index(nCorner, nControlPoint, nPolygon) : -1;
+			if (nNormal >= 0)
+			{
+				for (int c = 0; c < 3; c++) key.aValues[c] = (float)(*normals.pData)[nNormal * 3 + c];
+			}
+			for (size_t nSet = 0; nSet < aUvSets.size(); nSet++)
+			{
+				int64_t nUv = aUvSets[nSet].index(nCorner, nControlPoint, nPolygon);
+				if (nUv < 0) continue;
+				key.aValues[3 + nSet * 2] = (float)(*aUvSets[nSet].pData)[nUv * 2];
+				key.aValues[4 + nSet * 2] = (float)(*aUvSets[nSet].pData)[nUv * 2 + 1];
+			}
+
+			auto vertex = aVertexMaps[nPrimitive].find(key);
+			if (vertex != aVertexMaps[nPrimitive].end())
+			{
+				aPolygon.push_back(vertex->second);
+				continue;
+			}
+			uint32_t nVertex = (uint32_t)primitive.getVertexCount();
+			aVertexMaps[nPrimitive][key] = nVertex;
+			aPrimitiveControlPoints[nPrimitive].push_back(nControlPoint);
+			aPolygon.push_back(nVertex);
+
+			double aPosition[3];
+			vertexMatrix.transformPoint(&aVertices[nControlPoint * 3], aPosition);
+			for (int c = 0; c < 3; c++) primitive.aPositions.push_back((float)aPosition[c]);
+			if (normals.isValid())
+			{
+				double aNormal[3] = { key.aValues[0], key.aValues[1], key.aValues[2] };
+				normalMatrix.transformVector(aNormal, aNormal);
+				double fLength = std::sqrt(aNormal[0] * aNormal[0] + aNormal[1] * aNormal[1] + aNormal[2] * aNormal[2]);
+				for (int c = 0; c < 3; c++) primitive.aNormals.push_back((float)(fLength > 0.0 ? aNormal[c] / fLength : 0.0));
+			}
+			for (size_t nSet = 0; nSet < aUvSets.size(); nSet++)
+			{
+				primitive.aTexCoords[nSet].push_back(key.aValues[3 + nSet * 2]);
+				primitive.aTexCoords[nSet].push_back(1.0f - key.aValues[4 + nSet * 2]);
+			}
+		}
+		// fan triangulation, as the polygons exported by Daz Studio are convex
+		for (size_t i = 1; i + 1 < aPolygon.size(); i++)
+		{
+			primitive.aIndices.push_back(aPolygon[0]);
+			primitive.aIndices.push_back(aPolygon[i]);
+			primitive.aIndices.push_back(aPolygon[i + 1]);
+		}
+		nPolygon++;
+		nPolygonStart = nPolygonVertex + 1;
+	}
+
+	// per vertex skinning and morph data from the control points
+	for (size_t nPrimitive = 0; nPrimitive < mesh.aPrimitives.size(); nPrimitive++)
+	{
+		ScenePrimitive& primitive = mesh.aPrimitives[nPrimitive];
+		const std::vector<int64_t>& aControlPoints = aPrimitiveControlPoints[nPrimitive];
+		if (pSkin)
+		{
+			primitive.nInfluences = nInfluences;
+			primitive.aJoints.assign(aControlPoints.size() * nInfluences, 0);
+			primitive.aWeights.assign(aControlPoints.size() * nInfluences, 0.0f);
+			for (size_t v = 0; v < aControlPoints.size(); v++)
+			{
+				const std::vector<Influence>& aVertexInfluences = aInfluences[aControlPoints[v]];
+				for (size_t i = 0; i < aVertexInfluences.size() && (int)i < nInfluences; i++)
+				{
+					primitive.aJoints[v * nInfluences + i] = (uint16_t)aVertexInfluences[i].nJoint;
+					primitive.aWeights[v * nInfluences + i] = aVertexInfluences[i].fWeight;
+				}
+			}
+		}
+		for (const MorphChannel& channel : aMorphChannels)
+		{
+			SceneMorphTarget target;
+			target.sName = channel.sName;
+			target.aPositionDeltas.resize(aControlPoints.size() * 3);
+			for (size_t v = 0; v < aControlPoints.size(); v++)
+			{
+				for (int c = 0; c < 3; c++) target.aPositionDeltas[v * 3 + c] = channel.aDeltas[aControlPoints[v] * 3 + c];
+			}
+			primitive.aMorphTargets.push_back(std::move(target));
+		}
+	}
+	return true;
+}
+
+void FbxReader::readMeshes(Scene& scene)
+{
+	std::vector<MeshJob> aJobs;
+	std::vector<const Object*> aModels;
+	for (const auto& entry : m_aObjects)
+	{
+		if (entry.second.sType == "Model") aModels.push_back(&entry.second);
+	}
+	std::sort(aModels.begin(), aModels.end(), [](const Object* a, const Object* b) { return a->pNode < b->pNode; });
+	for (const Object* pModel : aModels)
+	{
+		for (const Object* pGeometry : getSources(pModel->nId, "Geometry"))
+		{
+			if (pGeometry->sSubType != "Mesh") continue;
+			MeshJob job;
+			job.nModelId = pModel->nId;
+			job.nGeometryId = pGeometry->nId;
+			job.nNode = m_aModelNodes[pModel->nId];
+			job.nMesh = (int)scene.aMeshes.size();
+			scene.aMeshes.push_back(SceneMesh());
+			scene.aMeshes.back().sName = pGeometry->sName.empty() ? pModel->sName : pGeometry->sName;
+			std::vector<const Object*> aDeformers = getSources(pGeometry->nId, "Deformer");
+			if (!aDeformers.empty() && aDeformers[0]->sSubType == "Skin" && !getSources(aDeformers[0]->nId, "Deformer").empty())
+			{
+				job.nSkin = (int)scene.aSkins.size();
+				scene.aSkins.push_back(SceneSkin());
+				scene.aSkins.back().sName = pModel->sName;
+			}
+			scene.aNodes[job.nNode].nMesh = job.nMesh;
+			scene.aNodes[job.nNode].nSkin = job.nSkin;
+			aJobs.push_back(job);
+			break;
+		}
+	}
+
+	std::mutex errorMutex;
+	parallelFor(aJobs.size(), m_nThreads, [&](size_t i)
+	{
+		std::string sError;
+		if (!readMesh(aJobs[i], scene, sError))
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			log("ERROR: FbxReader: " + sError);
+			scene.aMeshes[aJobs[i].nMesh].aPrimitives.clear();
+		}
+	});
+	// meshes which failed to read are detached from their nodes
+	for (const MeshJob& job : aJobs)
+	{
+		if (scene.aMeshes[job.nMesh].aPrimitives.empty())
+		{
+			scene.aNodes[job.nNode].nMesh = -1;
+			scene.aNodes[job.nNode].nSkin = -1;
+		}
+	}
+}
+
+void FbxReader::readAnimations(Scene& scene)
+{
+	std::vector<const Object*> aStacks;
+	for (const auto& entry : m_aObjects)
+	{
+		if (entry.second.sType == "AnimationStack") aStacks.push_back(&entry.second);
+	}
+	std::sort(aStacks.begin(), aStacks.end(), [](const Object* a, const Object* b) { return a->pNode < b->pNode; });
+
+	// blend shape channel -> (mesh node, target index)
+	std::unordered_map<int64_t, std::pair<int, int>> aChannelTargets;
+	for (const auto& entry : m_aModelNodes)
+	{
+		if (scene.aNodes[entry.second].nMesh < 0) continue;
+		for (const Object* pGeometry : getSources(entry.first, "Geometry"))
+		{
+			int nTarget = 0;
+			for (const Object* pBlendShape : getSources(pGeometry->nId, "Deformer"))
+			{
+				if (pBlendShape->sSubType != "BlendShape") continue;
+				for (const Object* pChannel : getSources(pBlendShape->nId, "Deformer"))
+				{
+					if (pChannel->sSubType != "BlendShapeChannel" || getSources(pChannel->nId, "Geometry").empty()) continue;
+					aChannelTargets[pChannel->nId] = std::make_pair(entry.second, nTarget++);
+				}
+			}
+		}
+	}
+
+	for (const Object* pStack : aStacks)
+	{
+		SceneAnimation animation;
+		animation.sName = pStack->sName;
+		int64_t nStart = pStack->pNode->getProperty70Int("LocalStart", 0);
+		std::vector<const Object*> aLayers = getSources(pStack->nId, "AnimationLayer");
+		if (aLayers.empty()) continue;
+
+		struct ModelCurves
+		{
+			Curve aCurves[3][3]; // translation, rotation, scaling x xyz
+			bool aAnimated[3] = { false, false, false };
+		};
+		std::map<int64_t, ModelCurves> aModelCurves;
+		std::map<int, std::map<int, Curve>> aWeightCurves; // mesh node -> target -> curve
+		for (const Object* pCurveNode : getSources(aLayers[0]->nId, "AnimationCurveNode"))
+		{
+			auto destinations = m_aDestinations.find(pCurveNode->nId);
+			if (destinations == m_aDestinations.end()) continue;
+			for (const Connection& destination : destinations->second)
+			{
+				const Object* pTarget = findObject(destination.nId);
+				if (pTarget == nullptr) continue;
+				if (pTarget->sType == "Model")
+				{
+					int nComponent = -1;
+					if (destination.sProperty == "Lcl Translation") nComponent = 0;
+					else if (destination.sProperty == "Lcl Rotation") nComponent = 1;
+					else if (destination.sProperty == "Lcl Scaling") nComponent = 2;
+					if (nComponent < 0) continue;
+					ModelCurves& curves = aModelCurves[pTarget->nId];
+					static const char* s_aAxes[3] = { "d|X", "d|Y", "d|Z" };
+					for (int c = 0; c < 3; c++)
+					{
+						std::vector<const Object*> aCurves = getSources(pCurveNode->nId, "AnimationCurve", s_aAxes[c]);
+						if (aCurves.empty()) continue;
+						curves.aCurves[nComponent][c] = readCurve(aCurves[0]->pNode);
+						if (curves.aCurves[nComponent][c].isSet()) curves.aAnimated[nComponent] = true;
+					}
+				}
+				else if (pTarget->sSubType == "BlendShapeChannel" && destination.sProperty == "DeformPercent")
+				{
+					auto target = aChannelTargets.find(pTarget->nId);
+					std::vector<const Object*> aCurves = getSources(pCurveNode->nId, "AnimationCurve", "d|DeformPercent");
+					if (target == aChannelTargets.end() || aCurves.empty()) continue;
+					Curve curve = readCurve(aCurves[0]->pNode);
+					if (curve.isSet()) aWeightCurves[target->second.first][target->second.second] = curve;
+				}
+			}
+		}
+
+		for (auto& entry : aModelCurves)
+		{
+			const Object* pModel = findObject(entry.first);
+			const ModelCurves& curves = entry.second;
+			std::vector<int64_t> aTimes;
+			for (int i = 0; i < 3; i++)
+			{
+				for (int c = 0; c < 3; c++) appendTimes(curves.aCurves[i][c], aTimes);
+			}
+			if (aTimes.empty()) continue;
+			std::sort(aTimes.begin(), aTimes.end());
+			aTimes.erase(std::unique(aTimes.begin(), aTimes.end()), aTimes.end());
+
+			// pivots and offsets mix rotation and scale into the translation
+			double aOffset[3] = { 0, 0, 0 };
+			bool bPivots = false;
+			for (const char* sProperty : { "RotationOffset", "RotationPivot", "ScalingOffset", "ScalingPivot" })
+			{
+				if (pModel->pNode->getProperty70Vector(sProperty, aOffset) && (aOffset[0] != 0.0 || aOffset[1] != 0.0 || aOffset[2] != 0.0)) bPivots = true;
+			}
+			double aDefaults[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 1, 1, 1 } };
+			pModel->pNode->getProperty70Vector("Lcl Translation", aDefaults[0]);
+			pModel->pNode->getProperty70Vector("Lcl Rotation", aDefaults[1]);
+			pModel->pNode->getProperty70Vector("Lcl Scaling", aDefaults[2]);
+
+			SceneAnimationChannel aChannels[3];
+			static const char* s_aPaths[3] = { "translation", "rotation", "scale" };
+			double aPreviousRotation[4] = { 0, 0, 0, 1 };
+			for (int64_t nTime : aTimes)
+			{
+				double aValues[3][3];
+				for (int i = 0; i < 3; i++)
+				{
+					for (int c = 0; c < 3; c++)
+					{
+						aValues[i][c] = curves.aCurves[i][c].isSet() ? curves.aCurves[i][c].evaluate(nTime) : aDefaults[i][c];
+					}
+				}
+				double aTranslation[3], aRotation[4], aScale[3];
+				convert(localMatrix(*pModel->pNode, aValues[0], aValues[1], aValues[2])).decompose(aTranslation, aRotation, aScale);
+				// shortest path between consecutive keys
+				double fDot = 0.0;
+				for (int c = 0; c < 4; c++) fDot += aRotation[c] * aPreviousRotation[c];
+				if (fDot < 0.0)
+				{
+					for (int c = 0; c < 4; c++) aRotation[c] = -aRotation[c];
+				}
+				memcpy(aPreviousRotation, aRotation, sizeof(aPreviousRotation));
+
+				float fSeconds = (float)std::max(0.0, (double)(nTime - nStart) / (double)FBX_TICKS_PER_SECOND);
+				const double* aComponents[3] = { aTranslation, aRotation, aScale };
+				for (int i = 0; i < 3; i++)
+				{
+					aChannels[i].aTimes.push_back(fSeconds);
+					for (int c = 0; c < (i == 1 ? 4 : 3); c++) aChannels[i].aValues.push_back((float)aComponents[i][c]);
+				}
+			}
+			for (int i = 0; i < 3; i++)
+			{
+				// rotation changes the translation of nodes with pre/post rotation only through pivots
+				if (!curves.aAnimated[i] && !bPivots) continue;
+				aChannels[i].nNode = m_aModelNodes[pModel->nId];
+				aChannels[i].sPath = s_aPaths[i];
+				animation.aChannels.push_back(std::move(aChannels[i]));
+			}
+		}
+
+		for (auto& entry : aWeightCurves)
+		{
+			int nNode = entry.first;
+			const SceneMesh& mesh = scene.aMeshes[scene.aNodes[nNode].nMesh];
+			size_t nTargets = mesh.aMorphWeights.size();
+			std::vector<int64_t> aTimes;
+			for (auto& curve : entry.second) appendTimes(curve.second, aTimes);
+			std::sort(aTimes.begin(), aTimes.end());
+			aTimes.erase(std::unique(aTimes.begin(), aTimes.end()), aTimes.end());
+			SceneAnimationChannel channel;
+			channel.nNode = nNode;
+			channel.sPath = "weights";
+			for (int64_t nTime : aTimes)
+			{
+				channel.aTimes.push_back((float)std::max(0.0, (double)(nTime - nStart) / (double)FBX_TICKS_PER_SECOND));
+				for (size_t nTarget = 0; nTarget < nTargets; nTarget++)
+				{
+					auto curve = entry.second.find((int)nTarget);
+					channel.aValues.push_back(curve != entry.second.end() ? (float)(curve->second.evaluate(nTime) / 100.0) : mesh.aMorphWeights[nTarget]);
+				}
+			}
+			animation.aChannels.push_back(std::move(channel));
+		}
+
+		if (!animation.aChannels.empty()) scene.aAnimations.push_back(std::move(animation));
+	}
+}
+
+bool FbxReader::read(const FbxDocument& document, Scene& scene)
+{
+	m_sError.clear();
+	const FbxNode& root = document.getRoot();
+	if (root.find("Objects") == nullptr)
+	{
+		m_sError = "FBX file without objects";
+		return false;
+	}
+	readGlobalSettings(root);
+	readObjects(root);
+	readBindPoses();
+	readModels(scene);
+	readMaterials(scene);
+	if (!m_bSkipMeshes) readMeshes(scene);
+	readAnimations(scene);
+
+	size_t nVertices = 0;
+	for (const SceneMesh& mesh : scene.aMeshes)
+	{
+		for (const ScenePrimitive& primitive : mesh.aPrimitives) nVertices += primitive.getVertexCount();
+	}
+	log("DEBUG: FbxReader: nodes=" + std::to_string(scene.aNodes.size()) + ", meshes=" + std::to_string(scene.aMeshes.size())
+		+ ", vertices=" + std::to_string(nVertices) + ", skins=" + std::to_string(scene.aSkins.size())
+		+ ", materials=" + std::to_string(scene.aMaterials.size()) + ", animations=" + std::to_string(scene.aAnimations.size()));
+	return true;
+}
+
+bool FbxReader::read(const std::string& sFilePath, Scene& scene)
+{
+	FbxDocument document;
+	if (!document.load(sFilePath, m_nThreads))
+	{
+		m_sError = document.getError();
+		return false;
+	}
+	return read(document, scene);
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FbxDocument.h"
+#include "Math.h"
+#include "Scene.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Builds a Scene from the binary FBX files written by the Daz FBX exporter
+ * with the DzGodotAction::setExportOptions() settings: model hierarchy with
+ * pre/post rotation (as blender_tools.import_fbx() with use_prepost_rot),
+ * meshes with normals, UV sets and per-polygon materials, skin clusters,
+ * blend shapes, bind poses and one animation per animation stack.  The
+ * scene is converted to glTF conventions: meters and Y up.
+ */
+class FbxReader
+{
+public:
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+	// animation-only exports reuse the meshes of the published character
+	void setSkipMeshes(bool bSkip) { m_bSkipMeshes = bSkip; }
+	// joints/weights kept per vertex, 0 = all (rounded up to a multiple of 4)
+	void setMaxInfluences(int nMaxInfluences) { m_nMaxInfluences = nMaxInfluences; }
+	// Catmull-Clark levels baked into meshes, by mesh model name ("<node>.Shape"), see Subdivider
+	void setSubdivisionLevels(const std::map<std::string, int>& aLevels) { m_aSubdivisionLevels = aLevels; }
+
+	bool read(const std::string& sFilePath, Scene& scene);
+	bool read(const FbxDocument& document, Scene& scene);
+
+	const std::string& getError() const { return m_sError; }
+
+	static const int64_t FBX_TICKS_PER_SECOND = 46186158000LL;
+
+protected:
+	struct Object
+	{
+		int64_t nId = 0;
+		std::string sType; // "Model", "Geometry", "Material", "Deformer", ...
+		std::string sName;
+		std::string sSubType; // "LimbNode", "Mesh", "Skin", "Cluster", "BlendShapeChannel", "Shape", ...
+		const FbxNode* pNode = nullptr;
+	};
+
+	struct Connection
+	{
+		int64_t nId = 0;
+		std::string sProperty; // empty for object-object connections
+	};
+
+	struct MeshJob
+	{
+		int64_t nModelId = 0;
+		int64_t nGeometryId = 0;
+		int nNode = -1;
+		int nMesh = -1;
+		int nSkin = -1;
+	};
+
+	int m_nThreads = 0;
+	bool m_bSkipMeshes = false;
+	int m_nMaxInfluences = 0;
+	std::map<std::string, int> m_aSubdivisionLevels;
+	std::string m_sError;
+
+	std::unordered_map<int64_t, Object> m_aObjects;
+	std::unordered_map<int64_t, std::vector<Connection>> m_aSources; // destination -> connected sources, in file order
+	std::unordered_map<int64_t, std::vector<Connection>> m_aDestinations; // source -> destinations
+	std::unordered_map<int64_t, int> m_aModelNodes; // model id -> scene node
+	std::unordered_map<int64_t, Matrix4> m_aBindPoses; // model id -> bind pose world matrix
+	Matrix4 m_oConversion; // FBX axes and units -> glTF
+	Matrix4 m_oInverseConversion;
+	double m_fUnitScale = 0.01;
+
+	void readGlobalSettings(const FbxNode& root);
+	void readObjects(const FbxNode& root);
+	void readBindPoses();
+	void readModels(Scene& scene);
+	void readMaterials(Scene& scene);
+	void readMeshes(Scene& scene);
+	bool readMesh(const MeshJob& job, Scene& scene, std::string& sError) const;
+	void readAnimations(Scene& scene);
+
+	const Object* findObject(int64_t nId) const;
+	std::vector<const Object*> getSources(int64_t nId, const std::string& sType, const std::string& sProperty = "") const;
+	std::vector<const Object*> getDestinations(int64_t nId, const std::string& sType) const;
+
+	Matrix4 localMatrix(const FbxNode& model, const double* pTranslation = nullptr, const double* pRotation = nullptr, const double* pScale = nullptr) const;
+	Matrix4 geometricMatrix(const FbxNode& model) const;
+	Matrix4 convert(const Matrix4& matrix) const { return m_oConversion * matrix * m_oInverseConversion; }
+};
+
+}
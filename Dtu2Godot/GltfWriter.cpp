@@ -0,0 +1,656 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#ifndef _WIN32
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "GltfWriter.h"
+#include "Log.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+const int GL_ARRAY_BUFFER = 34962;
+const int GL_ELEMENT_ARRAY_BUFFER = 34963;
+const int GL_UNSIGNED_SHORT = 5123;
+const int GL_UNSIGNED_INT = 5125;
+const int GL_FLOAT = 5126;
+
+int componentCount(const std::string& sType)
+{
+	if (sType == "SCALAR") return 1;
+	if (sType == "VEC2") return 2;
+	if (sType == "VEC3") return 3;
+	if (sType == "VEC4") return 4;
+	if (sType == "MAT4") return 16;
+	return 1;
+}
+
+int componentSize(int nComponentType)
+{
+	return (nComponentType == GL_FLOAT || nComponentType == GL_UNSIGNED_INT) ? 4 : 2;
+}
+
+JsonValue floatArray(const float* pValues, int nCount)
+{
+	JsonValue array = JsonValue::array();
+	for (int i = 0; i < nCount; i++) array.append((double)pValues[i]);
+	return array;
+}
+
+void addExtensionUsed(JsonValue& json, const std::string& sExtension)
+{
+	JsonValue& extensions = json["extensionsUsed"];
+	for (size_t i = 0; i < extensions.size(); i++)
+	{
+		if (extensions[i].toString() == sExtension) return;
+	}
+	extensions.append(sExtension);
+}
+
+bool readFile(const std::string& sFilePath, std::vector<uint8_t>& aData)
+{
+	std::ifstream file(sFilePath, std::ios::binary);
+	if (!file) return false;
+	aData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+struct FilePiece
+{
+	const void* pData;
+	size_t nBytes;
+};
+
+// writes the pieces in order with scatter-gather writes where available
+bool writeFile(const std::string& sFilePath, const std::vector<FilePiece>& aPieces)
+{
+#ifndef _WIN32
+	int nFile = open(sFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (nFile < 0) return false;
+	std::vector<iovec> aVectors;
+	for (const FilePiece& piece : aPieces)
+	{
+		if (piece.nBytes > 0) aVectors.push_back({ const_cast<void*>(piece.pData), piece.nBytes });
+	}
+	size_t nNext = 0;
+	while (nNext < aVectors.size())
+	{
+		int nCount = (int)std::min(aVectors.size() - nNext, (size_t)IOV_MAX);
+		ssize_t nWritten = writev(nFile, &aVectors[nNext], nCount);
+		if (nWritten < 0)
+		{
+			if (errno == EINTR) continue;
+			close(nFile);
+			return false;
+		}
+		// skip the written vectors, a partial write continues inside a vector
+		while (nNext < aVectors.size() && nWritten >= (ssize_t)aVectors[nNext].iov_len)
+		{
+			nWritten -= aVectors[nNext].iov_len;
+			nNext++;
+		}
+		if (nWritten > 0)
+		{
+			aVectors[nNext].iov_base = (uint8_t*)aVectors[nNext].iov_base + nWritten;
+			aVectors[nNext].iov_len -= nWritten;
+		}
+	}
+	return close(nFile) == 0;
+#else
+	std::ofstream file(sFilePath, std::ios::binary | std::ios::trunc);
+	for (const FilePiece& piece : aPieces)
+	{
+		file.write((const char*)piece.pData, piece.nBytes);
+	}
+	return (bool)file;
+#endif
+}
+}
+
+int GltfWriter::addBufferView(const void* pData, size_t nBytes, int nTarget)
+{
+	m_nBufferSize = (m_nBufferSize + 3) / 4 * 4;
+	BufferSegment segment;
+	segment.nOffset = m_nBufferSize;
+	segment.nBytes = nBytes;
+	segment.pData = (const uint8_t*)pData;
+	m_aSegments.push_back(std::move(segment));
+	m_nBufferSize += nBytes;
+
+	JsonValue view = JsonValue::object();
+	view["buffer"] = 0;
+	view["byteOffset"] = m_aSegments.back().nOffset;
+	view["byteLength"] = nBytes;
+	if (nTarget != 0) view["target"] = nTarget;
+	JsonValue& views = m_oJson["bufferViews"];
+	views.append(view);
+	return (int)views.size() - 1;
+}
+
+int GltfWriter::addBufferView(size_t nBytes, int nTarget, const std::function<bool(std::vector<uint8_t>&)>& encode)
+{
+	int nView = addBufferView(nullptr, nBytes, nTarget);
+	m_aSegments.back().encode = encode;
+	return nView;
+}
+
+int GltfWriter::addAccessor(int nBufferView, size_t nCount, int nComponentType, const std::string& sType)
+{
+	JsonValue accessor = JsonValue::object();
+	accessor["bufferView"] = nBufferView;
+	accessor["componentType"] = nComponentType;
+	accessor["count"] = nCount;
+	accessor["type"] = sType;
+	JsonValue& accessors = m_oJson["accessors"];
+	accessors.append(accessor);
+	return (int)accessors.size() - 1;
+}
+
+int GltfWriter::addAccessor(const void* pData, size_t nCount, int nComponentType, const std::string& sType, int nTarget, bool bMinMax)
+{
+	int nComponents = componentCount(sType);
+	int nView = addBufferView(pData, nCount * nComponents * componentSize(nComponentType), nTarget);
+	int nAccessor = addAccessor(nView, nCount, nComponentType, sType);
+	if (bMinMax && nComponentType == GL_FLOAT && nCount > 0)
+	{
+		BoundsJob job;
+		job.nAccessor = nAccessor;
+		job.pValues = (const float*)pData;
+		job.nCount = nCount;
+		job.nComponents = nComponents;
+		m_aBoundsJobs.push_back(std::move(job));
+	}
+	return nAccessor;
+}
+
+void GltfWriter::writeNodes(const Scene& scene)
+{
+	for (const SceneNode& node : scene.aNodes)
+	{
+		JsonValue jsonNode = JsonValue::object();
+		if (!node.sName.empty()) jsonNode["name"] = node.sName;
+		if (node.aTranslation[0] != 0.0f || node.aTranslation[1] != 0.0f || node.aTranslation[2] != 0.0f)
+		{
+			jsonNode["translation"] = floatArray(node.aTranslation, 3);
+		}
+		if (node.aRotation[0] != 0.0f || node.aRotation[1] != 0.0f || node.aRotation[2] != 0.0f || node.aRotation[3] != 1.0f)
+		{
+			jsonNode["rotation"] = floatArray(node.aRotation, 4);
+		}
+		if (node.aScale[0] != 1.0f || node.aScale[1] != 1.0f || node.aScale[2] != 1.0f)
+		{
+			jsonNode["scale"] = floatArray(node.aScale, 3);
+		}
+		if (!node.aChildren.empty())
+		{
+			JsonValue& children = jsonNode["children"];
+			for (int nChild : node.aChildren) children.append(nChild);
+		}
+		if (node.nMesh >= 0) jsonNode["mesh"] = node.nMesh;
+		if (node.nSkin >= 0) jsonNode["skin"] = node.nSkin;
+		m_oJson["nodes"].append(jsonNode);
+	}
+
+	JsonValue jsonScene = JsonValue::object();
+	jsonScene["name"] = scene.sName;
+	jsonScene["nodes"] = JsonValue::array();
+	for (int nRoot : scene.aRootNodes) jsonScene["nodes"].append(nRoot);
+	m_oJson["scenes"].append(jsonScene);
+	m_oJson["scene"] = 0;
+}
+
+void GltfWriter::writeMeshes(const Scene& scene)
+{
+	for (const SceneMesh& mesh : scene.aMeshes)
+	{
+		JsonValue jsonMesh = JsonValue::object();
+		jsonMesh["name"] = mesh.sName;
+		jsonMesh["primitives"] = JsonValue::array();
+		for (const ScenePrimitive& primitive : mesh.aPrimitives)
+		{
+			size_t nVertices = primitive.getVertexCount();
+			JsonValue jsonPrimitive = JsonValue::object();
+			JsonValue& attributes = jsonPrimitive["attributes"];
+			attributes["POSITION"] = addAccessor(primitive.aPositions.data(), nVertices, GL_FLOAT, "VEC3", GL_ARRAY_BUFFER, true);
+			if (!primitive.aNormals.empty())
+			{
+				attributes["NORMAL"] = addAccessor(primitive.aNormals.data(), nVertices, GL_FLOAT, "VEC3", GL_ARRAY_BUFFER);
+			}
+			if (!primitive.aTangents.empty())
+			{
+				attributes["TANGENT"] = addAccessor(primitive.aTangents.data(), nVertices, GL_FLOAT, "VEC4", GL_ARRAY_BUFFER);
+			}
+			for (size_t nSet = 0; nSet < primitive.aTexCoords.size(); nSet++)
+			{
+				attributes["TEXCOORD_" + std::to_string(nSet)] = addAccessor(primitive.aTexCoords[nSet].data(), nVertices, GL_FLOAT, "VEC2", GL_ARRAY_BUFFER);
+			}
+			// joints and weights are stored in sets of four influences
+			for (int nSet = 0; nSet < primitive.nInfluences / 4; nSet++)
+			{
+				std::string sSet = std::to_string(nSet);
+				if (primitive.nInfluences == 4)
+				{
+					attributes["JOINTS_" + sSet] = addAccessor(primitive.aJoints.data(), nVertices, GL_UNSIGNED_SHORT, "VEC4", GL_ARRAY_BUFFER);
+					attributes["WEIGHTS_" + sSet] = addAccessor(primitive.aWeights.data(), nVertices, GL_FLOAT, "VEC4", GL_ARRAY_BUFFER);
+					continue;
+				}
+				auto encodeSet = [&primitive, nSet, nVertices](const void* pSource, size_t nSize, std::vector<uint8_t>& aData)
+				{
+					const uint8_t* pBytes = (const uint8_t*)pSource;
+					for (size_t v = 0; v < nVertices; v++)
+					{
+						memcpy(&aData[v * 4 * nSize], pBytes + (v * primitive.nInfluences + nSet * 4) * nSize, 4 * nSize);
+					}
+					return true;
+				};
+				int nJointsView = addBufferView(nVertices * 4 * sizeof(uint16_t), GL_ARRAY_BUFFER, [&primitive, encodeSet](std::vector<uint8_t>& aData)
+				{
+					return encodeSet(primitive.aJoints.data(), sizeof(uint16_t), aData);
+				});
+				attributes["JOINTS_" + sSet] = addAccessor(nJointsView, nVertices, GL_UNSIGNED_SHORT, "VEC4");
+				int nWeightsView = addBufferView(nVertices * 4 * sizeof(float), GL_ARRAY_BUFFER, [&primitive, encodeSet](std::vector<uint8_t>& aData)
+				{
+					return encodeSet(primitive.aWeights.data(), sizeof(float), aData);
+				});
+				attributes["WEIGHTS_" + sSet] = addAccessor(nWeightsView, nVertices, GL_FLOAT, "VEC4");
+			}
+			if (!primitive.aIndices.empty())
+			{
+				// valid indices are below the vertex count
+				if (nVertices <= 65535)
+				{
+					int nView = addBufferView(primitive.aIndices.size() * sizeof(uint16_t), GL_ELEMENT_ARRAY_BUFFER, [&primitive](std::vector<uint8_t>& aData)
+					{
+						uint16_t* pIndices = (uint16_t*)aData.data();
+						for (size_t i = 0; i < primitive.aIndices.size(); i++) pIndices[i] = (uint16_t)primitive.aIndices[i];
+						return true;
+					});
+					jsonPrimitive["indices"] = addAccessor(nView, primitive.aIndices.size(), GL_UNSIGNED_SHORT, "SCALAR");
+				}
+				else
+				{
+					jsonPrimitive["indices"] = addAccessor(primitive.aIndices.data(), primitive.aIndices.size(), GL_UNSIGNED_INT, "SCALAR", GL_ELEMENT_ARRAY_BUFFER);
+				}
+			}
+			if (primitive.nMaterial >= 0) jsonPrimitive["material"] = primitive.nMaterial;
+			for (const SceneMorphTarget& target : primitive.aMorphTargets)
+			{
+				JsonValue jsonTarget = JsonValue::object();
+				jsonTarget["POSITION"] = addAccessor(target.aPositionDeltas.data(), nVertices, GL_FLOAT, "VEC3", GL_ARRAY_BUFFER, true);
+				if (!target.aNormalDeltas.empty())
+				{
+					jsonTarget["NORMAL"] = addAccessor(target.aNormalDeltas.data(), nVertices, GL_FLOAT, "VEC3", GL_ARRAY_BUFFER);
+				}
+				jsonPrimitive["targets"].append(jsonTarget);
+			}
+			jsonMesh["primitives"].append(jsonPrimitive);
+		}
+		// morph target names as written by the blender glTF exporter
+		if (!mesh.aPrimitives.empty() && !mesh.aPrimitives[0].aMorphTargets.empty())
+		{
+			JsonValue& names = jsonMesh["extras"]["targetNames"];
+			names = JsonValue::array();
+			for (const SceneMorphTarget& target : mesh.aPrimitives[0].aMorphTargets) names.append(target.sName);
+			JsonValue& weights = jsonMesh["weights"];
+			weights = JsonValue::array();
+			for (size_t i = 0; i < mesh.aPrimitives[0].aMorphTargets.size(); i++)
+			{
+				weights.append(i < mesh.aMorphWeights.size() ? (double)mesh.aMorphWeights[i] : 0.0);
+			}
+		}
+		m_oJson["meshes"].append(jsonMesh);
+	}
+}
+
+void GltfWriter::writeSkins(const Scene& scene)
+{
+	for (const SceneSkin& skin : scene.aSkins)
+	{
+		JsonValue jsonSkin = JsonValue::object();
+		if (!skin.sName.empty()) jsonSkin["name"] = skin.sName;
+		jsonSkin["joints"] = JsonValue::array();
+		for (int nJoint : skin.aJoints) jsonSkin["joints"].append(nJoint);
+		if (skin.aInverseBindMatrices.size() == skin.aJoints.size() * 16 && !skin.aJoints.empty())
+		{
+			jsonSkin["inverseBindMatrices"] = addAccessor(skin.aInverseBindMatrices.data(), skin.aJoints.size(), GL_FLOAT, "MAT4", 0);
+		}
+		if (skin.nSkeleton >= 0) jsonSkin["skeleton"] = skin.nSkeleton;
+		m_oJson["skins"].append(jsonSkin);
+	}
+}
+
+void GltfWriter::writeAnimations(const Scene& scene)
+{
+	for (const SceneAnimation& animation : scene.aAnimations)
+	{
+		JsonValue jsonAnimation = JsonValue::object();
+		jsonAnimation["name"] = animation.sName;
+		jsonAnimation["channels"] = JsonValue::array();
+		jsonAnimation["samplers"] = JsonValue::array();
+		for (const SceneAnimationChannel& channel : animation.aChannels)
+		{
+			if (channel.aTimes.empty() || channel.nNode < 0) continue;
+			size_t nKeys = channel.aTimes.size();
+			std::string sType = "SCALAR";
+			if (channel.sPath == "translation" || channel.sPath == "scale") sType = "VEC3";
+			else if (channel.sPath == "rotation") sType = "VEC4";
+			// weights have one value per morph target of the node's mesh, cubic splines add two tangents per value
+			size_t nValuesPerKey = componentCount(sType);
+			if (channel.sPath == "weights")
+			{
+				int nMesh = channel.nNode < (int)scene.aNodes.size() ? scene.aNodes[channel.nNode].nMesh : -1;
+				nValuesPerKey = (nMesh >= 0 && nMesh < (int)scene.aMeshes.size() && !scene.aMeshes[nMesh].aPrimitives.empty()) ?
+					scene.aMeshes[nMesh].aPrimitives[0].aMorphTargets.size() : 0;
+			}
+			if (channel.sInterpolation == "CUBICSPLINE") nValuesPerKey *= 3;
+			if (nValuesPerKey == 0 || channel.aValues.size() != nKeys * nValuesPerKey)
+			{
+				log("WARNING: GltfWriter: skipping " + channel.sPath + " channel of node " + std::to_string(channel.nNode) + " in animation " + animation.sName +
+					": " + std::to_string(channel.aValues.size()) + " values for " + std::to_string(nKeys) + " keys");
+				continue;
+			}
+
+			JsonValue sampler = JsonValue::object();
+			sampler["input"] = addAccessor(channel.aTimes.data(), nKeys, GL_FLOAT, "SCALAR", 0, true);
+			sampler["interpolation"] = channel.sInterpolation;
+			size_t nOutputCount = channel.aValues.size() / componentCount(sType);
+			sampler["output"] = addAccessor(channel.aValues.data(), nOutputCount, GL_FLOAT, sType, 0);
+			jsonAnimation["samplers"].append(sampler);
+
+			JsonValue jsonChannel = JsonValue::object();
+			jsonChannel["sampler"] = (int)jsonAnimation["samplers"].size() - 1;
+			jsonChannel["target"]["node"] = channel.nNode;
+			jsonChannel["target"]["path"] = channel.sPath;
+			jsonAnimation["channels"].append(jsonChannel);
+		}
+		m_oJson["animations"].append(jsonAnimation);
+	}
+}
+
+JsonValue GltfWriter::textureInfo(const SceneTextureRef& texture, const std::vector<int>& aImageTextures, const SceneMaterial& material)
+{
+	JsonValue info = JsonValue::object();
+	info["index"] = aImageTextures[texture.nImage];
+	if (texture.nTexCoord != 0) info["texCoord"] = texture.nTexCoord;
+	if (material.aUvScale[0] != 1.0f || material.aUvScale[1] != 1.0f)
+	{
+		info["extensions"]["KHR_texture_transform"]["scale"] = floatArray(material.aUvScale, 2);
+		addExtensionUsed(m_oJson, "KHR_texture_transform");
+	}
+	return info;
+}
+
+void GltfWriter::writeMaterials(const Scene& scene)
+{
+	// one texture per image, all with the default repeat sampler
+	std::vector<int> aImageTextures(scene.aImages.size(), -1);
+	for (size_t i = 0; i < scene.aImages.size(); i++)
+	{
+		const SceneImage& image = scene.aImages[i];
+		if (image.sFilePath.empty()) continue;
+		std::string sExtension = fs::path(image.sFilePath).extension().string();
+		std::transform(sExtension.begin(), sExtension.end(), sExtension.begin(), ::tolower);
+		std::string sMimeType = (sExtension == ".png") ? "image/png" : "image/jpeg";
+
+		JsonValue jsonImage = JsonValue::object();
+		jsonImage["name"] = image.sName;
+		if (m_bBinary)
+		{
+			std::error_code error;
+			size_t nBytes = (size_t)fs::file_size(image.sFilePath, error);
+			if (error)
+			{
+				log("ERROR: GltfWriter: unable to read image: " + image.sFilePath);
+				continue;
+			}
+			std::string sImagePath = image.sFilePath;
+			jsonImage["bufferView"] = addBufferView(nBytes, 0, [sImagePath, nBytes](std::vector<uint8_t>& aData)
+			{
+				if (readFile(sImagePath, aData) && aData.size() == nBytes) return true;
+				log("ERROR: GltfWriter: unable to read image: " + sImagePath);
+				return false;
+			});
+			jsonImage["mimeType"] = sMimeType;
+		}
+		else
+		{
+			std::error_code error;
+			fs::path relativePath = fs::relative(image.sFilePath, m_sFolder, error);
+			jsonImage["uri"] = error ? image.sFilePath : relativePath.generic_string();
+		}
+		m_oJson["images"].append(jsonImage);
+
+		JsonValue jsonTexture = JsonValue::object();
+		jsonTexture["sampler"] = 0;
+		jsonTexture["source"] = (int)m_oJson["images"].size() - 1;
+		m_oJson["textures"].append(jsonTexture);
+		aImageTextures[i] = (int)m_oJson["textures"].size() - 1;
+	}
+	if (m_oJson.contains("textures"))
+	{
+		JsonValue sampler = JsonValue::object();
+		sampler["magFilter"] = 9729; // LINEAR
+		sampler["minFilter"] = 9987; // LINEAR_MIPMAP_LINEAR
+		m_oJson["samplers"].append(sampler);
+	}
+
+	auto isWritten = [&](const SceneTextureRef& texture)
+	{
+		return texture.isSet() && texture.nImage < (int)aImageTextures.size() && aImageTextures[texture.nImage] >= 0;
+	};
+
+	for (const SceneMaterial& material : scene.aMaterials)
+	{
+		JsonValue jsonMaterial = JsonValue::object();
+		jsonMaterial["name"] = material.sName;
+		JsonValue& pbr = jsonMaterial["pbrMetallicRoughness"];
+		pbr["baseColorFactor"] = floatArray(material.aBaseColorFactor, 4);
+		if (isWritten(material.baseColorTexture)) pbr["baseColorTexture"] = textureInfo(material.baseColorTexture, aImageTextures, material);
+		pbr["metallicFactor"] = (double)material.fMetallicFactor;
+		pbr["roughnessFactor"] = (double)material.fRoughnessFactor;
+		if (isWritten(material.metallicRoughnessTexture))
+		{
+			pbr["metallicRoughnessTexture"] = textureInfo(material.metallicRoughnessTexture, aImageTextures, material);
+		}
+		if (isWritten(material.normalTexture))
+		{
+			JsonValue normal = textureInfo(material.normalTexture, aImageTextures, material);
+			if (material.fNormalScale != 1.0f) normal["scale"] = (double)material.fNormalScale;
+			jsonMaterial["normalTexture"] = normal;
+		}
+		if (isWritten(material.occlusionTexture))
+		{
+			jsonMaterial["occlusionTexture"] = textureInfo(material.occlusionTexture, aImageTextures, material);
+		}
+		if (isWritten(material.emissiveTexture))
+		{
+			jsonMaterial["emissiveTexture"] = textureInfo(material.emissiveTexture, aImageTextures, material);
+		}
+		if (material.aEmissiveFactor[0] != 0.0f || material.aEmissiveFactor[1] != 0.0f || material.aEmissiveFactor[2] != 0.0f)
+		{
+			jsonMaterial["emissiveFactor"] = floatArray(material.aEmissiveFactor, 3);
+		}
+		if (material.sAlphaMode != "OPAQUE") jsonMaterial["alphaMode"] = material.sAlphaMode;
+		if (material.sAlphaMode == "MASK") jsonMaterial["alphaCutoff"] = (double)material.fAlphaCutoff;
+		if (material.bDoubleSided) jsonMaterial["doubleSided"] = true;
+		if (material.fSpecularFactor >= 0.0f)
+		{
+			jsonMaterial["extensions"]["KHR_materials_specular"]["specularFactor"] = (double)material.fSpecularFactor;
+			addExtensionUsed(m_oJson, "KHR_materials_specular");
+		}
+		m_oJson["materials"].append(jsonMaterial);
+	}
+}
+
+bool GltfWriter::encodeBuffers()
+{
+	// encoded segments and accessor bounds, largest first so that no long job starts last
+	struct Task
+	{
+		BufferSegment* pSegment;
+		BoundsJob* pBounds;
+		size_t nBytes;
+	};
+	std::vector<Task> aTasks;
+	for (BufferSegment& segment : m_aSegments)
+	{
+		if (segment.encode) aTasks.push_back({ &segment, nullptr, segment.nBytes });
+	}
+	for (BoundsJob& job : m_aBoundsJobs)
+	{
+		aTasks.push_back({ nullptr, &job, job.nCount * job.nComponents * sizeof(float) });
+	}
+	std::stable_sort(aTasks.begin(), aTasks.end(), [](const Task& a, const Task& b) { return a.nBytes > b.nBytes; });
+
+	std::atomic<bool> bSucceeded(true);
+	parallelFor(aTasks.size(), m_nThreads, [&](size_t i)
+	{
+		if (aTasks[i].pSegment)
+		{
+			BufferSegment& segment = *aTasks[i].pSegment;
+			segment.aData.resize(segment.nBytes);
+			if (!segment.encode(segment.aData) || segment.aData.size() != segment.nBytes) bSucceeded = false;
+			segment.pData = segment.aData.data();
+			return;
+		}
+		BoundsJob& job = *aTasks[i].pBounds;
+		job.aMin.assign(job.nComponents, FLT_MAX);
+		job.aMax.assign(job.nComponents, -FLT_MAX);
+		for (size_t v = 0; v < job.nCount; v++)
+		{
+			for (int c = 0; c < job.nComponents; c++)
+			{
+				job.aMin[c] = std::min(job.aMin[c], job.pValues[v * job.nComponents + c]);
+				job.aMax[c] = std::max(job.aMax[c], job.pValues[v * job.nComponents + c]);
+			}
+		}
+	});
+	if (!bSucceeded)
+	{
+		m_sError = "unable to encode the binary buffer";
+		return false;
+	}
+
+	JsonValue& accessors = m_oJson["accessors"];
+	for (const BoundsJob& job : m_aBoundsJobs)
+	{
+		accessors[job.nAccessor]["min"] = floatArray(job.aMin.data(), job.nComponents);
+		accessors[job.nAccessor]["max"] = floatArray(job.aMax.data(), job.nComponents);
+	}
+	return true;
+}
+
+bool GltfWriter::saveFiles(const std::string& sFilePath)
+{
+	std::error_code error;
+	if (!m_sFolder.empty()) fs::create_directories(m_sFolder, error);
+
+	// the segments with zero padding between them, as pieces of one write
+	static const uint8_t s_aZeros[4] = { 0, 0, 0, 0 };
+	size_t nPaddedBufferSize = (m_nBufferSize + 3) / 4 * 4;
+	std::vector<FilePiece> aBufferPieces;
+	size_t nEnd = 0;
+	for (const BufferSegment& segment : m_aSegments)
+	{
+		if (segment.nOffset > nEnd) aBufferPieces.push_back({ s_aZeros, segment.nOffset - nEnd });
+		aBufferPieces.push_back({ segment.pData, segment.nBytes });
+		nEnd = segment.nOffset + segment.nBytes;
+	}
+	if (nPaddedBufferSize > nEnd) aBufferPieces.push_back({ s_aZeros, nPaddedBufferSize - nEnd });
+
+	if (!m_bBinary)
+	{
+		std::string sBinPath = (fs::path(sFilePath).parent_path() / (fs::path(sFilePath).stem().string() + ".bin")).string();
+		if (m_nBufferSize > 0 && !writeFile(sBinPath, aBufferPieces))
+		{
+			m_sError = "unable to write file: " + sBinPath;
+			return false;
+		}
+		std::string sJson = m_oJson.serialize(true);
+		if (!writeFile(sFilePath, { { sJson.data(), sJson.size() } }))
+		{
+			m_sError = "unable to write file: " + sFilePath;
+			return false;
+		}
+		return true;
+	}
+
+	// GLB: 12 byte header, JSON chunk padded with spaces, BIN chunk padded with zeros
+	std::string sJson = m_oJson.serialize(false);
+	while (sJson.size() % 4 != 0) sJson += ' ';
+	uint32_t nTotalLength = 12 + 8 + (uint32_t)sJson.size() + (m_nBufferSize == 0 ? 0 : 8 + (uint32_t)nPaddedBufferSize);
+	uint32_t aHeader[3] = { 0x46546C67, 2, nTotalLength };
+	uint32_t aJsonChunk[2] = { (uint32_t)sJson.size(), 0x4E4F534A };
+	uint32_t aBinChunk[2] = { (uint32_t)nPaddedBufferSize, 0x004E4942 };
+	std::vector<FilePiece> aPieces = { { aHeader, sizeof(aHeader) }, { aJsonChunk, sizeof(aJsonChunk) }, { sJson.data(), sJson.size() } };
+	if (m_nBufferSize > 0)
+	{
+		aPieces.push_back({ aBinChunk, sizeof(aBinChunk) });
+		aPieces.insert(aPieces.end(), aBufferPieces.begin(), aBufferPieces.end());
+	}
+	if (!writeFile(sFilePath, aPieces))
+	{
+		m_sError = "unable to write file: " + sFilePath;
+		return false;
+	}
+	return true;
+}
+
+bool GltfWriter::write(const Scene& scene, const std::string& sFilePath)
+{
+	m_sError.clear();
+	m_aSegments.clear();
+	m_aBoundsJobs.clear();
+	m_nBufferSize = 0;
+	m_oJson = JsonValue::object();
+	std::string sExtension = fs::path(sFilePath).extension().string();
+	std::transform(sExtension.begin(), sExtension.end(), sExtension.begin(), ::tolower);
+	m_bBinary = (sExtension != ".gltf");
+	m_sFolder = fs::path(sFilePath).parent_path().string();
+
+	JsonValue& asset = m_oJson["asset"];
+	asset["generator"] = "dtu2godot";
+	asset["version"] = "2.0";
+
+	writeNodes(scene);
+	writeMeshes(scene);
+	writeSkins(scene);
+	writeAnimations(scene);
+	writeMaterials(scene);
+
+	if (m_nBufferSize > 0)
+	{
+		JsonValue buffer = JsonValue::object();
+		buffer["byteLength"] = (m_nBufferSize + 3) / 4 * 4;
+		if (!m_bBinary) buffer["uri"] = fs::path(sFilePath).stem().string() + ".bin";
+		m_oJson["buffers"].append(buffer);
+	}
+
+	if (!encodeBuffers() || !saveFiles(sFilePath))
+	{
+		log("ERROR: GltfWriter: " + m_sError);
+		return false;
+	}
+	log("DEBUG: GltfWriter: wrote " + sFilePath + " (" + std::to_string(m_nBufferSize) + " buffer bytes)");
+	// the encoded segments are not needed after writing
+	m_aSegments.clear();
+	m_aBoundsJobs.clear();
+	return true;
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+#include "Scene.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Writes a Scene as glTF 2.0: a binary .glb with the textures embedded, or a
+ * .gltf with a separate .bin and the textures referenced relative to the
+ * .gltf file, like the GLTF_SEPARATE export of the blender scripts.
+ */
+class GltfWriter
+{
+public:
+	// 0 = one per hardware thread
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+
+	// the format is chosen from the file extension, ".glb" or ".gltf"
+	bool write(const Scene& scene, const std::string& sFilePath);
+
+	const std::string& getError() const { return m_sError; }
+	const JsonValue& getJson() const { return m_oJson; }
+
+protected:
+	/*
+	 * Part of the binary buffer. The JSON is laid out first with the offsets
+	 * of all segments, then the segments which need encoding are filled in
+	 * parallel and written with the scene data they borrow, without copying
+	 * them into one buffer.
+	 */
+	struct BufferSegment
+	{
+		size_t nOffset = 0;
+		size_t nBytes = 0;
+		const uint8_t* pData = nullptr; // borrowed from the scene, or aData
+		std::vector<uint8_t> aData;
+		std::function<bool(std::vector<uint8_t>&)> encode; // fills aData with nBytes
+	};
+
+	// accessor min/max, computed with the buffer encoding
+	struct BoundsJob
+	{
+		int nAccessor = -1;
+		const float* pValues = nullptr;
+		size_t nCount = 0;
+		int nComponents = 0;
+		std::vector<float> aMin, aMax;
+	};
+
+	int m_nThreads = 0;
+	std::string m_sError;
+	JsonValue m_oJson;
+	std::vector<BufferSegment> m_aSegments;
+	std::vector<BoundsJob> m_aBoundsJobs;
+	size_t m_nBufferSize = 0;
+	bool m_bBinary = true;
+	std::string m_sFolder;
+
+	int addBufferView(const void* pData, size_t nBytes, int nTarget);
+	int addBufferView(size_t nBytes, int nTarget, const std::function<bool(std::vector<uint8_t>&)>& encode);
+	int addAccessor(int nBufferView, size_t nCount, int nComponentType, const std::string& sType);
+	int addAccessor(const void* pData, size_t nCount, int nComponentType, const std::string& sType, int nTarget, bool bMinMax = false);
+	JsonValue textureInfo(const SceneTextureRef& texture, const std::vector<int>& aImageTextures, const SceneMaterial& material);
+
+	void writeNodes(const Scene& scene);
+	void writeMeshes(const Scene& scene);
+	void writeSkins(const Scene& scene);
+	void writeAnimations(const Scene& scene);
+	void writeMaterials(const Scene& scene);
+	bool encodeBuffers();
+	bool saveFiles(const std::string& sFilePath);
+};
+
+}
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <csetjmp>
+#include <fstream>
+
+#include <png.h>
+#include <jpeglib.h>
+
+#include "Image.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+std::string lowerExtension(const std::string& sFilePath)
+{
+	size_t nDot = sFilePath.rfind('.');
+	if (nDot == std::string::npos) return "";
+	std::string sExtension = sFilePath.substr(nDot);
+	std::transform(sExtension.begin(), sExtension.end(), sExtension.begin(), ::tolower);
+	return sExtension;
+}
+
+uint32_t readBigEndian32(const unsigned char* pData)
+{
+	return ((uint32_t)pData[0] << 24) | ((uint32_t)pData[1] << 16) | ((uint32_t)pData[2] << 8) | pData[3];
+}
+
+// libjpeg reports fatal errors through a callback, which must not return
+struct JpegErrorManager
+{
+	jpeg_error_mgr base;
+	jmp_buf jumpBuffer;
+	char sMessage[JMSG_LENGTH_MAX];
+};
+
+void jpegErrorExit(j_common_ptr pInfo)
+{
+	JpegErrorManager* pErrorManager = (JpegErrorManager*)pInfo->err;
+	(*pInfo->err->format_message)(pInfo, pErrorManager->sMessage);
+	longjmp(pErrorManager->jumpBuffer, 1);
+}
+
+bool loadPng(const std::string& sFilePath, ImageData& image, std::string& sError)
+{
+	png_image pngImage;
+	std::memset(&pngImage, 0, sizeof(pngImage));
+	pngImage.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_file(&pngImage, sFilePath.c_str()))
+	{
+		sError = sFilePath + ": " + pngImage.message;
+		return false;
+	}
+	bool bHasAlpha = (pngImage.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+	bool bHasColor = (pngImage.format & PNG_FORMAT_FLAG_COLOR) != 0;
+	if (bHasColor)
+	{
+		pngImage.format = bHasAlpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+	}
+	else
+	{
+		pngImage.format = bHasAlpha ? PNG_FORMAT_GA : PNG_FORMAT_GRAY;
+	}
+	image.nWidth = pngImage.width;
+	image.nHeight = pngImage.height;
+	image.nChannels = PNG_IMAGE_SAMPLE_CHANNELS(pngImage.format);
+	image.aPixels.resize(PNG_IMAGE_SIZE(pngImage));
+	if (!png_image_finish_read(&pngImage, nullptr, image.aPixels.data(), 0, nullptr))
+	{
+		sError = sFilePath + ": " + pngImage.message;
+		png_image_free(&pngImage);
+		return false;
+	}
+	if (image.nChannels == 2)
+	{
+		// gray + alpha is expanded to RGBA, the other stages only handle 1, 3 and 4 channels
+		ImageData rgba;
+		rgba.nWidth = image.nWidth;
+		rgba.nHeight = image.nHeight;
+		rgba.nChannels = 4;
+		rgba.aPixels.resize((size_t)image.nWidth * image.nHeight * 4);
+		for (size_t i = 0; i < (size_t)image.nWidth * image.nHeight; i++)
+		{
+			rgba.aPixels[i * 4 + 0] = rgba.aPixels[i * 4 + 1] = rgba.aPixels[i * 4 + 2] = image.aPixels[i * 2];
+			rgba.aPixels[i * 4 + 3] = image.aPixels[i * 2 + 1];
+		}
+		image = std::move(rgba);
+	}
+	return true;
+}
+
+bool loadJpeg(const std::string& sFilePath, ImageData& image, std::string& sError)
+{
+	FILE* pFile = std::fopen(sFilePath.c_str(), "rb");
+	if (pFile == nullptr)
+	{
+		sError = "unable to open file: " + sFilePath;
+		return false;
+	}
+	jpeg_decompress_struct info;
+	JpegErrorManager errorManager;
+	info.err = jpeg_std_error(&errorManager.base);
+	errorManager.base.error_exit = jpegErrorExit;
+	if (setjmp(errorManager.jumpBuffer))
+	{
+		sError = sFilePath + ": " + errorManager.sMessage;
+		jpeg_destroy_decompress(&info);
+		std::fclose(pFile);
+		return false;
+	}
+	jpeg_create_decompress(&info);
+	jpeg_stdio_src(&info, pFile);
+	jpeg_read_header(&info, TRUE);
+	if (info.jpeg_color_space != JCS_GRAYSCALE)
+	{
+		info.out_color_space = JCS_RGB;
+	}
+	jpeg_start_decompress(&info);
+	image.nWidth = info.output_width;
+	image.nHeight = info.output_height;
+	image.nChannels = info.output_components;
+	image.aPixels.resize((size_t)image.nWidth * image.nHeight * image.nChannels);
+	while (info.output_scanline < info.output_height)
+	{
+		JSAMPROW pRow = &image.aPixels[(size_t)info.output_scanline * image.nWidth * image.nChannels];
+		jpeg_read_scanlines(&info, &pRow, 1);
+	}
+	jpeg_finish_decompress(&info);
+	jpeg_destroy_decompress(&info);
+	std::fclose(pFile);
+	return true;
+}
+
+bool savePng(const std::string& sFilePath, const ImageData& image, std::string& sError)
+{
+	png_image pngImage;
+	std::memset(&pngImage, 0, sizeof(pngImage));
+	pngImage.version = PNG_IMAGE_VERSION;
+	pngImage.width = image.nWidth;
+	pngImage.height = image.nHeight;
+	switch (image.nChannels)
+	{
+	case 1: pngImage.format = PNG_FORMAT_GRAY; break;
+	case 3: pngImage.format = PNG_FORMAT_RGB; break;
+	case 4: pngImage.format = PNG_FORMAT_RGBA; break;
+	default:
+		sError = "unsupported channel count for " + sFilePath;
+		return false;
+	}
+	if (!png_image_write_to_file(&pngImage, sFilePath.c_str(), 0, image.aPixels.data(), 0, nullptr))
+	{
+		sError = sFilePath + ": " + pngImage.message;
+		return false;
+	}
+	return true;
+}
+
+bool saveJpeg(const std::string& sFilePath, const ImageData& image, std::string& sError, int nQuality)
+{
+	if (image.nChannels != 1 && image.nChannels != 3)
+	{
+		sError = "JPEG files can not store an alpha channel: " + sFilePath;
+		return false;
+	}
+	FILE* pFile = std::fopen(sFilePath.c_str(), "wb");
+	if (pFile == nullptr)
+	{
+		sError = "unable to write file: " + sFilePath;
+		return false;
+	}
+	jpeg_compress_struct info;
+	JpegErrorManager errorManager;
+	info.err = jpeg_std_error(&errorManager.base);
+	errorManager.base.error_exit = jpegErrorExit;
+	if (setjmp(errorManager.jumpBuffer))
+	{
+		sError = sFilePath + ": " + errorManager.sMessage;
+		jpeg_destroy_compress(&info);
+		std::fclose(pFile);
+		return false;
+	}
+	jpeg_create_compress(&info);
+	jpeg_stdio_dest(&info, pFile);
+	info.image_width = image.nWidth;
+	info.image_height = image.nHeight;
+	info.input_components = image.nChannels;
+	info.in_color_space = image.nChannels == 1 ? JCS_GRAYSCALE : JCS_RGB;
+	jpeg_set_defaults(&info);
+	jpeg_set_quality(&info, nQuality, TRUE);
+	jpeg_start_compress(&info, TRUE);
+	while (info.next_scanline < info.image_height)
+	{
+		JSAMPROW pRow = (JSAMPROW)&image.aPixels[(size_t)info.next_scanline * image.nWidth * image.nChannels];
+		jpeg_write_scanlines(&info, &pRow, 1);
+	}
+	jpeg_finish_compress(&info);
+	jpeg_destroy_compress(&info);
+	std::fclose(pFile);
+	return true;
+}
+}
+
+ImageInfo probeImage(const std::string& sFilePath)
+{
+	ImageInfo info;
+	std::ifstream file(sFilePath, std::ios::binary);
+	if (!file) return info;
+	unsigned char aHeader[33] = { 0 };
+	file.read((char*)aHeader, sizeof(aHeader));
+	if (file.gcount() >= 26 && std::memcmp(aHeader, "\x89PNG\r\n\x1a\n", 8) == 0)
+	{
+		// IHDR: width, height, bit depth, color type
+		info.sFormat = "png";
+		info.nWidth = readBigEndian32(aHeader + 16);
+		info.nHeight = readBigEndian32(aHeader + 20);
+		int nColorType = aHeader[25];
+		info.bHasAlpha = (nColorType & 4) != 0;
+		info.bValid = true;
+		return info;
+	}
+	if (file.gcount() >= 3 && aHeader[0] == 0xFF && aHeader[1] == 0xD8)
+	{
+		// walk the segments to the start of frame marker
+		file.clear();
+		file.seekg(2);
+		unsigned char aSegment[9];
+		while (file.read((char*)aSegment, 4))
+		{
+			if (aSegment[0] != 0xFF) break;
+			int nMarker = aSegment[1];
+			int nLength = (aSegment[2] << 8) | aSegment[3];
+			bool bStartOfFrame = nMarker >= 0xC0 && nMarker <= 0xCF && nMarker != 0xC4 && nMarker != 0xC8 && nMarker != 0xCC;
+			if (bStartOfFrame)
+			{
+				if (!file.read((char*)aSegment, 5)) break;
+				info.sFormat = "jpeg";
+				info.nHeight = (aSegment[1] << 8) | aSegment[2];
+				info.nWidth = (aSegment[3] << 8) | aSegment[4];
+				info.bValid = true;
+				return info;
+			}
+			file.seekg(nLength - 2, std::ios::cur);
+		}
+	}
+	return info;
+}
+
+bool loadImage(const std::string& sFilePath, ImageData& image, std::string& sError)
+{
+	ImageInfo info = probeImage(sFilePath);
+	if (info.sFormat == "png") return loadPng(sFilePath, image, sError);
+	if (info.sFormat == "jpeg") return loadJpeg(sFilePath, image, sError);
+	sError = "unsupported image format: " + sFilePath;
+	return false;
+}
+
+bool saveImage(const std::string& sFilePath, const ImageData& image, std::string& sError, int nJpegQuality)
+{
+	std::string sExtension = lowerExtension(sFilePath);
+	if (sExtension == ".jpg" || sExtension == ".jpeg")
+	{
+		return saveJpeg(sFilePath, image, sError, nJpegQuality);
+	}
+	return savePng(sFilePath, image, sError);
+}
+
+void fitImageSize(int nWidth, int nHeight, int nMaxSize, int& nFitWidth, int& nFitHeight)
+{
+	nFitWidth = nWidth;
+	nFitHeight = nHeight;
+	if (nMaxSize <= 0 || (nWidth <= nMaxSize && nHeight <= nMaxSize)) return;
+	if (nWidth >= nHeight)
+	{
+		nFitWidth = nMaxSize;
+		nFitHeight = std::max(1, (int)((long long)nHeight * nMaxSize / nWidth));
+	}
+	else
+	{
+		nFitHeight = nMaxSize;
+		nFitWidth = std::max(1, (int)((long long)nWidth * nMaxSize / nHeight));
+	}
+}
+
+ImageData resizeImage(const ImageData& image, int nWidth, int nHeight)
+{
+	ImageData result;
+	result.nWidth = nWidth;
+	result.nHeight = nHeight;
+	result.nChannels = image.nChannels;
+	result.aPixels.resize((size_t)nWidth * nHeight * image.nChannels);
+	if (!image.isValid() || nWidth <= 0 || nHeight <= 0) return result;
+
+	double fScaleX = (double)image.nWidth / nWidth;
+	double fScaleY = (double)image.nHeight / nHeight;
+	std::vector<double> aSums(image.nChannels);
+	for (int y = 0; y < nHeight; y++)
+	{
+		for (int x = 0; x < nWidth; x++)
+		{
+			uint8_t* pTarget = result.pixel(x, y);
+			if (fScaleX >= 1.0 && fScaleY >= 1.0)
+			{
+				// average of the source pixels covered by the target pixel
+				int nX0 = (int)(x * fScaleX), nX1 = std::max(nX0 + 1, std::min(image.nWidth, (int)((x + 1) * fScaleX)));
+				int nY0 = (int)(y * fScaleY), nY1 = std::max(nY0 + 1, std::min(image.nHeight, (int)((y + 1) * fScaleY)));
+				std::fill(aSums.begin(), aSums.end(), 0.0);
+				for (int sy = nY0; sy < nY1; sy++)
+				{
+					for (int sx = nX0; sx < nX1; sx++)
+					{
+						const uint8_t* pSource = image.pixel(sx, sy);
+						for (int c = 0; c < image.nChannels; c++) aSums[c] += pSource[c];
+					}
+				}
+				double fCount = (double)(nX1 - nX0) * (nY1 - nY0);
+				for (int c = 0; c < image.nChannels; c++) pTarget[c] = (uint8_t)(aSums[c] / fCount + 0.5);
+			}
+			else
+			{
+				double fX = std::max(0.0, (x + 0.5) * fScaleX - 0.5);
+				double fY = std::max(0.0, (y + 0.5) * fScaleY - 0.5);
+				int nX0 = std::min((int)fX, image.nWidth - 1), nX1 = std::min(nX0 + 1, image.nWidth - 1);
+				int nY0 = std::min((int)fY, image.nHeight - 1), nY1 = std::min(nY0 + 1, image.nHeight - 1);
+				double fTx = fX - nX0, fTy = fY - nY0;
+				for (int c = 0; c < image.nChannels; c++)
+				{
+					double fTop = image.pixel(nX0, nY0)[c] * (1.0 - fTx) + image.pixel(nX1, nY0)[c] * fTx;
+					double fBottom = image.pixel(nX0, nY1)[c] * (1.0 - fTx) + image.pixel(nX1, nY1)[c] * fTx;
+					pTarget[c] = (uint8_t)(fTop * (1.0 - fTy) + fBottom * fTy + 0.5);
+				}
+			}
+		}
+	}
+	return result;
+}
+
+ImageData extractChannel(const ImageData& image, int nChannel)
+{
+	ImageData result;
+	result.nWidth = image.nWidth;
+	result.nHeight = image.nHeight;
+	result.nChannels = 1;
+	result.aPixels.resize((size_t)image.nWidth * image.nHeight);
+	size_t nPixels = result.aPixels.size();
+	for (size_t i = 0; i < nPixels; i++)
+	{
+		const uint8_t* pSource = &image.aPixels[i * image.nChannels];
+		if (image.nChannels == 1)
+		{
+			result.aPixels[i] = pSource[0];
+		}
+		else if (nChannel < 0)
+		{
+			result.aPixels[i] = (uint8_t)((pSource[0] * 54 + pSource[1] * 183 + pSource[2] * 19) >> 8);
+		}
+		else
+		{
+			result.aPixels[i] = pSource[std::min(nChannel, image.nChannels - 1)];
+		}
+	}
+	return result;
+}
+
+}
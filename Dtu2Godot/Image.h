@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+// 8-bit image with interleaved channels (1 = gray, 3 = RGB, 4 = RGBA)
+struct ImageData
+{
+	int nWidth = 0;
+	int nHeight = 0;
+	int nChannels = 0;
+	std::vector<uint8_t> aPixels;
+
+	bool isValid() const { return nWidth > 0 && nHeight > 0 && nChannels > 0; }
+	uint8_t* pixel(int x, int y) { return &aPixels[((size_t)y * nWidth + x) * nChannels]; }
+	const uint8_t* pixel(int x, int y) const { return &aPixels[((size_t)y * nWidth + x) * nChannels]; }
+};
+
+// Header information, read without decoding the pixels
+struct ImageInfo
+{
+	bool bValid = false;
+	std::string sFormat; // "png" or "jpeg", detected from the content
+	int nWidth = 0;
+	int nHeight = 0;
+	bool bHasAlpha = false;
+};
+
+ImageInfo probeImage(const std::string& sFilePath);
+
+// PNG (any bit depth, converted to 8-bit) and baseline/progressive JPEG
+bool loadImage(const std::string& sFilePath, ImageData& image, std::string& sError);
+
+// format from the file extension: ".png", ".jpg" or ".jpeg"
+bool saveImage(const std::string& sFilePath, const ImageData& image, std::string& sError, int nJpegQuality = 90);
+
+// box-filtered downsample (or bilinear upsample) to the given size
+ImageData resizeImage(const ImageData& image, int nWidth, int nHeight);
+
+// size which fits into nMaxSize x nMaxSize keeping the aspect ratio, 0 = unchanged
+void fitImageSize(int nWidth, int nHeight, int nMaxSize, int& nFitWidth, int& nFitHeight);
+
+// copies one channel (or the luminance of RGB for nChannel = -1) into a new gray image
+ImageData extractChannel(const ImageData& image, int nChannel);
+
+}
@@ -0,0 +1,510 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "Json.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+const JsonValue s_nullValue;
+
+class JsonParser
+{
+public:
+	JsonParser(const std::string& sText) : m_sText(sText) {}
+
+	bool parseDocument(JsonValue& result, std::string& sError)
+	{
+		skipWhitespace();
+		// DTU files written on Windows may start with a UTF-8 byte order mark
+		if (m_sText.compare(m_nPos, 3, "\xEF\xBB\xBF") == 0)
+		{
+			m_nPos += 3;
+			skipWhitespace();
+		}
+		if (!parseValue(result, 0))
+		{
+			sError = m_sError;
+			return false;
+		}
+		skipWhitespace();
+		if (m_nPos != m_sText.size())
+		{
+			sError = error("unexpected data after the document");
+			return false;
+		}
+		return true;
+	}
+
+protected:
+	const std::string& m_sText;
+	size_t m_nPos = 0;
+	std::string m_sError;
+
+	std::string error(const std::string& sMessage)
+	{
+		size_t nLine = 1;
+		for (size_t i = 0; i < m_nPos && i < m_sText.size(); i++)
+		{
+			if (m_sText[i] == '\n') nLine++;
+		}
+		m_sError = sMessage + " at line " + std::to_string(nLine);
+		return m_sError;
+	}
+
+	void skipWhitespace()
+	{
+		while (m_nPos < m_sText.size() && (m_sText[m_nPos] == ' ' || m_sText[m_nPos] == '\t' ||
+			m_sText[m_nPos] == '\n' || m_sText[m_nPos] == '\r'))
+		{
+			m_nPos++;
+		}
+	}
+
+	bool parseValue(JsonValue& result, int nDepth)
+	{
+		if (nDepth > 512)
+		{
+			error("nesting too deep");
+			return false;
+		}
+		skipWhitespace();
+		if (m_nPos >= m_sText.size())
+		{
+			error("unexpected end of document");
+			return false;
+		}
+		char c = m_sText[m_nPos];
+		if (c == '{') return parseObject(result, nDepth);
+		if (c == '[') return parseArray(result, nDepth);
+		if (c == '"')
+		{
+			std::string sValue;
+			if (!parseString(sValue)) return false;
+			result = JsonValue(sValue);
+			return true;
+		}
+		if (m_sText.compare(m_nPos, 4, "true") == 0) { m_nPos += 4; result = JsonValue(true); return true; }
+		if (m_sText.compare(m_nPos, 5, "false") == 0) { m_nPos += 5; result = JsonValue(false); return true; }
+		if (m_sText.compare(m_nPos, 4, "null") == 0) { m_nPos += 4; result = JsonValue(); return true; }
+		return parseNumber(result);
+	}
+
+	bool parseNumber(JsonValue& result)
+	{
+		const char* pStart = m_sText.c_str() + m_nPos;
+		char* pEnd = nullptr;
+		double fValue = std::strtod(pStart, &pEnd);
+		if (pEnd == pStart)
+		{
+			error("invalid value");
+			return false;
+		}
+		m_nPos += pEnd - pStart;
+		result = JsonValue(fValue);
+		return true;
+	}
+
+	static void appendUtf8(std::string& sOutput, unsigned int nCodePoint)
+	{
+		if (nCodePoint < 0x80)
+		{
+			sOutput += (char)nCodePoint;
+		}
+		else if (nCodePoint < 0x800)
+		{
+			sOutput += (char)(0xC0 | (nCodePoint >> 6));
+			sOutput += (char)(0x80 | (nCodePoint & 0x3F));
+		}
+		else if (nCodePoint < 0x10000)
+		{
+			sOutput += (char)(0xE0 | (nCodePoint >> 12));
+			sOutput += (char)(0x80 | ((nCodePoint >> 6) & 0x3F));
+			sOutput += (char)(0x80 | (nCodePoint & 0x3F));
+		}
+		else
+		{
+			sOutput += (char)(0xF0 | (nCodePoint >> 18));
+			sOutput += (char)(0x80 | ((nCodePoint >> 12) & 0x3F));
+			sOutput += (char)(0x80 | ((nCodePoint >> 6) & 0x3F));
+			sOutput += (char)(0x80 | (nCodePoint & 0x3F));
+		}
+	}
+
+	bool parseHex4(unsigned int& nValue)
+	{
+		if (m_nPos + 4 > m_sText.size())
+		{
+			error("invalid unicode escape");
+			return false;
+		}
+		nValue = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = m_sText[m_nPos++];
+			nValue <<= 4;
+			if (c >= '0' && c <= '9') nValue |= c - '0';
+			else if (c >= 'a' && c <= 'f') nValue |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') nValue |= c - 'A' + 10;
+			else
+			{
+				error("invalid unicode escape");
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool parseString(std::string& sValue)
+	{
+		m_nPos++; // opening quote
+		while (m_nPos < m_sText.size())
+		{
+			char c = m_sText[m_nPos++];
+			if (c == '"') return true;
+			if (c != '\\')
+			{
+				sValue += c;
+				continue;
+			}
+			if (m_nPos >= m_sText.size()) break;
+			char cEscape = m_sText[m_nPos++];
+			switch (cEscape)
+			{
+			case '"': sValue += '"'; break;
+			case '\\': sValue += '\\'; break;
+			case '/': sValue += '/'; break;
+			case 'b': sValue += '\b'; break;
+			case 'f': sValue += '\f'; break;
+			case 'n': sValue += '\n'; break;
+			case 'r': sValue += '\r'; break;
+			case 't': sValue += '\t'; break;
+			case 'u':
+			{
+				unsigned int nCodePoint = 0;
+				if (!parseHex4(nCodePoint)) return false;
+				// surrogate pair
+				if (nCodePoint >= 0xD800 && nCodePoint < 0xDC00 && m_sText.compare(m_nPos, 2, "\\u") == 0)
+				{
+					m_nPos += 2;
+					unsigned int nLow = 0;
+					if (!parseHex4(nLow)) return false;
+					nCodePoint = 0x10000 + ((nCodePoint - 0xD800) << 10) + (nLow - 0xDC00);
+				}
+				appendUtf8(sValue, nCodePoint);
+				break;
+			}
+			default:
+				error("invalid escape sequence");
+				return false;
+			}
+		}
+		error("unterminated string");
+		return false;
+	}
+
+	bool parseArray(JsonValue& result, int nDepth)
+	{
+		m_nPos++;
+		result = JsonValue::array();
+		skipWhitespace();
+		if (m_nPos < m_sText.size() && m_sText[m_nPos] == ']')
+		{
+			m_nPos++;
+			return true;
+		}
+		while (true)
+		{
+			JsonValue element;
+			if (!parseValue(element, nDepth + 1)) return false;
+			result.append(element);
+			skipWhitespace();
+			if (m_nPos >= m_sText.size()) break;
+			char c = m_sText[m_nPos++];
+			if (c == ']') return true;
+			if (c != ',')
+			{
+				error("expected ',' or ']'");
+				return false;
+			}
+		}
+		error("unterminated array");
+		return false;
+	}
+
+	bool parseObject(JsonValue& result, int nDepth)
+	{
+		m_nPos++;
+		result = JsonValue::object();
+		skipWhitespace();
+		if (m_nPos < m_sText.size() && m_sText[m_nPos] == '}')
+		{
+			m_nPos++;
+			return true;
+		}
+		while (true)
+		{
+			skipWhitespace();
+			if (m_nPos >= m_sText.size() || m_sText[m_nPos] != '"')
+			{
+				error("expected member name");
+				return false;
+			}
+			std::string sKey;
+			if (!parseString(sKey)) return false;
+			skipWhitespace();
+			if (m_nPos >= m_sText.size() || m_sText[m_nPos] != ':')
+			{
+				error("expected ':'");
+				return false;
+			}
+			m_nPos++;
+			JsonValue value;
+			if (!parseValue(value, nDepth + 1)) return false;
+			result[sKey] = value;
+			skipWhitespace();
+			if (m_nPos >= m_sText.size()) break;
+			char c = m_sText[m_nPos++];
+			if (c == '}') return true;
+			if (c != ',')
+			{
+				error("expected ',' or '}'");
+				return false;
+			}
+		}
+		error("unterminated object");
+		return false;
+	}
+};
+}
+
+bool JsonValue::toBool(bool bDefault) const
+{
+	if (m_eType == Bool) return m_bValue;
+	if (m_eType == Number) return m_fValue != 0.0;
+	return bDefault;
+}
+
+double JsonValue::toDouble(double fDefault) const
+{
+	if (m_eType == Number) return m_fValue;
+	if (m_eType == Bool) return m_bValue ? 1.0 : 0.0;
+	return fDefault;
+}
+
+int JsonValue::toInt(int nDefault) const
+{
+	if (m_eType == Number) return (int)std::lround(m_fValue);
+	if (m_eType == Bool) return m_bValue ? 1 : 0;
+	return nDefault;
+}
+
+std::string JsonValue::toString(const std::string& sDefault) const
+{
+	if (m_eType == String) return m_sValue;
+	return sDefault;
+}
+
+size_t JsonValue::size() const
+{
+	if (m_eType == Array) return m_aElements.size();
+	if (m_eType == Object) return m_aMembers.size();
+	return 0;
+}
+
+const JsonValue& JsonValue::operator[](size_t nIndex) const
+{
+	if (m_eType != Array || nIndex >= m_aElements.size()) return s_nullValue;
+	return m_aElements[nIndex];
+}
+
+JsonValue& JsonValue::operator[](size_t nIndex)
+{
+	return m_aElements.at(nIndex);
+}
+
+JsonValue& JsonValue::append(const JsonValue& value)
+{
+	if (m_eType != Array)
+	{
+		*this = array();
+	}
+	m_aElements.push_back(value);
+	return m_aElements.back();
+}
+
+bool JsonValue::contains(const std::string& sKey) const
+{
+	for (const auto& member : m_aMembers)
+	{
+		if (member.first == sKey) return true;
+	}
+	return false;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& sKey) const
+{
+	for (const auto& member : m_aMembers)
+	{
+		if (member.first == sKey) return member.second;
+	}
+	return s_nullValue;
+}
+
+JsonValue& JsonValue::operator[](const std::string& sKey)
+{
+	if (m_eType != Object)
+	{
+		*this = object();
+	}
+	for (auto& member : m_aMembers)
+	{
+		if (member.first == sKey) return member.second;
+	}
+	m_aMembers.push_back(std::make_pair(sKey, JsonValue()));
+	return m_aMembers.back().second;
+}
+
+bool JsonValue::remove(const std::string& sKey)
+{
+	for (auto it = m_aMembers.begin(); it != m_aMembers.end(); ++it)
+	{
+		if (it->first == sKey)
+		{
+			m_aMembers.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string jsonQuote(const std::string& sValue)
+{
+	std::string sOutput = "\"";
+	for (unsigned char c : sValue)
+	{
+		switch (c)
+		{
+		case '"': sOutput += "\\\""; break;
+		case '\\': sOutput += "\\\\"; break;
+		case '\n': sOutput += "\\n"; break;
+		case '\r': sOutput += "\\r"; break;
+		case '\t': sOutput += "\\t"; break;
+		default:
+			if (c < 0x20)
+			{
+				char sBuffer[8];
+				std::snprintf(sBuffer, sizeof(sBuffer), "\\u%04x", c);
+				sOutput += sBuffer;
+			}
+			else
+			{
+				sOutput += (char)c;
+			}
+		}
+	}
+	return sOutput + "\"";
+}
+
+std::string jsonNumber(double fValue)
+{
+	if (!std::isfinite(fValue))
+	{
+		return "0";
+	}
+	if (fValue == std::floor(fValue) && std::fabs(fValue) < 1e15)
+	{
+		return std::to_string((long long)fValue);
+	}
+	char sBuffer[32];
+	for (int nPrecision = 6; nPrecision <= 17; nPrecision++)
+	{
+		std::snprintf(sBuffer, sizeof(sBuffer), "%.*g", nPrecision, fValue);
+		if (std::strtod(sBuffer, nullptr) == fValue)
+		{
+			break;
+		}
+	}
+	return sBuffer;
+}
+
+void JsonValue::serialize(std::string& sOutput, bool bPretty, int nIndent) const
+{
+	std::string sNewline = bPretty ? "\n" + std::string((nIndent + 1) * 4, ' ') : "";
+	std::string sClose = bPretty ? "\n" + std::string(nIndent * 4, ' ') : "";
+	switch (m_eType)
+	{
+	case Null: sOutput += "null"; break;
+	case Bool: sOutput += m_bValue ? "true" : "false"; break;
+	case Number: sOutput += jsonNumber(m_fValue); break;
+	case String: sOutput += jsonQuote(m_sValue); break;
+	case Array:
+		if (m_aElements.empty())
+		{
+			sOutput += "[]";
+			break;
+		}
+		sOutput += "[";
+		for (size_t i = 0; i < m_aElements.size(); i++)
+		{
+			if (i > 0) sOutput += ",";
+			sOutput += sNewline;
+			m_aElements[i].serialize(sOutput, bPretty, nIndent + 1);
+		}
+		sOutput += sClose + "]";
+		break;
+	case Object:
+		if (m_aMembers.empty())
+		{
+			sOutput += "{}";
+			break;
+		}
+		sOutput += "{";
+		for (size_t i = 0; i < m_aMembers.size(); i++)
+		{
+			if (i > 0) sOutput += ",";
+			sOutput += sNewline + jsonQuote(m_aMembers[i].first) + (bPretty ? ": " : ":");
+			m_aMembers[i].second.serialize(sOutput, bPretty, nIndent + 1);
+		}
+		sOutput += sClose + "}";
+		break;
+	}
+}
+
+std::string JsonValue::serialize(bool bPretty) const
+{
+	std::string sOutput;
+	serialize(sOutput, bPretty, 0);
+	return sOutput;
+}
+
+bool JsonValue::parse(const std::string& sText, JsonValue& result, std::string& sError)
+{
+	JsonParser parser(sText);
+	return parser.parseDocument(result, sError);
+}
+
+bool JsonValue::loadFile(const std::string& sFilePath, JsonValue& result, std::string& sError)
+{
+	std::ifstream file(sFilePath, std::ios::binary);
+	if (!file)
+	{
+		sError = "unable to open file: " + sFilePath;
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	if (!parse(buffer.str(), result, sError))
+	{
+		sError = sFilePath + ": " + sError;
+		return false;
+	}
+	return true;
+}
+
+}
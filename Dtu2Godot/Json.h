@@ -0,0 +1,81 @@
+#pragma once
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+/*
+ * Minimal JSON document model for reading DTU files and writing glTF.
+ * Object members keep their insertion order so that written files are stable
+ * and diffable between exports.
+ */
+class JsonValue
+{
+public:
+	enum Type { Null = 0, Bool, Number, String, Array, Object };
+
+	JsonValue() {}
+	JsonValue(bool bValue) : m_eType(Bool), m_bValue(bValue) {}
+	JsonValue(int nValue) : m_eType(Number), m_fValue(nValue) {}
+	JsonValue(unsigned int nValue) : m_eType(Number), m_fValue(nValue) {}
+	JsonValue(long long nValue) : m_eType(Number), m_fValue((double)nValue) {}
+	JsonValue(size_t nValue) : m_eType(Number), m_fValue((double)nValue) {}
+	JsonValue(double fValue) : m_eType(Number), m_fValue(fValue) {}
+	JsonValue(const char* sValue) : m_eType(String), m_sValue(sValue) {}
+	JsonValue(const std::string& sValue) : m_eType(String), m_sValue(sValue) {}
+
+	static JsonValue array() { JsonValue value; value.m_eType = Array; return value; }
+	static JsonValue object() { JsonValue value; value.m_eType = Object; return value; }
+
+	Type type() const { return m_eType; }
+	bool isNull() const { return m_eType == Null; }
+	bool isBool() const { return m_eType == Bool; }
+	bool isNumber() const { return m_eType == Number; }
+	bool isString() const { return m_eType == String; }
+	bool isArray() const { return m_eType == Array; }
+	bool isObject() const { return m_eType == Object; }
+
+	bool toBool(bool bDefault = false) const;
+	double toDouble(double fDefault = 0.0) const;
+	int toInt(int nDefault = 0) const;
+	std::string toString(const std::string& sDefault = "") const;
+
+	// arrays
+	size_t size() const;
+	const JsonValue& operator[](size_t nIndex) const;
+	JsonValue& operator[](size_t nIndex);
+	JsonValue& append(const JsonValue& value);
+
+	// objects, a missing member reads as null
+	bool contains(const std::string& sKey) const;
+	const JsonValue& operator[](const std::string& sKey) const;
+	JsonValue& operator[](const std::string& sKey);
+	bool remove(const std::string& sKey);
+	const std::vector<std::pair<std::string, JsonValue>>& members() const { return m_aMembers; }
+
+	std::string serialize(bool bPretty = false) const;
+
+	static bool parse(const std::string& sText, JsonValue& result, std::string& sError);
+	static bool loadFile(const std::string& sFilePath, JsonValue& result, std::string& sError);
+
+protected:
+	Type m_eType = Null;
+	bool m_bValue = false;
+	double m_fValue = 0.0;
+	std::string m_sValue;
+	std::vector<JsonValue> m_aElements;
+	std::vector<std::pair<std::string, JsonValue>> m_aMembers;
+
+	void serialize(std::string& sOutput, bool bPretty, int nIndent) const;
+};
+
+// escapes a string for JSON output, including the quotes
+std::string jsonQuote(const std::string& sValue);
+
+// shortest decimal form which reads back to the same value
+std::string jsonNumber(double fValue);
+
+}
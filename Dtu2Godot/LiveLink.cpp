@@ -0,0 +1,315 @@
+#include <cmath>
+#include <cstring>
+
+#include "LiveLink.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+void writeU8(std::vector<uint8_t>& aData, uint8_t nValue)
+{
+	aData.push_back(nValue);
+}
+
+void writeU16(std::vector<uint8_t>& aData, uint16_t nValue)
+{
+	aData.push_back((uint8_t)(nValue & 0xff));
+	aData.push_back((uint8_t)(nValue >> 8));
+}
+
+void writeU32(std::vector<uint8_t>& aData, uint32_t nValue)
+{
+	for (int i = 0; i < 4; i++) aData.push_back((uint8_t)((nValue >> (i * 8)) & 0xff));
+}
+
+void writeFloat(std::vector<uint8_t>& aData, float fValue)
+{
+	uint32_t nBits;
+	std::memcpy(&nBits, &fValue, sizeof(nBits));
+	writeU32(aData, nBits);
+}
+
+// names longer than a u16 length are cut, they are only matched against node and material names
+void writeString(std::vector<uint8_t>& aData, const std::string& sValue)
+{
+	size_t nLength = sValue.size() < 0xffff ? sValue.size() : 0xffff;
+	writeU16(aData, (uint16_t)nLength);
+	aData.insert(aData.end(), sValue.begin(), sValue.begin() + nLength);
+}
+
+// bounds checked reading of a frame payload
+struct Reader
+{
+	const uint8_t* pData;
+	size_t nSize;
+	size_t nPosition = 0;
+	bool bOk = true;
+
+	Reader(const uint8_t* pFrameData, size_t nFrameSize) : pData(pFrameData), nSize(nFrameSize) {}
+
+	bool require(size_t nBytes)
+	{
+		if (!bOk || nSize - nPosition < nBytes) bOk = false;
+		return bOk;
+	}
+	uint8_t readU8()
+	{
+		if (!require(1)) return 0;
+		return pData[nPosition++];
+	}
+	uint16_t readU16()
+	{
+		if (!require(2)) return 0;
+		uint16_t nValue = (uint16_t)(pData[nPosition] | (pData[nPosition + 1] << 8));
+		nPosition += 2;
+		return nValue;
+	}
+	uint32_t readU32()
+	{
+		if (!require(4)) return 0;
+		uint32_t nValue = 0;
+		for (int i = 0; i < 4; i++) nValue |= (uint32_t)pData[nPosition + i] << (i * 8);
+		nPosition += 4;
+		return nValue;
+	}
+	float readFloat()
+	{
+		uint32_t nBits = readU32();
+		float fValue;
+		std::memcpy(&fValue, &nBits, sizeof(fValue));
+		return fValue;
+	}
+	std::string readString()
+	{
+		uint16_t nLength = readU16();
+		if (!require(nLength)) return "";
+		std::string sValue((const char*)pData + nPosition, nLength);
+		nPosition += nLength;
+		return sValue;
+	}
+};
+}
+
+void LiveLinkEncoder::setAssetName(const std::string& sAssetName)
+{
+	if (sAssetName == m_sAssetName) return;
+	m_sAssetName = sAssetName;
+	m_bAssetNamePending = true;
+}
+
+bool LiveLinkEncoder::setValue(LiveLink::Kind eKind, const std::string& sName, const float* pValues, size_t nCount)
+{
+	if (nCount > LiveLink::MAX_VALUES) return false;
+	std::pair<uint8_t, std::string> key((uint8_t)eKind, sName);
+	std::map<std::pair<uint8_t, std::string>, uint16_t>::const_iterator found = m_aChannelIds.find(key);
+	uint16_t nId;
+	if (found != m_aChannelIds.end())
+	{
+		nId = found->second;
+	}
+	else
+	{
+		if (m_aChannels.size() >= LiveLink::MAX_CHANNELS) return false;
+		nId = (uint16_t)m_aChannels.size();
+		m_aChannelIds[key] = nId;
+		m_aChannels.push_back(Channel());
+		m_aChannels.back().eKind = eKind;
+		m_aChannels.back().sName = sName;
+	}
+	Channel& channel = m_aChannels[nId];
+
+	// unchanged against what the add-on has, zero if it has nothing yet
+	bool bChanged = channel.bDefined && channel.aSent.size() != nCount;
+	for (size_t i = 0; i < nCount && !bChanged; i++)
+	{
+		float fReference = i < channel.aSent.size() ? channel.aSent[i] : 0.0f;
+		bChanged = !(std::fabs(pValues[i] - fReference) <= m_fTolerance);
+	}
+	if (!bChanged)
+	{
+		// a change which was reverted before the next frame
+		if (channel.bPending)
+		{
+			channel.bPending = false;
+			m_nPending--;
+		}
+		return true;
+	}
+	channel.aPending.assign(pValues, pValues + nCount);
+	if (!channel.bPending)
+	{
+		channel.bPending = true;
+		m_aPendingIds.push_back(nId);
+		m_nPending++;
+	}
+	return true;
+}
+
+std::vector<uint8_t> LiveLinkEncoder::takeFrame(double fNowSeconds)
+{
+	std::vector<uint8_t> aFrame;
+	// up to a tenth of the interval early, so a timer at the frame rate is not throttled by its jitter
+	if (!hasPendingChanges() || fNowSeconds - m_fLastFrameTime < m_fMinFrameInterval * 0.9)
+	{
+		return aFrame;
+	}
+	m_fLastFrameTime = fNowSeconds;
+
+	std::vector<uint16_t> aIds;
+	aIds.reserve(m_nPending);
+	for (uint16_t nId : m_aPendingIds)
+	{
+		Channel& channel = m_aChannels[nId];
+		if (!channel.bPending) continue;
+		channel.bPending = false;
+		aIds.push_back(nId);
+	}
+	m_aPendingIds.clear();
+	m_nPending = 0;
+
+	writeU32(aFrame, 0); // payload size, filled in below
+	writeU8(aFrame, LiveLink::PROTOCOL_VERSION);
+	writeU32(aFrame, m_nSequence++);
+	writeString(aFrame, m_bAssetNamePending ? m_sAssetName : std::string());
+	m_bAssetNamePending = false;
+
+	size_t nDefinitionCount = 0;
+	size_t nDefinitionCountOffset = aFrame.size();
+	writeU16(aFrame, 0);
+	for (uint16_t nId : aIds)
+	{
+		Channel& channel = m_aChannels[nId];
+		// a channel keeps its value count once defined, the add-on reads it from the definition
+		if (channel.bDefined && channel.aPending.size() == channel.aSent.size()) continue;
+		writeU16(aFrame, nId);
+		writeU8(aFrame, (uint8_t)channel.eKind);
+		writeU8(aFrame, (uint8_t)channel.aPending.size());
+		writeString(aFrame, channel.sName);
+		channel.bDefined = true;
+		nDefinitionCount++;
+	}
+	aFrame[nDefinitionCountOffset] = (uint8_t)(nDefinitionCount & 0xff);
+	aFrame[nDefinitionCountOffset + 1] = (uint8_t)(nDefinitionCount >> 8);
+
+	writeU16(aFrame, (uint16_t)aIds.size());
+	for (uint16_t nId : aIds)
+	{
+		Channel& channel = m_aChannels[nId];
+		writeU16(aFrame, nId);
+		for (float fValue : channel.aPending) writeFloat(aFrame, fValue);
+		channel.aSent.swap(channel.aPending);
+		channel.aPending.clear();
+	}
+
+	uint32_t nPayloadSize = (uint32_t)(aFrame.size() - 4);
+	for (int i = 0; i < 4; i++) aFrame[i] = (uint8_t)((nPayloadSize >> (i * 8)) & 0xff);
+	return aFrame;
+}
+
+void LiveLinkEncoder::reset()
+{
+	for (size_t nId = 0; nId < m_aChannels.size(); nId++)
+	{
+		Channel& channel = m_aChannels[nId];
+		// the values sent over the previous connection go out again
+		if (!channel.bPending && channel.bDefined)
+		{
+			channel.aPending.swap(channel.aSent);
+			channel.bPending = true;
+			m_aPendingIds.push_back((uint16_t)nId);
+			m_nPending++;
+		}
+		channel.aSent.clear();
+		channel.bDefined = false;
+	}
+	m_nSequence = 0;
+	m_fLastFrameTime = -1.0e30;
+	m_bAssetNamePending = !m_sAssetName.empty();
+}
+
+bool LiveLinkDecoder::decode(const uint8_t* pData, size_t nSize, std::vector<Frame>& aFrames)
+{
+	m_aBuffer.insert(m_aBuffer.end(), pData, pData + nSize);
+	size_t nOffset = 0;
+	bool bOk = true;
+	while (m_aBuffer.size() - nOffset >= 4)
+	{
+		const uint8_t* pFrame = m_aBuffer.data() + nOffset;
+		uint32_t nPayloadSize = (uint32_t)pFrame[0] | ((uint32_t)pFrame[1] << 8) | ((uint32_t)pFrame[2] << 16) | ((uint32_t)pFrame[3] << 24);
+		if (m_aBuffer.size() - nOffset - 4 < nPayloadSize) break;
+		Frame frame;
+		if (!decodeFrame(pFrame + 4, nPayloadSize, frame))
+		{
+			bOk = false;
+			nOffset = m_aBuffer.size();
+			break;
+		}
+		aFrames.push_back(frame);
+		nOffset += 4 + nPayloadSize;
+	}
+	m_aBuffer.erase(m_aBuffer.begin(), m_aBuffer.begin() + nOffset);
+	return bOk;
+}
+
+bool LiveLinkDecoder::decodeFrame(const uint8_t* pData, size_t nSize, Frame& frame)
+{
+	Reader reader(pData, nSize);
+	uint8_t nVersion = reader.readU8();
+	if (reader.bOk && nVersion != LiveLink::PROTOCOL_VERSION)
+	{
+		m_sError = "unsupported live link protocol version " + std::to_string(nVersion);
+		return false;
+	}
+	frame.nSequence = reader.readU32();
+	std::string sAssetName = reader.readString();
+	if (!sAssetName.empty()) m_sAssetName = sAssetName;
+
+	uint16_t nDefinitions = reader.readU16();
+	for (uint16_t i = 0; i < nDefinitions && reader.bOk; i++)
+	{
+		uint16_t nId = reader.readU16();
+		Definition definition;
+		definition.eKind = (LiveLink::Kind)reader.readU8();
+		definition.nCount = reader.readU8();
+		definition.sName = reader.readString();
+		definition.bDefined = true;
+		if (nId >= m_aDefinitions.size()) m_aDefinitions.resize(nId + 1);
+		m_aDefinitions[nId] = definition;
+	}
+
+	uint16_t nValues = reader.readU16();
+	for (uint16_t i = 0; i < nValues && reader.bOk; i++)
+	{
+		uint16_t nId = reader.readU16();
+		if (!reader.bOk) break;
+		if (nId >= m_aDefinitions.size() || !m_aDefinitions[nId].bDefined)
+		{
+			m_sError = "live link value for undefined channel " + std::to_string(nId);
+			return false;
+		}
+		const Definition& definition = m_aDefinitions[nId];
+		Value value;
+		value.eKind = definition.eKind;
+		value.sName = definition.sName;
+		for (uint8_t j = 0; j < definition.nCount; j++) value.aValues.push_back(reader.readFloat());
+		frame.aValues.push_back(value);
+	}
+	if (!reader.bOk || reader.nPosition != nSize)
+	{
+		m_sError = "malformed live link frame " + std::to_string(frame.nSequence);
+		return false;
+	}
+	return true;
+}
+
+void LiveLinkDecoder::reset()
+{
+	m_aBuffer.clear();
+	m_aDefinitions.clear();
+	m_sAssetName.clear();
+	m_sError.clear();
+}
+
+}
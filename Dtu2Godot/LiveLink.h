@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+/*
+ * Binary protocol of the live link between the Daz Studio plugin and the
+ * Godot editor add-on.  The stream is a sequence of frames, all numbers
+ * little-endian:
+ *
+ *   u32 payload size
+ *   u8  protocol version
+ *   u32 frame sequence number
+ *   u16 asset name length, name (UTF-8), only in frames where it changed
+ *   u16 definition count, per definition:
+ *       u16 channel id, u8 kind, u8 value count, u16 name length, name
+ *   u16 value count, per value:
+ *       u16 channel id, float32 values (count from the definition)
+ *
+ * A channel is one bone pose (rotation quaternion xyzw relative to the rest
+ * pose and position in meters, both in figure space), one morph weight or
+ * one material parameter ("<material>/<property>").  Channels are defined
+ * once per connection, later frames only carry their id.
+ */
+namespace LiveLink
+{
+enum Kind : uint8_t { Pose = 0, Morph = 1, Material = 2 };
+
+const uint8_t PROTOCOL_VERSION = 1;
+const uint16_t DEFAULT_PORT = 9007;
+const size_t MAX_CHANNELS = 65535;
+const size_t MAX_VALUES = 255;
+}
+
+/*
+ * Collects channel values and writes the frames which are sent to the add-on.
+ * Values are coalesced: setting a channel twice before the next frame sends
+ * only the last value, and values within the tolerance of the last sent one
+ * are not sent at all.  Channels which were never sent are compared against
+ * zero, so unused morphs do not go out with the first frame.  Frames are
+ * rate limited to the maximum frame rate.
+ */
+class LiveLinkEncoder
+{
+public:
+	void setMaxFrameRate(double fFramesPerSecond) { m_fMinFrameInterval = fFramesPerSecond > 0.0 ? 1.0 / fFramesPerSecond : 0.0; }
+	void setTolerance(float fTolerance) { m_fTolerance = fTolerance; }
+	void setAssetName(const std::string& sAssetName);
+
+	// returns false if the channel table is full or the value count is too large
+	bool setValue(LiveLink::Kind eKind, const std::string& sName, const float* pValues, size_t nCount);
+	bool setValue(LiveLink::Kind eKind, const std::string& sName, const std::vector<float>& aValues)
+	{
+		return setValue(eKind, sName, aValues.data(), aValues.size());
+	}
+
+	bool hasPendingChanges() const { return m_nPending > 0 || m_bAssetNamePending; }
+	size_t getNumPendingChanges() const { return m_nPending; }
+	size_t getNumChannels() const { return m_aChannels.size(); }
+
+	// the next frame with everything changed since the previous one, empty if
+	// nothing changed or the previous frame was less than the frame interval ago
+	std::vector<uint8_t> takeFrame(double fNowSeconds);
+	// forgets what was sent, so that a new connection receives the complete state
+	void reset();
+
+protected:
+	struct Channel
+	{
+		LiveLink::Kind eKind = LiveLink::Pose;
+		std::string sName;
+		std::vector<float> aSent;
+		std::vector<float> aPending;
+		bool bDefined = false;
+		bool bPending = false;
+	};
+
+	double m_fMinFrameInterval = 1.0 / 30.0;
+	double m_fLastFrameTime = -1.0e30;
+	float m_fTolerance = 1e-5f;
+	uint32_t m_nSequence = 0;
+	std::string m_sAssetName;
+	bool m_bAssetNamePending = false;
+
+	std::vector<Channel> m_aChannels; // index = channel id
+	std::map<std::pair<uint8_t, std::string>, uint16_t> m_aChannelIds;
+	std::vector<uint16_t> m_aPendingIds; // in the order they changed, may contain reverted channels
+	size_t m_nPending = 0;
+};
+
+/*
+ * Reads the frames of a live link stream, as the Godot add-on does, for the
+ * tests and the stand-in server.  Data may arrive in pieces of any size.
+ */
+class LiveLinkDecoder
+{
+public:
+	struct Value
+	{
+		LiveLink::Kind eKind = LiveLink::Pose;
+		std::string sName;
+		std::vector<float> aValues;
+	};
+
+	struct Frame
+	{
+		uint32_t nSequence = 0;
+		std::vector<Value> aValues;
+	};
+
+	// appends received data and returns the frames it completed, false on malformed data
+	bool decode(const uint8_t* pData, size_t nSize, std::vector<Frame>& aFrames);
+	void reset();
+
+	const std::string& getAssetName() const { return m_sAssetName; }
+	const std::string& getError() const { return m_sError; }
+
+protected:
+	struct Definition
+	{
+		LiveLink::Kind eKind = LiveLink::Pose;
+		uint8_t nCount = 0;
+		std::string sName;
+		bool bDefined = false;
+	};
+
+	std::vector<uint8_t> m_aBuffer;
+	std::vector<Definition> m_aDefinitions;
+	std::string m_sAssetName;
+	std::string m_sError;
+
+	bool decodeFrame(const uint8_t* pData, size_t nSize, Frame& frame);
+};
+
+}
@@ -0,0 +1,49 @@
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "Log.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+std::mutex s_logMutex;
+std::ofstream s_logFile;
+bool s_bQuiet = false;
+}
+
+void log(const std::string& sMessage)
+{
+	std::lock_guard<std::mutex> lock(s_logMutex);
+	if (!s_bQuiet || sMessage.compare(0, 6, "ERROR:") == 0 || sMessage.compare(0, 8, "WARNING:") == 0)
+	{
+		std::cerr << sMessage << std::endl;
+	}
+	if (s_logFile.is_open())
+	{
+		s_logFile << sMessage << std::endl;
+	}
+}
+
+void setLogFile(const std::string& sFilePath)
+{
+	std::lock_guard<std::mutex> lock(s_logMutex);
+	if (s_logFile.is_open())
+	{
+		s_logFile.close();
+	}
+	if (!sFilePath.empty())
+	{
+		s_logFile.open(sFilePath, std::ios::app);
+	}
+}
+
+void setLogQuiet(bool bQuiet)
+{
+	std::lock_guard<std::mutex> lock(s_logMutex);
+	s_bQuiet = bQuiet;
+}
+
+}
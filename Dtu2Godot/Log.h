@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+
+namespace Dtu2Godot
+{
+
+// Log messages use the "DEBUG:", "WARNING:" and "ERROR:" prefixes of the plugin and
+// the blender scripts.  Messages go to stderr and, if set, are appended to a log file.
+void log(const std::string& sMessage);
+void setLogFile(const std::string& sFilePath);
+void setLogQuiet(bool bQuiet); // only ERROR and WARNING messages on stderr
+
+}
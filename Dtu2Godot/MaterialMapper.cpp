@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <sstream>
+
+#include "Log.h"
+#include "MaterialMapper.h"
+
+namespace fs = std::filesystem;
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+std::string toLower(std::string sValue)
+{
+	std::transform(sValue.begin(), sValue.end(), sValue.begin(), ::tolower);
+	return sValue;
+}
+
+bool fileExists(const std::string& sFilePath)
+{
+	std::error_code error;
+	return fs::is_regular_file(sFilePath, error);
+}
+
+float propertyValue(const DtuProperty* pProperty, float fDefault)
+{
+	return pProperty ? (float)pProperty->value.toDouble(fDefault) : fDefault;
+}
+}
+
+float MaterialMapper::srgbToLinear(float fValue)
+{
+	if (fValue < 0.0f) return 0.0f;
+	if (fValue < 0.04045f) return fValue / 12.92f;
+	return std::pow((fValue + 0.055f) / 1.055f, 2.4f);
+}
+
+void MaterialMapper::dazColorToLinear(const std::string& sColor, float aLinear[3])
+{
+	std::string sHex = sColor;
+	sHex.erase(0, sHex.find_first_not_of('#'));
+	for (int i = 0; i < 3; i++)
+	{
+		float fValue = 1.0f;
+		if (sHex.size() >= (size_t)(i * 2 + 2))
+		{
+			fValue = std::strtol(sHex.substr(i * 2, 2).c_str(), nullptr, 16) / 255.0f;
+		}
+		aLinear[i] = srgbToLinear(fValue);
+	}
+}
+
+std::string MaterialMapper::swapLowResFilename(const std::string& sFilePath, const std::string& sResolution)
+{
+	fs::path filePath(sFilePath);
+	// variants of the Daz texture stage are in 2k/ and 1k/ subfolders with the same filename,
+	// in those folders a "_2k" file is a source texture of its own and never a variant
+	fs::path variant2k = filePath.parent_path() / "2k" / filePath.filename();
+	fs::path variant1k = filePath.parent_path() / "1k" / filePath.filename();
+	std::error_code error;
+	if (fs::is_directory(variant2k.parent_path(), error) || fs::is_directory(variant1k.parent_path(), error))
+	{
+		if (toLower(sResolution) == "1k" && fileExists(variant1k.string())) return variant1k.string();
+		if (fileExists(variant2k.string())) return variant2k.string();
+		return sFilePath;
+	}
+	std::string sExtension = filePath.extension().string();
+	std::string sBase = sFilePath.substr(0, sFilePath.size() - sExtension.size());
+	std::string sSquarePng = sBase + "_square.png";
+	if (fileExists(sSquarePng)) return sSquarePng;
+	if (toLower(sResolution) == "1k")
+	{
+		if (fileExists(sBase + "_1k.jpg")) return sBase + "_1k.jpg";
+		if (fileExists(sBase + "_1k" + sExtension)) return sBase + "_1k" + sExtension;
+	}
+	if (fileExists(sBase + "_2k.jpg")) return sBase + "_2k.jpg";
+	if (fileExists(sBase + "_2k" + sExtension)) return sBase + "_2k" + sExtension;
+	return sFilePath;
+}
+
+bool MaterialMapper::isEyeMaterial(const std::string& sMaterialName)
+{
+	std::string sName = toLower(sMaterialName);
+	bool bEyeWord = false;
+	std::istringstream words(sName);
+	std::string sWord;
+	while (std::getline(words, sWord, ' '))
+	{
+		if (sWord == "eye") bEyeWord = true;
+	}
+	return bEyeWord
+		&& sName.find("moisture") == std::string::npos
+		&& sName.find("tear") == std::string::npos
+		&& sName.find("brow") == std::string::npos
+		&& sName.find("lash") == std::string::npos;
+}
+
+bool MaterialMapper::isScalpMaterial(const std::string& sMaterialName)
+{
+	std::string sName = toLower(sMaterialName);
+	return sName.find("scalp") != std::string::npos || sName.find("cap") != std::string::npos;
+}
+
+std::string MaterialMapper::getTexture(const DtuProperty* pProperty) const
+{
+	if (pProperty == nullptr || pProperty->sTexture.empty()) return "";
+	std::string sTexture = pProperty->sTexture;
+	if (!m_sTextureResolution.empty() && toLower(m_sTextureResolution) != "full")
+	{
+		sTexture = swapLowResFilename(sTexture, m_sTextureResolution);
+	}
+	if (!fileExists(sTexture))
+	{
+		log("ERROR: MaterialMapper: " + pProperty->sName + " map file does not exist, skipping: " + sTexture);
+		return "";
+	}
+	return sTexture;
+}
+
+SceneTextureRef MaterialMapper::addImage(int nJob, Scene& scene, const TextureProcessor& textures)
+{
+	SceneTextureRef texture;
+	auto existing = m_aJobImages.find(nJob);
+	if (existing != m_aJobImages.end())
+	{
+		texture.nImage = existing->second;
+		return texture;
+	}
+	SceneImage image;
+	image.sName = fs::path(textures.getJob(nJob).sOutputFilename).stem().string();
+	texture.nImage = (int)scene.aImages.size();
+	scene.aImages.push_back(image);
+	m_aJobImages[nJob] = texture.nImage;
+	if ((int)m_aImageJobs.size() < texture.nImage + 1) m_aImageJobs.resize(texture.nImage + 1, -1);
+	m_aImageJobs[texture.nImage] = nJob;
+	return texture;
+}
+
+void MaterialMapper::mapMaterial(const DtuMaterial& dtuMaterial, SceneMaterial& material, Scene& scene, TextureProcessor& textures)
+{
+	const DtuProperty* pDiffuse = dtuMaterial.findProperty("Diffuse Color");
+	const DtuProperty* pMetallic = dtuMaterial.findProperty("Metallic Weight");
+	const DtuProperty* pDualLobeWeight = dtuMaterial.findProperty("Dual Lobe Specular Weight");
+	const DtuProperty* pGlossyWeight = dtuMaterial.findProperty("Glossy Layered Weight");
+	const DtuProperty* pEmission = dtuMaterial.findProperty("Emission Color");
+	const DtuProperty* pNormal = dtuMaterial.findProperty("Normal Map");
+	const DtuProperty* pOcclusion = dtuMaterial.findProperty("Ambient Occlusion");
+	const DtuProperty* pCutout = dtuMaterial.findProperty("Cutout Opacity");
+	if (pCutout == nullptr) pCutout = dtuMaterial.findProperty("Opacity Strength");
+
+	// later properties win, as in process_material()
+	const DtuProperty* pRoughness = nullptr;
+	const DtuProperty* pReflectivity = nullptr;
+	float fRoughness = 0.0f;
+	float fReflectivity = 0.0f;
+	for (const DtuProperty& property : dtuMaterial.aProperties)
+	{
+		if (property.sName == "Specular Lobe 1 Roughness" || property.sName == "Glossy Roughness")
+		{
+			if (property.value.toDouble() != 0.0) fRoughness = (float)property.value.toDouble();
+			if (!property.sTexture.empty()) pRoughness = &property;
+		}
+		else if (property.sName == "Dual Lobe Specular Reflectivity" || property.sName == "Glossy Reflectivity")
+		{
+			if (property.value.toDouble() != 0.0) fReflectivity = (float)property.value.toDouble();
+			if (!property.sTexture.empty()) pReflectivity = &property;
+		}
+	}
+
+	float aColor[3] = { 1.0f, 1.0f, 1.0f };
+	if (pDiffuse && pDiffuse->value.isString()) dazColorToLinear(pDiffuse->value.toString(), aColor);
+	float fMetallic = propertyValue(pMetallic, 0.0f);
+	float fDualLobeWeight = propertyValue(pDualLobeWeight, 0.0f);
+	float fGlossyWeight = propertyValue(pGlossyWeight, 0.0f);
+	float fOpacity = propertyValue(pCutout, 1.0f);
+	float fRefractionWeight = propertyValue(dtuMaterial.findProperty("Refraction Weight"), 0.0f);
+
+	std::string sColorMap = getTexture(pDiffuse);
+	std::string sMetallicMap = getTexture(pMetallic);
+	std::string sRoughnessMap = getTexture(pRoughness);
+	std::string sOcclusionMap = m_bPackOcclusion ? getTexture(pOcclusion) : "";
+	std::string sEmissionMap = getTexture(pEmission);
+	std::string sNormalMap = getTexture(pNormal);
+	std::string sCutoutMap = getTexture(pCutout);
+	if (!m_bPackOcclusion && pOcclusion && !pOcclusion->sTexture.empty())
+	{
+		log("DEBUG: MaterialMapper: occlusion map is only exported when texture packing is enabled, skipping...");
+	}
+
+	// base color, with the cutout map packed into the alpha channel
+	for (int i = 0; i < 3; i++) material.aBaseColorFactor[i] = sColorMap.empty() ? aColor[i] : 1.0f;
+	material.aBaseColorFactor[3] = sCutoutMap.empty() ? fOpacity : 1.0f;
+	material.baseColorTexture = SceneTextureRef();
+	if (!sCutoutMap.empty() && sCutoutMap != sColorMap)
+	{
+		TextureChannelSource aChannels[4];
+		uint8_t aDefaults[4] = { 255, 255, 255, 255 };
+		for (int i = 0; i < 3 && !sColorMap.empty(); i++)
+		{
+			aChannels[i].sFilePath = sColorMap;
+			aChannels[i].nChannel = i;
+		}
+		aChannels[3].sFilePath = sCutoutMap;
+		aChannels[3].nChannel = -1;
+		std::string sName = fs::path(sColorMap.empty() ? sCutoutMap : sColorMap).stem().string() + "_rgba";
+		material.baseColorTexture = addImage(textures.addPackedTexture(sName, aChannels, aDefaults, 4), scene, textures);
+	}
+	else if (!sColorMap.empty())
+	{
+		material.baseColorTexture = addImage(textures.addTexture(sColorMap), scene, textures);
+	}
+
+	// glTF reads roughness from G and metallic from B of one texture, so single maps are always packed
+	material.fMetallicFactor = sMetallicMap.empty() ? fMetallic : 1.0f;
+	material.fRoughnessFactor = sRoughnessMap.empty() ? fRoughness : 1.0f;
+	material.metallicRoughnessTexture = SceneTextureRef();
+	material.occlusionTexture = SceneTextureRef();
+	if (!sMetallicMap.empty() || !sRoughnessMap.empty() || !sOcclusionMap.empty())
+	{
+		TextureChannelSource aChannels[4];
+		uint8_t aDefaults[4] = { 255, 255, 255, 255 };
+		aChannels[0].sFilePath = sOcclusionMap;
+		aChannels[1].sFilePath = sRoughnessMap;
+		aChannels[2].sFilePath = sMetallicMap;
+		std::string sFirstMap = !sRoughnessMap.empty() ? sRoughnessMap : (!sMetallicMap.empty() ? sMetallicMap : sOcclusionMap);
+		std::string sName = fs::path(sFirstMap).stem().string() + (sOcclusionMap.empty() ? "_mr" : "_orm");
+		SceneTextureRef texture = addImage(textures.addPackedTexture(sName, aChannels, aDefaults, 3), scene, textures);
+		if (!sMetallicMap.empty() || !sRoughnessMap.empty()) material.metallicRoughnessTexture = texture;
+		if (!sOcclusionMap.empty()) material.occlusionTexture = texture;
+	}
+
+	// Principled BSDF specular 0.5 is the glTF default reflectance of 4%
+	float fSpecular = 0.0f;
+	if (pReflectivity || fReflectivity != 0.0f) fSpecular = fReflectivity;
+	else if (fDualLobeWeight != 0.0f) fSpecular = fDualLobeWeight;
+	else if (fGlossyWeight != 0.0f) fSpecular = fGlossyWeight;
+
+	material.emissiveTexture = SceneTextureRef();
+	for (int i = 0; i < 3; i++) material.aEmissiveFactor[i] = 0.0f;
+	if (!sEmissionMap.empty())
+	{
+		material.emissiveTexture = addImage(textures.addTexture(sEmissionMap), scene, textures);
+		for (int i = 0; i < 3; i++) material.aEmissiveFactor[i] = 1.0f;
+	}
+
+	material.normalTexture = SceneTextureRef();
+	if (!sNormalMap.empty())
+	{
+		material.normalTexture = addImage(textures.addTexture(sNormalMap), scene, textures);
+		material.fNormalScale = propertyValue(pNormal, 1.0f) * 0.5f;
+	}
+
+	material.aUvScale[0] = propertyValue(dtuMaterial.findProperty("Horizontal Tiles"), 1.0f);
+	material.aUvScale[1] = propertyValue(dtuMaterial.findProperty("Vertical Tiles"), 1.0f);
+
+	// fix_scalp() runs before the materials are processed, so a clipped scalp stays clipped
+	material.sAlphaMode = "OPAQUE";
+	material.bDoubleSided = true;
+	if (isScalpMaterial(material.sName))
+	{
+		log("DEBUG: MaterialMapper: fix_scalp(): mat found: " + material.sName);
+		material.sAlphaMode = "MASK";
+		material.bDoubleSided = false;
+	}
+	if (!sCutoutMap.empty() && material.sAlphaMode == "OPAQUE")
+	{
+		material.sAlphaMode = "BLEND";
+	}
+
+	if (fRefractionWeight != 0.0f)
+	{
+		if (material.sAlphaMode == "OPAQUE") material.sAlphaMode = "BLEND";
+		float fAlpha = material.aBaseColorFactor[3];
+		if (fAlpha > 0.75f)
+		{
+			float fNewValue = 1.0f - fAlpha;
+			if (fNewValue < 0.01f) fNewValue = fNewValue * 15.0f / fRefractionWeight;
+			else fNewValue = fNewValue / fRefractionWeight;
+			fAlpha = std::min(fNewValue, fAlpha);
+		}
+		// the cutout map is halved like the multiply node of process_material()
+		material.aBaseColorFactor[3] = sCutoutMap.empty() ? fAlpha : 0.5f;
+		material.fRoughnessFactor *= (1.0f - fRefractionWeight);
+		fSpecular *= (1.0f - fRefractionWeight);
+		material.fMetallicFactor = std::max(material.fMetallicFactor, fRefractionWeight);
+		log("DEBUG: MaterialMapper: refraction weight = " + std::to_string(fRefractionWeight) + ", alpha = " + std::to_string(material.aBaseColorFactor[3]));
+	}
+	material.fSpecularFactor = std::min(1.0f, fSpecular * 2.0f);
+
+	if (isEyeMaterial(material.sName) && material.sAlphaMode == "BLEND")
+	{
+		log("DEBUG: MaterialMapper: fix_eyes(): mat found: " + material.sName);
+		material.sAlphaMode = "MASK";
+	}
+}
+
+void MaterialMapper::mapMaterials(const DtuFile& dtu, Scene& scene, TextureProcessor& textures)
+{
+	for (const DtuMaterial& dtuMaterial : dtu.getMaterials())
+	{
+		int nMaterial = scene.findMaterial(dtuMaterial.sMaterialName);
+		if (nMaterial < 0)
+		{
+			nMaterial = (int)scene.aMaterials.size();
+			scene.aMaterials.push_back(SceneMaterial());
+			scene.aMaterials.back().sName = dtuMaterial.sMaterialName;
+		}
+		mapMaterial(dtuMaterial, scene.aMaterials[nMaterial], scene, textures);
+		log("DEBUG: MaterialMapper: done processing material: " + dtuMaterial.sMaterialName);
+	}
+}
+
+void MaterialMapper::resolveImages(Scene& scene, const TextureProcessor& textures) const
+{
+	for (size_t i = 0; i < m_aImageJobs.size() && i < scene.aImages.size(); i++)
+	{
+		if (m_aImageJobs[i] < 0) continue;
+		const TextureJob& job = textures.getJob(m_aImageJobs[i]);
+		scene.aImages[i].sFilePath = job.bSucceeded ? job.sOutputPath : "";
+	}
+}
+
+}
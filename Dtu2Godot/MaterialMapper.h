@@ -0,0 +1,49 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DtuFile.h"
+#include "Scene.h"
+#include "TextureProcessor.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Maps the Iray/PBR properties of the DTU materials to glTF metallic-roughness
+ * materials, following blender_tools.process_material() and the fix_eyes() /
+ * fix_scalp() passes of the blender scripts.  Textures are requested from the
+ * TextureProcessor; call resolveImages() after it has processed them.
+ */
+class MaterialMapper
+{
+public:
+	// "full", "2k" or "1k", as the DTU "Texture Resolution" setting
+	void setTextureResolution(const std::string& sResolution) { m_sTextureResolution = sResolution; }
+	// pack ambient occlusion into the red channel of the metallic-roughness texture
+	void setPackOcclusion(bool bPack) { m_bPackOcclusion = bPack; }
+
+	// adds or updates scene materials with the names of the DTU materials
+	void mapMaterials(const DtuFile& dtu, Scene& scene, TextureProcessor& textures);
+	// sets the processed file paths of the scene images
+	void resolveImages(Scene& scene, const TextureProcessor& textures) const;
+
+	static void dazColorToLinear(const std::string& sColor, float aLinear[3]);
+	static float srgbToLinear(float fValue);
+	static std::string swapLowResFilename(const std::string& sFilePath, const std::string& sResolution);
+	static bool isEyeMaterial(const std::string& sMaterialName);
+	static bool isScalpMaterial(const std::string& sMaterialName);
+
+protected:
+	std::string m_sTextureResolution = "full";
+	bool m_bPackOcclusion = false;
+	std::map<int, int> m_aJobImages; // texture job -> scene image
+	std::vector<int> m_aImageJobs; // scene image -> texture job
+
+	void mapMaterial(const DtuMaterial& dtuMaterial, SceneMaterial& material, Scene& scene, TextureProcessor& textures);
+	std::string getTexture(const DtuProperty* pProperty) const;
+	SceneTextureRef addImage(int nJob, Scene& scene, const TextureProcessor& textures);
+};
+
+}
@@ -0,0 +1,202 @@
+#include <cmath>
+#include <cstring>
+
+#include "Math.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+const double PI = 3.14159265358979323846;
+
+Matrix4 axisRotation(int nAxis, double fDegrees)
+{
+	double fRadians = fDegrees * PI / 180.0;
+	double c = std::cos(fRadians), s = std::sin(fRadians);
+	Matrix4 result;
+	int a = (nAxis + 1) % 3, b = (nAxis + 2) % 3;
+	result.m[a * 4 + a] = c;
+	result.m[a * 4 + b] = s;
+	result.m[b * 4 + a] = -s;
+	result.m[b * 4 + b] = c;
+	return result;
+}
+}
+
+Matrix4 Matrix4::fromArray(const double* pValues)
+{
+	Matrix4 result;
+	memcpy(result.m, pValues, sizeof(result.m));
+	return result;
+}
+
+Matrix4 Matrix4::translation(const double aTranslation[3])
+{
+	Matrix4 result;
+	result.m[12] = aTranslation[0];
+	result.m[13] = aTranslation[1];
+	result.m[14] = aTranslation[2];
+	return result;
+}
+
+Matrix4 Matrix4::scaling(const double aScale[3])
+{
+	Matrix4 result;
+	result.m[0] = aScale[0];
+	result.m[5] = aScale[1];
+	result.m[10] = aScale[2];
+	return result;
+}
+
+Matrix4 Matrix4::quaternionRotation(const double aRotation[4])
+{
+	double x = aRotation[0], y = aRotation[1], z = aRotation[2], w = aRotation[3];
+	Matrix4 result;
+	result.m[0] = 1.0 - 2.0 * (y * y + z * z);
+	result.m[1] = 2.0 * (x * y + z * w);
+	result.m[2] = 2.0 * (x * z - y * w);
+	result.m[4] = 2.0 * (x * y - z * w);
+	result.m[5] = 1.0 - 2.0 * (x * x + z * z);
+	result.m[6] = 2.0 * (y * z + x * w);
+	result.m[8] = 2.0 * (x * z + y * w);
+	result.m[9] = 2.0 * (y * z - x * w);
+	result.m[10] = 1.0 - 2.0 * (x * x + y * y);
+	return result;
+}
+
+Matrix4 Matrix4::eulerRotation(const double aDegrees[3], int nOrder)
+{
+	// axes in the order they are applied
+	static const int s_aOrders[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 2, 0 }, { 1, 0, 2 }, { 2, 0, 1 }, { 2, 1, 0 } };
+	if (nOrder < 0 || nOrder > 5) nOrder = 0;
+	const int* pOrder = s_aOrders[nOrder];
+	Matrix4 result;
+	for (int i = 0; i < 3; i++)
+	{
+		result = axisRotation(pOrder[i], aDegrees[pOrder[i]]) * result;
+	}
+	return result;
+}
+
+Matrix4 Matrix4::operator*(const Matrix4& other) const
+{
+	Matrix4 result;
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			double fSum = 0.0;
+			for (int k = 0; k < 4; k++) fSum += m[k * 4 + r] * other.m[c * 4 + k];
+			result.m[c * 4 + r] = fSum;
+		}
+	}
+	return result;
+}
+
+Matrix4 Matrix4::inverse() const
+{
+	// cofactor expansion
+	const double* a = m;
+	double inv[16];
+	inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+	inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+	inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+	inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+	inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+	inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+	inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+	inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+	inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+	inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+	inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+	inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+	inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+	inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+	inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+	inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+	double fDeterminant = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+	Matrix4 result;
+	if (fDeterminant == 0.0) return result;
+	for (int i = 0; i < 16; i++) result.m[i] = inv[i] / fDeterminant;
+	return result;
+}
+
+void Matrix4::transformPoint(const double aPoint[3], double aResult[3]) const
+{
+	double aTemp[3];
+	for (int r = 0; r < 3; r++) aTemp[r] = m[r] * aPoint[0] + m[4 + r] * aPoint[1] + m[8 + r] * aPoint[2] + m[12 + r];
+	for (int r = 0; r < 3; r++) aResult[r] = aTemp[r];
+}
+
+void Matrix4::transformVector(const double aVector[3], double aResult[3]) const
+{
+	double aTemp[3];
+	for (int r = 0; r < 3; r++) aTemp[r] = m[r] * aVector[0] + m[4 + r] * aVector[1] + m[8 + r] * aVector[2];
+	for (int r = 0; r < 3; r++) aResult[r] = aTemp[r];
+}
+
+void Matrix4::decompose(double aTranslation[3], double aRotation[4], double aScale[3]) const
+{
+	for (int i = 0; i < 3; i++) aTranslation[i] = m[12 + i];
+	double aColumns[3][3];
+	for (int c = 0; c < 3; c++)
+	{
+		aScale[c] = std::sqrt(m[c * 4] * m[c * 4] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2]);
+	}
+	double fDeterminant = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+	if (fDeterminant < 0.0) aScale[0] = -aScale[0];
+	for (int c = 0; c < 3; c++)
+	{
+		for (int r = 0; r < 3; r++) aColumns[c][r] = (aScale[c] != 0.0) ? m[c * 4 + r] / aScale[c] : (c == r ? 1.0 : 0.0);
+	}
+
+	// rotation matrix element (row, column) = aColumns[column][row]
+	double fTrace = aColumns[0][0] + aColumns[1][1] + aColumns[2][2];
+	double x, y, z, w;
+	if (fTrace > 0.0)
+	{
+		double s = std::sqrt(fTrace + 1.0) * 2.0;
+		w = 0.25 * s;
+		x = (aColumns[1][2] - aColumns[2][1]) / s;
+		y = (aColumns[2][0] - aColumns[0][2]) / s;
+		z = (aColumns[0][1] - aColumns[1][0]) / s;
+	}
+	else if (aColumns[0][0] > aColumns[1][1] && aColumns[0][0] > aColumns[2][2])
+	{
+		double s = std::sqrt(1.0 + aColumns[0][0] - aColumns[1][1] - aColumns[2][2]) * 2.0;
+		w = (aColumns[1][2] - aColumns[2][1]) / s;
+		x = 0.25 * s;
+		y = (aColumns[1][0] + aColumns[0][1]) / s;
+		z = (aColumns[2][0] + aColumns[0][2]) / s;
+	}
+	else if (aColumns[1][1] > aColumns[2][2])
+	{
+		double s = std::sqrt(1.0 + aColumns[1][1] - aColumns[0][0] - aColumns[2][2]) * 2.0;
+		w = (aColumns[2][0] - aColumns[0][2]) / s;
+		x = (aColumns[1][0] + aColumns[0][1]) / s;
+		y = 0.25 * s;
+		z = (aColumns[2][1] + aColumns[1][2]) / s;
+	}
+	else
+	{
+		double s = std::sqrt(1.0 + aColumns[2][2] - aColumns[0][0] - aColumns[1][1]) * 2.0;
+		w = (aColumns[0][1] - aColumns[1][0]) / s;
+		x = (aColumns[2][0] + aColumns[0][2]) / s;
+		y = (aColumns[2][1] + aColumns[1][2]) / s;
+		z = 0.25 * s;
+	}
+	double fLength = std::sqrt(x * x + y * y + z * z + w * w);
+	aRotation[0] = x / fLength;
+	aRotation[1] = y / fLength;
+	aRotation[2] = z / fLength;
+	aRotation[3] = w / fLength;
+}
+
+void Matrix4::toFloats(float* pValues) const
+{
+	for (int i = 0; i < 16; i++) pValues[i] = (float)m[i];
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace Dtu2Godot
+{
+
+// 4x4 double matrix, column-major like glTF: m[column * 4 + row]
+struct Matrix4
+{
+	double m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	static Matrix4 identity() { return Matrix4(); }
+	static Matrix4 fromArray(const double* pValues);
+	static Matrix4 translation(const double aTranslation[3]);
+	static Matrix4 scaling(const double aScale[3]);
+	// Euler angles in degrees, nOrder as FBX "RotationOrder": 0 = XYZ (X applied first), 1 = XZY,
+	// 2 = YZX, 3 = YXZ, 4 = ZXY, 5 = ZYX
+	static Matrix4 eulerRotation(const double aDegrees[3], int nOrder = 0);
+	// xyzw unit quaternion
+	static Matrix4 quaternionRotation(const double aRotation[4]);
+
+	Matrix4 operator*(const Matrix4& other) const;
+	Matrix4 inverse() const;
+	void transformPoint(const double aPoint[3], double aResult[3]) const;
+	void transformVector(const double aVector[3], double aResult[3]) const;
+
+	// translation, xyzw rotation and scale, assuming no shear
+	void decompose(double aTranslation[3], double aRotation[4], double aScale[3]) const;
+	void toFloats(float* pValues) const;
+};
+
+}
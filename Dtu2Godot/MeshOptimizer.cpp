@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+#include "Log.h"
+#include "Math.h"
+#include "MeshOptimizer.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+bool sameTexture(const SceneTextureRef& a, const SceneTextureRef& b)
+{
+	if (a.nImage != b.nImage) return false;
+	return !a.isSet() || a.nTexCoord == b.nTexCoord;
+}
+
+template <typename T>
+void compactVertices(std::vector<T>& aValues, const std::vector<uint32_t>& aKept, size_t nComponents)
+{
+	if (aValues.empty()) return;
+	for (size_t v = 0; v < aKept.size(); v++)
+	{
+		std::copy_n(aValues.begin() + aKept[v] * nComponents, nComponents, aValues.begin() + v * nComponents);
+	}
+	aValues.resize(aKept.size() * nComponents);
+}
+
+void remapTexture(SceneTextureRef& texture, const std::vector<int>& aImageRemap)
+{
+	if (texture.isSet()) texture.nImage = texture.nImage < (int)aImageRemap.size() ? aImageRemap[texture.nImage] : -1;
+}
+
+// meters, copies of a mesh whose positions differ by less than this are shared
+const double POSITION_TOLERANCE = 1e-5;
+// shared meshes with at least this many static instances are logged as MultiMeshInstance3D candidates
+const size_t MULTIMESH_MIN_INSTANCES = 4;
+
+bool findBoundsMinimum(const SceneMesh& mesh, double aMinimum[3])
+{
+	bool bFound = false;
+	for (const ScenePrimitive& primitive : mesh.aPrimitives)
+	{
+		for (size_t i = 0; i < primitive.aPositions.size(); i++)
+		{
+			double fValue = primitive.aPositions[i];
+			if (!bFound || fValue < aMinimum[i % 3]) aMinimum[i % 3] = fValue;
+			if (i % 3 == 2) bFound = true;
+		}
+	}
+	return bFound;
+}
+
+// FNV-1a over the sizes and indices, which do not depend on where a copy was placed
+uint64_t hashTopology(const SceneMesh& mesh)
+{
+	uint64_t nHash = 14695981039346656037ull;
+	auto add = [&](uint64_t nValue)
+	{
+		nHash = (nHash ^ nValue) * 1099511628211ull;
+	};
+	add(mesh.aPrimitives.size());
+	for (const ScenePrimitive& primitive : mesh.aPrimitives)
+	{
+		add(primitive.getVertexCount());
+		add(primitive.aTexCoords.size());
+		add(primitive.nInfluences);
+		add(primitive.aMorphTargets.size());
+		for (uint32_t nIndex : primitive.aIndices) add(nIndex);
+	}
+	return nHash;
+}
+}
+
+bool MeshOptimizer::isInvisible(const SceneMaterial& material)
+{
+	return material.sAlphaMode != "OPAQUE" && material.aBaseColorFactor[3] <= 0.0f;
+}
+
+bool MeshOptimizer::haveSameSignature(const SceneMaterial& a, const SceneMaterial& b)
+{
+	return std::equal(a.aBaseColorFactor, a.aBaseColorFactor + 4, b.aBaseColorFactor) &&
+		sameTexture(a.baseColorTexture, b.baseColorTexture) &&
+		a.fMetallicFactor == b.fMetallicFactor &&
+		a.fRoughnessFactor == b.fRoughnessFactor &&
+		sameTexture(a.metallicRoughnessTexture, b.metallicRoughnessTexture) &&
+		sameTexture(a.normalTexture, b.normalTexture) &&
+		a.fNormalScale == b.fNormalScale &&
+		sameTexture(a.occlusionTexture, b.occlusionTexture) &&
+		sameTexture(a.emissiveTexture, b.emissiveTexture) &&
+		std::equal(a.aEmissiveFactor, a.aEmissiveFactor + 3, b.aEmissiveFactor) &&
+		a.sAlphaMode == b.sAlphaMode &&
+		a.fAlphaCutoff == b.fAlphaCutoff &&
+		a.bDoubleSided == b.bDoubleSided &&
+		a.fSpecularFactor == b.fSpecularFactor &&
+		std::equal(a.aUvScale, a.aUvScale + 2, b.aUvScale);
+}
+
+bool MeshOptimizer::haveSameLayout(const ScenePrimitive& a, const ScenePrimitive& b)
+{
+	if (a.aNormals.empty() != b.aNormals.empty() || a.aTangents.empty() != b.aTangents.empty()) return false;
+	if (a.aTexCoords.size() != b.aTexCoords.size() || a.nInfluences != b.nInfluences) return false;
+	if (a.aMorphTargets.size() != b.aMorphTargets.size()) return false;
+	for (size_t i = 0; i < a.aMorphTargets.size(); i++)
+	{
+		if (a.aMorphTargets[i].sName != b.aMorphTargets[i].sName) return false;
+		if (a.aMorphTargets[i].aNormalDeltas.empty() != b.aMorphTargets[i].aNormalDeltas.empty()) return false;
+	}
+	return true;
+}
+
+void MeshOptimizer::appendPrimitive(ScenePrimitive& target, const ScenePrimitive& source)
+{
+	uint32_t nOffset = (uint32_t)target.getVertexCount();
+	target.aPositions.insert(target.aPositions.end(), source.aPositions.begin(), source.aPositions.end());
+	target.aNormals.insert(target.aNormals.end(), source.aNormals.begin(), source.aNormals.end());
+	target.aTangents.insert(target.aTangents.end(), source.aTangents.begin(), source.aTangents.end());
+	for (size_t i = 0; i < target.aTexCoords.size(); i++)
+	{
+		target.aTexCoords[i].insert(target.aTexCoords[i].end(), source.aTexCoords[i].begin(), source.aTexCoords[i].end());
+	}
+	target.aJoints.insert(target.aJoints.end(), source.aJoints.begin(), source.aJoints.end());
+	target.aWeights.insert(target.aWeights.end(), source.aWeights.begin(), source.aWeights.end());
+	for (size_t i = 0; i < target.aMorphTargets.size(); i++)
+	{
+		SceneMorphTarget& morph = target.aMorphTargets[i];
+		const SceneMorphTarget& sourceMorph = source.aMorphTargets[i];
+		morph.aPositionDeltas.insert(morph.aPositionDeltas.end(), sourceMorph.aPositionDeltas.begin(), sourceMorph.aPositionDeltas.end());
+		morph.aNormalDeltas.insert(morph.aNormalDeltas.end(), sourceMorph.aNormalDeltas.begin(), sourceMorph.aNormalDeltas.end());
+	}
+	target.aIndices.reserve(target.aIndices.size() + source.aIndices.size());
+	for (uint32_t nIndex : source.aIndices) target.aIndices.push_back(nIndex + nOffset);
+}
+
+size_t MeshOptimizer::removeUnusedVertices(ScenePrimitive& primitive)
+{
+	size_t nVertices = primitive.getVertexCount();
+	std::vector<uint8_t> aUsed(nVertices, 0);
+	for (uint32_t nIndex : primitive.aIndices)
+	{
+		if (nIndex < nVertices) aUsed[nIndex] = 1;
+	}
+	std::vector<uint32_t> aKept;
+	std::vector<uint32_t> aRemap(nVertices, 0);
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		if (!aUsed[v]) continue;
+		aRemap[v] = (uint32_t)aKept.size();
+		aKept.push_back((uint32_t)v);
+	}
+	if (aKept.size() == nVertices) return 0;
+
+	compactVertices(primitive.aPositions, aKept, 3);
+	compactVertices(primitive.aNormals, aKept, 3);
+	compactVertices(primitive.aTangents, aKept, 4);
+	for (std::vector<float>& aTexCoords : primitive.aTexCoords) compactVertices(aTexCoords, aKept, 2);
+	compactVertices(primitive.aJoints, aKept, primitive.nInfluences);
+	compactVertices(primitive.aWeights, aKept, primitive.nInfluences);
+	for (SceneMorphTarget& morph : primitive.aMorphTargets)
+	{
+		compactVertices(morph.aPositionDeltas, aKept, 3);
+		compactVertices(morph.aNormalDeltas, aKept, 3);
+	}
+	for (uint32_t& nIndex : primitive.aIndices)
+	{
+		nIndex = nIndex < nVertices ? aRemap[nIndex] : 0;
+	}
+	return nVertices - aKept.size();
+}
+
+size_t MeshOptimizer::countUsedTexCoordSets(const SceneMaterial* pMaterial)
+{
+	// the first set stays so materials assigned in Godot can still be textured
+	size_t nUsed = 1;
+	if (pMaterial == nullptr) return nUsed;
+	for (const SceneTextureRef* pTexture : { &pMaterial->baseColorTexture, &pMaterial->metallicRoughnessTexture,
+		&pMaterial->normalTexture, &pMaterial->occlusionTexture, &pMaterial->emissiveTexture })
+	{
+		if (pTexture->isSet()) nUsed = std::max(nUsed, (size_t)pTexture->nTexCoord + 1);
+	}
+	return nUsed;
+}
+
+bool MeshOptimizer::haveSameGeometry(const Scene& scene, const SceneMesh& a, const SceneMesh& b, const double aOffset[3])
+{
+	if (a.aPrimitives.size() != b.aPrimitives.size() || a.aMorphWeights != b.aMorphWeights) return false;
+	for (size_t p = 0; p < a.aPrimitives.size(); p++)
+	{
+		const ScenePrimitive& primitiveA = a.aPrimitives[p];
+		const ScenePrimitive& primitiveB = b.aPrimitives[p];
+		if (primitiveA.nMaterial != primitiveB.nMaterial)
+		{
+			int nMaterials = (int)scene.aMaterials.size();
+			if (primitiveA.nMaterial < 0 || primitiveB.nMaterial < 0 || primitiveA.nMaterial >= nMaterials || primitiveB.nMaterial >= nMaterials) return false;
+			if (!haveSameSignature(scene.aMaterials[primitiveA.nMaterial], scene.aMaterials[primitiveB.nMaterial])) return false;
+		}
+		if (!haveSameLayout(primitiveA, primitiveB) || primitiveA.aIndices != primitiveB.aIndices) return false;
+		if (primitiveA.aPositions.size() != primitiveB.aPositions.size()) return false;
+		for (size_t i = 0; i < primitiveA.aPositions.size(); i++)
+		{
+			if (std::fabs((double)primitiveA.aPositions[i] + aOffset[i % 3] - primitiveB.aPositions[i]) > POSITION_TOLERANCE) return false;
+		}
+		if (primitiveA.aNormals != primitiveB.aNormals || primitiveA.aTangents != primitiveB.aTangents) return false;
+		if (primitiveA.aTexCoords != primitiveB.aTexCoords) return false;
+		if (primitiveA.aJoints != primitiveB.aJoints || primitiveA.aWeights != primitiveB.aWeights) return false;
+		for (size_t i = 0; i < primitiveA.aMorphTargets.size(); i++)
+		{
+			if (primitiveA.aMorphTargets[i].aPositionDeltas != primitiveB.aMorphTargets[i].aPositionDeltas) return false;
+			if (primitiveA.aMorphTargets[i].aNormalDeltas != primitiveB.aMorphTargets[i].aNormalDeltas) return false;
+		}
+	}
+	return true;
+}
+
+MeshOptimizer::Statistics MeshOptimizer::process(Scene& scene)
+{
+	m_oStatistics = Statistics();
+	for (SceneMesh& mesh : scene.aMeshes)
+	{
+		std::vector<ScenePrimitive> aPrimitives;
+		for (ScenePrimitive& primitive : mesh.aPrimitives)
+		{
+			const SceneMaterial* pMaterial = nullptr;
+			if (primitive.nMaterial >= 0 && primitive.nMaterial < (int)scene.aMaterials.size())
+			{
+				pMaterial = &scene.aMaterials[primitive.nMaterial];
+			}
+			if (primitive.getVertexCount() == 0 || primitive.aIndices.size() < 3 || (pMaterial && isInvisible(*pMaterial)))
+			{
+				log("DEBUG: MeshOptimizer: removing surface " + (pMaterial ? pMaterial->sName : std::string("(none)")) + " of mesh " + mesh.sName);
+				m_oStatistics.nRemovedPrimitives++;
+				continue;
+			}
+			size_t nTexCoordSets = countUsedTexCoordSets(pMaterial);
+			if (primitive.aTexCoords.size() > nTexCoordSets)
+			{
+				m_oStatistics.nRemovedTexCoordSets += primitive.aTexCoords.size() - nTexCoordSets;
+				primitive.aTexCoords.resize(nTexCoordSets);
+			}
+
+			// surfaces which only differ by their material name render the same as one
+			bool bMerged = false;
+			for (ScenePrimitive& kept : aPrimitives)
+			{
+				bool bSameMaterial = kept.nMaterial == primitive.nMaterial ||
+					(pMaterial && kept.nMaterial >= 0 && kept.nMaterial < (int)scene.aMaterials.size() && haveSameSignature(scene.aMaterials[kept.nMaterial], *pMaterial));
+				if (!bSameMaterial || !haveSameLayout(kept, primitive)) continue;
+				appendPrimitive(kept, primitive);
+				m_oStatistics.nMergedPrimitives++;
+				bMerged = true;
+				break;
+			}
+			if (!bMerged) aPrimitives.push_back(std::move(primitive));
+		}
+		for (ScenePrimitive& primitive : aPrimitives)
+		{
+			m_oStatistics.nRemovedVertices += removeUnusedVertices(primitive);
+		}
+		mesh.aPrimitives = std::move(aPrimitives);
+	}
+	removeUnusedMeshes(scene);
+	removeUnusedMaterials(scene);
+
+	log("DEBUG: MeshOptimizer: removed " + std::to_string(m_oStatistics.nRemovedPrimitives) + " and merged " +
+		std::to_string(m_oStatistics.nMergedPrimitives) + " surfaces, removed " + std::to_string(m_oStatistics.nRemovedVertices) +
+		" vertices, " + std::to_string(m_oStatistics.nRemovedTexCoordSets) + " UV sets, " +
+		std::to_string(m_oStatistics.nRemovedMeshes) + " meshes and " + std::to_string(m_oStatistics.nRemovedMaterials) + " materials");
+	return m_oStatistics;
+}
+
+size_t MeshOptimizer::deduplicateMeshes(Scene& scene)
+{
+	// skinned meshes are bound to their skeleton where they are, so only exact copies are shared
+	std::vector<bool> aSkinned(scene.aMeshes.size(), false);
+	for (const SceneNode& node : scene.aNodes)
+	{
+		if (node.nMesh >= 0 && node.nMesh < (int)aSkinned.size() && node.nSkin >= 0) aSkinned[node.nMesh] = true;
+	}
+	std::vector<std::array<double, 3>> aOrigins(scene.aMeshes.size(), std::array<double, 3>{ { 0.0, 0.0, 0.0 } });
+	std::unordered_map<uint64_t, std::vector<int>> buckets;
+	std::vector<int> aShared(scene.aMeshes.size(), -1);
+	size_t nDuplicates = 0;
+	for (size_t i = 0; i < scene.aMeshes.size(); i++)
+	{
+		const SceneMesh& mesh = scene.aMeshes[i];
+		if (mesh.aPrimitives.empty()) continue;
+		if (!aSkinned[i]) findBoundsMinimum(mesh, aOrigins[i].data());
+		std::vector<int>& aCandidates = buckets[hashTopology(mesh)];
+		for (int nFirst : aCandidates)
+		{
+			double aOffset[3];
+			for (int c = 0; c < 3; c++) aOffset[c] = aOrigins[i][c] - aOrigins[nFirst][c];
+			if (!haveSameGeometry(scene, scene.aMeshes[nFirst], mesh, aOffset)) continue;
+			aShared[i] = nFirst;
+			nDuplicates++;
+			break;
+		}
+		if (aShared[i] < 0) aCandidates.push_back((int)i);
+	}
+	if (nDuplicates == 0) return 0;
+
+	std::vector<size_t> aInstances(scene.aMeshes.size(), 0);
+	size_t nNodes = scene.aNodes.size();
+	for (size_t n = 0; n < nNodes; n++)
+	{
+		int nMesh = scene.aNodes[n].nMesh;
+		if (nMesh < 0 || nMesh >= (int)aShared.size()) continue;
+		int nFirst = aShared[nMesh] >= 0 ? aShared[nMesh] : nMesh;
+		aInstances[nFirst]++;
+		if (nFirst == nMesh) continue;
+		scene.aNodes[n].nMesh = nFirst;
+		double aOffset[3];
+		for (int c = 0; c < 3; c++) aOffset[c] = aOrigins[nMesh][c] - aOrigins[nFirst][c];
+		if (std::fabs(aOffset[0]) > POSITION_TOLERANCE || std::fabs(aOffset[1]) > POSITION_TOLERANCE || std::fabs(aOffset[2]) > POSITION_TOLERANCE)
+		{
+			moveMeshOffsetToNode(scene, (int)n, aOffset);
+		}
+	}
+	for (size_t i = 0; i < scene.aMeshes.size(); i++)
+	{
+		if (aShared[i] >= 0 || aInstances[i] < 2) continue;
+		const SceneMesh& mesh = scene.aMeshes[i];
+		bool bStatic = !aSkinned[i] && std::none_of(mesh.aPrimitives.begin(), mesh.aPrimitives.end(), [](const ScenePrimitive& primitive)
+		{
+			return !primitive.aMorphTargets.empty();
+		});
+		log("DEBUG: MeshOptimizer: mesh " + mesh.sName + " is shared by " + std::to_string(aInstances[i]) + " nodes" +
+			(bStatic && aInstances[i] >= MULTIMESH_MIN_INSTANCES ? ", a MultiMeshInstance3D candidate" : ""));
+	}
+
+	// the copies are left without nodes and removed like meshes without primitives
+	for (size_t i = 0; i < scene.aMeshes.size(); i++)
+	{
+		if (aShared[i] >= 0) scene.aMeshes[i].aPrimitives.clear();
+	}
+	size_t nRemovedMeshes = m_oStatistics.nRemovedMeshes;
+	removeUnusedMeshes(scene);
+	removeUnusedMaterials(scene);
+	log("DEBUG: MeshOptimizer: removed " + std::to_string(nDuplicates) + " duplicate meshes");
+	return m_oStatistics.nRemovedMeshes - nRemovedMeshes;
+}
+
+void MeshOptimizer::moveMeshOffsetToNode(Scene& scene, int nNode, const double aOffset[3])
+{
+	bool bAnimated = false;
+	for (const SceneAnimation& animation : scene.aAnimations)
+	{
+		for (const SceneAnimationChannel& channel : animation.aChannels)
+		{
+			if (channel.nNode == nNode && channel.sPath != "weights") bAnimated = true;
+		}
+	}
+	SceneNode& node = scene.aNodes[nNode];
+	if (!bAnimated && node.aChildren.empty())
+	{
+		// T * R * S * offset: the offset in the parent space is the offset rotated and scaled by the node
+		double aRotation[4] = { node.aRotation[0], node.aRotation[1], node.aRotation[2], node.aRotation[3] };
+		double aScaled[3] = { aOffset[0] * node.aScale[0], aOffset[1] * node.aScale[1], aOffset[2] * node.aScale[2] };
+		double aMoved[3];
+		Matrix4::quaternionRotation(aRotation).transformVector(aScaled, aMoved);
+		for (int c = 0; c < 3; c++) node.aTranslation[c] += (float)aMoved[c];
+		return;
+	}
+
+	// the children and animation must not move, so a new child node takes over the mesh
+	SceneNode child;
+	child.sName = node.sName + "_mesh";
+	child.nMesh = node.nMesh;
+	for (int c = 0; c < 3; c++) child.aTranslation[c] = (float)aOffset[c];
+	node.nMesh = -1;
+	int nChild = (int)scene.aNodes.size();
+	scene.aNodes[nNode].aChildren.push_back(nChild);
+	scene.aNodes.push_back(child);
+	for (SceneAnimation& animation : scene.aAnimations)
+	{
+		for (SceneAnimationChannel& channel : animation.aChannels)
+		{
+			if (channel.nNode == nNode && channel.sPath == "weights") channel.nNode = nChild;
+		}
+	}
+}
+
+void MeshOptimizer::removeUnusedMeshes(Scene& scene)
+{
+	size_t nRemoved = (size_t)std::count_if(scene.aMeshes.begin(), scene.aMeshes.end(), [](const SceneMesh& mesh) { return mesh.aPrimitives.empty(); });
+	if (nRemoved == 0) return;
+	m_oStatistics.nRemovedMeshes += nRemoved;
+
+	std::vector<int> aRemap(scene.aMeshes.size(), -1);
+	std::vector<SceneMesh> aMeshes;
+	for (size_t i = 0; i < scene.aMeshes.size(); i++)
+	{
+		if (scene.aMeshes[i].aPrimitives.empty()) continue;
+		aRemap[i] = (int)aMeshes.size();
+		aMeshes.push_back(std::move(scene.aMeshes[i]));
+	}
+	scene.aMeshes = std::move(aMeshes);
+
+	std::vector<bool> aLostMesh(scene.aNodes.size(), false);
+	for (size_t i = 0; i < scene.aNodes.size(); i++)
+	{
+		SceneNode& node = scene.aNodes[i];
+		if (node.nMesh < 0) continue;
+		node.nMesh = node.nMesh < (int)aRemap.size() ? aRemap[node.nMesh] : -1;
+		if (node.nMesh < 0)
+		{
+			// a skin without a mesh has nothing to deform
+			node.nSkin = -1;
+			aLostMesh[i] = true;
+		}
+	}
+	for (SceneAnimation& animation : scene.aAnimations)
+	{
+		animation.aChannels.erase(std::remove_if(animation.aChannels.begin(), animation.aChannels.end(), [&](const SceneAnimationChannel& channel)
+		{
+			return channel.sPath == "weights" && channel.nNode >= 0 && channel.nNode < (int)aLostMesh.size() && aLostMesh[channel.nNode];
+		}), animation.aChannels.end());
+	}
+}
+
+void MeshOptimizer::removeUnusedMaterials(Scene& scene)
+{
+	// a materials only conversion has no meshes and keeps every material
+	if (scene.aMeshes.empty()) return;
+	std::vector<bool> aUsed(scene.aMaterials.size(), false);
+	for (const SceneMesh& mesh : scene.aMeshes)
+	{
+		for (const ScenePrimitive& primitive : mesh.aPrimitives)
+		{
+			if (primitive.nMaterial >= 0 && primitive.nMaterial < (int)aUsed.size()) aUsed[primitive.nMaterial] = true;
+		}
+	}
+	size_t nRemoved = (size_t)std::count(aUsed.begin(), aUsed.end(), false);
+	if (nRemoved == 0) return;
+	m_oStatistics.nRemovedMaterials += nRemoved;
+
+	std::vector<int> aRemap(scene.aMaterials.size(), -1);
+	std::vector<SceneMaterial> aMaterials;
+	for (size_t i = 0; i < scene.aMaterials.size(); i++)
+	{
+		if (!aUsed[i]) continue;
+		aRemap[i] = (int)aMaterials.size();
+		aMaterials.push_back(std::move(scene.aMaterials[i]));
+	}
+	scene.aMaterials = std::move(aMaterials);
+	for (SceneMesh& mesh : scene.aMeshes)
+	{
+		for (ScenePrimitive& primitive : mesh.aPrimitives)
+		{
+			if (primitive.nMaterial >= 0) primitive.nMaterial = primitive.nMaterial < (int)aRemap.size() ? aRemap[primitive.nMaterial] : -1;
+		}
+	}
+
+	// images only the removed materials used
+	std::vector<bool> aUsedImages(scene.aImages.size(), false);
+	for (const SceneMaterial& material : scene.aMaterials)
+	{
+		for (const SceneTextureRef* pTexture : { &material.baseColorTexture, &material.metallicRoughnessTexture,
+			&material.normalTexture, &material.occlusionTexture, &material.emissiveTexture })
+		{
+			if (pTexture->isSet() && pTexture->nImage < (int)aUsedImages.size()) aUsedImages[pTexture->nImage] = true;
+		}
+	}
+	std::vector<int> aImageRemap(scene.aImages.size(), -1);
+	std::vector<SceneImage> aImages;
+	for (size_t i = 0; i < scene.aImages.size(); i++)
+	{
+		if (!aUsedImages[i]) continue;
+		aImageRemap[i] = (int)aImages.size();
+		aImages.push_back(std::move(scene.aImages[i]));
+	}
+	scene.aImages = std::move(aImages);
+	for (SceneMaterial& material : scene.aMaterials)
+	{
+		remapTexture(material.baseColorTexture, aImageRemap);
+		remapTexture(material.metallicRoughnessTexture, aImageRemap);
+		remapTexture(material.normalTexture, aImageRemap);
+		remapTexture(material.occlusionTexture, aImageRemap);
+		remapTexture(material.emissiveTexture, aImageRemap);
+	}
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+
+#include "Scene.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Prunes the per-surface primitives which the FBX import and material
+ * mapping produce, one per Daz surface: primitives without triangles or
+ * with a fully transparent material are removed, primitives of a mesh
+ * whose materials differ only by name are merged into one surface, and
+ * vertices no triangle references and UV sets no texture reads are
+ * dropped.  Materials and images left without users go with them.
+ *
+ * Meshes with the same geometry and material signatures, such as the
+ * repeated props of an environment, are shared: copies whose transform
+ * was baked into the vertices are matched relative to their bounds, and
+ * the offset is moved onto the nodes which now reference the first mesh.
+ */
+class MeshOptimizer
+{
+public:
+	struct Statistics
+	{
+		size_t nRemovedPrimitives = 0;
+		size_t nMergedPrimitives = 0;
+		size_t nRemovedVertices = 0;
+		size_t nRemovedTexCoordSets = 0;
+		size_t nRemovedMeshes = 0;
+		size_t nRemovedMaterials = 0;
+	};
+
+	Statistics process(Scene& scene);
+	// returns the number of meshes removed
+	size_t deduplicateMeshes(Scene& scene);
+
+	// alpha blended or masked with a zero base color alpha
+	static bool isInvisible(const SceneMaterial& material);
+	// every property except the name
+	static bool haveSameSignature(const SceneMaterial& a, const SceneMaterial& b);
+	// same attributes, influences and morph targets, so the vertex data can be concatenated
+	static bool haveSameLayout(const ScenePrimitive& a, const ScenePrimitive& b);
+	static void appendPrimitive(ScenePrimitive& target, const ScenePrimitive& source);
+	// returns the number of vertices removed
+	static size_t removeUnusedVertices(ScenePrimitive& primitive);
+	// number of UV sets the material's textures read, at least one
+	static size_t countUsedTexCoordSets(const SceneMaterial* pMaterial);
+	// same indices, material signatures and vertex data, with the positions of b those of a plus aOffset
+	static bool haveSameGeometry(const Scene& scene, const SceneMesh& a, const SceneMesh& b, const double aOffset[3]);
+
+protected:
+	void removeUnusedMeshes(Scene& scene);
+	void removeUnusedMaterials(Scene& scene);
+	void moveMeshOffsetToNode(Scene& scene, int nNode, const double aOffset[3]);
+
+	Statistics m_oStatistics;
+};
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+/*
+ * In-memory scene assembled from the DTU and FBX files of an intermediate
+ * folder, in glTF conventions: meters, Y up, column-major matrices, xyzw
+ * quaternions and materials as metallic-roughness PBR.
+ */
+
+struct SceneTextureRef
+{
+	int nImage = -1; // -1 = no texture
+	int nTexCoord = 0;
+	bool isSet() const { return nImage >= 0; }
+};
+
+struct SceneImage
+{
+	std::string sName;
+	std::string sFilePath; // processed texture file
+};
+
+struct SceneMaterial
+{
+	std::string sName;
+	float aBaseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	SceneTextureRef baseColorTexture;
+	float fMetallicFactor = 0.0f;
+	float fRoughnessFactor = 0.5f;
+	SceneTextureRef metallicRoughnessTexture; // roughness in G, metallic in B (and occlusion in R if packed)
+	SceneTextureRef normalTexture;
+	float fNormalScale = 1.0f;
+	SceneTextureRef occlusionTexture;
+	SceneTextureRef emissiveTexture;
+	float aEmissiveFactor[3] = { 0.0f, 0.0f, 0.0f };
+	std::string sAlphaMode = "OPAQUE"; // "OPAQUE", "MASK" or "BLEND"
+	float fAlphaCutoff = 0.5f;
+	bool bDoubleSided = true;
+	float fSpecularFactor = -1.0f; // KHR_materials_specular, < 0 = not written
+	float aUvScale[2] = { 1.0f, 1.0f }; // KHR_texture_transform for tiled surfaces
+};
+
+struct SceneMorphTarget
+{
+	std::string sName;
+	std::vector<float> aPositionDeltas; // xyz per vertex
+	std::vector<float> aNormalDeltas; // xyz per vertex, may be empty
+};
+
+struct ScenePrimitive
+{
+	std::vector<float> aPositions; // xyz
+	std::vector<float> aNormals; // xyz, may be empty
+	std::vector<float> aTangents; // xyzw, may be empty
+	std::vector<std::vector<float>> aTexCoords; // uv per set, v pointing down as in glTF
+	int nInfluences = 0; // joints/weights per vertex, a multiple of 4
+	std::vector<uint16_t> aJoints; // nInfluences per vertex, indices into the skin's joints
+	std::vector<float> aWeights; // nInfluences per vertex
+	std::vector<uint32_t> aIndices; // triangles
+	std::vector<SceneMorphTarget> aMorphTargets;
+	int nMaterial = -1;
+
+	size_t getVertexCount() const { return aPositions.size() / 3; }
+};
+
+struct SceneMesh
+{
+	std::string sName;
+	std::vector<ScenePrimitive> aPrimitives;
+	std::vector<float> aMorphWeights; // default weight of each morph target
+};
+
+struct SceneNode
+{
+	std::string sName;
+	float aTranslation[3] = { 0.0f, 0.0f, 0.0f };
+	float aRotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // xyzw
+	float aScale[3] = { 1.0f, 1.0f, 1.0f };
+	std::vector<int> aChildren;
+	int nMesh = -1;
+	int nSkin = -1;
+};
+
+struct SceneSkin
+{
+	std::string sName;
+	std::vector<int> aJoints; // node indices
+	std::vector<float> aInverseBindMatrices; // 16 floats per joint, column-major
+	int nSkeleton = -1;
+};
+
+struct SceneAnimationChannel
+{
+	int nNode = -1;
+	std::string sPath; // "translation", "rotation", "scale" or "weights"
+	std::string sInterpolation = "LINEAR";
+	std::vector<float> aTimes; // seconds
+	std::vector<float> aValues; // 3 or 4 floats per key, or one per morph target for weights
+};
+
+struct SceneAnimation
+{
+	std::string sName;
+	std::vector<SceneAnimationChannel> aChannels;
+};
+
+struct Scene
+{
+	std::string sName;
+	std::vector<SceneNode> aNodes;
+	std::vector<int> aRootNodes;
+	std::vector<SceneMesh> aMeshes;
+	std::vector<SceneMaterial> aMaterials;
+	std::vector<SceneImage> aImages;
+	std::vector<SceneSkin> aSkins;
+	std::vector<SceneAnimation> aAnimations;
+
+	int findMaterial(const std::string& sName) const
+	{
+		for (size_t i = 0; i < aMaterials.size(); i++)
+		{
+			if (aMaterials[i].sName == sName) return (int)i;
+		}
+		return -1;
+	}
+};
+
+}
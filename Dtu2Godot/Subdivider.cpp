@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Subdivider.h"
+#include "ThreadPool.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+typedef std::vector<std::pair<uint32_t, double>> Stencil; // control point, weight
+
+struct Topology
+{
+	std::vector<uint32_t> aFaceOffsets; // first corner of each face, plus the corner count
+	std::vector<uint32_t> aCornerFaces;
+	std::vector<uint32_t> aCornerEdges; // edge from the corner to the next corner of its face
+	std::vector<uint32_t> aEdgeVertices; // 2 per edge
+	std::vector<uint32_t> aEdgeFaces; // first 2 faces per edge
+	std::vector<uint32_t> aEdgeFaceCounts;
+	std::vector<uint32_t> aVertexOffsets; // first entry of each vertex in aVertexCorners, plus the corner count
+	std::vector<uint32_t> aVertexCorners; // corners at each vertex
+
+	uint32_t previousCorner(uint32_t nCorner) const
+	{
+		uint32_t nFace = aCornerFaces[nCorner];
+		return nCorner == aFaceOffsets[nFace] ? aFaceOffsets[nFace + 1] - 1 : nCorner - 1;
+	}
+	uint32_t nextCorner(uint32_t nCorner) const
+	{
+		uint32_t nFace = aCornerFaces[nCorner];
+		return nCorner + 1 == aFaceOffsets[nFace + 1] ? aFaceOffsets[nFace] : nCorner + 1;
+	}
+	bool isBoundary(uint32_t nEdge) const { return aEdgeFaceCounts[nEdge] != 2; }
+	uint32_t otherVertex(uint32_t nEdge, uint32_t nVertex) const
+	{
+		return aEdgeVertices[nEdge * 2] == nVertex ? aEdgeVertices[nEdge * 2 + 1] : aEdgeVertices[nEdge * 2];
+	}
+};
+
+void buildFaces(const SubdivisionMesh& mesh, Topology& topology)
+{
+	size_t nFaces = mesh.getFaceCount();
+	topology.aFaceOffsets.resize(nFaces + 1);
+	topology.aCornerFaces.resize(mesh.aFaceVertices.size());
+	uint32_t nOffset = 0;
+	for (size_t f = 0; f < nFaces; f++)
+	{
+		topology.aFaceOffsets[f] = nOffset;
+		std::fill(topology.aCornerFaces.begin() + nOffset, topology.aCornerFaces.begin() + nOffset + mesh.aFaceSizes[f], (uint32_t)f);
+		nOffset += mesh.aFaceSizes[f];
+	}
+	topology.aFaceOffsets[nFaces] = nOffset;
+}
+
+void buildVertexCorners(const SubdivisionMesh& mesh, Topology& topology)
+{
+	size_t nVertices = mesh.getVertexCount();
+	topology.aVertexOffsets.assign(nVertices + 1, 0);
+	for (uint32_t nVertex : mesh.aFaceVertices) topology.aVertexOffsets[nVertex + 1]++;
+	for (size_t v = 0; v < nVertices; v++) topology.aVertexOffsets[v + 1] += topology.aVertexOffsets[v];
+	topology.aVertexCorners.resize(mesh.aFaceVertices.size());
+	std::vector<uint32_t> aFill(topology.aVertexOffsets.begin(), topology.aVertexOffsets.end() - 1);
+	for (size_t c = 0; c < mesh.aFaceVertices.size(); c++)
+	{
+		topology.aVertexCorners[aFill[mesh.aFaceVertices[c]]++] = (uint32_t)c;
+	}
+}
+
+// edges shared by corners with the same (unordered) pair of vertices
+void buildEdges(const SubdivisionMesh& mesh, Topology& topology)
+{
+	size_t nCorners = mesh.aFaceVertices.size();
+	std::vector<std::pair<uint64_t, uint32_t>> aKeys(nCorners); // vertex pair, corner
+	for (size_t c = 0; c < nCorners; c++)
+	{
+		uint64_t a = mesh.aFaceVertices[c];
+		uint64_t b = mesh.aFaceVertices[topology.nextCorner((uint32_t)c)];
+		aKeys[c] = std::make_pair(std::min(a, b) << 32 | std::max(a, b), (uint32_t)c);
+	}
+	std::sort(aKeys.begin(), aKeys.end());
+
+	topology.aCornerEdges.resize(nCorners);
+	topology.aEdgeVertices.clear();
+	topology.aEdgeFaces.clear();
+	topology.aEdgeFaceCounts.clear();
+	for (size_t i = 0; i < nCorners; i++)
+	{
+		if (i == 0 || aKeys[i].first != aKeys[i - 1].first)
+		{
+			topology.aEdgeVertices.push_back((uint32_t)(aKeys[i].first >> 32));
+			topology.aEdgeVertices.push_back((uint32_t)(aKeys[i].first & 0xffffffff));
+			topology.aEdgeFaces.push_back(0);
+			topology.aEdgeFaces.push_back(0);
+			topology.aEdgeFaceCounts.push_back(0);
+		}
+		uint32_t nEdge = (uint32_t)topology.aEdgeFaceCounts.size() - 1;
+		topology.aCornerEdges[aKeys[i].second] = nEdge;
+		uint32_t& nCount = topology.aEdgeFaceCounts[nEdge];
+		if (nCount < 2) topology.aEdgeFaces[nEdge * 2 + nCount] = topology.aCornerFaces[aKeys[i].second];
+		nCount++;
+	}
+}
+
+void addFaceStencil(const SubdivisionMesh& mesh, const Topology& topology, uint32_t nFace, double fWeight, Stencil& stencil)
+{
+	uint32_t nStart = topology.aFaceOffsets[nFace];
+	uint32_t nEnd = topology.aFaceOffsets[nFace + 1];
+	double fCornerWeight = fWeight / (double)(nEnd - nStart);
+	for (uint32_t c = nStart; c < nEnd; c++) stencil.push_back(std::make_pair(mesh.aFaceVertices[c], fCornerWeight));
+}
+
+// boundary and non-manifold edges are creases
+void addEdgeStencil(const SubdivisionMesh& mesh, const Topology& topology, uint32_t nEdge, Stencil& stencil)
+{
+	uint32_t a = topology.aEdgeVertices[nEdge * 2];
+	uint32_t b = topology.aEdgeVertices[nEdge * 2 + 1];
+	if (topology.isBoundary(nEdge))
+	{
+		stencil.push_back(std::make_pair(a, 0.5));
+		stencil.push_back(std::make_pair(b, 0.5));
+		return;
+	}
+	stencil.push_back(std::make_pair(a, 0.25));
+	stencil.push_back(std::make_pair(b, 0.25));
+	addFaceStencil(mesh, topology, topology.aEdgeFaces[nEdge * 2], 0.25, stencil);
+	addFaceStencil(mesh, topology, topology.aEdgeFaces[nEdge * 2 + 1], 0.25, stencil);
+}
+
+void addVertexStencil(const SubdivisionMesh& mesh, const Topology& topology, uint32_t nVertex, std::vector<uint32_t>& aEdges, Stencil& stencil)
+{
+	uint32_t nStart = topology.aVertexOffsets[nVertex];
+	uint32_t nEnd = topology.aVertexOffsets[nVertex + 1];
+	aEdges.clear();
+	for (uint32_t i = nStart; i < nEnd; i++)
+	{
+		uint32_t nCorner = topology.aVertexCorners[i];
+		aEdges.push_back(topology.aCornerEdges[nCorner]);
+		aEdges.push_back(topology.aCornerEdges[topology.previousCorner(nCorner)]);
+	}
+	std::sort(aEdges.begin(), aEdges.end());
+	aEdges.erase(std::unique(aEdges.begin(), aEdges.end()), aEdges.end());
+
+	uint32_t aBoundaryNeighbors[2] = { 0, 0 };
+	size_t nBoundaryEdges = 0;
+	for (uint32_t nEdge : aEdges)
+	{
+		if (!topology.isBoundary(nEdge)) continue;
+		if (nBoundaryEdges < 2) aBoundaryNeighbors[nBoundaryEdges] = topology.otherVertex(nEdge, nVertex);
+		nBoundaryEdges++;
+	}
+
+	size_t nFaces = nEnd - nStart;
+	size_t n = aEdges.size();
+	if (nBoundaryEdges == 2 && nFaces > 1)
+	{
+		// crease rule along the boundary
+		stencil.push_back(std::make_pair(nVertex, 0.75));
+		stencil.push_back(std::make_pair(aBoundaryNeighbors[0], 0.125));
+		stencil.push_back(std::make_pair(aBoundaryNeighbors[1], 0.125));
+	}
+	else if (nBoundaryEdges > 0 || n < 3)
+	{
+		// corners, non-manifold and isolated vertices stay in place
+		stencil.push_back(std::make_pair(nVertex, 1.0));
+	}
+	else
+	{
+		// (Q + 2R + (n - 3)S) / n with Q the average face point and R the average edge midpoint
+		double fN = (double)n;
+		stencil.push_back(std::make_pair(nVertex, (fN - 3.0) / fN + 1.0 / fN));
+		for (uint32_t i = nStart; i < nEnd; i++)
+		{
+			addFaceStencil(mesh, topology, topology.aCornerFaces[topology.aVertexCorners[i]], 1.0 / (fN * (double)nFaces), stencil);
+		}
+		for (uint32_t nEdge : aEdges)
+		{
+			stencil.push_back(std::make_pair(topology.otherVertex(nEdge, nVertex), 1.0 / (fN * fN)));
+		}
+	}
+}
+}
+
+bool Subdivider::subdivide(SubdivisionMesh& mesh, int nLevels)
+{
+	for (int nLevel = 0; nLevel < nLevels; nLevel++)
+	{
+		SubdivisionMesh result;
+		if (!subdivideLevel(mesh, result)) return false;
+		mesh = std::move(result);
+	}
+	return true;
+}
+
+bool Subdivider::subdivideLevel(const SubdivisionMesh& source, SubdivisionMesh& result)
+{
+	size_t nVertices = source.getVertexCount();
+	size_t nFaces = source.getFaceCount();
+	size_t nCorners = source.aFaceVertices.size();
+
+	// validate
+	size_t nCornerTotal = 0;
+	for (uint32_t nSize : source.aFaceSizes)
+	{
+		if (nSize < 3)
+		{
+			m_sError = "polygon with less than 3 corners";
+			return false;
+		}
+		nCornerTotal += nSize;
+	}
+	if (nCornerTotal != nCorners)
+	{
+		m_sError = "polygon sizes do not match the corner count";
+		return false;
+	}
+	for (uint32_t nVertex : source.aFaceVertices)
+	{
+		if (nVertex >= nVertices)
+		{
+			m_sError = "polygon corner references a missing control point";
+			return false;
+		}
+	}
+	if (!source.aFaceMaterials.empty() && source.aFaceMaterials.size() != nFaces)
+	{
+		m_sError = "material slots do not match the polygon count";
+		return false;
+	}
+	for (const SubdivisionMesh::UvSet& uvSet : source.aUvSets)
+	{
+		size_t nUvs = uvSet.aValues.size() / 2;
+		if (uvSet.aIndices.size() != nCorners || std::any_of(uvSet.aIndices.begin(), uvSet.aIndices.end(), [nUvs](uint32_t n) { return n >= nUvs; }))
+		{
+			m_sError = "UV indices do not match the polygons";
+			return false;
+		}
+	}
+	for (const std::vector<float>& aDeltas : source.aMorphDeltas)
+	{
+		if (aDeltas.size() != nVertices * 3)
+		{
+			m_sError = "morph deltas do not match the control points";
+			return false;
+		}
+	}
+	size_t nInfluences = source.nInfluences > 0 ? (size_t)source.nInfluences : 0;
+	if (source.aJoints.size() != nVertices * nInfluences || source.aWeights.size() != nVertices * nInfluences)
+	{
+		m_sError = "skin weights do not match the control points";
+		return false;
+	}
+
+	Topology topology;
+	buildFaces(source, topology);
+	buildEdges(source, topology);
+	buildVertexCorners(source, topology);
+	size_t nEdges = topology.aEdgeFaceCounts.size();
+
+	// face points, edge points, vertex points
+	size_t nNewVertices = nFaces + nEdges + nVertices;
+	if (nNewVertices > 0xffffffffULL || nCorners * 4 > 0xffffffffULL)
+	{
+		m_sError = "subdivided mesh exceeds 2^32 vertices";
+		return false;
+	}
+
+	result = SubdivisionMesh();
+	result.aPositions.resize(nNewVertices * 3);
+	result.aMorphDeltas.resize(source.aMorphDeltas.size());
+	for (std::vector<float>& aDeltas : result.aMorphDeltas) aDeltas.resize(nNewVertices * 3);
+	result.nInfluences = source.nInfluences;
+	result.aJoints.resize(nNewVertices * nInfluences);
+	result.aWeights.resize(nNewVertices * nInfluences);
+
+	size_t nPatches = (nNewVertices + m_nPatchSize - 1) / m_nPatchSize;
+	parallelFor(nPatches, m_nThreads, [&](size_t nPatch)
+	{
+		Stencil stencil;
+		std::vector<uint32_t> aEdges;
+		std::vector<std::pair<int, double>> aInfluences;
+		size_t nEnd = std::min(nNewVertices, (nPatch + 1) * m_nPatchSize);
+		for (size_t nNew = nPatch * m_nPatchSize; nNew < nEnd; nNew++)
+		{
+			stencil.clear();
+			if (nNew < nFaces) addFaceStencil(source, topology, (uint32_t)nNew, 1.0, stencil);
+			else if (nNew < nFaces + nEdges) addEdgeStencil(source, topology, (uint32_t)(nNew - nFaces), stencil);
+			else addVertexStencil(source, topology, (uint32_t)(nNew - nFaces - nEdges), aEdges, stencil);
+
+			double aPosition[3] = { 0.0, 0.0, 0.0 };
+			for (const auto& entry : stencil)
+			{
+				for (int c = 0; c < 3; c++) aPosition[c] += entry.second * source.aPositions[entry.first * 3 + c];
+			}
+			for (int c = 0; c < 3; c++) result.aPositions[nNew * 3 + c] = aPosition[c];
+
+			for (size_t nMorph = 0; nMorph < source.aMorphDeltas.size(); nMorph++)
+			{
+				const std::vector<float>& aSourceDeltas = source.aMorphDeltas[nMorph];
+				double aDelta[3] = { 0.0, 0.0, 0.0 };
+				for (const auto& entry : stencil)
+				{
+					for (int c = 0; c < 3; c++) aDelta[c] += entry.second * aSourceDeltas[entry.first * 3 + c];
+				}
+				for (int c = 0; c < 3; c++) result.aMorphDeltas[nMorph][nNew * 3 + c] = (float)aDelta[c];
+			}
+
+			if (nInfluences == 0) continue;
+			// weighted sum per joint, then the strongest nInfluences renormalized
+			aInfluences.clear();
+			for (const auto& entry : stencil)
+			{
+				for (size_t i = 0; i < nInfluences; i++)
+				{
+					int nJoint = source.aJoints[entry.first * nInfluences + i];
+					float fWeight = source.aWeights[entry.first * nInfluences + i];
+					if (nJoint < 0 || fWeight <= 0.0f) continue;
+					auto found = std::find_if(aInfluences.begin(), aInfluences.end(), [nJoint](const std::pair<int, double>& influence) { return influence.first == nJoint; });
+					if (found == aInfluences.end()) aInfluences.push_back(std::make_pair(nJoint, entry.second * fWeight));
+					else found->second += entry.second * fWeight;
+				}
+			}
+			std::sort(aInfluences.begin(), aInfluences.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b)
+			{
+				return a.second > b.second || (a.second == b.second && a.first < b.first);
+			});
+			if (aInfluences.size() > nInfluences) aInfluences.resize(nInfluences);
+			double fTotal = 0.0;
+			for (const auto& influence : aInfluences) fTotal += influence.second;
+			for (size_t i = 0; i < nInfluences; i++)
+			{
+				bool bSet = i < aInfluences.size() && fTotal > 0.0;
+				result.aJoints[nNew * nInfluences + i] = bSet ? aInfluences[i].first : -1;
+				result.aWeights[nNew * nInfluences + i] = bSet ? (float)(aInfluences[i].second / fTotal) : 0.0f;
+			}
+		}
+	});
+
+	// one quad per corner: vertex point, edge point to the next corner, face point, edge point from the previous corner
+	result.aFaceSizes.assign(nCorners, 4);
+	result.aFaceVertices.resize(nCorners * 4);
+	if (!source.aFaceMaterials.empty()) result.aFaceMaterials.resize(nCorners);
+	parallelFor((nFaces + m_nPatchSize - 1) / m_nPatchSize, m_nThreads, [&](size_t nPatch)
+	{
+		size_t nEnd = std::min(nFaces, (nPatch + 1) * m_nPatchSize);
+		for (size_t f = nPatch * m_nPatchSize; f < nEnd; f++)
+		{
+			for (uint32_t c = topology.aFaceOffsets[f]; c < topology.aFaceOffsets[f + 1]; c++)
+			{
+				uint32_t* pQuad = &result.aFaceVertices[c * 4];
+				pQuad[0] = (uint32_t)(nFaces + nEdges + source.aFaceVertices[c]);
+				pQuad[1] = (uint32_t)(nFaces + topology.aCornerEdges[c]);
+				pQuad[2] = (uint32_t)f;
+				pQuad[3] = (uint32_t)(nFaces + topology.aCornerEdges[topology.previousCorner(c)]);
+				if (!source.aFaceMaterials.empty()) result.aFaceMaterials[c] = source.aFaceMaterials[f];
+			}
+		}
+	});
+
+	// UVs: face centers, edge midpoints of the UV edges, the corner UVs
+	for (const SubdivisionMesh::UvSet& uvSet : source.aUvSets)
+	{
+		std::vector<std::pair<uint64_t, uint32_t>> aKeys(nCorners); // UV pair, corner
+		for (size_t c = 0; c < nCorners; c++)
+		{
+			uint64_t a = uvSet.aIndices[c];
+			uint64_t b = uvSet.aIndices[topology.nextCorner((uint32_t)c)];
+			aKeys[c] = std::make_pair(std::min(a, b) << 32 | std::max(a, b), (uint32_t)c);
+		}
+		std::sort(aKeys.begin(), aKeys.end());
+		std::vector<uint32_t> aCornerUvEdges(nCorners);
+		std::vector<uint32_t> aUvEdges; // 2 UV indices per UV edge
+		for (size_t i = 0; i < nCorners; i++)
+		{
+			if (i == 0 || aKeys[i].first != aKeys[i - 1].first)
+			{
+				aUvEdges.push_back((uint32_t)(aKeys[i].first >> 32));
+				aUvEdges.push_back((uint32_t)(aKeys[i].first & 0xffffffff));
+			}
+			aCornerUvEdges[aKeys[i].second] = (uint32_t)(aUvEdges.size() / 2 - 1);
+		}
+		aKeys.clear();
+		aKeys.shrink_to_fit();
+
+		size_t nUvEdges = aUvEdges.size() / 2;
+		size_t nUvs = uvSet.aValues.size() / 2;
+		result.aUvSets.push_back(SubdivisionMesh::UvSet());
+		SubdivisionMesh::UvSet& resultSet = result.aUvSets.back();
+		resultSet.aValues.resize((nFaces + nUvEdges + nUvs) * 2);
+		resultSet.aIndices.resize(nCorners * 4);
+		std::copy(uvSet.aValues.begin(), uvSet.aValues.end(), resultSet.aValues.begin() + (nFaces + nUvEdges) * 2);
+		for (size_t e = 0; e < nUvEdges; e++)
+		{
+			for (int c = 0; c < 2; c++)
+			{
+				resultSet.aValues[(nFaces + e) * 2 + c] = 0.5 * (uvSet.aValues[aUvEdges[e * 2] * 2 + c] + uvSet.aValues[aUvEdges[e * 2 + 1] * 2 + c]);
+			}
+		}
+		parallelFor((nFaces + m_nPatchSize - 1) / m_nPatchSize, m_nThreads, [&](size_t nPatch)
+		{
+			size_t nEnd = std::min(nFaces, (nPatch + 1) * m_nPatchSize);
+			for (size_t f = nPatch * m_nPatchSize; f < nEnd; f++)
+			{
+				uint32_t nStart = topology.aFaceOffsets[f];
+				uint32_t nStop = topology.aFaceOffsets[f + 1];
+				double aCenter[2] = { 0.0, 0.0 };
+				for (uint32_t c = nStart; c < nStop; c++)
+				{
+					uint32_t* pQuad = &resultSet.aIndices[c * 4];
+					pQuad[0] = (uint32_t)(nFaces + nUvEdges + uvSet.aIndices[c]);
+					pQuad[1] = (uint32_t)(nFaces + aCornerUvEdges[c]);
+					pQuad[2] = (uint32_t)f;
+					pQuad[3] = (uint32_t)(nFaces + aCornerUvEdges[topology.previousCorner(c)]);
+					for (int i = 0; i < 2; i++) aCenter[i] += uvSet.aValues[uvSet.aIndices[c] * 2 + i];
+				}
+				for (int i = 0; i < 2; i++) resultSet.aValues[f * 2 + i] = aCenter[i] / (double)(nStop - nStart);
+			}
+		});
+	}
+	return true;
+}
+
+std::vector<double> Subdivider::computeNormals(const SubdivisionMesh& mesh) const
+{
+	Topology topology;
+	buildFaces(mesh, topology);
+	buildVertexCorners(mesh, topology);
+	size_t nFaces = mesh.getFaceCount();
+	size_t nVertices = mesh.getVertexCount();
+
+	// Newell normals, their length is twice the polygon area
+	std::vector<double> aFaceNormals(nFaces * 3);
+	parallelFor((nFaces + m_nPatchSize - 1) / m_nPatchSize, m_nThreads, [&](size_t nPatch)
+	{
+		size_t nEnd = std::min(nFaces, (nPatch + 1) * m_nPatchSize);
+		for (size_t f = nPatch * m_nPatchSize; f < nEnd; f++)
+		{
+			double aNormal[3] = { 0.0, 0.0, 0.0 };
+			for (uint32_t c = topology.aFaceOffsets[f]; c < topology.aFaceOffsets[f + 1]; c++)
+			{
+				const double* p = &mesh.aPositions[mesh.aFaceVertices[c] * 3];
+				const double* q = &mesh.aPositions[mesh.aFaceVertices[topology.nextCorner(c)] * 3];
+				aNormal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+				aNormal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+				aNormal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+			}
+			for (int i = 0; i < 3; i++) aFaceNormals[f * 3 + i] = aNormal[i];
+		}
+	});
+
+	std::vector<double> aNormals(nVertices * 3, 0.0);
+	parallelFor((nVertices + m_nPatchSize - 1) / m_nPatchSize, m_nThreads, [&](size_t nPatch)
+	{
+		size_t nEnd = std::min(nVertices, (nPatch + 1) * m_nPatchSize);
+		for (size_t v = nPatch * m_nPatchSize; v < nEnd; v++)
+		{
+			double* pNormal = &aNormals[v * 3];
+			for (uint32_t i = topology.aVertexOffsets[v]; i < topology.aVertexOffsets[v + 1]; i++)
+			{
+				uint32_t nFace = topology.aCornerFaces[topology.aVertexCorners[i]];
+				for (int c = 0; c < 3; c++) pNormal[c] += aFaceNormals[nFace * 3 + c];
+			}
+			double fLength = std::sqrt(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]);
+			for (int c = 0; c < 3; c++) pNormal[c] = fLength > 0.0 ? pNormal[c] / fLength : 0.0;
+		}
+	});
+	return aNormals;
+}
+
+}
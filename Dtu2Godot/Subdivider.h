@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+// Polygon mesh over control points, with the attributes which are subdivided along
+struct SubdivisionMesh
+{
+	struct UvSet
+	{
+		std::vector<double> aValues; // uv pairs
+		std::vector<uint32_t> aIndices; // value per corner
+	};
+
+	std::vector<double> aPositions; // xyz per control point
+	std::vector<uint32_t> aFaceSizes; // corners per polygon
+	std::vector<uint32_t> aFaceVertices; // control point per corner
+	std::vector<int64_t> aFaceMaterials; // material slot per polygon, may be empty
+	std::vector<UvSet> aUvSets;
+	std::vector<std::vector<float>> aMorphDeltas; // xyz per control point, per morph
+	int nInfluences = 0; // joints/weights per control point
+	std::vector<int> aJoints; // nInfluences per control point, -1 = unused
+	std::vector<float> aWeights; // nInfluences per control point
+
+	size_t getVertexCount() const { return aPositions.size() / 3; }
+	size_t getFaceCount() const { return aFaceSizes.size(); }
+};
+
+/*
+ * Bakes Catmull-Clark subdivision levels into a mesh, as the subdivision
+ * levels of the DTU "Subdivisions" list which Daz Studio renders: each
+ * polygon becomes one quad per corner.  Positions, morph deltas and skin
+ * weights use the vertex rules (smooth, with boundary edges as creases and
+ * corners kept), UVs are interpolated linearly like OpenSubdiv's
+ * FVAR_LINEAR_ALL, so that seams and UDIM tiles stay in place.
+ *
+ * Each level is evaluated in parallel in patches of new vertices: the
+ * weights of a vertex over the control points are built when the vertex is
+ * evaluated and applied to all of its attributes, so no stencil table is
+ * kept and the peak memory is two consecutive levels.
+ */
+class Subdivider
+{
+public:
+	// 0 = one per hardware thread
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+	// new vertices evaluated per task
+	void setPatchSize(size_t nVertices) { m_nPatchSize = nVertices > 0 ? nVertices : 1; }
+
+	// replaces mesh with its nLevels subdivision, false with getError() for invalid meshes
+	bool subdivide(SubdivisionMesh& mesh, int nLevels);
+	bool subdivideLevel(const SubdivisionMesh& source, SubdivisionMesh& result);
+
+	// area weighted smooth normals, xyz per control point
+	std::vector<double> computeNormals(const SubdivisionMesh& mesh) const;
+
+	const std::string& getError() const { return m_sError; }
+
+protected:
+	int m_nThreads = 0;
+	size_t m_nPatchSize = 4096;
+	std::string m_sError;
+};
+
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "Log.h"
+#include "TangentGenerator.h"
+#include "ThreadPool.h"
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+struct Vector3
+{
+	double x = 0.0, y = 0.0, z = 0.0;
+
+	Vector3() {}
+	Vector3(double fX, double fY, double fZ) : x(fX), y(fY), z(fZ) {}
+	Vector3 operator+(const Vector3& v) const { return Vector3(x + v.x, y + v.y, z + v.z); }
+	Vector3 operator-(const Vector3& v) const { return Vector3(x - v.x, y - v.y, z - v.z); }
+	Vector3 operator*(double f) const { return Vector3(x * f, y * f, z * f); }
+	double dot(const Vector3& v) const { return x * v.x + y * v.y + z * v.z; }
+	double length() const { return std::sqrt(dot(*this)); }
+};
+
+Vector3 readVector(const std::vector<float>& aValues, size_t nIndex)
+{
+	return Vector3(aValues[nIndex * 3], aValues[nIndex * 3 + 1], aValues[nIndex * 3 + 2]);
+}
+
+bool normalize(Vector3& v)
+{
+	double fLength = v.length();
+	if (fLength < 1e-12 || !std::isfinite(fLength)) return false;
+	v = v * (1.0 / fLength);
+	return true;
+}
+
+// component of v in the plane perpendicular to the unit vector n
+Vector3 projectToPlane(const Vector3& v, const Vector3& n)
+{
+	return v - n * n.dot(v);
+}
+}
+
+bool TangentGenerator::generateTangents(ScenePrimitive& primitive, int nTexCoord)
+{
+	size_t nVertices = primitive.getVertexCount();
+	if (nVertices == 0 || primitive.aNormals.size() != nVertices * 3) return false;
+	if (nTexCoord < 0 || nTexCoord >= (int)primitive.aTexCoords.size() || primitive.aTexCoords[nTexCoord].size() != nVertices * 2) return false;
+	const std::vector<float>& aUvs = primitive.aTexCoords[nTexCoord];
+
+	std::vector<Vector3> aNormals(nVertices);
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		aNormals[v] = readVector(primitive.aNormals, v);
+		if (!normalize(aNormals[v])) aNormals[v] = Vector3(0.0, 1.0, 0.0);
+	}
+
+	// angle weighted sums of the triangle tangents, and of their orientation for the bitangent sign
+	std::vector<Vector3> aTangentSums(nVertices);
+	std::vector<double> aOrientationSums(nVertices, 0.0);
+	for (size_t t = 0; t + 2 < primitive.aIndices.size(); t += 3)
+	{
+		uint32_t aCorners[3] = { primitive.aIndices[t], primitive.aIndices[t + 1], primitive.aIndices[t + 2] };
+		if (aCorners[0] >= nVertices || aCorners[1] >= nVertices || aCorners[2] >= nVertices) continue;
+		Vector3 aPositions[3];
+		for (int i = 0; i < 3; i++) aPositions[i] = readVector(primitive.aPositions, aCorners[i]);
+		Vector3 edge1 = aPositions[1] - aPositions[0], edge2 = aPositions[2] - aPositions[0];
+		double fDu1 = aUvs[aCorners[1] * 2] - aUvs[aCorners[0] * 2], fDv1 = aUvs[aCorners[1] * 2 + 1] - aUvs[aCorners[0] * 2 + 1];
+		double fDu2 = aUvs[aCorners[2] * 2] - aUvs[aCorners[0] * 2], fDv2 = aUvs[aCorners[2] * 2 + 1] - aUvs[aCorners[0] * 2 + 1];
+		double fSignedArea = fDu1 * fDv2 - fDv1 * fDu2;
+		if (std::fabs(fSignedArea) < 1e-20) continue; // degenerate UVs, the neighbors define the tangent
+		// direction of increasing u: dP/du
+		Vector3 faceTangent = (edge1 * fDv2 - edge2 * fDv1) * (fSignedArea > 0.0 ? 1.0 : -1.0);
+		if (!normalize(faceTangent)) continue;
+		// MikkTSpace works with v pointing up as in Blender and Daz Studio, glTF v points down
+		double fOrientation = fSignedArea > 0.0 ? -1.0 : 1.0;
+
+		for (int i = 0; i < 3; i++)
+		{
+			uint32_t nVertex = aCorners[i];
+			const Vector3& normal = aNormals[nVertex];
+			Vector3 tangent = projectToPlane(faceTangent, normal);
+			if (!normalize(tangent)) continue;
+			Vector3 edgeA = projectToPlane(aPositions[(i + 1) % 3] - aPositions[i], normal);
+			Vector3 edgeB = projectToPlane(aPositions[(i + 2) % 3] - aPositions[i], normal);
+			if (!normalize(edgeA) || !normalize(edgeB)) continue;
+			double fAngle = std::acos(std::max(-1.0, std::min(1.0, edgeA.dot(edgeB))));
+			aTangentSums[nVertex] = aTangentSums[nVertex] + tangent * fAngle;
+			aOrientationSums[nVertex] += fOrientation * fAngle;
+		}
+	}
+
+	primitive.aTangents.resize(nVertices * 4);
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		const Vector3& normal = aNormals[v];
+		Vector3 tangent = projectToPlane(aTangentSums[v], normal);
+		if (!normalize(tangent))
+		{
+			// unused vertex or degenerate UVs: any direction in the tangent plane
+			tangent = projectToPlane(std::fabs(normal.x) < 0.9 ? Vector3(1.0, 0.0, 0.0) : Vector3(0.0, 1.0, 0.0), normal);
+			normalize(tangent);
+		}
+		primitive.aTangents[v * 4] = (float)tangent.x;
+		primitive.aTangents[v * 4 + 1] = (float)tangent.y;
+		primitive.aTangents[v * 4 + 2] = (float)tangent.z;
+		primitive.aTangents[v * 4 + 3] = aOrientationSums[v] < 0.0 ? -1.0f : 1.0f;
+	}
+	return true;
+}
+
+size_t TangentGenerator::process(Scene& scene)
+{
+	struct Job
+	{
+		ScenePrimitive* pPrimitive;
+		int nTexCoord;
+	};
+	std::vector<Job> aJobs;
+	for (SceneMesh& mesh : scene.aMeshes)
+	{
+		for (ScenePrimitive& primitive : mesh.aPrimitives)
+		{
+			if (!primitive.aTangents.empty() || primitive.aNormals.empty() || primitive.aTexCoords.empty()) continue;
+			// tangents follow the UV set of the normal map
+			int nTexCoord = 0;
+			if (primitive.nMaterial >= 0 && primitive.nMaterial < (int)scene.aMaterials.size())
+			{
+				const SceneMaterial& material = scene.aMaterials[primitive.nMaterial];
+				if (material.normalTexture.isSet()) nTexCoord = material.normalTexture.nTexCoord;
+			}
+			aJobs.push_back({ &primitive, nTexCoord });
+		}
+	}
+	// largest primitives first
+	std::stable_sort(aJobs.begin(), aJobs.end(), [](const Job& a, const Job& b)
+	{
+		return a.pPrimitive->aIndices.size() > b.pPrimitive->aIndices.size();
+	});
+
+	std::atomic<size_t> nGenerated(0);
+	parallelFor(aJobs.size(), m_nThreads, [&](size_t i)
+	{
+		if (generateTangents(*aJobs[i].pPrimitive, aJobs[i].nTexCoord)) nGenerated++;
+	});
+	log("DEBUG: TangentGenerator: generated tangents for " + std::to_string(nGenerated.load()) + " of " + std::to_string(aJobs.size()) + " primitives");
+	return nGenerated;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+#include "Scene.h"
+
+namespace Dtu2Godot
+{
+
+/*
+ * Generates glTF TANGENT attributes (xyz and the bitangent sign in w) with
+ * the MikkTSpace construction which Blender and Godot use: per triangle
+ * tangents along the UV u direction, projected into the tangent plane of
+ * each vertex normal, weighted by the corner angle and averaged over the
+ * triangles sharing the vertex.  Writing them lets Godot skip its own
+ * "ensure tangents" pass on import.
+ */
+class TangentGenerator
+{
+public:
+	// 0 = one per hardware thread
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+
+	// primitives with normals and UVs but without tangents, in parallel; returns the number generated
+	size_t process(Scene& scene);
+
+	// UVs from aTexCoords[nTexCoord], false if the primitive has no normals or UVs
+	static bool generateTangents(ScenePrimitive& primitive, int nTexCoord = 0);
+
+protected:
+	int m_nThreads = 0;
+};
+
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <filesystem>
+
+#include "Image.h"
+#include "Log.h"
+#include "TextureProcessor.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace Dtu2Godot
+{
+
+namespace
+{
+std::string toLower(std::string sValue)
+{
+	std::transform(sValue.begin(), sValue.end(), sValue.begin(), ::tolower);
+	return sValue;
+}
+
+// characters which are not valid in file names on Windows are replaced
+std::string sanitizeFilename(const std::string& sName)
+{
+	std::string sResult = sName;
+	for (char& c : sResult)
+	{
+		if (c == '/' || c == '\\' || c == ':' || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|' || c == ' ')
+		{
+			c = '_';
+		}
+	}
+	return sResult;
+}
+}
+
+std::string TextureProcessor::claimFilename(const std::string& sFilename, int nJob)
+{
+	fs::path filename(sFilename);
+	std::string sStem = filename.stem().string();
+	std::string sExtension = filename.extension().string();
+	std::string sCandidate = sFilename;
+	for (int nSuffix = 2; m_aClaimedFilenames.count(toLower(sCandidate)) > 0; nSuffix++)
+	{
+		sCandidate = sStem + "_" + std::to_string(nSuffix) + sExtension;
+	}
+	m_aClaimedFilenames[toLower(sCandidate)] = nJob;
+	return sCandidate;
+}
+
+int TextureProcessor::addTexture(const std::string& sSourcePath)
+{
+	std::string sKey = "file|" + sSourcePath;
+	auto existing = m_aJobKeys.find(sKey);
+	if (existing != m_aJobKeys.end()) return existing->second;
+
+	int nJob = (int)m_aJobs.size();
+	TextureJob job;
+	job.sSourcePath = sSourcePath;
+	std::string sExtension = toLower(fs::path(sSourcePath).extension().string());
+	std::string sFilename = fs::path(sSourcePath).filename().string();
+	if (sExtension != ".png" && sExtension != ".jpg" && sExtension != ".jpeg")
+	{
+		sFilename = fs::path(sSourcePath).stem().string() + ".png";
+	}
+	job.sOutputFilename = claimFilename(sanitizeFilename(sFilename), nJob);
+	m_aJobs.push_back(job);
+	m_aJobKeys[sKey] = nJob;
+	return nJob;
+}
+
+int TextureProcessor::addPackedTexture(const std::string& sName, const TextureChannelSource aChannels[4], const uint8_t aDefaults[4], int nOutputChannels)
+{
+	std::string sKey = "packed|" + std::to_string(nOutputChannels);
+	for (int i = 0; i < 4; i++)
+	{
+		sKey += "|" + aChannels[i].sFilePath + "#" + std::to_string(aChannels[i].nChannel) + "=" + std::to_string(aDefaults[i]);
+	}
+	auto existing = m_aJobKeys.find(sKey);
+	if (existing != m_aJobKeys.end()) return existing->second;
+
+	int nJob = (int)m_aJobs.size();
+	TextureJob job;
+	job.bPacked = true;
+	job.nOutputChannels = nOutputChannels;
+	for (int i = 0; i < 4; i++)
+	{
+		job.aChannels[i] = aChannels[i];
+		job.aDefaults[i] = aDefaults[i];
+	}
+	job.sOutputFilename = claimFilename(sanitizeFilename(sName) + ".png", nJob);
+	m_aJobs.push_back(job);
+	m_aJobKeys[sKey] = nJob;
+	return nJob;
+}
+
+bool TextureProcessor::processSingle(TextureJob& job)
+{
+	std::string sError;
+	ImageInfo info = probeImage(job.sSourcePath);
+	if (!info.bValid)
+	{
+		log("ERROR: TextureProcessor: unsupported or missing texture: " + job.sSourcePath);
+		return false;
+	}
+	std::string sExtension = toLower(fs::path(job.sOutputFilename).extension().string());
+	bool bSameFormat = (info.sFormat == "png" && sExtension == ".png") || (info.sFormat == "jpeg" && sExtension != ".png");
+	int nWidth = 0, nHeight = 0;
+	fitImageSize(info.nWidth, info.nHeight, m_nMaxTextureSize, nWidth, nHeight);
+	if (bSameFormat && nWidth == info.nWidth && nHeight == info.nHeight)
+	{
+		std::error_code error;
+		fs::remove(job.sOutputPath, error);
+		fs::copy_file(job.sSourcePath, job.sOutputPath, fs::copy_options::overwrite_existing, error);
+		if (error)
+		{
+			log("ERROR: TextureProcessor: unable to copy " + job.sSourcePath + ": " + error.message());
+			return false;
+		}
+		job.bPassedThrough = true;
+		return true;
+	}
+
+	ImageData image;
+	if (!loadImage(job.sSourcePath, image, sError))
+	{
+		log("ERROR: TextureProcessor: " + sError);
+		return false;
+	}
+	if (nWidth != image.nWidth || nHeight != image.nHeight)
+	{
+		image = resizeImage(image, nWidth, nHeight);
+	}
+	if (!saveImage(job.sOutputPath, image, sError))
+	{
+		log("ERROR: TextureProcessor: " + sError);
+		return false;
+	}
+	return true;
+}
+
+bool TextureProcessor::processPacked(TextureJob& job)
+{
+	std::string sError;
+	std::map<std::string, ImageData> aSources;
+	int nWidth = 0, nHeight = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		const std::string& sFilePath = job.aChannels[i].sFilePath;
+		if (sFilePath.empty() || aSources.count(sFilePath) > 0) continue;
+		ImageData image;
+		if (!loadImage(sFilePath, image, sError))
+		{
+			log("ERROR: TextureProcessor: " + sError);
+			return false;
+		}
+		// the largest source decides the packed size
+		if ((long long)image.nWidth * image.nHeight > (long long)nWidth * nHeight)
+		{
+			nWidth = image.nWidth;
+			nHeight = image.nHeight;
+		}
+		aSources[sFilePath] = std::move(image);
+	}
+	if (aSources.empty())
+	{
+		log("ERROR: TextureProcessor: packed texture without sources: " + job.sOutputFilename);
+		return false;
+	}
+	fitImageSize(nWidth, nHeight, m_nMaxTextureSize, nWidth, nHeight);
+
+	ImageData packed;
+	packed.nWidth = nWidth;
+	packed.nHeight = nHeight;
+	packed.nChannels = job.nOutputChannels;
+	packed.aPixels.resize((size_t)nWidth * nHeight * packed.nChannels);
+	for (int c = 0; c < packed.nChannels; c++)
+	{
+		ImageData channel;
+		if (!job.aChannels[c].sFilePath.empty())
+		{
+			const ImageData& source = aSources[job.aChannels[c].sFilePath];
+			channel = extractChannel(source, job.aChannels[c].nChannel);
+			if (channel.nWidth != nWidth || channel.nHeight != nHeight)
+			{
+				channel = resizeImage(channel, nWidth, nHeight);
+			}
+		}
+		for (size_t i = 0; i < (size_t)nWidth * nHeight; i++)
+		{
+			packed.aPixels[i * packed.nChannels + c] = channel.isValid() ? channel.aPixels[i] : job.aDefaults[c];
+		}
+	}
+	if (!saveImage(job.sOutputPath, packed, sError))
+	{
+		log("ERROR: TextureProcessor: " + sError);
+		return false;
+	}
+	return true;
+}
+
+bool TextureProcessor::process()
+{
+	std::error_code error;
+	fs::create_directories(m_sOutputFolder, error);
+	if (!fs::is_directory(m_sOutputFolder))
+	{
+		log("ERROR: TextureProcessor: unable to create output folder: " + m_sOutputFolder);
+		return false;
+	}
+	for (TextureJob& job : m_aJobs)
+	{
+		job.sOutputPath = (fs::path(m_sOutputFolder) / job.sOutputFilename).generic_string();
+	}
+
+	parallelFor(m_aJobs.size(), m_nThreads, [this](size_t nJob)
+	{
+		TextureJob& job = m_aJobs[nJob];
+		job.bSucceeded = job.bPacked ? processPacked(job) : processSingle(job);
+	});
+
+	bool bResult = true;
+	m_nPassedThrough = 0;
+	m_nConverted = 0;
+	for (const TextureJob& job : m_aJobs)
+	{
+		if (!job.bSucceeded) bResult = false;
+		else if (job.bPassedThrough) m_nPassedThrough++;
+		else m_nConverted++;
+	}
+	log("DEBUG: TextureProcessor: " + std::to_string(m_aJobs.size()) + " textures, " + std::to_string(m_nPassedThrough)
+		+ " copied, " + std::to_string(m_nConverted) + " converted, output=" + m_sOutputFolder);
+	return bResult;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Dtu2Godot
+{
+
+// Channel of a source texture, nChannel = -1 reads the luminance of color images
+struct TextureChannelSource
+{
+	std::string sFilePath; // empty = constant default value
+	int nChannel = -1;
+};
+
+struct TextureJob
+{
+	std::string sOutputFilename;
+	bool bPacked = false;
+	std::string sSourcePath; // single texture
+	TextureChannelSource aChannels[4]; // packed RGBA texture
+	uint8_t aDefaults[4] = { 255, 255, 255, 255 };
+	int nOutputChannels = 4;
+
+	// results
+	bool bSucceeded = false;
+	bool bPassedThrough = false;
+	std::string sOutputPath;
+};
+
+/*
+ * Converts the textures referenced by the mapped materials into the output
+ * folder: single textures are copied when they are PNG/JPEG files within
+ * the maximum size, otherwise decoded, downsampled and re-encoded, and
+ * channel packed textures (metallic-roughness, base color with cutout
+ * alpha) are assembled from their sources.  Jobs run in parallel and
+ * identical requests are shared.
+ */
+class TextureProcessor
+{
+public:
+	void setOutputFolder(const std::string& sFolder) { m_sOutputFolder = sFolder; }
+	const std::string& getOutputFolder() const { return m_sOutputFolder; }
+	void setMaxTextureSize(int nSize) { m_nMaxTextureSize = nSize; }
+	void setThreads(int nThreads) { m_nThreads = nThreads; }
+
+	// return the job index
+	int addTexture(const std::string& sSourcePath);
+	int addPackedTexture(const std::string& sName, const TextureChannelSource aChannels[4], const uint8_t aDefaults[4], int nOutputChannels);
+
+	bool process();
+
+	const TextureJob& getJob(int nJob) const { return m_aJobs[nJob]; }
+	size_t getJobCount() const { return m_aJobs.size(); }
+	int getNumPassedThrough() const { return m_nPassedThrough; }
+	int getNumConverted() const { return m_nConverted; }
+
+protected:
+	std::string m_sOutputFolder;
+	int m_nMaxTextureSize = 0; // 0 = keep the source size
+	int m_nThreads = 0;
+	std::vector<TextureJob> m_aJobs;
+	std::map<std::string, int> m_aJobKeys; // request key -> job index
+	std::map<std::string, int> m_aClaimedFilenames; // lower case output filename -> job index
+	int m_nPassedThrough = 0;
+	int m_nConverted = 0;
+
+	std::string claimFilename(const std::string& sFilename, int nJob);
+	bool processSingle(TextureJob& job);
+	bool processPacked(TextureJob& job);
+};
+
+}
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace Dtu2Godot
+{
+
+int getDefaultThreadCount()
+{
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void parallelFor(size_t nCount, int nThreads, const std::function<void(size_t)>& function)
+{
+	if (nThreads <= 0) nThreads = getDefaultThreadCount();
+	nThreads = (int)std::min((size_t)nThreads, nCount);
+	if (nThreads <= 1)
+	{
+		for (size_t i = 0; i < nCount; i++) function(i);
+		return;
+	}
+	std::atomic<size_t> nNext(0);
+	auto worker = [&]()
+	{
+		for (size_t i = nNext++; i < nCount; i = nNext++)
+		{
+			function(i);
+		}
+	};
+	std::vector<std::thread> aThreads;
+	for (int i = 1; i < nThreads; i++)
+	{
+		aThreads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : aThreads)
+	{
+		thread.join();
+	}
+}
+
+}
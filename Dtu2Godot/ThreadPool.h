@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace Dtu2Godot
+{
+
+// number of worker threads for nThreads = 0
+int getDefaultThreadCount();
+
+// Calls function(i) for i in [0, nCount) on up to nThreads threads, in any order
+void parallelFor(size_t nCount, int nThreads, const std::function<void(size_t)>& function);
+
+}
@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Converter.h"
+#include "Log.h"
+
+using namespace Dtu2Godot;
+
+static void printUsage()
+{
+	std::cout <<
+		"Usage: dtu2godot [options] <intermediate folder | file.dtu>\n"
+		"\n"
+		"Converts a Daz to Godot intermediate folder (DTU, FBX and textures) into a glTF asset.\n"
+		"\n"
+		"Options:\n"
+		"  -o, --output <folder>   output folder, default: <Godot Project Folder>/<Asset Name> from the DTU\n"
+		"  --format <glb|gltf>     output format, default: from the DTU asset type\n"
+		"  --texture-size <pixels> maximum texture width and height, 0 = keep (default)\n"
+		"  --threads <count>       worker threads, 0 = one per core (default)\n"
+		"  --subdivide             bake the subdivision levels of the DTU into the meshes\n"
+		"  --log <file>            append log messages to a file\n"
+		"  -q, --quiet             only print warnings and errors\n"
+		"  -h, --help              show this help\n";
+}
+
+int main(int argc, char** argv)
+{
+	Converter converter;
+	std::string sInput;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string sArg = argv[i];
+		bool bHasValue = (i + 1 < argc);
+		if (sArg == "-h" || sArg == "--help")
+		{
+			printUsage();
+			return 0;
+		}
+		else if ((sArg == "-o" || sArg == "--output") && bHasValue)
+		{
+			converter.setOutputFolder(argv[++i]);
+		}
+		else if (sArg == "--format" && bHasValue)
+		{
+			converter.setFormat(argv[++i]);
+		}
+		else if (sArg == "--texture-size" && bHasValue)
+		{
+			converter.setMaxTextureSize(std::atoi(argv[++i]));
+		}
+		else if (sArg == "--threads" && bHasValue)
+		{
+			converter.setThreads(std::atoi(argv[++i]));
+		}
+		else if (sArg == "--subdivide")
+		{
+			converter.setBakeSubdivisions(true);
+		}
+		else if (sArg == "--log" && bHasValue)
+		{
+			setLogFile(argv[++i]);
+		}
+		else if (sArg == "-q" || sArg == "--quiet")
+		{
+			setLogQuiet(true);
+		}
+		else if (!sArg.empty() && sArg[0] != '-' && sInput.empty())
+		{
+			sInput = sArg;
+		}
+		else
+		{
+			std::cerr << "dtu2godot: invalid argument: " << sArg << "\n";
+			printUsage();
+			return 2;
+		}
+	}
+	if (sInput.empty())
+	{
+		printUsage();
+		return 2;
+	}
+
+	if (!converter.convert(sInput))
+	{
+		std::cerr << "dtu2godot: conversion failed: " << converter.getError() << "\n";
+		return 1;
+	}
+	std::cout << converter.getOutputFilePath() << "\n";
+	return 0;
+}
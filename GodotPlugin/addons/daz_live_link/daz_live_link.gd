@@ -0,0 +1,257 @@
+@tool
+extends EditorPlugin
+## Receives the live link of the Daz To Godot bridge and applies the pose,
+## morph and material values to the published asset in the edited scene: the
+## node named like the asset, or the scene root.  The protocol is described in
+## Dtu2Godot/LiveLink.h of the bridge.
+##
+## Poses and morph weights are set on the skeletons and meshes of the asset.
+## Material values are set on copies of the imported materials, assigned as
+## surface overrides, so reload the scene to discard them.
+
+const PROTOCOL_VERSION := 1
+const DEFAULT_PORT := 9007
+const PORT_SETTING := "daz_live_link/port"
+const KIND_POSE := 0
+const KIND_MORPH := 1
+const KIND_MATERIAL := 2
+
+var _server := TCPServer.new()
+var _peer: StreamPeerTCP = null
+var _buffer := PackedByteArray()
+var _channels := {} # channel id -> [kind, value count, name]
+var _asset_name := ""
+var _target: Node = null
+var _skeletons: Array[Node] = []
+var _meshes: Array[Node] = []
+
+# frame being read
+var _frame := PackedByteArray()
+var _offset := 0
+var _ok := true
+
+
+func _enter_tree() -> void:
+	if not ProjectSettings.has_setting(PORT_SETTING):
+		ProjectSettings.set_setting(PORT_SETTING, DEFAULT_PORT)
+	ProjectSettings.set_initial_value(PORT_SETTING, DEFAULT_PORT)
+	var port: int = ProjectSettings.get_setting(PORT_SETTING)
+	var error := _server.listen(port, "127.0.0.1")
+	if error != OK:
+		push_error("Daz Live Link: unable to listen on port %d: %s" % [port, error_string(error)])
+
+
+func _exit_tree() -> void:
+	_close()
+	_server.stop()
+
+
+func _process(_delta: float) -> void:
+	if _server.is_connection_available():
+		# a new export replaces the previous link
+		_close()
+		_peer = _server.take_connection()
+		print("Daz Live Link: connected")
+	if _peer == null:
+		return
+	_peer.poll()
+	if _peer.get_status() != StreamPeerTCP.STATUS_CONNECTED:
+		print("Daz Live Link: disconnected")
+		_close()
+		return
+	var available := _peer.get_available_bytes()
+	if available > 0:
+		var result := _peer.get_data(available)
+		if result[0] == OK:
+			_buffer.append_array(result[1])
+	var offset := 0
+	while _buffer.size() - offset >= 4:
+		var size := _buffer.decode_u32(offset)
+		if _buffer.size() - offset - 4 < size:
+			break
+		if not _apply_frame(_buffer.slice(offset + 4, offset + 4 + size)):
+			push_error("Daz Live Link: malformed frame, closing the link")
+			_close()
+			return
+		offset += 4 + size
+	if offset > 0:
+		_buffer = _buffer.slice(offset)
+
+
+func _close() -> void:
+	if _peer != null:
+		_peer.disconnect_from_host()
+	_peer = null
+	_buffer.clear()
+	_channels.clear()
+	_target = null
+
+
+func _apply_frame(frame: PackedByteArray) -> bool:
+	_frame = frame
+	_offset = 0
+	_ok = true
+	if _read_u8() != PROTOCOL_VERSION:
+		return false
+	_read_u32() # sequence
+	var asset_name := _read_string()
+	if asset_name != "":
+		_asset_name = asset_name
+		_target = null
+
+	for i in _read_u16():
+		var id := _read_u16()
+		var kind := _read_u8()
+		var count := _read_u8()
+		_channels[id] = [kind, count, _read_string()]
+
+	var target := _find_target()
+	var poses := {} # bone name -> values, applied together below
+	for i in _read_u16():
+		var id := _read_u16()
+		if not _ok or not _channels.has(id):
+			return false
+		var channel: Array = _channels[id]
+		var values := PackedFloat32Array()
+		for j in channel[1]:
+			values.append(_read_f32())
+		if target == null:
+			continue
+		match channel[0]:
+			KIND_POSE:
+				poses[channel[2]] = values
+			KIND_MORPH:
+				_apply_morph(channel[2], values[0])
+			KIND_MATERIAL:
+				_apply_material(channel[2], values)
+	if not poses.is_empty():
+		_apply_poses(target, poses)
+	return _ok and _offset == _frame.size()
+
+
+func _find_target() -> Node:
+	if _target != null and is_instance_valid(_target) and _target.is_inside_tree():
+		return _target
+	var root := get_editor_interface().get_edited_scene_root()
+	if root == null:
+		return null
+	_target = root if root.name == _asset_name else root.find_child(_asset_name, true, false)
+	if _target == null:
+		_target = root
+	# the nodes of instanced scenes are not owned by the edited scene
+	_skeletons = _target.find_children("*", "Skeleton3D", true, false)
+	_meshes = _target.find_children("*", "MeshInstance3D", true, false)
+	if _target is Skeleton3D:
+		_skeletons.append(_target)
+	if _target is MeshInstance3D:
+		_meshes.append(_target)
+	return _target
+
+
+# The values are rotations relative to the rest pose and positions in meters,
+# both in the space of the asset root, which are converted to bone poses.
+func _apply_poses(target: Node, poses: Dictionary) -> void:
+	for skeleton in _skeletons:
+		var to_skeleton := Transform3D.IDENTITY
+		if target is Node3D and target != skeleton:
+			to_skeleton = (skeleton as Node3D).global_transform.affine_inverse() * (target as Node3D).global_transform
+		var global_poses := {}
+		for bone_name in poses:
+			var bone: int = skeleton.find_bone(bone_name)
+			if bone < 0:
+				continue
+			var values: PackedFloat32Array = poses[bone_name]
+			var rotation := Basis(Quaternion(values[0], values[1], values[2], values[3]).normalized())
+			var rest: Transform3D = skeleton.get_bone_global_rest(bone)
+			var basis := to_skeleton.basis * rotation * to_skeleton.basis.inverse() * rest.basis
+			global_poses[bone] = Transform3D(basis, to_skeleton * Vector3(values[4], values[5], values[6]))
+		# parents of the same frame first, they may come in any order
+		var bones := global_poses.keys()
+		bones.sort()
+		for bone in bones:
+			var pose: Transform3D = global_poses[bone]
+			var parent: int = skeleton.get_bone_parent(bone)
+			if parent >= 0:
+				var parent_pose: Transform3D = global_poses.get(parent, skeleton.get_bone_global_pose(parent))
+				pose = parent_pose.affine_inverse() * pose
+			skeleton.set_bone_pose_rotation(bone, pose.basis.get_rotation_quaternion())
+			skeleton.set_bone_pose_position(bone, pose.origin)
+
+
+func _apply_morph(morph_name: String, weight: float) -> void:
+	for mesh in _meshes:
+		var index: int = mesh.find_blend_shape_by_name(morph_name)
+		if index >= 0:
+			mesh.set_blend_shape_value(index, weight)
+
+
+func _apply_material(parameter: String, values: PackedFloat32Array) -> void:
+	var separator := parameter.rfind("/")
+	var material_name := parameter.left(separator)
+	var property := parameter.substr(separator + 1)
+	for mesh in _meshes:
+		for surface in mesh.get_surface_override_material_count():
+			var material := mesh.get_active_material(surface) as BaseMaterial3D
+			if material == null:
+				continue
+			# blender adds a number to materials with the same name
+			if material.resource_name != material_name and not material.resource_name.begins_with(material_name + "."):
+				continue
+			if mesh.get_surface_override_material(surface) == null:
+				material = material.duplicate()
+				mesh.set_surface_override_material(surface, material)
+			match property:
+				"Diffuse Color":
+					material.albedo_color = Color(values[0], values[1], values[2], material.albedo_color.a)
+				"Cutout Opacity":
+					material.albedo_color.a = values[0]
+					if values[0] < 1.0 and material.transparency == BaseMaterial3D.TRANSPARENCY_DISABLED:
+						material.transparency = BaseMaterial3D.TRANSPARENCY_ALPHA
+				"Metallic Weight":
+					material.metallic = values[0]
+				"Glossy Roughness":
+					material.roughness = values[0]
+				"Emission Color":
+					material.emission = Color(values[0], values[1], values[2])
+					material.emission_enabled = material.emission != Color.BLACK
+
+
+func _read_u8() -> int:
+	if _offset + 1 > _frame.size():
+		_ok = false
+		return 0
+	_offset += 1
+	return _frame.decode_u8(_offset - 1)
+
+
+func _read_u16() -> int:
+	if _offset + 2 > _frame.size():
+		_ok = false
+		return 0
+	_offset += 2
+	return _frame.decode_u16(_offset - 2)
+
+
+func _read_u32() -> int:
+	if _offset + 4 > _frame.size():
+		_ok = false
+		return 0
+	_offset += 4
+	return _frame.decode_u32(_offset - 4)
+
+
+func _read_f32() -> float:
+	if _offset + 4 > _frame.size():
+		_ok = false
+		return 0.0
+	_offset += 4
+	return _frame.decode_float(_offset - 4)
+
+
+func _read_string() -> String:
+	var length := _read_u16()
+	if _offset + length > _frame.size():
+		_ok = false
+		return ""
+	_offset += length
+	return _frame.slice(_offset - length, _offset).get_string_from_utf8()
@@ -0,0 +1,53 @@
+"""Unit tests of the glTF post-processing in BlenderScripts/gltf_tools.py,
+run by ctest with any python 3 that has numpy. Exits with 77 (skipped) if
+numpy is not installed.
+"""
+import os, sys, tempfile, unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "BlenderScripts"))
+try:
+    import numpy as np
+except ImportError:
+    print("numpy not found, skipping the gltf_tools tests")
+    sys.exit(77)
+import gltf_tools
+
+def make_prop_asset(offsets, num_vertices=2000):
+    # one mesh and node per offset, each a copy of the same irregular prop with the offset baked into its vertices
+    asset = gltf_tools.GltfAsset(os.path.join(tempfile.gettempdir(), "gltf_tools_test.gltf"), load=False)
+    asset.json = {"asset": {"version": "2.0"}, "scene": 0, "scenes": [{"nodes": []}], "nodes": [], "meshes": [],
+                  "materials": [{"name": "Wood"}], "buffers": [{"byteLength": 0}]}
+    rng = np.random.default_rng(7)
+    positions = rng.uniform(-0.5, 0.5, (num_vertices, 3))
+    normals = np.tile(np.array([[0.0, 0.0, 1.0]], dtype=np.float32), (num_vertices, 1))
+    indices = np.arange(num_vertices - num_vertices % 3, dtype=np.uint32).reshape(-1, 1)
+    for index, offset in enumerate(offsets):
+        position_accessor = asset.add_accessor((positions + offset).astype(np.float32), gltf_tools.FLOAT, "VEC3", vertex_attribute=True)
+        normal_accessor = asset.add_accessor(normals, gltf_tools.FLOAT, "VEC3", vertex_attribute=True)
+        index_accessor = asset.add_accessor(indices, gltf_tools.UNSIGNED_INT, "SCALAR")
+        asset.json["meshes"].append({"name": "Prop." + str(index), "primitives": [
+            {"attributes": {"POSITION": position_accessor, "NORMAL": normal_accessor}, "indices": index_accessor, "material": 0}]})
+        asset.json["nodes"].append({"name": "Prop." + str(index), "mesh": index})
+        asset.json["scenes"][0]["nodes"].append(index)
+    return asset
+
+class DeduplicateMeshesTest(unittest.TestCase):
+    def test_shares_translated_copies(self):
+        for offset in [1.0, 3.0, 12.7, 150.0]:
+            asset = make_prop_asset([0.0, offset])
+            report = gltf_tools.deduplicate_meshes(asset)
+            self.assertEqual(report["meshes_after"], 1, "offset " + str(offset))
+            self.assertEqual(asset.json["nodes"][1]["mesh"], 0)
+            self.assertTrue(np.allclose(asset.json["nodes"][1]["translation"], [offset] * 3, atol=1e-4))
+
+    def test_keeps_different_meshes(self):
+        asset = make_prop_asset([0.0, 2.0])
+        positions = asset.read_accessor(asset.json["meshes"][1]["primitives"][0]["attributes"]["POSITION"])
+        positions[5, 1] += 0.01
+        asset.write_accessor(asset.json["meshes"][1]["primitives"][0]["attributes"]["POSITION"], positions, gltf_tools.FLOAT)
+        report = gltf_tools.deduplicate_meshes(asset)
+        self.assertEqual(report["meshes_after"], 2)
+
+if __name__ == "__main__":
+    os.chdir(tempfile.gettempdir()) # gltf_tools.log
+    unittest.main()
@@ -0,0 +1,286 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace Dtu2Godot
+{
+
+// Minimal binary FBX writer for the reader tests
+struct FbxTestNode
+{
+	std::string sName;
+	std::vector<std::vector<uint8_t>> aProperties; // type code followed by the value
+	std::vector<FbxTestNode> aChildren;
+
+	FbxTestNode(const std::string& sNodeName = "") : sName(sNodeName) {}
+
+	FbxTestNode& add(const std::string& sChildName)
+	{
+		aChildren.emplace_back(sChildName);
+		return aChildren.back();
+	}
+
+	template <typename T> FbxTestNode& addValue(char cType, T value)
+	{
+		std::vector<uint8_t> aProperty(1 + sizeof(T));
+		aProperty[0] = (uint8_t)cType;
+		memcpy(aProperty.data() + 1, &value, sizeof(T));
+		aProperties.push_back(aProperty);
+		return *this;
+	}
+	FbxTestNode& addInt(int32_t nValue) { return addValue('I', nValue); }
+	FbxTestNode& addLong(int64_t nValue) { return addValue('L', nValue); }
+	FbxTestNode& addDouble(double fValue) { return addValue('D', fValue); }
+
+	FbxTestNode& addString(const std::string& sValue)
+	{
+		std::vector<uint8_t> aProperty(5);
+		aProperty[0] = 'S';
+		uint32_t nLength = (uint32_t)sValue.size();
+		memcpy(aProperty.data() + 1, &nLength, 4);
+		aProperty.insert(aProperty.end(), sValue.begin(), sValue.end());
+		aProperties.push_back(aProperty);
+		return *this;
+	}
+
+	template <typename T> FbxTestNode& addArray(char cType, const std::vector<T>& aValues, bool bCompressed)
+	{
+		std::vector<uint8_t> aData(aValues.size() * sizeof(T));
+		if (!aData.empty()) memcpy(aData.data(), aValues.data(), aData.size());
+		if (bCompressed)
+		{
+			uLongf nLength = compressBound((uLong)aData.size());
+			std::vector<uint8_t> aCompressed(nLength);
+			compress(aCompressed.data(), &nLength, aData.data(), (uLong)aData.size());
+			aCompressed.resize(nLength);
+			aData = aCompressed;
+		}
+		uint32_t aHeader[3] = { (uint32_t)aValues.size(), bCompressed ? 1u : 0u, (uint32_t)aData.size() };
+		std::vector<uint8_t> aProperty(13);
+		aProperty[0] = (uint8_t)cType;
+		memcpy(aProperty.data() + 1, aHeader, 12);
+		aProperty.insert(aProperty.end(), aData.begin(), aData.end());
+		aProperties.push_back(aProperty);
+		return *this;
+	}
+	FbxTestNode& addIntArray(const std::vector<int32_t>& aValues, bool bCompressed = true) { return addArray('i', aValues, bCompressed); }
+	FbxTestNode& addLongArray(const std::vector<int64_t>& aValues, bool bCompressed = true) { return addArray('l', aValues, bCompressed); }
+	FbxTestNode& addFloatArray(const std::vector<float>& aValues, bool bCompressed = true) { return addArray('f', aValues, bCompressed); }
+	FbxTestNode& addDoubleArray(const std::vector<double>& aValues, bool bCompressed = true) { return addArray('d', aValues, bCompressed); }
+
+	// Properties70 records
+	FbxTestNode& properties() { FbxTestNode* pNode = find("Properties70"); return pNode ? *pNode : add("Properties70"); }
+	FbxTestNode& setInt(const std::string& sName, int32_t nValue)
+	{
+		properties().add("P").addString(sName).addString("int").addString("Integer").addString("").addInt(nValue);
+		return *this;
+	}
+	FbxTestNode& setTime(const std::string& sName, int64_t nValue)
+	{
+		properties().add("P").addString(sName).addString("KTime").addString("Time").addString("").addLong(nValue);
+		return *this;
+	}
+	FbxTestNode& setDouble(const std::string& sName, double fValue)
+	{
+		properties().add("P").addString(sName).addString("double").addString("Number").addString("").addDouble(fValue);
+		return *this;
+	}
+	FbxTestNode& setVector(const std::string& sName, double x, double y, double z)
+	{
+		properties().add("P").addString(sName).addString(sName).addString("").addString("A").addDouble(x).addDouble(y).addDouble(z);
+		return *this;
+	}
+
+	FbxTestNode* find(const std::string& sChildName)
+	{
+		for (FbxTestNode& child : aChildren)
+		{
+			if (child.sName == sChildName) return &child;
+		}
+		return nullptr;
+	}
+
+	void write(std::vector<uint8_t>& aData, bool bWide) const
+	{
+		size_t nStart = aData.size();
+		size_t nHeaderSize = bWide ? 25 : 13;
+		aData.resize(nStart + nHeaderSize);
+		aData.insert(aData.end(), sName.begin(), sName.end());
+		size_t nPropertiesStart = aData.size();
+		for (const std::vector<uint8_t>& aProperty : aProperties) aData.insert(aData.end(), aProperty.begin(), aProperty.end());
+		uint64_t nPropertiesLength = aData.size() - nPropertiesStart;
+		for (const FbxTestNode& child : aChildren) child.write(aData, bWide);
+		if (!aChildren.empty() || aProperties.empty()) aData.resize(aData.size() + nHeaderSize);
+		uint64_t aHeader[3] = { aData.size(), aProperties.size(), nPropertiesLength };
+		for (int i = 0; i < 3; i++)
+		{
+			if (bWide) memcpy(&aData[nStart + i * 8], &aHeader[i], 8);
+			else { uint32_t nValue = (uint32_t)aHeader[i]; memcpy(&aData[nStart + i * 4], &nValue, 4); }
+		}
+		aData[nStart + nHeaderSize - 1] = (uint8_t)sName.size();
+	}
+};
+
+// top level records of a binary FBX file
+inline std::vector<uint8_t> fbxFileData(const FbxTestNode& root, uint32_t nVersion = 7400)
+{
+	std::vector<uint8_t> aData(27, 0);
+	memcpy(aData.data(), "Kaydara FBX Binary  ", 20);
+	aData[21] = 0x1a;
+	memcpy(&aData[23], &nVersion, 4);
+	for (const FbxTestNode& node : root.aChildren) node.write(aData, nVersion >= 7500);
+	aData.resize(aData.size() + (nVersion >= 7500 ? 25 : 13));
+	return aData;
+}
+
+inline void writeFbxFile(const std::string& sFilePath, const FbxTestNode& root, uint32_t nVersion = 7400)
+{
+	std::vector<uint8_t> aData = fbxFileData(root, nVersion);
+	std::ofstream file(sFilePath, std::ios::binary);
+	file.write((const char*)aData.data(), aData.size());
+}
+
+// object name in the binary "Name\x00\x01Class" form
+inline std::string fbxName(const std::string& sName, const std::string& sClass)
+{
+	return sName + std::string("\x00\x01", 2) + sClass;
+}
+
+/*
+ * Character in the layout of the Daz FBX exporter with the
+ * DzGodotAction::setExportOptions() settings: Y up, centimeters, a root
+ * with two LimbNodes (the second with a pre-rotation), a skinned mesh with
+ * two materials, one blend shape, a bind pose and one animation stack.
+ *
+ *   control points 0-3: quad at z = 0 weighted to "hip"
+ *   control point 4: weighted 3:1 to "hip" and "pelvis", moved by the blend shape
+ */
+inline FbxTestNode dazTestCharacter(int nUpAxis = 1)
+{
+	const int64_t nSecond = 46186158000LL;
+	FbxTestNode root;
+	root.aChildren.reserve(3); // references to the top level records are kept below
+	FbxTestNode& settings = root.add("GlobalSettings");
+	settings.add("Version").addInt(1000);
+	int nFrontAxis = (nUpAxis == 1) ? 2 : 1;
+	settings.setInt("UpAxis", nUpAxis).setInt("UpAxisSign", 1).setInt("FrontAxis", nFrontAxis)
+		.setInt("FrontAxisSign", nUpAxis == 1 ? 1 : -1).setInt("CoordAxis", 0).setInt("CoordAxisSign", 1).setDouble("UnitScaleFactor", 1.0);
+
+	FbxTestNode& objects = root.add("Objects");
+	FbxTestNode& connections = root.add("Connections");
+	auto connect = [&](int64_t nSource, int64_t nDestination, const std::string& sProperty)
+	{
+		FbxTestNode& connection = connections.add("C").addString(sProperty.empty() ? "OO" : "OP").addLong(nSource).addLong(nDestination);
+		if (!sProperty.empty()) connection.addString(sProperty);
+	};
+	auto model = [&](int64_t nId, const std::string& sName, const std::string& sType) -> FbxTestNode&
+	{
+		return objects.add("Model").addLong(nId).addString(fbxName(sName, "Model")).addString(sType);
+	};
+
+	// hierarchy: Genesis9 -> hip (1 m up) -> pelvis (10 cm up, pre-rotated 90 degrees about Z), and the mesh
+	model(100, "Genesis9", "Null");
+	model(101, "hip", "LimbNode").setVector("Lcl Translation", 0, 100, 0);
+	model(102, "pelvis", "LimbNode").setVector("Lcl Translation", 0, 10, 0).setInt("RotationActive", 1).setVector("PreRotation", 0, 0, 90);
+	model(103, "Genesis9.Shape", "Mesh");
+	connect(100, 0, "");
+	connect(101, 100, "");
+	connect(102, 101, "");
+	connect(103, 100, "");
+
+	FbxTestNode& skinMaterial = objects.add("Material").addLong(200).addString(fbxName("Skin", "Material")).addString("");
+	skinMaterial.setVector("DiffuseColor", 0.8, 0.6, 0.5);
+	objects.add("Material").addLong(201).addString(fbxName("Eyes", "Material")).addString("");
+	connect(200, 103, "");
+	connect(201, 103, "");
+
+	// quad (material 0) and triangle (material 1), normals by polygon vertex, indexed UVs
+	FbxTestNode& geometry = objects.add("Geometry").addLong(300).addString(fbxName("Genesis9", "Geometry")).addString("Mesh");
+	geometry.add("Vertices").addDoubleArray({ 0, 0, 0, 10, 0, 0, 10, 10, 0, 0, 10, 0, 20, 0, 0 });
+	geometry.add("PolygonVertexIndex").addIntArray({ 0, 1, 2, ~3, 1, 4, ~2 }, false);
+	FbxTestNode& normals = geometry.add("LayerElementNormal").addInt(0);
+	normals.add("MappingInformationType").addString("ByPolygonVertex");
+	normals.add("ReferenceInformationType").addString("Direct");
+	normals.add("Normals").addDoubleArray({ 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 });
+	FbxTestNode& uvs = geometry.add("LayerElementUV").addInt(0);
+	uvs.add("MappingInformationType").addString("ByPolygonVertex");
+	uvs.add("ReferenceInformationType").addString("IndexToDirect");
+	uvs.add("UV").addDoubleArray({ 0, 0, 1, 0, 1, 1, 0, 1, 0.5, 0.25 });
+	uvs.add("UVIndex").addIntArray({ 0, 1, 2, 3, 1, 4, 2 });
+	FbxTestNode& materials = geometry.add("LayerElementMaterial").addInt(0);
+	materials.add("MappingInformationType").addString("ByPolygon");
+	materials.add("ReferenceInformationType").addString("IndexToDirect");
+	materials.add("Materials").addIntArray({ 0, 1 }, false);
+	connect(300, 103, "");
+
+	// skin, cluster matrices are the bind pose world matrices
+	objects.add("Deformer").addLong(400).addString(fbxName("Genesis9", "Deformer")).addString("Skin");
+	connect(400, 300, "");
+	std::vector<double> aIdentity = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	std::vector<double> aHip = aIdentity, aPelvis = { 0, 1, 0, 0, -1, 0, 0, 0, 0, 0, 1, 0, 0, 110, 0, 1 };
+	aHip[13] = 100;
+	FbxTestNode& hipCluster = objects.add("Deformer").addLong(401).addString(fbxName("hip", "SubDeformer")).addString("Cluster");
+	hipCluster.add("Indexes").addIntArray({ 0, 1, 2, 3, 4 });
+	hipCluster.add("Weights").addDoubleArray({ 1, 1, 1, 1, 0.75 });
+	hipCluster.add("Transform").addDoubleArray(aIdentity);
+	hipCluster.add("TransformLink").addDoubleArray(aHip);
+	FbxTestNode& pelvisCluster = objects.add("Deformer").addLong(402).addString(fbxName("pelvis", "SubDeformer")).addString("Cluster");
+	pelvisCluster.add("Indexes").addIntArray({ 4 });
+	pelvisCluster.add("Weights").addDoubleArray({ 0.25 });
+	pelvisCluster.add("Transform").addDoubleArray(aIdentity);
+	pelvisCluster.add("TransformLink").addDoubleArray(aPelvis);
+	connect(401, 400, "");
+	connect(402, 400, "");
+	connect(101, 401, "");
+	connect(102, 402, "");
+
+	FbxTestNode& pose = objects.add("Pose").addLong(500).addString(fbxName("BindPose", "Pose")).addString("BindPose");
+	pose.add("Type").addString("BindPose");
+	pose.add("NbPoseNodes").addInt(3);
+	pose.add("PoseNode").add("Node").addLong(103);
+	pose.aChildren.back().add("Matrix").addDoubleArray(aIdentity, false);
+	pose.add("PoseNode").add("Node").addLong(101);
+	pose.aChildren.back().add("Matrix").addDoubleArray(aHip, false);
+	pose.add("PoseNode").add("Node").addLong(102);
+	pose.aChildren.back().add("Matrix").addDoubleArray(aPelvis, false);
+
+	// blend shape moving control point 4 up by 10 cm, 25% applied
+	objects.add("Deformer").addLong(600).addString(fbxName("Genesis9", "Deformer")).addString("BlendShape");
+	objects.add("Deformer").addLong(601).addString(fbxName("Smile", "SubDeformer")).addString("BlendShapeChannel").setDouble("DeformPercent", 25.0);
+	FbxTestNode& shape = objects.add("Geometry").addLong(602).addString(fbxName("Smile", "Geometry")).addString("Shape");
+	shape.add("Indexes").addIntArray({ 4 });
+	shape.add("Vertices").addDoubleArray({ 0, 10, 0 });
+	connect(600, 300, "");
+	connect(601, 600, "");
+	connect(602, 601, "");
+
+	// one second of pelvis rotation about X and blend shape weight, starting at frame 0
+	FbxTestNode& stack = objects.add("AnimationStack").addLong(700).addString(fbxName("Take 001", "AnimStack")).addString("");
+	stack.setTime("LocalStart", 0).setTime("LocalStop", nSecond);
+	objects.add("AnimationLayer").addLong(701).addString(fbxName("BaseLayer", "AnimLayer")).addString("");
+	objects.add("AnimationCurveNode").addLong(702).addString(fbxName("R", "AnimCurveNode")).addString("")
+		.setDouble("d|X", 0).setDouble("d|Y", 0).setDouble("d|Z", 0);
+	FbxTestNode& rotation = objects.add("AnimationCurve").addLong(703).addString(fbxName("", "AnimCurve")).addString("");
+	rotation.add("KeyTime").addLongArray({ 0, nSecond / 2, nSecond });
+	rotation.add("KeyValueFloat").addFloatArray({ 0.0f, 45.0f, 90.0f });
+	objects.add("AnimationCurveNode").addLong(704).addString(fbxName("DeformPercent", "AnimCurveNode")).addString("")
+		.setDouble("d|DeformPercent", 25);
+	FbxTestNode& weight = objects.add("AnimationCurve").addLong(705).addString(fbxName("", "AnimCurve")).addString("");
+	weight.add("KeyTime").addLongArray({ 0, nSecond });
+	weight.add("KeyValueFloat").addFloatArray({ 0.0f, 100.0f });
+	connect(701, 700, "");
+	connect(702, 701, "");
+	connect(702, 102, "Lcl Rotation");
+	connect(703, 702, "d|X");
+	connect(704, 701, "");
+	connect(704, 601, "DeformPercent");
+	connect(705, 704, "d|DeformPercent");
+	return root;
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Image.h"
+#include "Json.h"
+
+namespace Dtu2Godot
+{
+
+// Empty folder under the system temp folder, removed with the fixture
+class TempFolderTest : public ::testing::Test
+{
+protected:
+	std::filesystem::path m_oFolder;
+
+	void SetUp() override
+	{
+		const ::testing::TestInfo* pInfo = ::testing::UnitTest::GetInstance()->current_test_info();
+		m_oFolder = std::filesystem::temp_directory_path() / "dtu2godot_tests" / (std::string(pInfo->test_suite_name()) + "_" + pInfo->name());
+		std::filesystem::remove_all(m_oFolder);
+		std::filesystem::create_directories(m_oFolder);
+	}
+
+	void TearDown() override
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_oFolder, error);
+	}
+
+	std::string path(const std::string& sName) const
+	{
+		return (m_oFolder / sName).generic_string();
+	}
+
+	std::string writeTextFile(const std::string& sName, const std::string& sText) const
+	{
+		std::ofstream file(path(sName), std::ios::binary);
+		file << sText;
+		return path(sName);
+	}
+
+	// solid color image, or a horizontal gradient in the first channel if bGradient
+	std::string writeImage(const std::string& sName, int nWidth, int nHeight, int nChannels, uint8_t nValue, bool bGradient = false) const
+	{
+		ImageData image;
+		image.nWidth = nWidth;
+		image.nHeight = nHeight;
+		image.nChannels = nChannels;
+		image.aPixels.assign((size_t)nWidth * nHeight * nChannels, nValue);
+		if (bGradient)
+		{
+			for (int y = 0; y < nHeight; y++)
+			{
+				for (int x = 0; x < nWidth; x++) image.pixel(x, y)[0] = (uint8_t)(x * 255 / std::max(1, nWidth - 1));
+			}
+		}
+		std::string sError;
+		EXPECT_TRUE(saveImage(path(sName), image, sError)) << sError;
+		return path(sName);
+	}
+};
+
+// DTU material property in the layout written by DzBridgeAction
+inline JsonValue dtuProperty(const std::string& sName, const JsonValue& value, const std::string& sTexture = "", const std::string& sDataType = "Double")
+{
+	JsonValue property = JsonValue::object();
+	property["Name"] = sName;
+	property["Value"] = value;
+	property["Data Type"] = sDataType;
+	property["Texture"] = sTexture;
+	return property;
+}
+
+inline JsonValue dtuMaterial(const std::string& sName, const JsonValue& properties)
+{
+	JsonValue material = JsonValue::object();
+	material["Version"] = 4;
+	material["Asset Name"] = "Test";
+	material["Material Name"] = sName;
+	material["Material Type"] = "Iray Uber";
+	material["Properties"] = properties;
+	return material;
+}
+
+}
@@ -0,0 +1,93 @@
+#include <filesystem>
+
+#include "Converter.h"
+#include "FbxTestWriter.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+class ConverterTest : public TempFolderTest
+{
+protected:
+	// intermediate folder as written by DzGodotAction
+	std::string writeIntermediateFolder(const std::string& sAssetType)
+	{
+		std::filesystem::create_directories(path("Intermediate/Textures"));
+		std::string sColor = writeImage("Intermediate/Textures/body.jpg", 32, 32, 3, 180);
+		std::string sNormal = writeImage("Intermediate/Textures/body_nm.png", 32, 32, 3, 128);
+		JsonValue properties = JsonValue::array();
+		properties.append(dtuProperty("Diffuse Color", "#ffffff", sColor, "Color"));
+		properties.append(dtuProperty("Normal Map", 2.0, sNormal));
+		properties.append(dtuProperty("Glossy Roughness", 0.6));
+
+		JsonValue root = JsonValue::object();
+		root["DTU Version"] = 4;
+		root["Asset Name"] = "Character";
+		root["Asset Type"] = sAssetType;
+		root["Godot Project Folder"] = path("project");
+		root["Materials"].append(dtuMaterial("Body", properties));
+		writeTextFile("Intermediate/Character.dtu", root.serialize(true));
+		return path("Intermediate");
+	}
+};
+
+TEST_F(ConverterTest, ConvertToGlb)
+{
+	Converter converter;
+	converter.setThreads(2);
+	ASSERT_TRUE(converter.convert(writeIntermediateFolder("godot_glb"))) << converter.getError();
+	EXPECT_EQ(converter.getOutputFilePath(), path("project/Character/Character.glb"));
+	EXPECT_TRUE(std::filesystem::exists(converter.getOutputFilePath()));
+	ASSERT_EQ(converter.getScene().aMaterials.size(), 1u);
+	EXPECT_FLOAT_EQ(converter.getScene().aMaterials[0].fNormalScale, 1.0f);
+	EXPECT_EQ(converter.getScene().aImages.size(), 2u);
+}
+
+TEST_F(ConverterTest, ConvertToSeparateGltf)
+{
+	Converter converter;
+	converter.setOutputFolder(path("out"));
+	converter.setMaxTextureSize(16);
+	ASSERT_TRUE(converter.convert(writeIntermediateFolder("godot_gltf") + "/Character.dtu")) << converter.getError();
+	EXPECT_EQ(converter.getOutputFilePath(), path("out/Character.gltf"));
+	ImageInfo info = probeImage(path("out/Textures/body.jpg"));
+	EXPECT_TRUE(info.bValid);
+	EXPECT_EQ(info.nWidth, 16);
+	EXPECT_TRUE(std::filesystem::exists(path("out/Textures/body_nm.png")));
+}
+
+TEST_F(ConverterTest, ImportsFbx)
+{
+	std::string sFolder = writeIntermediateFolder("godot_glb");
+	writeFbxFile(sFolder + "/Character.fbx", dazTestCharacter());
+	Converter converter;
+	ASSERT_TRUE(converter.convert(sFolder)) << converter.getError();
+	const Scene& scene = converter.getScene();
+	EXPECT_EQ(scene.aNodes.size(), 4u);
+	ASSERT_EQ(scene.aMeshes.size(), 1u);
+	EXPECT_EQ(scene.aSkins.size(), 1u);
+	EXPECT_EQ(scene.aAnimations.size(), 1u);
+	// FBX materials first, then the DTU materials by name
+	ASSERT_EQ(scene.aMaterials.size(), 3u);
+	EXPECT_EQ(scene.aMaterials[2].sName, "Body");
+	EXPECT_TRUE(std::filesystem::exists(converter.getOutputFilePath()));
+}
+
+TEST_F(ConverterTest, FailsOnCorruptFbx)
+{
+	std::string sFolder = writeIntermediateFolder("godot_glb");
+	writeTextFile("Intermediate/Character.fbx", "Kaydara FBX Binary  ");
+	Converter converter;
+	EXPECT_FALSE(converter.convert(sFolder));
+	EXPECT_FALSE(converter.getError().empty());
+}
+
+TEST_F(ConverterTest, FailsWithoutDtu)
+{
+	std::filesystem::create_directories(path("Empty"));
+	Converter converter;
+	EXPECT_FALSE(converter.convert(path("Empty")));
+	EXPECT_FALSE(converter.getError().empty());
+	converter.setFormat("fbx");
+	EXPECT_FALSE(converter.convert(writeIntermediateFolder("godot_glb")));
+}
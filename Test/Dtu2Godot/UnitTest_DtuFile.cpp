@@ -0,0 +1,68 @@
+#include "DtuFile.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+class DtuFileTest : public TempFolderTest {};
+
+TEST_F(DtuFileTest, LoadSettingsAndMaterials)
+{
+	JsonValue root = JsonValue::object();
+	root["DTU Version"] = 4;
+	root["Asset Name"] = "Character";
+	root["Asset Type"] = "godot_glb";
+	root["Godot Project Folder"] = "/projects/game";
+	root["Max Bone Influences"] = 4;
+	JsonValue subdivision = JsonValue::object();
+	subdivision["Version"] = 1;
+	subdivision["Asset Name"] = "Genesis9.Shape";
+	subdivision["Value"] = 2;
+	root["Subdivisions"].append(subdivision);
+	JsonValue properties = JsonValue::array();
+	properties.append(dtuProperty("Diffuse Color", "#ffffff", "/textures/skin.jpg", "Color"));
+	properties.append(dtuProperty("Metallic Weight", 0.0));
+	root["Materials"].append(dtuMaterial("Torso", properties));
+	std::string sDtuPath = writeTextFile("Character.dtu", root.serialize(true));
+
+	DtuFile dtu;
+	ASSERT_TRUE(dtu.load(sDtuPath)) << dtu.getError();
+	EXPECT_EQ(dtu.getDtuVersion(), 4);
+	EXPECT_EQ(dtu.getAssetName(), "Character");
+	EXPECT_EQ(dtu.getGodotProjectFolder(), "/projects/game");
+	EXPECT_FALSE(dtu.isAnimationOnly());
+	EXPECT_EQ(dtu.getFbxFilePath(), path("Character.fbx"));
+	EXPECT_EQ(dtu.getInt("Max Bone Influences", 8), 4);
+	EXPECT_EQ(dtu.getInt("Morph Budget", -1), -1);
+	EXPECT_EQ(dtu.getSubdivisionLevels(), (std::map<std::string, int>({ { "Genesis9.Shape", 2 } })));
+	ASSERT_EQ(dtu.getMaterials().size(), 1u);
+	const DtuMaterial& material = dtu.getMaterials()[0];
+	EXPECT_EQ(material.sMaterialName, "Torso");
+	ASSERT_NE(material.findProperty("Diffuse Color"), nullptr);
+	EXPECT_EQ(material.findProperty("Diffuse Color")->sTexture, "/textures/skin.jpg");
+	EXPECT_EQ(material.findProperty("Missing"), nullptr);
+}
+
+TEST_F(DtuFileTest, AppliesTextureRemap)
+{
+	JsonValue root = JsonValue::object();
+	root["Asset Name"] = "Prop";
+	root["Asset Type"] = "godot_animation";
+	root["Texture Remap"]["/library/wood.tif"] = "/intermediate/Textures/wood.png";
+	JsonValue properties = JsonValue::array();
+	properties.append(dtuProperty("Diffuse Color", "#808080", "/library/wood.tif", "Color"));
+	root["Materials"].append(dtuMaterial("Wood", properties));
+
+	DtuFile dtu;
+	ASSERT_TRUE(dtu.load(writeTextFile("Prop.dtu", root.serialize())));
+	EXPECT_TRUE(dtu.isAnimationOnly());
+	EXPECT_EQ(dtu.getMaterials()[0].aProperties[0].sTexture, "/intermediate/Textures/wood.png");
+}
+
+TEST_F(DtuFileTest, RejectsInvalidFiles)
+{
+	DtuFile dtu;
+	EXPECT_FALSE(dtu.load(path("missing.dtu")));
+	EXPECT_FALSE(dtu.load(writeTextFile("broken.dtu", "{ \"Asset Name\": ")));
+	EXPECT_FALSE(dtu.getError().empty());
+	EXPECT_FALSE(dtu.load(writeTextFile("other.dtu", "{ \"Version\": 1 }")));
+}
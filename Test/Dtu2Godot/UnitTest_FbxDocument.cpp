@@ -0,0 +1,103 @@
+#include "FbxDocument.h"
+#include "FbxTestWriter.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+FbxTestNode testTree()
+{
+	FbxTestNode root;
+	FbxTestNode& header = root.add("FBXHeaderExtension");
+	header.add("FBXVersion").addInt(7400);
+	header.add("Creator").addString("Daz Studio");
+	FbxTestNode& objects = root.add("Objects");
+	FbxTestNode& geometry = objects.add("Geometry").addLong(12345678901LL).addString(fbxName("Body", "Geometry")).addString("Mesh");
+	geometry.add("Vertices").addDoubleArray({ 1.5, -2.0, 3.25 });
+	geometry.add("PolygonVertexIndex").addIntArray({ 0, 1, ~2 }, false);
+	geometry.add("Weights").addFloatArray({ 0.5f, 0.25f });
+	geometry.add("KeyTime").addLongArray({ 0, 46186158000LL }, false);
+	geometry.setDouble("DeformPercent", 25.0).setVector("Lcl Translation", 1.0, 2.0, 3.0).setInt("RotationOrder", 4);
+	return root;
+}
+}
+
+TEST(FbxDocumentTest, ParsesNodesAndProperties)
+{
+	FbxDocument document;
+	ASSERT_TRUE(document.parse(fbxFileData(testTree()))) << document.getError();
+	EXPECT_EQ(document.getVersion(), 7400u);
+	const FbxNode& root = document.getRoot();
+	ASSERT_EQ(root.aChildren.size(), 2u);
+	const FbxNode* pCreator = root.aChildren[0].find("Creator");
+	ASSERT_NE(pCreator, nullptr);
+	EXPECT_EQ(pCreator->aProperties[0].toString(), "Daz Studio");
+
+	const FbxNode* pGeometry = root.find("Objects")->find("Geometry");
+	ASSERT_NE(pGeometry, nullptr);
+	ASSERT_EQ(pGeometry->aProperties.size(), 3u);
+	EXPECT_EQ(pGeometry->aProperties[0].toInt(), 12345678901LL);
+	EXPECT_EQ(FbxDocument::objectName(pGeometry->aProperties[1].toString()), "Body");
+	EXPECT_EQ(pGeometry->aProperties[2].toString(), "Mesh");
+}
+
+TEST(FbxDocumentTest, DecodesRawAndCompressedArrays)
+{
+	FbxDocument document;
+	ASSERT_TRUE(document.parse(fbxFileData(testTree()), 2)) << document.getError();
+	const FbxNode* pGeometry = document.getRoot().find("Objects")->find("Geometry");
+	EXPECT_EQ(pGeometry->find("Vertices")->aProperties[0].aDoubleArray, std::vector<double>({ 1.5, -2.0, 3.25 }));
+	EXPECT_EQ(pGeometry->find("PolygonVertexIndex")->aProperties[0].aIntArray, std::vector<int64_t>({ 0, 1, -3 }));
+	EXPECT_EQ(pGeometry->find("Weights")->aProperties[0].aDoubleArray, std::vector<double>({ 0.5, 0.25 }));
+	EXPECT_EQ(pGeometry->find("KeyTime")->aProperties[0].aIntArray, std::vector<int64_t>({ 0, 46186158000LL }));
+	EXPECT_TRUE(pGeometry->find("Vertices")->aProperties[0].isArray());
+}
+
+TEST(FbxDocumentTest, ReadsProperties70)
+{
+	FbxDocument document;
+	ASSERT_TRUE(document.parse(fbxFileData(testTree()))) << document.getError();
+	const FbxNode* pGeometry = document.getRoot().find("Objects")->find("Geometry");
+	EXPECT_DOUBLE_EQ(pGeometry->getProperty70Double("DeformPercent", 0.0), 25.0);
+	EXPECT_EQ(pGeometry->getProperty70Int("RotationOrder", 0), 4);
+	EXPECT_EQ(pGeometry->getProperty70Int("Missing", 7), 7);
+	double aTranslation[3] = { 0, 0, 0 };
+	EXPECT_TRUE(pGeometry->getProperty70Vector("Lcl Translation", aTranslation));
+	EXPECT_DOUBLE_EQ(aTranslation[2], 3.0);
+	EXPECT_FALSE(pGeometry->getProperty70Vector("Lcl Rotation", aTranslation));
+}
+
+TEST(FbxDocumentTest, ReadsWideRecordHeaders)
+{
+	FbxDocument document;
+	ASSERT_TRUE(document.parse(fbxFileData(testTree(), 7500))) << document.getError();
+	EXPECT_EQ(document.getVersion(), 7500u);
+	const FbxNode* pGeometry = document.getRoot().find("Objects")->find("Geometry");
+	ASSERT_NE(pGeometry, nullptr);
+	EXPECT_EQ(pGeometry->find("Vertices")->aProperties[0].aDoubleArray.size(), 3u);
+}
+
+TEST(FbxDocumentTest, ObjectNames)
+{
+	EXPECT_EQ(FbxDocument::objectName(fbxName("hip", "Model")), "hip");
+	EXPECT_EQ(FbxDocument::objectName("Model::hip"), "hip");
+	EXPECT_EQ(FbxDocument::objectName("hip"), "hip");
+}
+
+TEST(FbxDocumentTest, RejectsInvalidFiles)
+{
+	FbxDocument document;
+	std::vector<uint8_t> aText = { 'K', 'a', 'y', 'd', 'a', 'r', 'a', ' ', 'F', 'B', 'X' };
+	EXPECT_FALSE(document.parse(aText));
+	EXPECT_FALSE(document.getError().empty());
+
+	std::vector<uint8_t> aData = fbxFileData(testTree());
+	aData.resize(aData.size() / 2);
+	EXPECT_FALSE(document.parse(aData));
+
+	aData = fbxFileData(testTree(), 6100);
+	EXPECT_FALSE(document.parse(aData));
+
+	EXPECT_FALSE(document.load("missing.fbx"));
+}
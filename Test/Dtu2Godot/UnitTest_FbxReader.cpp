@@ -0,0 +1,211 @@
+#include <cmath>
+
+#include "FbxReader.h"
+#include "FbxTestWriter.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+class FbxReaderTest : public TempFolderTest
+{
+protected:
+	Scene m_oScene;
+
+	void read(FbxReader& reader, const FbxTestNode& root)
+	{
+		writeFbxFile(path("Character.fbx"), root);
+		ASSERT_TRUE(reader.read(path("Character.fbx"), m_oScene)) << reader.getError();
+	}
+
+	void read(const FbxTestNode& root)
+	{
+		FbxReader reader;
+		reader.setThreads(2);
+		read(reader, root);
+	}
+
+	int findNode(const std::string& sName) const
+	{
+		for (size_t i = 0; i < m_oScene.aNodes.size(); i++)
+		{
+			if (m_oScene.aNodes[i].sName == sName) return (int)i;
+		}
+		return -1;
+	}
+};
+
+TEST_F(FbxReaderTest, ReadsHierarchyInMeters)
+{
+	read(dazTestCharacter());
+	ASSERT_EQ(m_oScene.aNodes.size(), 4u);
+	ASSERT_EQ(m_oScene.aRootNodes.size(), 1u);
+	int nHip = findNode("hip"), nPelvis = findNode("pelvis");
+	const SceneNode& root = m_oScene.aNodes[m_oScene.aRootNodes[0]];
+	EXPECT_EQ(root.sName, "Genesis9");
+	EXPECT_EQ(root.aChildren, std::vector<int>({ nHip, findNode("Genesis9.Shape") }));
+	EXPECT_EQ(m_oScene.aNodes[nHip].aChildren, std::vector<int>({ nPelvis }));
+	EXPECT_NEAR(m_oScene.aNodes[nHip].aTranslation[1], 1.0f, 1e-6f);
+	EXPECT_NEAR(m_oScene.aNodes[nPelvis].aTranslation[1], 0.1f, 1e-6f);
+}
+
+TEST_F(FbxReaderTest, AppliesPreRotation)
+{
+	read(dazTestCharacter());
+	const SceneNode& pelvis = m_oScene.aNodes[findNode("pelvis")];
+	float fHalf = std::sqrt(0.5f);
+	EXPECT_NEAR(pelvis.aRotation[0], 0.0f, 1e-6f);
+	EXPECT_NEAR(pelvis.aRotation[1], 0.0f, 1e-6f);
+	EXPECT_NEAR(pelvis.aRotation[2], fHalf, 1e-6f);
+	EXPECT_NEAR(pelvis.aRotation[3], fHalf, 1e-6f);
+}
+
+TEST_F(FbxReaderTest, ConvertsZUp)
+{
+	read(dazTestCharacter(2));
+	const SceneNode& hip = m_oScene.aNodes[findNode("hip")];
+	EXPECT_NEAR(hip.aTranslation[0], 0.0f, 1e-6f);
+	EXPECT_NEAR(hip.aTranslation[1], 0.0f, 1e-6f);
+	EXPECT_NEAR(hip.aTranslation[2], -1.0f, 1e-6f);
+}
+
+TEST_F(FbxReaderTest, SplitsMeshByMaterial)
+{
+	read(dazTestCharacter());
+	ASSERT_EQ(m_oScene.aMaterials.size(), 2u);
+	EXPECT_EQ(m_oScene.aMaterials[0].sName, "Skin");
+	EXPECT_FLOAT_EQ(m_oScene.aMaterials[0].aBaseColorFactor[1], 0.6f);
+	ASSERT_EQ(m_oScene.aMeshes.size(), 1u);
+	EXPECT_EQ(m_oScene.aNodes[findNode("Genesis9.Shape")].nMesh, 0);
+
+	const SceneMesh& mesh = m_oScene.aMeshes[0];
+	ASSERT_EQ(mesh.aPrimitives.size(), 2u);
+	const ScenePrimitive& quad = mesh.aPrimitives[0];
+	EXPECT_EQ(quad.nMaterial, 0);
+	EXPECT_EQ(quad.getVertexCount(), 4u);
+	EXPECT_EQ(quad.aIndices, std::vector<uint32_t>({ 0, 1, 2, 0, 2, 3 }));
+	EXPECT_NEAR(quad.aPositions[3], 0.1f, 1e-6f);
+	EXPECT_NEAR(quad.aNormals[2], 1.0f, 1e-6f);
+
+	const ScenePrimitive& triangle = mesh.aPrimitives[1];
+	EXPECT_EQ(triangle.nMaterial, 1);
+	EXPECT_EQ(triangle.getVertexCount(), 3u);
+	EXPECT_EQ(triangle.aIndices, std::vector<uint32_t>({ 0, 1, 2 }));
+	ASSERT_EQ(triangle.aTexCoords.size(), 1u);
+	// second vertex is control point 4, with v flipped for glTF
+	EXPECT_FLOAT_EQ(triangle.aTexCoords[0][2], 0.5f);
+	EXPECT_FLOAT_EQ(triangle.aTexCoords[0][3], 0.75f);
+}
+
+TEST_F(FbxReaderTest, ReadsSkinClusters)
+{
+	read(dazTestCharacter());
+	ASSERT_EQ(m_oScene.aSkins.size(), 1u);
+	const SceneSkin& skin = m_oScene.aSkins[0];
+	EXPECT_EQ(skin.aJoints, std::vector<int>({ findNode("hip"), findNode("pelvis") }));
+	ASSERT_EQ(skin.aInverseBindMatrices.size(), 32u);
+	EXPECT_NEAR(skin.aInverseBindMatrices[13], -1.0f, 1e-6f);
+	EXPECT_EQ(m_oScene.aNodes[findNode("Genesis9.Shape")].nSkin, 0);
+
+	const ScenePrimitive& triangle = m_oScene.aMeshes[0].aPrimitives[1];
+	ASSERT_EQ(triangle.nInfluences, 4);
+	EXPECT_EQ(triangle.aJoints[4], 0);
+	EXPECT_EQ(triangle.aJoints[5], 1);
+	EXPECT_FLOAT_EQ(triangle.aWeights[4], 0.75f);
+	EXPECT_FLOAT_EQ(triangle.aWeights[5], 0.25f);
+	EXPECT_FLOAT_EQ(triangle.aWeights[0], 1.0f);
+}
+
+TEST_F(FbxReaderTest, LimitsInfluences)
+{
+	FbxReader reader;
+	reader.setMaxInfluences(1);
+	read(reader, dazTestCharacter());
+	const ScenePrimitive& triangle = m_oScene.aMeshes[0].aPrimitives[1];
+	EXPECT_FLOAT_EQ(triangle.aWeights[4], 1.0f);
+	EXPECT_FLOAT_EQ(triangle.aWeights[5], 0.0f);
+}
+
+TEST_F(FbxReaderTest, BakesSubdivisionLevels)
+{
+	FbxReader reader;
+	reader.setThreads(2);
+	reader.setSubdivisionLevels({ { "Genesis9.Shape", 1 } });
+	read(reader, dazTestCharacter());
+	const SceneMesh& mesh = m_oScene.aMeshes[0];
+	ASSERT_EQ(mesh.aPrimitives.size(), 2u);
+	// the quad becomes 4 quads, the triangle 3, each 2 triangles
+	EXPECT_EQ(mesh.aPrimitives[0].aIndices.size(), 4u * 6u);
+	EXPECT_EQ(mesh.aPrimitives[1].aIndices.size(), 3u * 6u);
+	EXPECT_EQ(mesh.aPrimitives[0].nMaterial, 0);
+	for (const ScenePrimitive& primitive : mesh.aPrimitives)
+	{
+		size_t nVertices = primitive.getVertexCount();
+		EXPECT_EQ(primitive.aNormals.size(), nVertices * 3);
+		EXPECT_EQ(primitive.aTexCoords[0].size(), nVertices * 2);
+		ASSERT_EQ(primitive.aMorphTargets.size(), 1u);
+		EXPECT_EQ(primitive.aMorphTargets[0].aPositionDeltas.size(), nVertices * 3);
+		ASSERT_EQ(primitive.nInfluences, 4);
+		for (size_t v = 0; v < nVertices; v++)
+		{
+			float fTotal = 0.0f;
+			for (int i = 0; i < 4; i++) fTotal += primitive.aWeights[v * 4 + i];
+			EXPECT_NEAR(fTotal, 1.0f, 1e-5f);
+		}
+	}
+}
+
+TEST_F(FbxReaderTest, ReadsBlendShapes)
+{
+	read(dazTestCharacter());
+	const SceneMesh& mesh = m_oScene.aMeshes[0];
+	EXPECT_EQ(mesh.aMorphWeights, std::vector<float>({ 0.25f }));
+	for (const ScenePrimitive& primitive : mesh.aPrimitives)
+	{
+		ASSERT_EQ(primitive.aMorphTargets.size(), 1u);
+		EXPECT_EQ(primitive.aMorphTargets[0].sName, "Smile");
+		EXPECT_EQ(primitive.aMorphTargets[0].aPositionDeltas.size(), primitive.aPositions.size());
+	}
+	EXPECT_NEAR(mesh.aPrimitives[1].aMorphTargets[0].aPositionDeltas[4], 0.1f, 1e-6f);
+	EXPECT_FLOAT_EQ(mesh.aPrimitives[0].aMorphTargets[0].aPositionDeltas[4], 0.0f);
+}
+
+TEST_F(FbxReaderTest, ReadsAnimationStacks)
+{
+	read(dazTestCharacter());
+	ASSERT_EQ(m_oScene.aAnimations.size(), 1u);
+	const SceneAnimation& animation = m_oScene.aAnimations[0];
+	EXPECT_EQ(animation.sName, "Take 001");
+	ASSERT_EQ(animation.aChannels.size(), 2u);
+
+	// only the animated rotation, with the pre-rotation applied
+	const SceneAnimationChannel& rotation = animation.aChannels[0];
+	EXPECT_EQ(rotation.nNode, findNode("pelvis"));
+	EXPECT_EQ(rotation.sPath, "rotation");
+	EXPECT_EQ(rotation.aTimes, std::vector<float>({ 0.0f, 0.5f, 1.0f }));
+	ASSERT_EQ(rotation.aValues.size(), 12u);
+	for (int i = 8; i < 12; i++) EXPECT_NEAR(rotation.aValues[i], 0.5f, 1e-6f);
+
+	const SceneAnimationChannel& weights = animation.aChannels[1];
+	EXPECT_EQ(weights.nNode, findNode("Genesis9.Shape"));
+	EXPECT_EQ(weights.sPath, "weights");
+	EXPECT_EQ(weights.aValues, std::vector<float>({ 0.0f, 1.0f }));
+}
+
+TEST_F(FbxReaderTest, SkipsMeshesOfAnimations)
+{
+	FbxReader reader;
+	reader.setSkipMeshes(true);
+	read(reader, dazTestCharacter());
+	EXPECT_EQ(m_oScene.aNodes.size(), 4u);
+	EXPECT_TRUE(m_oScene.aMeshes.empty());
+	ASSERT_EQ(m_oScene.aAnimations.size(), 1u);
+	EXPECT_EQ(m_oScene.aAnimations[0].aChannels.size(), 1u);
+}
+
+TEST_F(FbxReaderTest, FailsOnInvalidFile)
+{
+	writeTextFile("Text.fbx", "; FBX 7.4.0 project file");
+	FbxReader reader;
+	EXPECT_FALSE(reader.read(path("Text.fbx"), m_oScene));
+	EXPECT_FALSE(reader.getError().empty());
+}
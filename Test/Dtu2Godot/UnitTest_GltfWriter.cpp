@@ -0,0 +1,277 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "GltfWriter.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+Scene makeTriangleScene(const std::string& sImagePath)
+{
+	Scene scene;
+	scene.sName = "Triangle";
+	SceneMaterial material;
+	material.sName = "Skin";
+	material.fSpecularFactor = 0.5f;
+	material.aUvScale[0] = 2.0f;
+	material.baseColorTexture.nImage = 0;
+	scene.aMaterials.push_back(material);
+	SceneImage image;
+	image.sName = "skin";
+	image.sFilePath = sImagePath;
+	scene.aImages.push_back(image);
+
+	ScenePrimitive primitive;
+	primitive.aPositions = { 0, 0, 0, 1, 0, 0, 0, 2, 0 };
+	primitive.aNormals = { 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+	primitive.aTexCoords.push_back({ 0, 0, 1, 0, 0, 1 });
+	primitive.nInfluences = 4;
+	primitive.aJoints = { 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 };
+	primitive.aWeights = { 0.5f, 0.5f, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0 };
+	primitive.aIndices = { 0, 1, 2 };
+	primitive.nMaterial = 0;
+	SceneMorphTarget target;
+	target.sName = "Smile";
+	target.aPositionDeltas = { 0, 0, 0, 0, 0.5f, 0, 0, 0, 0 };
+	primitive.aMorphTargets.push_back(target);
+	SceneMesh mesh;
+	mesh.sName = "TriangleMesh";
+	mesh.aPrimitives.push_back(primitive);
+	scene.aMeshes.push_back(mesh);
+
+	SceneNode root;
+	root.sName = "Armature";
+	root.aChildren = { 1, 2 };
+	SceneNode hip;
+	hip.sName = "hip";
+	hip.aTranslation[1] = 1.0f;
+	SceneNode body;
+	body.sName = "Body";
+	body.nMesh = 0;
+	body.nSkin = 0;
+	scene.aNodes = { root, hip, body };
+	scene.aRootNodes = { 0 };
+
+	SceneSkin skin;
+	skin.aJoints = { 0, 1 };
+	skin.aInverseBindMatrices.assign(32, 0.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		skin.aInverseBindMatrices[i * 5] = 1.0f;
+		skin.aInverseBindMatrices[16 + i * 5] = 1.0f;
+	}
+	scene.aSkins.push_back(skin);
+
+	SceneAnimation animation;
+	animation.sName = "Wave";
+	SceneAnimationChannel channel;
+	channel.nNode = 1;
+	channel.sPath = "translation";
+	channel.aTimes = { 0.0f, 1.0f };
+	channel.aValues = { 0, 1, 0, 0, 2, 0 };
+	animation.aChannels.push_back(channel);
+	scene.aAnimations.push_back(animation);
+	return scene;
+}
+}
+
+class GltfWriterTest : public TempFolderTest
+{
+protected:
+	// JSON and BIN chunk of a .glb file
+	bool readGlb(const std::string& sFilePath, JsonValue& json, std::vector<uint8_t>& aBinary)
+	{
+		std::ifstream file(sFilePath, std::ios::binary);
+		std::vector<char> aData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (aData.size() < 28) return false;
+		uint32_t nJsonLength = 0, nBinLength = 0;
+		memcpy(&nJsonLength, aData.data() + 12, 4);
+		std::string sError;
+		if (!JsonValue::parse(std::string(aData.data() + 20, nJsonLength), json, sError)) return false;
+		memcpy(&nBinLength, aData.data() + 20 + nJsonLength, 4);
+		const char* pBinary = aData.data() + 28 + nJsonLength;
+		aBinary.assign(pBinary, pBinary + nBinLength);
+		return aData.size() == 28 + nJsonLength + nBinLength;
+	}
+
+	template <typename T> std::vector<T> accessorData(const JsonValue& json, const std::vector<uint8_t>& aBinary, int nAccessor, int nComponents)
+	{
+		const JsonValue& accessor = json["accessors"][nAccessor];
+		const JsonValue& view = json["bufferViews"][accessor["bufferView"].toInt()];
+		std::vector<T> aValues(accessor["count"].toInt() * nComponents);
+		memcpy(aValues.data(), aBinary.data() + view["byteOffset"].toInt(), aValues.size() * sizeof(T));
+		return aValues;
+	}
+};
+
+TEST_F(GltfWriterTest, WriteGlb)
+{
+	std::string sImage = writeImage("skin.png", 4, 4, 3, 100);
+	Scene scene = makeTriangleScene(sImage);
+	GltfWriter writer;
+	ASSERT_TRUE(writer.write(scene, path("out/Triangle.glb"))) << writer.getError();
+
+	std::ifstream file(path("out/Triangle.glb"), std::ios::binary);
+	std::vector<char> aData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	ASSERT_GT(aData.size(), 20u);
+	uint32_t aHeader[5];
+	memcpy(aHeader, aData.data(), sizeof(aHeader));
+	EXPECT_EQ(aHeader[0], 0x46546C67u);
+	EXPECT_EQ(aHeader[1], 2u);
+	EXPECT_EQ(aHeader[2], aData.size());
+	EXPECT_EQ(aHeader[3] % 4, 0u);
+	EXPECT_EQ(aHeader[4], 0x4E4F534Au);
+
+	JsonValue json;
+	std::string sError;
+	ASSERT_TRUE(JsonValue::parse(std::string(aData.data() + 20, aHeader[3]), json, sError)) << sError;
+	EXPECT_EQ(json["asset"]["version"].toString(), "2.0");
+	const JsonValue& primitive = json["meshes"][0]["primitives"][0];
+	EXPECT_TRUE(primitive["attributes"].contains("POSITION"));
+	EXPECT_TRUE(primitive["attributes"].contains("JOINTS_0"));
+	EXPECT_TRUE(primitive["attributes"].contains("WEIGHTS_0"));
+	EXPECT_EQ(json["meshes"][0]["extras"]["targetNames"][0].toString(), "Smile");
+	const JsonValue& position = json["accessors"][primitive["attributes"]["POSITION"].toInt()];
+	EXPECT_DOUBLE_EQ(position["max"][1].toDouble(), 2.0);
+	EXPECT_EQ(json["accessors"][primitive["indices"].toInt()]["componentType"].toInt(), 5123);
+	EXPECT_EQ(json["skins"][0]["joints"].size(), 2u);
+	EXPECT_EQ(json["animations"][0]["channels"][0]["target"]["path"].toString(), "translation");
+	EXPECT_TRUE(json["images"][0].contains("bufferView"));
+	EXPECT_EQ(json["images"][0]["mimeType"].toString(), "image/png");
+	EXPECT_EQ(json["extensionsUsed"].size(), 2u);
+	EXPECT_DOUBLE_EQ(json["materials"][0]["extensions"]["KHR_materials_specular"]["specularFactor"].toDouble(), 0.5);
+	EXPECT_DOUBLE_EQ(json["materials"][0]["pbrMetallicRoughness"]["baseColorTexture"]["extensions"]["KHR_texture_transform"]["scale"][0].toDouble(), 2.0);
+
+	// every buffer view fits into the BIN chunk
+	uint32_t nBinLength = 0;
+	memcpy(&nBinLength, aData.data() + 20 + aHeader[3], 4);
+	for (size_t i = 0; i < json["bufferViews"].size(); i++)
+	{
+		const JsonValue& view = json["bufferViews"][i];
+		EXPECT_EQ(view["byteOffset"].toInt() % 4, 0);
+		EXPECT_LE(view["byteOffset"].toInt() + view["byteLength"].toInt(), (int)nBinLength);
+	}
+}
+
+TEST_F(GltfWriterTest, WriteSeparateGltf)
+{
+	std::filesystem::create_directories(path("out/Textures"));
+	std::string sImage = writeImage("out/Textures/skin.png", 4, 4, 3, 100);
+	Scene scene = makeTriangleScene(sImage);
+	GltfWriter writer;
+	ASSERT_TRUE(writer.write(scene, path("out/Triangle.gltf"))) << writer.getError();
+	EXPECT_TRUE(std::filesystem::exists(path("out/Triangle.bin")));
+
+	JsonValue json;
+	std::string sError;
+	ASSERT_TRUE(JsonValue::loadFile(path("out/Triangle.gltf"), json, sError)) << sError;
+	EXPECT_EQ(json["buffers"][0]["uri"].toString(), "Triangle.bin");
+	EXPECT_EQ(json["images"][0]["uri"].toString(), "Textures/skin.png");
+	EXPECT_EQ((size_t)json["buffers"][0]["byteLength"].toInt(), std::filesystem::file_size(path("out/Triangle.bin")));
+}
+
+TEST_F(GltfWriterTest, SkipsUnprocessedImages)
+{
+	Scene scene = makeTriangleScene("");
+	GltfWriter writer;
+	ASSERT_TRUE(writer.write(scene, path("Triangle.glb")));
+	EXPECT_FALSE(writer.getJson().contains("images"));
+	EXPECT_FALSE(writer.getJson()["materials"][0]["pbrMetallicRoughness"].contains("baseColorTexture"));
+}
+
+TEST_F(GltfWriterTest, SkipsAnimationChannelsWithWrongValueCounts)
+{
+	Scene scene = makeTriangleScene("");
+	SceneAnimationChannel channel;
+	channel.nNode = 2;
+	channel.sPath = "weights";
+	channel.aTimes = { 0.0f, 1.0f };
+	channel.aValues = { 0.0f, 1.0f };
+	scene.aAnimations[0].aChannels.push_back(channel);
+	// cubic splines need an in and out tangent per value
+	channel.sInterpolation = "CUBICSPLINE";
+	scene.aAnimations[0].aChannels.push_back(channel);
+	channel.aValues = { 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	scene.aAnimations[0].aChannels.push_back(channel);
+	channel.sInterpolation = "LINEAR";
+	channel.sPath = "rotation";
+	channel.aValues = { 0, 0, 0, 1, 0, 0, 0 };
+	scene.aAnimations[0].aChannels.push_back(channel);
+	GltfWriter writer;
+	ASSERT_TRUE(writer.write(scene, path("Triangle.glb"))) << writer.getError();
+	const JsonValue& animation = writer.getJson()["animations"][0];
+	ASSERT_EQ(animation["channels"].size(), 3u);
+	EXPECT_EQ(animation["channels"][1]["target"]["path"].toString(), "weights");
+	EXPECT_EQ(animation["samplers"][1]["interpolation"].toString(), "LINEAR");
+	EXPECT_EQ(animation["samplers"][2]["interpolation"].toString(), "CUBICSPLINE");
+}
+
+TEST_F(GltfWriterTest, WritesBufferContents)
+{
+	Scene scene = makeTriangleScene("");
+	// eight influences are written as two sets
+	ScenePrimitive& primitive = scene.aMeshes[0].aPrimitives[0];
+	primitive.nInfluences = 8;
+	primitive.aJoints.resize(24);
+	primitive.aWeights.resize(24);
+	for (int i = 0; i < 24; i++)
+	{
+		primitive.aJoints[i] = (uint16_t)i;
+		primitive.aWeights[i] = i / 100.0f;
+	}
+	// many morph targets, each with its own bounds
+	for (int i = 1; i < 200; i++)
+	{
+		SceneMorphTarget target;
+		target.sName = "Morph" + std::to_string(i);
+		target.aPositionDeltas = { 0, 0, 0, (float)i, 0, 0, 0, 0, -(float)i };
+		primitive.aMorphTargets.push_back(target);
+	}
+	GltfWriter writer;
+	writer.setThreads(4);
+	ASSERT_TRUE(writer.write(scene, path("Triangle.glb"))) << writer.getError();
+
+	JsonValue json;
+	std::vector<uint8_t> aBinary;
+	ASSERT_TRUE(readGlb(path("Triangle.glb"), json, aBinary));
+	const JsonValue& jsonPrimitive = json["meshes"][0]["primitives"][0];
+	EXPECT_EQ(accessorData<float>(json, aBinary, jsonPrimitive["attributes"]["POSITION"].toInt(), 3), primitive.aPositions);
+	EXPECT_EQ(accessorData<uint16_t>(json, aBinary, jsonPrimitive["indices"].toInt(), 1), std::vector<uint16_t>({ 0, 1, 2 }));
+	std::vector<uint16_t> aJoints = accessorData<uint16_t>(json, aBinary, jsonPrimitive["attributes"]["JOINTS_1"].toInt(), 4);
+	EXPECT_EQ(aJoints, std::vector<uint16_t>({ 4, 5, 6, 7, 12, 13, 14, 15, 20, 21, 22, 23 }));
+	std::vector<float> aWeights = accessorData<float>(json, aBinary, jsonPrimitive["attributes"]["WEIGHTS_0"].toInt(), 4);
+	EXPECT_FLOAT_EQ(aWeights[4], 0.08f);
+
+	ASSERT_EQ(jsonPrimitive["targets"].size(), 200u);
+	for (int i = 1; i < 200; i++)
+	{
+		const JsonValue& accessor = json["accessors"][jsonPrimitive["targets"][i]["POSITION"].toInt()];
+		EXPECT_DOUBLE_EQ(accessor["max"][0].toDouble(), (double)i);
+		EXPECT_DOUBLE_EQ(accessor["min"][2].toDouble(), -(double)i);
+		EXPECT_EQ(accessorData<float>(json, aBinary, jsonPrimitive["targets"][i]["POSITION"].toInt(), 3), primitive.aMorphTargets[i].aPositionDeltas);
+	}
+}
+
+TEST_F(GltfWriterTest, WritesLargeIndices)
+{
+	Scene scene = makeTriangleScene("");
+	ScenePrimitive& primitive = scene.aMeshes[0].aPrimitives[0];
+	primitive.aPositions.resize(70000 * 3, 0.0f);
+	primitive.aNormals.clear();
+	primitive.aTexCoords.clear();
+	primitive.nInfluences = 0;
+	primitive.aMorphTargets.clear();
+	primitive.aIndices = { 0, 69999, 1 };
+	GltfWriter writer;
+	ASSERT_TRUE(writer.write(scene, path("Large.glb"))) << writer.getError();
+
+	JsonValue json;
+	std::vector<uint8_t> aBinary;
+	ASSERT_TRUE(readGlb(path("Large.glb"), json, aBinary));
+	int nIndices = json["meshes"][0]["primitives"][0]["indices"].toInt();
+	EXPECT_EQ(json["accessors"][nIndices]["componentType"].toInt(), 5125);
+	EXPECT_EQ(accessorData<uint32_t>(json, aBinary, nIndices, 1), primitive.aIndices);
+}
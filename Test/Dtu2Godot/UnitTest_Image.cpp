@@ -0,0 +1,84 @@
+#include "Image.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+class ImageTest : public TempFolderTest {};
+
+TEST_F(ImageTest, PngRoundTrip)
+{
+	std::string sPath = writeImage("gradient.png", 64, 32, 4, 200, true);
+	ImageInfo info = probeImage(sPath);
+	EXPECT_TRUE(info.bValid);
+	EXPECT_EQ(info.sFormat, "png");
+	EXPECT_EQ(info.nWidth, 64);
+	EXPECT_EQ(info.nHeight, 32);
+	EXPECT_TRUE(info.bHasAlpha);
+
+	ImageData image;
+	std::string sError;
+	ASSERT_TRUE(loadImage(sPath, image, sError)) << sError;
+	EXPECT_EQ(image.nChannels, 4);
+	EXPECT_EQ(image.pixel(0, 0)[0], 0);
+	EXPECT_EQ(image.pixel(63, 5)[0], 255);
+	EXPECT_EQ(image.pixel(10, 10)[3], 200);
+}
+
+TEST_F(ImageTest, JpegRoundTrip)
+{
+	std::string sPath = writeImage("solid.jpg", 40, 20, 3, 128);
+	ImageInfo info = probeImage(sPath);
+	EXPECT_TRUE(info.bValid);
+	EXPECT_EQ(info.sFormat, "jpeg");
+	EXPECT_EQ(info.nWidth, 40);
+	EXPECT_EQ(info.nHeight, 20);
+
+	ImageData image;
+	std::string sError;
+	ASSERT_TRUE(loadImage(sPath, image, sError)) << sError;
+	EXPECT_EQ(image.nChannels, 3);
+	EXPECT_NEAR(image.pixel(20, 10)[1], 128, 2);
+}
+
+TEST_F(ImageTest, ProbeRejectsOtherFiles)
+{
+	EXPECT_FALSE(probeImage(writeTextFile("texture.tif", "II*\0")).bValid);
+	EXPECT_FALSE(probeImage(path("missing.png")).bValid);
+}
+
+TEST(Image, FitImageSize)
+{
+	int nWidth = 0, nHeight = 0;
+	fitImageSize(4096, 2048, 1024, nWidth, nHeight);
+	EXPECT_EQ(nWidth, 1024);
+	EXPECT_EQ(nHeight, 512);
+	fitImageSize(512, 512, 1024, nWidth, nHeight);
+	EXPECT_EQ(nWidth, 512);
+	fitImageSize(4096, 4096, 0, nWidth, nHeight);
+	EXPECT_EQ(nWidth, 4096);
+}
+
+TEST(Image, ResizeAveragesPixels)
+{
+	ImageData image;
+	image.nWidth = 4;
+	image.nHeight = 1;
+	image.nChannels = 1;
+	image.aPixels = { 0, 100, 200, 200 };
+	ImageData resized = resizeImage(image, 2, 1);
+	ASSERT_EQ(resized.aPixels.size(), 2u);
+	EXPECT_EQ(resized.aPixels[0], 50);
+	EXPECT_EQ(resized.aPixels[1], 200);
+}
+
+TEST(Image, ExtractChannel)
+{
+	ImageData image;
+	image.nWidth = 1;
+	image.nHeight = 1;
+	image.nChannels = 3;
+	image.aPixels = { 10, 20, 30 };
+	EXPECT_EQ(extractChannel(image, 1).aPixels[0], 20);
+	EXPECT_EQ(extractChannel(image, 3).aPixels[0], 30);
+	EXPECT_NEAR(extractChannel(image, -1).aPixels[0], 18, 1);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "Json.h"
+
+using namespace Dtu2Godot;
+
+TEST(Json, ParseDtuLikeDocument)
+{
+	JsonValue root;
+	std::string sError;
+	ASSERT_TRUE(JsonValue::parse("{ \"DTU Version\": 4, \"Asset Name\": \"Genesis 9\", \"Pack ORM Textures\": true,"
+		" \"Materials\": [ { \"Value\": 0.25 }, { \"Value\": \"#ff8000\" } ], \"Empty\": null }", root, sError)) << sError;
+	EXPECT_EQ(root["DTU Version"].toInt(), 4);
+	EXPECT_EQ(root["Asset Name"].toString(), "Genesis 9");
+	EXPECT_TRUE(root["Pack ORM Textures"].toBool());
+	EXPECT_EQ(root["Materials"].size(), 2u);
+	EXPECT_DOUBLE_EQ(root["Materials"][0]["Value"].toDouble(), 0.25);
+	EXPECT_EQ(root["Materials"][1]["Value"].toString(), "#ff8000");
+	EXPECT_TRUE(root["Empty"].isNull());
+	// missing keys read as null and return the default
+	EXPECT_EQ(root["Missing"]["Key"].toInt(7), 7);
+}
+
+TEST(Json, ParseStringEscapes)
+{
+	JsonValue root;
+	std::string sError;
+	ASSERT_TRUE(JsonValue::parse("\"C:\\\\Textures\\/a\\tb \\u00e9 \\ud83d\\ude00\"", root, sError)) << sError;
+	EXPECT_EQ(root.toString(), "C:\\Textures/a\tb \xc3\xa9 \xf0\x9f\x98\x80");
+}
+
+TEST(Json, ParseErrorReportsLine)
+{
+	JsonValue root;
+	std::string sError;
+	EXPECT_FALSE(JsonValue::parse("{\n\"a\": 1,\n\"b\": }", root, sError));
+	EXPECT_NE(sError.find("line 3"), std::string::npos) << sError;
+}
+
+TEST(Json, SerializeRoundTrip)
+{
+	JsonValue root = JsonValue::object();
+	root["name"] = "quote\" and \\ backslash";
+	root["integer"] = 65536;
+	root["fraction"] = 0.1;
+	root["list"].append(true);
+	root["list"].append(JsonValue());
+	std::string sText = root.serialize();
+	EXPECT_EQ(sText, "{\"name\":\"quote\\\" and \\\\ backslash\",\"integer\":65536,\"fraction\":0.1,\"list\":[true,null]}");
+
+	JsonValue parsed;
+	std::string sError;
+	ASSERT_TRUE(JsonValue::parse(root.serialize(true), parsed, sError)) << sError;
+	EXPECT_EQ(parsed.serialize(), sText);
+}
+
+TEST(Json, NumbersRoundTrip)
+{
+	EXPECT_EQ(jsonNumber(1.0), "1");
+	EXPECT_EQ(jsonNumber(-3.0), "-3");
+	EXPECT_EQ(jsonNumber(0.5), "0.5");
+	double fValue = 0.123456789012345;
+	EXPECT_EQ(std::stod(jsonNumber(fValue)), fValue);
+	EXPECT_EQ(std::stod(jsonNumber((double)0.1f)), (double)0.1f);
+}
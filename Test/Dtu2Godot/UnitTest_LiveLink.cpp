@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "LiveLink.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+std::vector<LiveLinkDecoder::Frame> decodeFrames(LiveLinkDecoder& decoder, const std::vector<uint8_t>& aData)
+{
+	std::vector<LiveLinkDecoder::Frame> aFrames;
+	EXPECT_TRUE(decoder.decode(aData.data(), aData.size(), aFrames)) << decoder.getError();
+	return aFrames;
+}
+}
+
+TEST(LiveLinkTest, RoundTrip)
+{
+	LiveLinkEncoder encoder;
+	encoder.setAssetName("Genesis 9");
+	EXPECT_TRUE(encoder.setValue(LiveLink::Pose, "l_forearm", { 0.0f, 0.5f, 0.0f, 0.866f, 0.1f, 1.2f, -0.05f }));
+	EXPECT_TRUE(encoder.setValue(LiveLink::Morph, "eCTRLSmile", { 0.75f }));
+	EXPECT_TRUE(encoder.setValue(LiveLink::Material, "Face/Diffuse Color", { 1.0f, 0.5f, 0.25f }));
+	std::vector<uint8_t> aFrame = encoder.takeFrame(0.0);
+	ASSERT_FALSE(aFrame.empty());
+	EXPECT_FALSE(encoder.hasPendingChanges());
+
+	LiveLinkDecoder decoder;
+	std::vector<LiveLinkDecoder::Frame> aFrames = decodeFrames(decoder, aFrame);
+	ASSERT_EQ(aFrames.size(), 1u);
+	EXPECT_EQ(decoder.getAssetName(), "Genesis 9");
+	EXPECT_EQ(aFrames[0].nSequence, 0u);
+	ASSERT_EQ(aFrames[0].aValues.size(), 3u);
+	EXPECT_EQ(aFrames[0].aValues[0].eKind, LiveLink::Pose);
+	EXPECT_EQ(aFrames[0].aValues[0].sName, "l_forearm");
+	ASSERT_EQ(aFrames[0].aValues[0].aValues.size(), 7u);
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[0].aValues[5], 1.2f);
+	EXPECT_EQ(aFrames[0].aValues[1].eKind, LiveLink::Morph);
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[1].aValues[0], 0.75f);
+	EXPECT_EQ(aFrames[0].aValues[2].sName, "Face/Diffuse Color");
+
+	// later frames carry only the channel ids of the changed values
+	encoder.setValue(LiveLink::Morph, "eCTRLSmile", { 0.5f });
+	std::vector<uint8_t> aDelta = encoder.takeFrame(1.0);
+	EXPECT_EQ(aDelta.size(), 4u + 1u + 4u + 2u + 2u + 2u + 2u + 4u);
+	aFrames = decodeFrames(decoder, aDelta);
+	ASSERT_EQ(aFrames.size(), 1u);
+	EXPECT_EQ(aFrames[0].nSequence, 1u);
+	ASSERT_EQ(aFrames[0].aValues.size(), 1u);
+	EXPECT_EQ(aFrames[0].aValues[0].sName, "eCTRLSmile");
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[0].aValues[0], 0.5f);
+}
+
+TEST(LiveLinkTest, CoalescesChanges)
+{
+	LiveLinkEncoder encoder;
+	encoder.setTolerance(0.001f);
+	// never sent channels are compared against zero
+	encoder.setValue(LiveLink::Morph, "Unused", { 0.0f });
+	EXPECT_FALSE(encoder.hasPendingChanges());
+	for (int i = 1; i <= 10; i++) encoder.setValue(LiveLink::Morph, "Blink", { i * 0.1f });
+	EXPECT_EQ(encoder.getNumPendingChanges(), 1u);
+
+	LiveLinkDecoder decoder;
+	std::vector<LiveLinkDecoder::Frame> aFrames = decodeFrames(decoder, encoder.takeFrame(0.0));
+	ASSERT_EQ(aFrames.size(), 1u);
+	ASSERT_EQ(aFrames[0].aValues.size(), 1u);
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[0].aValues[0], 1.0f);
+
+	// within the tolerance of the sent value
+	encoder.setValue(LiveLink::Morph, "Blink", { 1.0005f });
+	EXPECT_FALSE(encoder.hasPendingChanges());
+	// changed and changed back before the next frame
+	encoder.setValue(LiveLink::Morph, "Blink", { 0.5f });
+	encoder.setValue(LiveLink::Morph, "Blink", { 1.0f });
+	EXPECT_FALSE(encoder.hasPendingChanges());
+	EXPECT_TRUE(encoder.takeFrame(1.0).empty());
+}
+
+TEST(LiveLinkTest, RateLimitsFrames)
+{
+	LiveLinkEncoder encoder;
+	encoder.setMaxFrameRate(10.0);
+	encoder.setValue(LiveLink::Morph, "Blink", { 1.0f });
+	EXPECT_FALSE(encoder.takeFrame(5.0).empty());
+	encoder.setValue(LiveLink::Morph, "Blink", { 0.5f });
+	EXPECT_TRUE(encoder.takeFrame(5.05).empty());
+	EXPECT_TRUE(encoder.hasPendingChanges());
+	encoder.setValue(LiveLink::Morph, "Blink", { 0.25f });
+	std::vector<uint8_t> aFrame = encoder.takeFrame(5.1);
+	EXPECT_FALSE(aFrame.empty());
+}
+
+TEST(LiveLinkTest, ResetResendsState)
+{
+	LiveLinkEncoder encoder;
+	encoder.setAssetName("Chair");
+	encoder.setValue(LiveLink::Morph, "Fold", { 0.5f });
+	encoder.setValue(LiveLink::Morph, "Tilt", { 0.25f });
+	encoder.takeFrame(0.0);
+	encoder.setValue(LiveLink::Morph, "Tilt", { 0.75f });
+	encoder.reset();
+
+	// a new connection starts with a new decoder and gets the definitions again
+	LiveLinkDecoder decoder;
+	std::vector<LiveLinkDecoder::Frame> aFrames = decodeFrames(decoder, encoder.takeFrame(0.0));
+	ASSERT_EQ(aFrames.size(), 1u);
+	EXPECT_EQ(decoder.getAssetName(), "Chair");
+	EXPECT_EQ(aFrames[0].nSequence, 0u);
+	ASSERT_EQ(aFrames[0].aValues.size(), 2u);
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[0].aValues[0], 0.75f);
+	EXPECT_FLOAT_EQ(aFrames[0].aValues[1].aValues[0], 0.5f);
+}
+
+TEST(LiveLinkTest, DecodesSplitStream)
+{
+	LiveLinkEncoder encoder;
+	encoder.setMaxFrameRate(0.0);
+	std::vector<uint8_t> aStream;
+	for (int i = 1; i <= 3; i++)
+	{
+		encoder.setValue(LiveLink::Pose, "hip", { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, i * 0.1f, 0.0f });
+		std::vector<uint8_t> aFrame = encoder.takeFrame(0.0);
+		aStream.insert(aStream.end(), aFrame.begin(), aFrame.end());
+	}
+
+	LiveLinkDecoder decoder;
+	std::vector<LiveLinkDecoder::Frame> aFrames;
+	for (size_t i = 0; i < aStream.size(); i += 5)
+	{
+		size_t nSize = std::min<size_t>(5, aStream.size() - i);
+		ASSERT_TRUE(decoder.decode(aStream.data() + i, nSize, aFrames)) << decoder.getError();
+	}
+	ASSERT_EQ(aFrames.size(), 3u);
+	EXPECT_EQ(aFrames[2].nSequence, 2u);
+	EXPECT_FLOAT_EQ(aFrames[2].aValues[0].aValues[5], 0.3f);
+}
+
+TEST(LiveLinkTest, RejectsMalformedFrames)
+{
+	LiveLinkDecoder decoder;
+	std::vector<LiveLinkDecoder::Frame> aFrames;
+	// a value for a channel which was never defined
+	std::vector<uint8_t> aFrame = { 11, 0, 0, 0, LiveLink::PROTOCOL_VERSION, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0 };
+	aFrame[0] = (uint8_t)(aFrame.size() - 4 + 2);
+	aFrame.push_back(3);
+	aFrame.push_back(0);
+	EXPECT_FALSE(decoder.decode(aFrame.data(), aFrame.size(), aFrames));
+	EXPECT_NE(decoder.getError().find("undefined"), std::string::npos) << decoder.getError();
+
+	decoder.reset();
+	std::vector<uint8_t> aVersion = { 1, 0, 0, 0, 99 };
+	EXPECT_FALSE(decoder.decode(aVersion.data(), aVersion.size(), aFrames));
+	EXPECT_TRUE(aFrames.empty());
+}
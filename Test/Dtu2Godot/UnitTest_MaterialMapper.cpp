@@ -0,0 +1,208 @@
+#include "MaterialMapper.h"
+#include "TestUtils.h"
+
+using namespace Dtu2Godot;
+
+class MaterialMapperTest : public TempFolderTest
+{
+protected:
+	DtuFile loadDtu(const JsonValue& materials)
+	{
+		JsonValue root = JsonValue::object();
+		root["DTU Version"] = 4;
+		root["Asset Name"] = "Test";
+		root["Materials"] = materials;
+		DtuFile dtu;
+		EXPECT_TRUE(dtu.load(writeTextFile("Test.dtu", root.serialize())));
+		return dtu;
+	}
+};
+
+TEST(MaterialMapper, DazColorToLinear)
+{
+	float aLinear[3];
+	MaterialMapper::dazColorToLinear("#ff8000", aLinear);
+	EXPECT_FLOAT_EQ(aLinear[0], 1.0f);
+	EXPECT_NEAR(aLinear[1], 0.2158605f, 1e-5f);
+	EXPECT_FLOAT_EQ(aLinear[2], 0.0f);
+}
+
+TEST(MaterialMapper, MaterialNameFixes)
+{
+	EXPECT_TRUE(MaterialMapper::isEyeMaterial("Eye Left"));
+	EXPECT_FALSE(MaterialMapper::isEyeMaterial("EyeMoisture"));
+	EXPECT_FALSE(MaterialMapper::isEyeMaterial("Eye Moisture Left"));
+	EXPECT_FALSE(MaterialMapper::isEyeMaterial("Eyelashes"));
+	EXPECT_TRUE(MaterialMapper::isScalpMaterial("Hair Cap"));
+	EXPECT_TRUE(MaterialMapper::isScalpMaterial("Scalp"));
+	EXPECT_FALSE(MaterialMapper::isScalpMaterial("Hair"));
+}
+
+TEST_F(MaterialMapperTest, SwapLowResFilename)
+{
+	std::string sTexture = writeImage("skin.png", 8, 8, 3, 255);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "2k"), sTexture);
+	std::string s2k = writeImage("skin_2k.jpg", 4, 4, 3, 255);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "1k"), s2k);
+	std::string s1k = writeImage("skin_1k.png", 2, 2, 3, 255);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "1k"), s1k);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "2k"), s2k);
+}
+
+TEST_F(MaterialMapperTest, SwapLowResFilenameFromVariantFolders)
+{
+	// a source texture which happens to end in "_2k" is not a variant of another one
+	std::string sTexture = writeImage("skin.png", 8, 8, 3, 255);
+	writeImage("skin_2k.png", 8, 8, 3, 255);
+	std::filesystem::create_directories(path("2k"));
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "2k"), sTexture);
+	std::string s2k = writeImage("2k/skin.png", 4, 4, 3, 255);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "1k"), s2k);
+	std::filesystem::create_directories(path("1k"));
+	std::string s1k = writeImage("1k/skin.png", 2, 2, 3, 255);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "1k"), s1k);
+	EXPECT_EQ(MaterialMapper::swapLowResFilename(sTexture, "2k"), s2k);
+}
+
+TEST_F(MaterialMapperTest, ScalarProperties)
+{
+	JsonValue properties = JsonValue::array();
+	properties.append(dtuProperty("Diffuse Color", "#ffffff", "", "Color"));
+	properties.append(dtuProperty("Metallic Weight", 0.25));
+	properties.append(dtuProperty("Specular Lobe 1 Roughness", 0.4));
+	properties.append(dtuProperty("Dual Lobe Specular Weight", 0.2));
+	properties.append(dtuProperty("Horizontal Tiles", 4.0));
+	JsonValue materials = JsonValue::array();
+	materials.append(dtuMaterial("Body", properties));
+	DtuFile dtu = loadDtu(materials);
+
+	Scene scene;
+	TextureProcessor textures;
+	MaterialMapper mapper;
+	mapper.mapMaterials(dtu, scene, textures);
+	ASSERT_EQ(scene.aMaterials.size(), 1u);
+	const SceneMaterial& material = scene.aMaterials[0];
+	EXPECT_EQ(material.sName, "Body");
+	EXPECT_FLOAT_EQ(material.aBaseColorFactor[0], 1.0f);
+	EXPECT_FLOAT_EQ(material.fMetallicFactor, 0.25f);
+	EXPECT_FLOAT_EQ(material.fRoughnessFactor, 0.4f);
+	EXPECT_FLOAT_EQ(material.fSpecularFactor, 0.4f);
+	EXPECT_FLOAT_EQ(material.aUvScale[0], 4.0f);
+	EXPECT_FLOAT_EQ(material.aUvScale[1], 1.0f);
+	EXPECT_EQ(material.sAlphaMode, "OPAQUE");
+	EXPECT_FALSE(material.baseColorTexture.isSet());
+	EXPECT_EQ(textures.getJobCount(), 0u);
+}
+
+TEST_F(MaterialMapperTest, TextureMapsAndPacking)
+{
+	std::string sColor = writeImage("color.jpg", 16, 16, 3, 200);
+	std::string sRoughness = writeImage("rough.png", 16, 16, 1, 100);
+	std::string sMetallic = writeImage("metal.png", 8, 8, 1, 50);
+	std::string sCutout = writeImage("cutout.png", 16, 16, 1, 255);
+	std::string sNormal = writeImage("normal.png", 16, 16, 3, 128);
+
+	JsonValue properties = JsonValue::array();
+	properties.append(dtuProperty("Diffuse Color", "#ff0000", sColor, "Color"));
+	properties.append(dtuProperty("Metallic Weight", 1.0, sMetallic));
+	properties.append(dtuProperty("Glossy Roughness", 0.5, sRoughness));
+	properties.append(dtuProperty("Cutout Opacity", 1.0, sCutout));
+	properties.append(dtuProperty("Normal Map", 1.0, sNormal));
+	properties.append(dtuProperty("Emission Color", "#000000", path("missing.png"), "Color"));
+	JsonValue materials = JsonValue::array();
+	materials.append(dtuMaterial("Hair", properties));
+	materials.append(dtuMaterial("Hair Copy", properties));
+	DtuFile dtu = loadDtu(materials);
+
+	Scene scene;
+	TextureProcessor textures;
+	textures.setOutputFolder(path("out"));
+	MaterialMapper mapper;
+	mapper.mapMaterials(dtu, scene, textures);
+	ASSERT_EQ(scene.aMaterials.size(), 2u);
+	const SceneMaterial& material = scene.aMaterials[0];
+	EXPECT_FLOAT_EQ(material.aBaseColorFactor[1], 1.0f);
+	EXPECT_FLOAT_EQ(material.fMetallicFactor, 1.0f);
+	EXPECT_FLOAT_EQ(material.fRoughnessFactor, 1.0f);
+	EXPECT_FLOAT_EQ(material.fNormalScale, 0.5f);
+	EXPECT_EQ(material.sAlphaMode, "BLEND");
+	EXPECT_TRUE(material.baseColorTexture.isSet());
+	EXPECT_TRUE(material.metallicRoughnessTexture.isSet());
+	EXPECT_TRUE(material.normalTexture.isSet());
+	EXPECT_FALSE(material.emissiveTexture.isSet());
+	EXPECT_FALSE(material.occlusionTexture.isSet());
+	// color + cutout, metallic-roughness and normal, shared by both materials
+	EXPECT_EQ(textures.getJobCount(), 3u);
+	EXPECT_EQ(scene.aImages.size(), 3u);
+	EXPECT_EQ(scene.aMaterials[1].baseColorTexture.nImage, material.baseColorTexture.nImage);
+
+	ASSERT_TRUE(textures.process());
+	mapper.resolveImages(scene, textures);
+	ImageData packed;
+	std::string sError;
+	ASSERT_TRUE(loadImage(scene.aImages[material.metallicRoughnessTexture.nImage].sFilePath, packed, sError)) << sError;
+	EXPECT_EQ(packed.nWidth, 16);
+	EXPECT_EQ(packed.nChannels, 3);
+	EXPECT_EQ(packed.pixel(3, 3)[0], 255);
+	EXPECT_EQ(packed.pixel(3, 3)[1], 100);
+	EXPECT_EQ(packed.pixel(3, 3)[2], 50);
+}
+
+TEST_F(MaterialMapperTest, EyeScalpAndRefraction)
+{
+	std::string sCutout = writeImage("cutout.png", 4, 4, 1, 255);
+	JsonValue cutoutProperties = JsonValue::array();
+	cutoutProperties.append(dtuProperty("Cutout Opacity", 1.0, sCutout));
+	JsonValue refractionProperties = JsonValue::array();
+	refractionProperties.append(dtuProperty("Refraction Weight", 1.0));
+	refractionProperties.append(dtuProperty("Glossy Roughness", 0.5));
+	refractionProperties.append(dtuProperty("Glossy Reflectivity", 0.5));
+	JsonValue materials = JsonValue::array();
+	materials.append(dtuMaterial("Eye Left", cutoutProperties));
+	materials.append(dtuMaterial("Hair Cap", cutoutProperties));
+	materials.append(dtuMaterial("Cornea", refractionProperties));
+	DtuFile dtu = loadDtu(materials);
+
+	Scene scene;
+	TextureProcessor textures;
+	MaterialMapper mapper;
+	mapper.mapMaterials(dtu, scene, textures);
+	EXPECT_EQ(scene.aMaterials[0].sAlphaMode, "MASK");
+	EXPECT_TRUE(scene.aMaterials[0].bDoubleSided);
+	EXPECT_EQ(scene.aMaterials[1].sAlphaMode, "MASK");
+	EXPECT_FALSE(scene.aMaterials[1].bDoubleSided);
+	const SceneMaterial& cornea = scene.aMaterials[2];
+	EXPECT_EQ(cornea.sAlphaMode, "BLEND");
+	EXPECT_FLOAT_EQ(cornea.aBaseColorFactor[3], 0.0f);
+	EXPECT_FLOAT_EQ(cornea.fRoughnessFactor, 0.0f);
+	EXPECT_FLOAT_EQ(cornea.fMetallicFactor, 1.0f);
+	EXPECT_FLOAT_EQ(cornea.fSpecularFactor, 0.0f);
+}
+
+TEST_F(MaterialMapperTest, PackOcclusion)
+{
+	std::string sRoughness = writeImage("rough.png", 4, 4, 1, 100);
+	std::string sOcclusion = writeImage("ao.png", 4, 4, 1, 30);
+	JsonValue properties = JsonValue::array();
+	properties.append(dtuProperty("Glossy Roughness", 0.5, sRoughness));
+	properties.append(dtuProperty("Ambient Occlusion", 1.0, sOcclusion));
+	JsonValue materials = JsonValue::array();
+	materials.append(dtuMaterial("Body", properties));
+	DtuFile dtu = loadDtu(materials);
+
+	Scene scene;
+	TextureProcessor textures;
+	MaterialMapper mapper;
+	mapper.mapMaterials(dtu, scene, textures);
+	EXPECT_FALSE(scene.aMaterials[0].occlusionTexture.isSet());
+
+	Scene packedScene;
+	TextureProcessor packedTextures;
+	MaterialMapper packedMapper;
+	packedMapper.setPackOcclusion(true);
+	packedMapper.mapMaterials(dtu, packedScene, packedTextures);
+	const SceneMaterial& material = packedScene.aMaterials[0];
+	EXPECT_TRUE(material.occlusionTexture.isSet());
+	EXPECT_EQ(material.occlusionTexture.nImage, material.metallicRoughnessTexture.nImage);
+	EXPECT_FLOAT_EQ(material.fMetallicFactor, 0.0f);
+}
@@ -0,0 +1,58 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "Math.h"
+
+using namespace Dtu2Godot;
+
+TEST(MathTest, EulerRotationOrder)
+{
+	// XYZ applies X first: the X axis rotated 90 degrees about Y ends on -Z, then about Z stays -Z
+	double aDegrees[3] = { 0, 90, 90 };
+	double aAxis[3] = { 1, 0, 0 }, aResult[3];
+	Matrix4::eulerRotation(aDegrees, 0).transformVector(aAxis, aResult);
+	EXPECT_NEAR(aResult[0], 0.0, 1e-9);
+	EXPECT_NEAR(aResult[1], 0.0, 1e-9);
+	EXPECT_NEAR(aResult[2], -1.0, 1e-9);
+	// ZYX applies Z first: X goes to Y, which the Y rotation keeps
+	Matrix4::eulerRotation(aDegrees, 5).transformVector(aAxis, aResult);
+	EXPECT_NEAR(aResult[1], 1.0, 1e-9);
+}
+
+TEST(MathTest, InverseAndTransform)
+{
+	double aTranslation[3] = { 1, 2, 3 }, aScale[3] = { 2, 2, 2 }, aDegrees[3] = { 30, 45, 60 };
+	Matrix4 matrix = Matrix4::translation(aTranslation) * Matrix4::eulerRotation(aDegrees) * Matrix4::scaling(aScale);
+	Matrix4 identity = matrix * matrix.inverse();
+	for (int i = 0; i < 16; i++) EXPECT_NEAR(identity.m[i], (i % 5 == 0) ? 1.0 : 0.0, 1e-9);
+	double aPoint[3] = { 0, 0, 0 }, aResult[3];
+	matrix.transformPoint(aPoint, aResult);
+	EXPECT_DOUBLE_EQ(aResult[2], 3.0);
+}
+
+TEST(MathTest, Decompose)
+{
+	double aTranslation[3] = { 1, 2, 3 }, aScale[3] = { 1, 2, 3 }, aDegrees[3] = { 0, 0, 90 };
+	Matrix4 matrix = Matrix4::translation(aTranslation) * Matrix4::eulerRotation(aDegrees) * Matrix4::scaling(aScale);
+	double aT[3], aR[4], aS[3];
+	matrix.decompose(aT, aR, aS);
+	EXPECT_DOUBLE_EQ(aT[1], 2.0);
+	EXPECT_NEAR(aS[2], 3.0, 1e-9);
+	EXPECT_NEAR(aR[2], std::sqrt(0.5), 1e-9);
+	EXPECT_NEAR(aR[3], std::sqrt(0.5), 1e-9);
+}
+
+TEST(MathTest, QuaternionRotation)
+{
+	// 90 degrees about Y turns X into -Z
+	double aRotation[4] = { 0, std::sqrt(0.5), 0, std::sqrt(0.5) };
+	double aAxis[3] = { 1, 0, 0 }, aResult[3];
+	Matrix4 matrix = Matrix4::quaternionRotation(aRotation);
+	matrix.transformVector(aAxis, aResult);
+	EXPECT_NEAR(aResult[0], 0.0, 1e-9);
+	EXPECT_NEAR(aResult[2], -1.0, 1e-9);
+	double aT[3], aR[4], aS[3];
+	matrix.decompose(aT, aR, aS);
+	for (int i = 0; i < 4; i++) EXPECT_NEAR(aR[i], aRotation[i], 1e-9);
+}
@@ -0,0 +1,230 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "MeshOptimizer.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+// one triangle on vertices 1..3, vertex 0 is unused
+ScenePrimitive makeTriangle(int nMaterial, float fX)
+{
+	ScenePrimitive primitive;
+	primitive.aPositions = { 9, 9, 9, fX, 0, 0, fX + 1, 0, 0, fX, 1, 0 };
+	primitive.aNormals = { 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+	primitive.aTexCoords.push_back({ 0, 0, 0, 1, 1, 1, 0, 0 });
+	primitive.aTexCoords.push_back({ 0, 0, 0, 0, 0, 0, 0, 0 });
+	primitive.aIndices = { 1, 2, 3 };
+	primitive.nMaterial = nMaterial;
+	return primitive;
+}
+
+SceneMaterial makeMaterial(const std::string& sName, int nImage)
+{
+	SceneMaterial material;
+	material.sName = sName;
+	material.baseColorTexture.nImage = nImage;
+	return material;
+}
+}
+
+TEST(MeshOptimizerTest, MaterialSignature)
+{
+	SceneMaterial a = makeMaterial("Arms", 0), b = makeMaterial("Legs", 0);
+	EXPECT_TRUE(MeshOptimizer::haveSameSignature(a, b));
+	b.baseColorTexture.nTexCoord = 1;
+	EXPECT_FALSE(MeshOptimizer::haveSameSignature(a, b));
+	b = makeMaterial("Legs", 1);
+	EXPECT_FALSE(MeshOptimizer::haveSameSignature(a, b));
+
+	EXPECT_FALSE(MeshOptimizer::isInvisible(a));
+	a.aBaseColorFactor[3] = 0.0f;
+	EXPECT_FALSE(MeshOptimizer::isInvisible(a));
+	a.sAlphaMode = "BLEND";
+	EXPECT_TRUE(MeshOptimizer::isInvisible(a));
+}
+
+TEST(MeshOptimizerTest, RemovesUnusedVertices)
+{
+	ScenePrimitive primitive = makeTriangle(-1, 0);
+	primitive.nInfluences = 4;
+	primitive.aJoints = { 9, 9, 9, 9, 1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0 };
+	primitive.aWeights.assign(16, 0.25f);
+	SceneMorphTarget morph;
+	morph.aPositionDeltas = { 9, 9, 9, 1, 0, 0, 2, 0, 0, 3, 0, 0 };
+	primitive.aMorphTargets.push_back(morph);
+
+	EXPECT_EQ(MeshOptimizer::removeUnusedVertices(primitive), 1u);
+	EXPECT_EQ(primitive.getVertexCount(), 3u);
+	EXPECT_EQ(primitive.aIndices, (std::vector<uint32_t>{ 0, 1, 2 }));
+	EXPECT_FLOAT_EQ(primitive.aPositions[3], 1.0f);
+	EXPECT_EQ(primitive.aTexCoords[0].size(), 6u);
+	EXPECT_EQ(primitive.aJoints.size(), 12u);
+	EXPECT_EQ(primitive.aJoints[4], 2);
+	EXPECT_FLOAT_EQ(primitive.aMorphTargets[0].aPositionDeltas[6], 3.0f);
+	EXPECT_EQ(MeshOptimizer::removeUnusedVertices(primitive), 0u);
+}
+
+TEST(MeshOptimizerTest, PrunesAndMergesSurfaces)
+{
+	Scene scene;
+	scene.aImages.resize(2);
+	scene.aImages[1].sName = "Skin";
+	scene.aMaterials.push_back(makeMaterial("Cornea", 0));
+	scene.aMaterials[0].sAlphaMode = "BLEND";
+	scene.aMaterials[0].aBaseColorFactor[3] = 0.0f;
+	scene.aMaterials.push_back(makeMaterial("Arms", 1));
+	scene.aMaterials.push_back(makeMaterial("Legs", 1));
+	scene.aMaterials.push_back(makeMaterial("Torso", -1));
+
+	SceneMesh body;
+	body.aPrimitives.push_back(makeTriangle(0, 0));
+	body.aPrimitives.push_back(makeTriangle(1, 2));
+	body.aPrimitives.push_back(makeTriangle(2, 4));
+	body.aPrimitives.push_back(makeTriangle(3, 6));
+	// a surface without triangles
+	body.aPrimitives.push_back(makeTriangle(3, 8));
+	body.aPrimitives.back().aIndices.clear();
+	scene.aMeshes.push_back(body);
+
+	// a mesh with only the invisible surface goes away, with its skin and morph animation
+	SceneMesh eyes;
+	eyes.aPrimitives.push_back(makeTriangle(0, 0));
+	scene.aMeshes.push_back(eyes);
+	scene.aNodes.resize(2);
+	scene.aNodes[0].nMesh = 1;
+	scene.aNodes[0].nSkin = 0;
+	scene.aNodes[1].nMesh = 0;
+	SceneAnimation animation;
+	animation.aChannels.resize(2);
+	animation.aChannels[0].nNode = 0;
+	animation.aChannels[0].sPath = "weights";
+	animation.aChannels[1].nNode = 0;
+	animation.aChannels[1].sPath = "rotation";
+	scene.aAnimations.push_back(animation);
+
+	MeshOptimizer optimizer;
+	MeshOptimizer::Statistics statistics = optimizer.process(scene);
+	EXPECT_EQ(statistics.nRemovedPrimitives, 3u);
+	EXPECT_EQ(statistics.nMergedPrimitives, 1u);
+	EXPECT_EQ(statistics.nRemovedVertices, 3u);
+	EXPECT_EQ(statistics.nRemovedTexCoordSets, 3u);
+	EXPECT_EQ(statistics.nRemovedMeshes, 1u);
+	EXPECT_EQ(statistics.nRemovedMaterials, 2u);
+
+	ASSERT_EQ(scene.aMeshes.size(), 1u);
+	const std::vector<ScenePrimitive>& aPrimitives = scene.aMeshes[0].aPrimitives;
+	ASSERT_EQ(aPrimitives.size(), 2u);
+	// Arms and Legs share everything but the name
+	EXPECT_EQ(aPrimitives[0].getVertexCount(), 6u);
+	EXPECT_EQ(aPrimitives[0].aIndices, (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5 }));
+	EXPECT_FLOAT_EQ(aPrimitives[0].aPositions[9], 4.0f);
+	EXPECT_EQ(aPrimitives[0].aTexCoords.size(), 1u);
+	EXPECT_EQ(aPrimitives[1].getVertexCount(), 3u);
+
+	ASSERT_EQ(scene.aMaterials.size(), 2u);
+	EXPECT_EQ(scene.aMaterials[aPrimitives[0].nMaterial].sName, "Arms");
+	EXPECT_EQ(scene.aMaterials[aPrimitives[1].nMaterial].sName, "Torso");
+	ASSERT_EQ(scene.aImages.size(), 1u);
+	EXPECT_EQ(scene.aImages[0].sName, "Skin");
+	EXPECT_EQ(scene.aMaterials[0].baseColorTexture.nImage, 0);
+
+	EXPECT_EQ(scene.aNodes[0].nMesh, -1);
+	EXPECT_EQ(scene.aNodes[0].nSkin, -1);
+	EXPECT_EQ(scene.aNodes[1].nMesh, 0);
+	ASSERT_EQ(scene.aAnimations[0].aChannels.size(), 1u);
+	EXPECT_EQ(scene.aAnimations[0].aChannels[0].sPath, "rotation");
+}
+
+TEST(MeshOptimizerTest, SharesCopiesOfMeshes)
+{
+	Scene scene;
+	scene.aMaterials.push_back(makeMaterial("Wood", -1));
+	scene.aMaterials.push_back(makeMaterial("Wood.001", -1));
+	// the second chair was placed by baking its transform into the vertices
+	SceneMesh chair;
+	chair.sName = "Chair";
+	chair.aPrimitives.push_back(makeTriangle(0, 0));
+	SceneMesh movedChair = chair;
+	movedChair.sName = "Chair.001";
+	movedChair.aPrimitives[0] = makeTriangle(1, 0);
+	for (size_t i = 0; i < movedChair.aPrimitives[0].aPositions.size(); i += 3) movedChair.aPrimitives[0].aPositions[i] += 2.5f;
+	SceneMesh table = chair;
+	table.sName = "Table";
+	table.aPrimitives[0].aPositions[4] = 2.0f;
+	SceneMesh animatedChair = chair;
+	animatedChair.sName = "Chair.002";
+	for (size_t i = 2; i < animatedChair.aPrimitives[0].aPositions.size(); i += 3) animatedChair.aPrimitives[0].aPositions[i] -= 1.0f;
+	scene.aMeshes = { chair, movedChair, table, animatedChair };
+
+	scene.aNodes.resize(5);
+	scene.aNodes[0].nMesh = 0;
+	scene.aNodes[1].nMesh = 1;
+	scene.aNodes[1].aTranslation[1] = 1.0f;
+	// rotated 90 degrees about Y: the x offset of the copy becomes -z
+	scene.aNodes[1].aRotation[1] = std::sqrt(0.5f);
+	scene.aNodes[1].aRotation[3] = std::sqrt(0.5f);
+	scene.aNodes[2].nMesh = 2;
+	scene.aNodes[3].sName = "Animated";
+	scene.aNodes[3].nMesh = 3;
+	scene.aNodes[3].aChildren.push_back(4);
+	SceneAnimation animation;
+	animation.aChannels.resize(1);
+	animation.aChannels[0].nNode = 3;
+	animation.aChannels[0].sPath = "translation";
+	scene.aAnimations.push_back(animation);
+
+	MeshOptimizer optimizer;
+	EXPECT_EQ(optimizer.deduplicateMeshes(scene), 2u);
+	ASSERT_EQ(scene.aMeshes.size(), 2u);
+	EXPECT_EQ(scene.aMeshes[0].sName, "Chair");
+	EXPECT_EQ(scene.aMeshes[1].sName, "Table");
+	EXPECT_EQ(scene.aNodes[1].nMesh, 0);
+	EXPECT_NEAR(scene.aNodes[1].aTranslation[0], 0.0f, 1e-6f);
+	EXPECT_NEAR(scene.aNodes[1].aTranslation[1], 1.0f, 1e-6f);
+	EXPECT_NEAR(scene.aNodes[1].aTranslation[2], -2.5f, 1e-6f);
+	EXPECT_EQ(scene.aNodes[2].nMesh, 1);
+	// the animated node keeps its transform and gets a child with the offset
+	EXPECT_EQ(scene.aNodes[3].nMesh, -1);
+	ASSERT_EQ(scene.aNodes.size(), 6u);
+	EXPECT_EQ(scene.aNodes[3].aChildren, (std::vector<int>{ 4, 5 }));
+	EXPECT_EQ(scene.aNodes[5].sName, "Animated_mesh");
+	EXPECT_EQ(scene.aNodes[5].nMesh, 0);
+	EXPECT_FLOAT_EQ(scene.aNodes[5].aTranslation[2], -1.0f);
+	// the copies used the other material
+	ASSERT_EQ(scene.aMaterials.size(), 1u);
+	EXPECT_EQ(scene.aMaterials[0].sName, "Wood");
+}
+
+TEST(MeshOptimizerTest, KeepsMaterialsWhenNothingIsPruned)
+{
+	Scene scene;
+	scene.aMaterials.push_back(makeMaterial("Hair", -1));
+	scene.aMaterials[0].sAlphaMode = "MASK";
+	scene.aMaterials.push_back(makeMaterial("Skin", -1));
+	SceneMesh mesh;
+	mesh.aPrimitives.push_back(makeTriangle(0, 0));
+	mesh.aPrimitives.push_back(makeTriangle(1, 2));
+	scene.aMeshes.push_back(mesh);
+	scene.aNodes.resize(1);
+	scene.aNodes[0].nMesh = 0;
+
+	MeshOptimizer optimizer;
+	EXPECT_EQ(optimizer.deduplicateMeshes(scene), 0u);
+	ASSERT_EQ(scene.aMaterials.size(), 2u);
+	EXPECT_EQ(scene.aMaterials[0].sName, "Hair");
+	EXPECT_EQ(scene.aMaterials[0].sAlphaMode, "MASK");
+	EXPECT_EQ(scene.aMaterials[1].sAlphaMode, "OPAQUE");
+
+	MeshOptimizer::Statistics statistics = optimizer.process(scene);
+	EXPECT_EQ(statistics.nRemovedMeshes, 0u);
+	EXPECT_EQ(statistics.nRemovedMaterials, 0u);
+	ASSERT_EQ(scene.aMeshes.size(), 1u);
+	ASSERT_EQ(scene.aMaterials.size(), 2u);
+	EXPECT_EQ(scene.aMaterials[0].sName, "Hair");
+	EXPECT_EQ(scene.aMaterials[0].sAlphaMode, "MASK");
+	EXPECT_EQ(scene.aMaterials[1].sName, "Skin");
+	EXPECT_EQ(scene.aMaterials[1].sAlphaMode, "OPAQUE");
+}
@@ -0,0 +1,216 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "Subdivider.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+// unit quad in the XY plane, counter-clockwise seen from +Z
+SubdivisionMesh makeQuad()
+{
+	SubdivisionMesh mesh;
+	mesh.aPositions = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 };
+	mesh.aFaceSizes = { 4 };
+	mesh.aFaceVertices = { 0, 1, 2, 3 };
+	return mesh;
+}
+
+// cube [-1, 1]^3 with outward facing quads
+SubdivisionMesh makeCube()
+{
+	SubdivisionMesh mesh;
+	mesh.aPositions = { -1, -1, -1, 1, -1, -1, 1, 1, -1, -1, 1, -1, -1, -1, 1, 1, -1, 1, 1, 1, 1, -1, 1, 1 };
+	mesh.aFaceSizes = { 4, 4, 4, 4, 4, 4 };
+	mesh.aFaceVertices = { 0, 3, 2, 1, 4, 5, 6, 7, 0, 1, 5, 4, 1, 2, 6, 5, 2, 3, 7, 6, 3, 0, 4, 7 };
+	return mesh;
+}
+
+// nSize x nSize quads in the XY plane
+SubdivisionMesh makeGrid(int nSize)
+{
+	SubdivisionMesh mesh;
+	for (int y = 0; y <= nSize; y++)
+	{
+		for (int x = 0; x <= nSize; x++)
+		{
+			mesh.aPositions.insert(mesh.aPositions.end(), { (double)x, (double)y, std::sin(x * 0.7) * std::cos(y * 0.3) });
+		}
+	}
+	for (int y = 0; y < nSize; y++)
+	{
+		for (int x = 0; x < nSize; x++)
+		{
+			uint32_t n = (uint32_t)(y * (nSize + 1) + x);
+			mesh.aFaceSizes.push_back(4);
+			mesh.aFaceVertices.insert(mesh.aFaceVertices.end(), { n, n + 1, n + (uint32_t)nSize + 2, n + (uint32_t)nSize + 1 });
+		}
+	}
+	return mesh;
+}
+
+int findVertex(const SubdivisionMesh& mesh, double x, double y, double z)
+{
+	for (size_t v = 0; v < mesh.getVertexCount(); v++)
+	{
+		const double* p = &mesh.aPositions[v * 3];
+		if (std::fabs(p[0] - x) < 1e-9 && std::fabs(p[1] - y) < 1e-9 && std::fabs(p[2] - z) < 1e-9) return (int)v;
+	}
+	return -1;
+}
+}
+
+TEST(SubdividerTest, SplitsPolygonsIntoQuads)
+{
+	SubdivisionMesh mesh = makeQuad();
+	mesh.aFaceSizes = { 3, 3 };
+	mesh.aFaceVertices = { 0, 1, 2, 0, 2, 3 };
+	mesh.aFaceMaterials = { 0, 1 };
+	Subdivider subdivider;
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+	// 2 face points, 5 edge points, 4 vertex points
+	EXPECT_EQ(mesh.getVertexCount(), 11u);
+	EXPECT_EQ(mesh.aFaceSizes, std::vector<uint32_t>(6, 4));
+	EXPECT_EQ(mesh.aFaceMaterials, std::vector<int64_t>({ 0, 0, 0, 1, 1, 1 }));
+
+	ASSERT_TRUE(subdivider.subdivide(mesh, 2)) << subdivider.getError();
+	EXPECT_EQ(mesh.getFaceCount(), 6u * 16u);
+}
+
+TEST(SubdividerTest, KeepsBoundaryCorners)
+{
+	SubdivisionMesh mesh = makeQuad();
+	Subdivider subdivider;
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+	ASSERT_EQ(mesh.getVertexCount(), 9u);
+	EXPECT_GE(findVertex(mesh, 0, 0, 0), 0);
+	EXPECT_GE(findVertex(mesh, 1, 1, 0), 0);
+	EXPECT_GE(findVertex(mesh, 0.5, 0.5, 0), 0);
+	// boundary edges are split at their midpoints
+	EXPECT_GE(findVertex(mesh, 0.5, 0, 0), 0);
+	EXPECT_GE(findVertex(mesh, 1, 0.5, 0), 0);
+}
+
+TEST(SubdividerTest, SmoothsClosedMeshes)
+{
+	SubdivisionMesh mesh = makeCube();
+	Subdivider subdivider;
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+	EXPECT_EQ(mesh.getVertexCount(), 26u);
+	EXPECT_EQ(mesh.getFaceCount(), 24u);
+	// valence 3 corners move to 5/9, edge points to 3/4
+	const double f = 5.0 / 9.0;
+	EXPECT_GE(findVertex(mesh, f, f, f), 0);
+	EXPECT_GE(findVertex(mesh, -f, -f, -f), 0);
+	EXPECT_GE(findVertex(mesh, 0.75, 0.75, 0), 0);
+	EXPECT_GE(findVertex(mesh, 0, 0, 1), 0);
+
+	// the normals point outwards
+	std::vector<double> aNormals = subdivider.computeNormals(mesh);
+	int nCorner = findVertex(mesh, f, f, f);
+	double fInvSqrt3 = 1.0 / std::sqrt(3.0);
+	for (int c = 0; c < 3; c++) EXPECT_NEAR(aNormals[nCorner * 3 + c], fInvSqrt3, 1e-9);
+}
+
+TEST(SubdividerTest, InterpolatesMorphsAndSkinWeights)
+{
+	SubdivisionMesh mesh = makeCube();
+	// deltas of a uniform scale, which subdivision keeps proportional to the positions
+	mesh.aMorphDeltas.push_back(std::vector<float>(mesh.aPositions.begin(), mesh.aPositions.end()));
+	for (float& fDelta : mesh.aMorphDeltas[0]) fDelta *= 0.5f;
+	// bottom on joint 0, top on joint 1
+	mesh.nInfluences = 2;
+	for (size_t v = 0; v < 8; v++)
+	{
+		bool bTop = mesh.aPositions[v * 3 + 2] > 0.0;
+		mesh.aJoints.insert(mesh.aJoints.end(), { bTop ? 1 : 0, -1 });
+		mesh.aWeights.insert(mesh.aWeights.end(), { 1.0f, 0.0f });
+	}
+	Subdivider subdivider;
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+	// the face point of a side blends both joints equally
+	int nSide = findVertex(mesh, 1, 0, 0);
+	ASSERT_GE(nSide, 0);
+	EXPECT_NEAR(mesh.aWeights[nSide * 2], 0.5f, 1e-6f);
+	EXPECT_NEAR(mesh.aWeights[nSide * 2 + 1], 0.5f, 1e-6f);
+
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+	for (size_t v = 0; v < mesh.getVertexCount(); v++)
+	{
+		for (int c = 0; c < 3; c++) EXPECT_NEAR(mesh.aMorphDeltas[0][v * 3 + c], 0.5 * mesh.aPositions[v * 3 + c], 1e-6);
+		EXPECT_NEAR(mesh.aWeights[v * 2] + mesh.aWeights[v * 2 + 1], 1.0f, 1e-6f);
+		EXPECT_GE(mesh.aWeights[v * 2], mesh.aWeights[v * 2 + 1]);
+	}
+}
+
+TEST(SubdividerTest, InterpolatesUvsLinearly)
+{
+	// two quads side by side with a UV seam on the shared edge
+	SubdivisionMesh mesh;
+	mesh.aPositions = { 0, 0, 0, 1, 0, 0, 2, 0, 0, 0, 1, 0, 1, 1, 0, 2, 1, 0 };
+	mesh.aFaceSizes = { 4, 4 };
+	mesh.aFaceVertices = { 0, 1, 4, 3, 1, 2, 5, 4 };
+	SubdivisionMesh::UvSet uvs;
+	uvs.aValues = { 0, 0, 1, 0, 1, 1, 0, 1, 2, 0, 3, 0, 3, 1, 2, 1 };
+	uvs.aIndices = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	mesh.aUvSets.push_back(uvs);
+	Subdivider subdivider;
+	ASSERT_TRUE(subdivider.subdivide(mesh, 1)) << subdivider.getError();
+
+	ASSERT_EQ(mesh.aUvSets.size(), 1u);
+	const SubdivisionMesh::UvSet& result = mesh.aUvSets[0];
+	ASSERT_EQ(result.aIndices.size(), 32u);
+	// the child quads meet at the parent face point: its uv is the face center
+	EXPECT_DOUBLE_EQ(result.aValues[result.aIndices[2] * 2], 0.5);
+	EXPECT_DOUBLE_EQ(result.aValues[result.aIndices[2] * 2 + 1], 0.5);
+	EXPECT_DOUBLE_EQ(result.aValues[result.aIndices[16 + 2] * 2], 2.5);
+	// the shared edge keeps a UV on each side of the seam
+	std::vector<double> aSeamUs;
+	for (size_t c = 0; c < result.aIndices.size(); c++)
+	{
+		const double* pUv = &result.aValues[result.aIndices[c] * 2];
+		const double* pPosition = &mesh.aPositions[mesh.aFaceVertices[c] * 3];
+		if (pPosition[0] == 1.0 && std::fabs(pPosition[1] - 0.5) < 1e-9) aSeamUs.push_back(pUv[0]);
+	}
+	ASSERT_EQ(aSeamUs.size(), 4u);
+	for (double fU : aSeamUs) EXPECT_TRUE(fU == 1.0 || fU == 2.0) << fU;
+}
+
+TEST(SubdividerTest, ParallelPatchesMatchSerial)
+{
+	SubdivisionMesh serial = makeGrid(12);
+	serial.aMorphDeltas.push_back(std::vector<float>(serial.getVertexCount() * 3, 0.25f));
+	SubdivisionMesh parallel = serial;
+
+	Subdivider serialSubdivider;
+	serialSubdivider.setThreads(1);
+	ASSERT_TRUE(serialSubdivider.subdivide(serial, 2)) << serialSubdivider.getError();
+	Subdivider parallelSubdivider;
+	parallelSubdivider.setThreads(4);
+	parallelSubdivider.setPatchSize(7);
+	ASSERT_TRUE(parallelSubdivider.subdivide(parallel, 2)) << parallelSubdivider.getError();
+
+	EXPECT_EQ(serial.aFaceVertices, parallel.aFaceVertices);
+	EXPECT_EQ(serial.aPositions, parallel.aPositions);
+	EXPECT_EQ(serial.aMorphDeltas, parallel.aMorphDeltas);
+	EXPECT_EQ(serialSubdivider.computeNormals(serial), parallelSubdivider.computeNormals(parallel));
+}
+
+TEST(SubdividerTest, RejectsInvalidMeshes)
+{
+	Subdivider subdivider;
+	SubdivisionMesh mesh = makeQuad();
+	mesh.aFaceVertices[2] = 7;
+	EXPECT_FALSE(subdivider.subdivide(mesh, 1));
+	EXPECT_NE(subdivider.getError().find("control point"), std::string::npos) << subdivider.getError();
+
+	mesh = makeQuad();
+	mesh.aMorphDeltas.push_back(std::vector<float>(3, 0.0f));
+	EXPECT_FALSE(subdivider.subdivide(mesh, 1));
+
+	mesh = makeQuad();
+	mesh.aFaceSizes = { 2, 2 };
+	EXPECT_FALSE(subdivider.subdivide(mesh, 1));
+}
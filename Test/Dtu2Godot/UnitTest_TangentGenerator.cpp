@@ -0,0 +1,95 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "TangentGenerator.h"
+
+using namespace Dtu2Godot;
+
+namespace
+{
+// unit quad in the XY plane facing +Z, u along +X and glTF v (pointing down) along -Y
+ScenePrimitive makeQuad()
+{
+	ScenePrimitive primitive;
+	primitive.aPositions = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 };
+	primitive.aNormals = { 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+	primitive.aTexCoords.push_back({ 0, 1, 1, 1, 1, 0, 0, 0 });
+	primitive.aIndices = { 0, 1, 2, 0, 2, 3 };
+	return primitive;
+}
+}
+
+TEST(TangentGeneratorTest, TangentFollowsU)
+{
+	ScenePrimitive primitive = makeQuad();
+	ASSERT_TRUE(TangentGenerator::generateTangents(primitive));
+	ASSERT_EQ(primitive.aTangents.size(), 16u);
+	for (int v = 0; v < 4; v++)
+	{
+		EXPECT_NEAR(primitive.aTangents[v * 4], 1.0f, 1e-6f);
+		EXPECT_NEAR(primitive.aTangents[v * 4 + 1], 0.0f, 1e-6f);
+		EXPECT_NEAR(primitive.aTangents[v * 4 + 2], 0.0f, 1e-6f);
+		// bitangent = cross(normal, tangent) * w = +Y, up in the normal map
+		EXPECT_FLOAT_EQ(primitive.aTangents[v * 4 + 3], 1.0f);
+	}
+}
+
+TEST(TangentGeneratorTest, MirroredUvsFlipSign)
+{
+	ScenePrimitive primitive = makeQuad();
+	primitive.aTexCoords[0] = { 1, 1, 0, 1, 0, 0, 1, 0 };
+	ASSERT_TRUE(TangentGenerator::generateTangents(primitive));
+	EXPECT_NEAR(primitive.aTangents[0], -1.0f, 1e-6f);
+	EXPECT_FLOAT_EQ(primitive.aTangents[3], -1.0f);
+}
+
+TEST(TangentGeneratorTest, TangentIsOrthogonalToNormal)
+{
+	ScenePrimitive primitive = makeQuad();
+	// bent normals, as on a smooth surface
+	float fComponent = std::sqrt(0.5f);
+	primitive.aNormals = { fComponent, 0, fComponent, 0, 0, 1, 0, 0, 1, -fComponent, 0, fComponent };
+	ASSERT_TRUE(TangentGenerator::generateTangents(primitive));
+	for (int v = 0; v < 4; v++)
+	{
+		const float* pTangent = &primitive.aTangents[v * 4];
+		const float* pNormal = &primitive.aNormals[v * 3];
+		EXPECT_NEAR(pTangent[0] * pNormal[0] + pTangent[1] * pNormal[1] + pTangent[2] * pNormal[2], 0.0f, 1e-6f);
+		EXPECT_NEAR(pTangent[0] * pTangent[0] + pTangent[1] * pTangent[1] + pTangent[2] * pTangent[2], 1.0f, 1e-5f);
+	}
+}
+
+TEST(TangentGeneratorTest, ProcessesSceneInParallel)
+{
+	Scene scene;
+	SceneMaterial material;
+	material.normalTexture.nImage = 0;
+	material.normalTexture.nTexCoord = 1;
+	scene.aMaterials.push_back(material);
+	SceneMesh mesh;
+	for (int i = 0; i < 8; i++) mesh.aPrimitives.push_back(makeQuad());
+	// normal map on the second UV set, mirrored against the first
+	mesh.aPrimitives[0].nMaterial = 0;
+	mesh.aPrimitives[0].aTexCoords.push_back({ 1, 1, 0, 1, 0, 0, 1, 0 });
+	// no UVs, no tangents
+	mesh.aPrimitives[7].aTexCoords.clear();
+	scene.aMeshes.push_back(mesh);
+
+	TangentGenerator generator;
+	generator.setThreads(4);
+	EXPECT_EQ(generator.process(scene), 7u);
+	EXPECT_NEAR(scene.aMeshes[0].aPrimitives[0].aTangents[0], -1.0f, 1e-6f);
+	EXPECT_NEAR(scene.aMeshes[0].aPrimitives[1].aTangents[0], 1.0f, 1e-6f);
+	EXPECT_TRUE(scene.aMeshes[0].aPrimitives[7].aTangents.empty());
+	// existing tangents are kept
+	EXPECT_EQ(generator.process(scene), 0u);
+}
+
+TEST(TangentGeneratorTest, RejectsPrimitivesWithoutNormals)
+{
+	ScenePrimitive primitive = makeQuad();
+	primitive.aNormals.clear();
+	EXPECT_FALSE(TangentGenerator::generateTangents(primitive));
+	EXPECT_FALSE(TangentGenerator::generateTangents(primitive, 3));
+}
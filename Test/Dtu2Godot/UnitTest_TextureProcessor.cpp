@@ -0,0 +1,74 @@
+#include <filesystem>
+
+#include "TestUtils.h"
+#include "TextureProcessor.h"
+
+using namespace Dtu2Godot;
+
+class TextureProcessorTest : public TempFolderTest {};
+
+TEST_F(TextureProcessorTest, PassThroughAndConvert)
+{
+	std::string sSmall = writeImage("small.png", 16, 16, 3, 10);
+	std::string sLarge = writeImage("large.jpg", 64, 32, 3, 20);
+	std::filesystem::create_directories(path("other"));
+	std::string sSameName = writeImage("other/small.png", 8, 8, 3, 30);
+
+	TextureProcessor textures;
+	textures.setOutputFolder(path("out"));
+	textures.setMaxTextureSize(32);
+	textures.setThreads(2);
+	int nSmall = textures.addTexture(sSmall);
+	int nLarge = textures.addTexture(sLarge);
+	int nSameName = textures.addTexture(sSameName);
+	EXPECT_EQ(textures.addTexture(sSmall), nSmall);
+	ASSERT_TRUE(textures.process());
+	EXPECT_EQ(textures.getNumPassedThrough(), 2);
+	EXPECT_EQ(textures.getNumConverted(), 1);
+
+	EXPECT_TRUE(textures.getJob(nSmall).bPassedThrough);
+	EXPECT_EQ(textures.getJob(nSmall).sOutputFilename, "small.png");
+	EXPECT_EQ(textures.getJob(nSameName).sOutputFilename, "small_2.png");
+	EXPECT_FALSE(textures.getJob(nLarge).bPassedThrough);
+	ImageInfo info = probeImage(textures.getJob(nLarge).sOutputPath);
+	EXPECT_EQ(info.sFormat, "jpeg");
+	EXPECT_EQ(info.nWidth, 32);
+	EXPECT_EQ(info.nHeight, 16);
+}
+
+TEST_F(TextureProcessorTest, PackedChannels)
+{
+	std::string sColor = writeImage("color.png", 8, 8, 3, 90);
+	std::string sAlpha = writeImage("alpha.png", 4, 4, 1, 40);
+	TextureChannelSource aChannels[4];
+	for (int i = 0; i < 3; i++)
+	{
+		aChannels[i].sFilePath = sColor;
+		aChannels[i].nChannel = i;
+	}
+	aChannels[3].sFilePath = sAlpha;
+	uint8_t aDefaults[4] = { 255, 255, 255, 255 };
+
+	TextureProcessor textures;
+	textures.setOutputFolder(path("out"));
+	int nJob = textures.addPackedTexture("color_rgba", aChannels, aDefaults, 4);
+	EXPECT_EQ(textures.addPackedTexture("color_rgba", aChannels, aDefaults, 4), nJob);
+	ASSERT_TRUE(textures.process());
+
+	ImageData packed;
+	std::string sError;
+	ASSERT_TRUE(loadImage(textures.getJob(nJob).sOutputPath, packed, sError)) << sError;
+	EXPECT_EQ(packed.nWidth, 8);
+	EXPECT_EQ(packed.nChannels, 4);
+	EXPECT_EQ(packed.pixel(5, 5)[0], 90);
+	EXPECT_EQ(packed.pixel(5, 5)[3], 40);
+}
+
+TEST_F(TextureProcessorTest, ReportsMissingSources)
+{
+	TextureProcessor textures;
+	textures.setOutputFolder(path("out"));
+	int nJob = textures.addTexture(path("missing.png"));
+	EXPECT_FALSE(textures.process());
+	EXPECT_FALSE(textures.getJob(nJob).bSucceeded);
+}
@@ -17,6 +17,11 @@ bool UnitTest_DzGodotAction::runUnitTests()
 	RUNTEST(writeConfiguration);
 	RUNTEST(setExportOptions);
 	RUNTEST(readGuiRootFolder);
+	RUNTEST(calculateSkeletonHash);
+	RUNTEST(buildAnimationClipTimeline);
+	RUNTEST(restoreAnimationClipTimeline);
+	RUNTEST(applyExportProfile);
+	RUNTEST(checkExportBudgets);
 
 	return true;
 }
@@ -64,6 +69,41 @@ bool UnitTest_DzGodotAction::readGuiRootFolder(UnitTest::TestResult* testResult)
 	return bResult;
 }
 
+bool UnitTest_DzGodotAction::calculateSkeletonHash(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotAction*>(m_testObject)->calculateSkeletonHash(nullptr));
+	return bResult;
+}
+
+bool UnitTest_DzGodotAction::buildAnimationClipTimeline(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotAction*>(m_testObject)->buildAnimationClipTimeline());
+	return bResult;
+}
+
+bool UnitTest_DzGodotAction::restoreAnimationClipTimeline(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotAction*>(m_testObject)->restoreAnimationClipTimeline());
+	return bResult;
+}
+
+bool UnitTest_DzGodotAction::applyExportProfile(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotAction*>(m_testObject)->applyExportProfile(QVariantMap()));
+	return bResult;
+}
+
+bool UnitTest_DzGodotAction::checkExportBudgets(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotAction*>(m_testObject)->checkExportBudgets());
+	return bResult;
+}
+
 
 #include "moc_UnitTest_DzGodotAction.cpp"
 
@@ -17,6 +17,11 @@ private:
 	bool writeConfiguration(UnitTest::TestResult* testResult);
 	bool setExportOptions(UnitTest::TestResult* testResult);
 	bool readGuiRootFolder(UnitTest::TestResult* testResult);
+	bool calculateSkeletonHash(UnitTest::TestResult* testResult);
+	bool buildAnimationClipTimeline(UnitTest::TestResult* testResult);
+	bool restoreAnimationClipTimeline(UnitTest::TestResult* testResult);
+	bool applyExportProfile(UnitTest::TestResult* testResult);
+	bool checkExportBudgets(UnitTest::TestResult* testResult);
 
 };
 
@@ -17,6 +17,9 @@ bool UnitTest_DzGodotDialog::runUnitTests()
 	RUNTEST(loadSavedSettings);
 	RUNTEST(HandleSelectIntermediateFolderButton);
 	RUNTEST(HandleAssetTypeComboChange);
+	RUNTEST(getExportProfileNames);
+	RUNTEST(getExportProfile);
+	RUNTEST(HandleExportProfileComboChange);
 
 	return true;
 }
@@ -63,6 +66,27 @@ bool UnitTest_DzGodotDialog::HandleAssetTypeComboChange(UnitTest::TestResult* te
 	return bResult;
 }
 
+bool UnitTest_DzGodotDialog::getExportProfileNames(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotDialog*>(m_testObject)->getExportProfileNames());
+	return bResult;
+}
+
+bool UnitTest_DzGodotDialog::getExportProfile(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotDialog*>(m_testObject)->getExportProfile("Desktop"));
+	return bResult;
+}
+
+bool UnitTest_DzGodotDialog::HandleExportProfileComboChange(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotDialog*>(m_testObject)->HandleExportProfileComboChange(0));
+	return bResult;
+}
+
 
 #include "moc_UnitTest_DzGodotDialog.cpp"
 #endif
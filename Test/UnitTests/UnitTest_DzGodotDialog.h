@@ -17,6 +17,9 @@ private:
 	bool loadSavedSettings(UnitTest::TestResult* testResult);
 	bool HandleSelectIntermediateFolderButton(UnitTest::TestResult* testResult);
 	bool HandleAssetTypeComboChange(UnitTest::TestResult* testResult);
+	bool getExportProfileNames(UnitTest::TestResult* testResult);
+	bool getExportProfile(UnitTest::TestResult* testResult);
+	bool HandleExportProfileComboChange(UnitTest::TestResult* testResult);
 
 };
 
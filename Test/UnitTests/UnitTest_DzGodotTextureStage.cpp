@@ -0,0 +1,190 @@
+#ifdef UNITTEST_DZBRIDGE
+
+#include "UnitTest_DzGodotTextureStage.h"
+#include "DzGodotTextureStage.h"
+
+
+UnitTest_DzGodotTextureStage::UnitTest_DzGodotTextureStage()
+{
+	m_testObject = (QObject*) new DzGodotTextureStage();
+}
+
+bool UnitTest_DzGodotTextureStage::runUnitTests()
+{
+	RUNTEST(_DzGodotTextureStage);
+	RUNTEST(collectTextures);
+	RUNTEST(processTexture);
+	RUNTEST(processNode);
+	RUNTEST(setCacheSize);
+	RUNTEST(clearCache);
+	RUNTEST(getOptionsKey);
+	RUNTEST(getSourceKey);
+	RUNTEST(getOutputFilename);
+	RUNTEST(encodeTexture);
+	RUNTEST(convertTexture);
+	RUNTEST(getDecodeSize);
+	RUNTEST(decodeTexture);
+	RUNTEST(acquireMemory);
+	RUNTEST(releaseMemory);
+	RUNTEST(probeTexture);
+	RUNTEST(classifyTexture);
+	RUNTEST(readHeaderBitDepth);
+	RUNTEST(linkTexture);
+	RUNTEST(writeTexture);
+	RUNTEST(getVariantFilename);
+
+	return true;
+}
+
+bool UnitTest_DzGodotTextureStage::_DzGodotTextureStage(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(new DzGodotTextureStage());
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::collectTextures(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->collectTextures(nullptr));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::processTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->processTexture(""));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::processNode(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->processNode(nullptr));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::setCacheSize(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(DzGodotTextureStage::setCacheSize(1024));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::clearCache(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(DzGodotTextureStage::clearCache());
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::getOptionsKey(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->getOptionsKey(QSize(4096, 4096)));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::getSourceKey(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->getSourceKey(QFileInfo("")));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::getOutputFilename(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->getOutputFilename(QFileInfo("")));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::encodeTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	QByteArray encodedData;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->encodeTexture(QFileInfo(""), encodedData, QSize(4096, 4096)));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::convertTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->convertTexture("", ""));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::getDecodeSize(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->getDecodeSize(QSize(8192, 8192), QSize(4096, 4096)));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::decodeTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	QImage image;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->decodeTexture(QFileInfo(""), image, QSize(4096, 4096)));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::acquireMemory(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->acquireMemory(0));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::releaseMemory(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->releaseMemory(0));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::probeTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->probeTexture(QFileInfo("")));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::classifyTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->classifyTexture(QFileInfo(""), DzGodotTextureProbe()));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::readHeaderBitDepth(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->readHeaderBitDepth("", "png"));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::linkTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->linkTexture("", ""));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::writeTexture(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->writeTexture(QFileInfo(""), "", QSize(1024, 1024)));
+	return bResult;
+}
+
+bool UnitTest_DzGodotTextureStage::getVariantFilename(UnitTest::TestResult* testResult)
+{
+	bool bResult = true;
+	TRY_METHODCALL(qobject_cast<DzGodotTextureStage*>(m_testObject)->getVariantFilename("", 1024));
+	return bResult;
+}
+
+
+#include "moc_UnitTest_DzGodotTextureStage.cpp"
+#endif
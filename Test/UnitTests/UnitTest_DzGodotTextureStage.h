@@ -0,0 +1,38 @@
+#pragma once
+#ifdef UNITTEST_DZBRIDGE
+
+#include <QObject>
+#include <UnitTest.h>
+
+class UnitTest_DzGodotTextureStage : public UnitTest {
+	Q_OBJECT
+public:
+	UnitTest_DzGodotTextureStage();
+	bool runUnitTests();
+
+private:
+	bool _DzGodotTextureStage(UnitTest::TestResult* testResult);
+	bool collectTextures(UnitTest::TestResult* testResult);
+	bool processTexture(UnitTest::TestResult* testResult);
+	bool processNode(UnitTest::TestResult* testResult);
+	bool setCacheSize(UnitTest::TestResult* testResult);
+	bool clearCache(UnitTest::TestResult* testResult);
+	bool getOptionsKey(UnitTest::TestResult* testResult);
+	bool getSourceKey(UnitTest::TestResult* testResult);
+	bool getOutputFilename(UnitTest::TestResult* testResult);
+	bool encodeTexture(UnitTest::TestResult* testResult);
+	bool convertTexture(UnitTest::TestResult* testResult);
+	bool getDecodeSize(UnitTest::TestResult* testResult);
+	bool decodeTexture(UnitTest::TestResult* testResult);
+	bool acquireMemory(UnitTest::TestResult* testResult);
+	bool releaseMemory(UnitTest::TestResult* testResult);
+	bool probeTexture(UnitTest::TestResult* testResult);
+	bool classifyTexture(UnitTest::TestResult* testResult);
+	bool readHeaderBitDepth(UnitTest::TestResult* testResult);
+	bool linkTexture(UnitTest::TestResult* testResult);
+	bool writeTexture(UnitTest::TestResult* testResult);
+	bool getVariantFilename(UnitTest::TestResult* testResult);
+
+};
+
+#endif